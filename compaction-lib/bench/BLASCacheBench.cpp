@@ -0,0 +1,302 @@
+/**
+ *  BLAS cache exerciser.  Generates seeded meshes, keys them with BLASCache::HashGeometry and runs
+ *  the cache through a cold start, a warm start, a corrupted entry, a device change and a driver
+ *  change under the same device key.  Serialized structures come from a mock backend whose blobs
+ *  start with the driver id that wrote them, the way D3D12's serialized header carries the driver
+ *  matching identifier.  Fails if a key isn't stable, a cached payload differs from what was
+ *  stored or an invalidation doesn't happen.  The directory is emptied first and left behind.
+ *
+ *  blas_cache_bench [--meshes n] [--vertices n] [--dir path] [--seed n]
+ */
+
+#include "BLASCache.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t    meshes   = 2000;
+        uint32_t    vertices = 4096;
+        std::string directory;
+        uint64_t    seed     = 0x853C49E6748FEA9Bull;
+    };
+
+    // Positions padded to 16 bytes like the engine's Vector4, the padding is garbage on purpose
+    // since only the first 12 bytes may reach the key
+    struct Mesh
+    {
+        std::vector<float>    vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    constexpr uint32_t VertexStride  = 4 * sizeof(float);
+    constexpr uint32_t PositionSize  = 3 * sizeof(float);
+    constexpr uint32_t FormatFloat3  = 6;  // DXGI_FORMAT_R32G32B32_FLOAT
+    constexpr uint32_t FormatUint32  = 42; // DXGI_FORMAT_R32_UINT
+    constexpr uint32_t FormatUint16  = 57; // DXGI_FORMAT_R16_UINT
+    constexpr uint32_t OpaqueFlag    = 1;  // D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE
+    constexpr uint32_t CompactFlag   = 2;  // D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION
+
+    Mesh MakeMesh(Rng& rng, uint32_t vertexCount)
+    {
+        Mesh mesh;
+        mesh.vertices.resize(size_t(vertexCount) * 4);
+        for (float& value : mesh.vertices)
+        {
+            value = static_cast<float>(rng.Next()) / 65536.0f;
+        }
+        mesh.indices.resize(size_t(vertexCount) * 3);
+        for (uint32_t& index : mesh.indices)
+        {
+            index = rng.Next(vertexCount);
+        }
+        return mesh;
+    }
+
+    BLASGeometry Describe(const Mesh& mesh, uint32_t indexFormat = FormatUint32)
+    {
+        BLASGeometry geometry = {};
+        geometry.vertices     = mesh.vertices.data();
+        geometry.vertexCount  = static_cast<uint32_t>(mesh.vertices.size() / 4);
+        geometry.vertexStride = VertexStride;
+        geometry.positionSize = PositionSize;
+        geometry.vertexFormat = FormatFloat3;
+        geometry.indices      = mesh.indices.data();
+        geometry.indexCount   = static_cast<uint32_t>(mesh.indices.size());
+        geometry.indexSize    = sizeof(uint32_t);
+        geometry.indexFormat  = indexFormat;
+        geometry.flags        = OpaqueFlag;
+        return geometry;
+    }
+
+    uint64_t Key(const Mesh& mesh)
+    {
+        BLASGeometry geometry = Describe(mesh);
+        return BLASCache::HashGeometry(&geometry, 1, CompactFlag);
+    }
+
+    // Blobs lead with the driver that serialized them
+    class MockBackend : public BLASSerializationBackend
+    {
+    public:
+
+        explicit MockBackend(uint64_t driver) : m_driver(driver) {}
+
+        bool IsCompatible(const uint8_t* payload, size_t sizeInBytes) const override
+        {
+            uint64_t driver = 0;
+            if (sizeInBytes < sizeof(driver))
+            {
+                return false;
+            }
+            memcpy(&driver, payload, sizeof(driver));
+            return driver == m_driver;
+        }
+
+        std::vector<uint8_t> Serialize(Rng& rng, uint64_t key) const
+        {
+            std::vector<uint8_t> payload(sizeof(m_driver) + 256 + rng.Next(64 * 1024));
+            memcpy(payload.data(), &m_driver, sizeof(m_driver));
+            Rng content = {key};
+            for (size_t byte = sizeof(m_driver); byte < payload.size(); byte++)
+            {
+                payload[byte] = static_cast<uint8_t>(content.Next());
+            }
+            return payload;
+        }
+
+    private:
+
+        uint64_t m_driver;
+    };
+
+    bool Check(bool condition, const char* what)
+    {
+        printf("  %-60s %s\n", what, condition ? "ok" : "FAILED");
+        return condition;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--meshes", options.meshes);
+        parser.Add("--vertices", options.vertices);
+        parser.Add("--dir", options.directory);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        if (options.directory.empty())
+        {
+            std::error_code error;
+            options.directory = (std::filesystem::temp_directory_path(error) / "blas_cache_bench").string();
+        }
+        return options.meshes > 0 && options.vertices > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(options.directory, error);
+
+    Rng               rng       = {options.seed};
+    const uint64_t    deviceKey = BLASCache::HashBytes("mock adapter", 12);
+    const MockBackend driver(1);
+    bool              success   = true;
+
+    std::vector<Mesh> meshes;
+    for (uint32_t mesh = 0; mesh < options.meshes; mesh++)
+    {
+        meshes.push_back(MakeMesh(rng, options.vertices));
+    }
+
+    printf("%u meshes of %u vertices, cache in %s\n", options.meshes, options.vertices, options.directory.c_str());
+
+    // Keys
+    auto                  start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> keys;
+    for (const Mesh& mesh : meshes)
+    {
+        keys.push_back(Key(mesh));
+    }
+    double hashSeconds = Seconds(start);
+    double hashedBytes = double(options.meshes) * options.vertices * (PositionSize + 3 * sizeof(uint32_t));
+    printf("hashing %.1f MB took %.1f ms, %.0f MB/s\n", hashedBytes / (1024.0 * 1024.0), hashSeconds * 1000.0, hashedBytes / (1024.0 * 1024.0) / hashSeconds);
+
+    std::vector<uint64_t> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+    {
+        Mesh         changed  = meshes[0];
+        BLASGeometry geometry = Describe(meshes[0]);
+        bool         padding  = true;
+        changed.vertices[3]  += 1.0f;
+        padding              &= Key(changed) == keys[0];
+        changed.vertices[0]  += 1.0f;
+
+        BLASGeometry sixteenBit = Describe(meshes[0], FormatUint16);
+        BLASGeometry noIndices  = Describe(meshes[0]);
+        noIndices.indices       = nullptr;
+
+        success &= Check(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end(), "keys are unique");
+        success &= Check(Key(meshes[0]) == keys[0], "keys are stable");
+        success &= Check(padding, "vertex padding is ignored");
+        success &= Check(Key(changed) != keys[0], "a moved vertex changes the key");
+        success &= Check(BLASCache::HashGeometry(&geometry, 1, 0) != keys[0], "build flags change the key");
+        success &= Check(BLASCache::HashGeometry(&sixteenBit, 1, CompactFlag) != keys[0], "index format changes the key");
+        success &= Check(BLASCache::HashGeometry(&noIndices, 1, CompactFlag) != keys[0], "dropping the indices changes the key");
+    }
+
+    // Cold start, every build misses and gets stored
+    std::vector<std::vector<uint8_t>> payloads;
+    {
+        BLASCache cache(options.directory, deviceKey, &driver);
+        start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> payload;
+        for (uint64_t key : keys)
+        {
+            if (cache.Load(key, payload) == false)
+            {
+                payloads.push_back(driver.Serialize(rng, key));
+                success &= cache.Store(key, payloads.back().data(), payloads.back().size());
+            }
+        }
+        success &= cache.Flush();
+        printf("cold start stored %llu entries, %.1f MB in %.1f ms\n",
+               static_cast<unsigned long long>(cache.GetStats().stores),
+               cache.GetStats().bytesWritten / (1024.0 * 1024.0),
+               Seconds(start) * 1000.0);
+        success &= Check(cache.GetStats().misses == keys.size() && cache.GetStats().hits == 0, "cold start misses everything");
+    }
+
+    // Warm start, every build comes back unchanged
+    {
+        BLASCache cache(options.directory, deviceKey, &driver);
+        start         = std::chrono::steady_clock::now();
+        bool identical = true;
+        std::vector<uint8_t> payload;
+        for (size_t mesh = 0; mesh < keys.size(); mesh++)
+        {
+            identical &= cache.Load(keys[mesh], payload) && payload == payloads[mesh];
+        }
+        printf("warm start loaded %.1f MB in %.1f ms\n", cache.GetStats().bytesRead / (1024.0 * 1024.0), Seconds(start) * 1000.0);
+        success &= Check(identical && cache.GetStats().hits == keys.size(), "warm start hits everything with the stored payloads");
+    }
+
+    // A flipped byte drops that entry only
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.as", static_cast<unsigned long long>(keys[0]));
+        std::fstream file((std::filesystem::path(options.directory) / name).string(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put(0x5A);
+        file.close();
+
+        BLASCache            cache(options.directory, deviceKey, &driver);
+        std::vector<uint8_t> payload;
+        bool                 corruptMissed = cache.Load(keys[0], payload) == false;
+        bool                 othersHit     = keys.size() < 2 || cache.Load(keys[1], payload);
+        success &= cache.Flush();
+        success &= Check(corruptMissed && othersHit && cache.GetStats().entriesDropped == 1 &&
+                         cache.GetEntryCount() == keys.size() - 1, "a corrupted entry is dropped on its own");
+    }
+
+    // Another adapter throws everything away on open
+    {
+        BLASCache cache(options.directory, deviceKey + 1, &driver);
+        success &= Check(cache.GetEntryCount() == 0 && cache.GetStats().invalidations == 1, "a device change invalidates the cache");
+    }
+    {
+        BLASCache cache(options.directory, deviceKey, &driver);
+        success &= Check(cache.GetEntryCount() == 0, "the invalidation is persistent");
+
+        std::vector<uint8_t> payload;
+        success &= cache.Store(keys[0], payloads[0].data(), payloads[0].size()) && cache.Flush();
+        success &= Check(cache.Load(keys[0], payload), "the cache refills after an invalidation");
+    }
+
+    // A driver update under the same device key is caught by the first rejected blob
+    {
+        const MockBackend    updated(2);
+        BLASCache            cache(options.directory, deviceKey, &updated);
+        std::vector<uint8_t> payload;
+        bool                 rejected = cache.Load(keys[0], payload) == false;
+        success &= cache.Flush();
+        success &= Check(rejected && cache.GetEntryCount() == 0 && cache.GetStats().invalidations == 1, "a driver change invalidates the cache");
+    }
+
+    // A future format version discards older indices, simulated by clobbering the version field
+    {
+        {
+            BLASCache cache(options.directory, deviceKey, &driver);
+            success &= cache.Store(keys[0], payloads[0].data(), payloads[0].size()) && cache.Flush();
+        }
+        std::fstream file((std::filesystem::path(options.directory) / "index.bin").string(), std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t     version = BLASCache::FormatVersion + 1;
+        file.seekp(sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.close();
+
+        BLASCache cache(options.directory, deviceKey, &driver);
+        success &= Check(cache.GetEntryCount() == 0 && cache.GetStats().invalidations == 1 &&
+                         cache.Contains(keys[0]) == false, "a format version change invalidates the cache");
+    }
+
+    printf("%s\n", success ? "all checks passed" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// What the device free benchmarks and simulations share, so each of them keeps only its workload:
+// the seeded generator every workload draws from, the wall clock spans are timed with and the
+// command line parsing.  Every bench still declares its own Options with the defaults, and binds
+// each field to its flag with an OptionParser.
+
+// xorshift64*, keeps the benches free of the math library
+struct Rng
+{
+    uint64_t state;
+
+    uint32_t Next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 2685821657736338717ull) >> 32);
+    }
+
+    uint32_t Next(uint32_t bound) { return static_cast<uint32_t>((uint64_t(Next()) * bound) >> 32); }
+
+    // Uniform in [0, 1)
+    float NextUnit() { return static_cast<float>(Next()) / 4294967296.0f; }
+
+    // Uniform in [-1, 1)
+    float NextSigned() { return static_cast<float>(Next()) / 2147483648.0f - 1.0f; }
+};
+
+// Seconds since start on the steady clock
+inline double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Flags of the form --name value, or a bare --name for a switch, each bound to the field it sets.
+// Anything else prints a usage line built from the flags in the order they were added.
+class OptionParser
+{
+public:
+
+    void Add(const char* flag, uint32_t& value, const char* valueName = "n")
+    {
+        m_options.push_back(Option{flag, valueName, Type::Uint32, &value});
+    }
+
+    void Add(const char* flag, uint64_t& value, const char* valueName = "n")
+    {
+        m_options.push_back(Option{flag, valueName, Type::Uint64, &value});
+    }
+
+    void Add(const char* flag, float& value, const char* valueName = "x")
+    {
+        m_options.push_back(Option{flag, valueName, Type::Float, &value});
+    }
+
+    void Add(const char* flag, std::string& value, const char* valueName = "path")
+    {
+        m_options.push_back(Option{flag, valueName, Type::String, &value});
+    }
+
+    // A switch, set when the flag is present
+    void Add(const char* flag, bool& value)
+    {
+        m_options.push_back(Option{flag, nullptr, Type::Switch, &value});
+    }
+
+    bool Parse(int argc, char** argv) const
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const Option* option = Find(argv[i]);
+            if (option == nullptr || (option->type != Type::Switch && i + 1 >= argc))
+            {
+                PrintUsage(argv[0]);
+                return false;
+            }
+
+            if (option->type == Type::Switch)
+            {
+                *static_cast<bool*>(option->value) = true;
+            }
+            else if (option->type == Type::Uint32)
+            {
+                uint32_t& value = *static_cast<uint32_t*>(option->value);
+                value           = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            }
+            else if (option->type == Type::Uint64)
+            {
+                *static_cast<uint64_t*>(option->value) = strtoull(argv[++i], nullptr, 10);
+            }
+            else if (option->type == Type::Float)
+            {
+                *static_cast<float*>(option->value) = strtof(argv[++i], nullptr);
+            }
+            else
+            {
+                *static_cast<std::string*>(option->value) = argv[++i];
+            }
+        }
+        return true;
+    }
+
+private:
+
+    enum class Type
+    {
+        Uint32,
+        Uint64,
+        Float,
+        String,
+        Switch
+    };
+
+    struct Option
+    {
+        const char* flag;
+        const char* valueName; // Null for switches
+        Type        type;
+        void*       value;
+    };
+
+    const Option* Find(const char* flag) const
+    {
+        for (const Option& option : m_options)
+        {
+            if (strcmp(flag, option.flag) == 0)
+            {
+                return &option;
+            }
+        }
+        return nullptr;
+    }
+
+    // Wraps before the column limit with the flags lined up under the first one
+    void PrintUsage(const char* program) const
+    {
+        const std::string indent(strlen("usage: ") + strlen(program), ' ');
+        std::string       usage     = "usage: " + std::string(program);
+        size_t            lineStart = 0;
+        for (const Option& option : m_options)
+        {
+            std::string flag = " [" + std::string(option.flag);
+            if (option.valueName != nullptr)
+            {
+                flag += " " + std::string(option.valueName);
+            }
+            flag += "]";
+
+            if (usage.size() - lineStart + flag.size() > 100)
+            {
+                usage     += "\n";
+                lineStart  = usage.size();
+                usage     += indent;
+            }
+            usage += flag;
+        }
+        fprintf(stderr, "%s\n", usage.c_str());
+    }
+
+    std::vector<Option> m_options;
+};
@@ -0,0 +1,357 @@
+/**
+ *  BLAS build batching simulator.  Streams a synthetic scene of mixed meshes, mostly small with a
+ *  tail of very large ones, into per frame build calls and lays each call out twice: in the order
+ *  the meshes were discovered, with the scratch arena cutting runs wherever the concurrent scratch
+ *  limit is reached, and in the order BuildBatcher plans.  Results are suballocated from pools of
+ *  fixed size blocks and given back once compacted a few frames later.  Reports builds, batches,
+ *  the UAV barriers between builds and after them and the scratch and result memory held, and
+ *  checks every plan is a permutation whose batches respect the limit.  Seeded, so the same
+ *  arguments always give the same output.
+ *
+ *  build_batch_sim [--meshes n] [--frames n] [--latency n] [--max-concurrent bytes]
+ *                  [--block-size bytes] [--seed n]
+ */
+
+#include "BuildBatcher.h"
+#include "ScratchArena.h"
+#include "TLSFAllocator.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <set>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment = 256;
+
+    struct Options
+    {
+        uint32_t meshes        = 10000;
+        uint32_t frames        = 100;
+        uint32_t latency       = 3;
+        uint64_t maxConcurrent = 64 * 1024 * 1024;
+        uint32_t blockSize     = 4 * 1024 * 1024;
+        uint64_t seed          = 0x853C49E6748FEA9Bull;
+    };
+
+    // Scratch buffers are only sizes
+    class MockScratch : public ScratchArenaBackend
+    {
+    public:
+
+        ScratchBuffer CreateBuffer(uint64_t sizeInBytes) override
+        {
+            ScratchBuffer buffer = {reinterpret_cast<void*>(m_nextAddress), m_nextAddress, sizeInBytes};
+            m_nextAddress       += sizeInBytes;
+            return buffer;
+        }
+
+        void ReleaseBuffer(const ScratchBuffer&) override {}
+
+    private:
+
+        uint64_t m_nextAddress = 0x100000;
+    };
+
+    // Fixed size blocks handed out first fit in block order the way BufferSuballocator does,
+    // empty blocks are released
+    class ResultPool
+    {
+    public:
+
+        struct Allocation
+        {
+            uint32_t block;
+            uint32_t node;
+        };
+
+        explicit ResultPool(uint32_t blockSize)
+            : m_blockSize(blockSize)
+        {
+        }
+
+        Allocation Allocate(uint32_t sizeInBytes)
+        {
+            for (uint32_t block = 0; block < m_blocks.size(); block++)
+            {
+                if (m_blocks[block].GetCapacity() > 0)
+                {
+                    TLSFAllocator::Allocation allocation = m_blocks[block].Allocate(sizeInBytes, Alignment);
+                    if (allocation.node != TLSFAllocator::InvalidNode)
+                    {
+                        return Allocation{block, allocation.node};
+                    }
+                }
+            }
+            uint32_t block = 0;
+            while (block < m_blocks.size() && m_blocks[block].GetCapacity() > 0)
+            {
+                block++;
+            }
+            if (block == m_blocks.size())
+            {
+                m_blocks.emplace_back();
+            }
+            const uint32_t capacity = std::max(m_blockSize, (sizeInBytes + (Alignment - 1)) & ~(Alignment - 1));
+            m_blocks[block]         = TLSFAllocator(capacity, Alignment);
+            m_residentBytes        += capacity;
+            m_peakBytes             = std::max(m_peakBytes, m_residentBytes);
+            return Allocation{block, m_blocks[block].Allocate(sizeInBytes, Alignment).node};
+        }
+
+        void Free(const Allocation& allocation)
+        {
+            TLSFAllocator& block = m_blocks[allocation.block];
+            block.Free(allocation.node);
+            if (block.GetAllocationCount() == 0)
+            {
+                m_residentBytes -= block.GetCapacity();
+                block            = TLSFAllocator();
+            }
+        }
+
+        uint64_t GetPeakBytes() const { return m_peakBytes; }
+
+    private:
+
+        uint32_t                   m_blockSize;
+        uint64_t                   m_residentBytes = 0;
+        uint64_t                   m_peakBytes     = 0;
+        std::vector<TLSFAllocator> m_blocks;
+    };
+
+    struct Totals
+    {
+        uint64_t builds            = 0;
+        uint64_t batches           = 0;
+        uint64_t scratchBarriers   = 0;
+        uint64_t postBuildBarriers = 0;
+    };
+
+    // One way of laying out the build calls, its own arena and pools so both see the same frames
+    struct Strategy
+    {
+        const char*                                  name;
+        bool                                         batched;
+        MockScratch                                  scratch;
+        ScratchArena*                                arena;
+        ResultPool*                                  results;
+        Totals                                       totals;
+        std::deque<std::vector<ResultPool::Allocation>> compacting;
+    };
+
+    // 70% small props, 25% medium and 5% hero meshes up to a million triangles, sizes about what
+    // a driver reports for them
+    PendingBuild MakeMesh(Rng& rng)
+    {
+        const uint32_t mix       = rng.Next(100);
+        const uint32_t triangles = mix < 70 ? 64 + rng.Next(2048) :
+                                   mix < 95 ? 2048 + rng.Next(65536) :
+                                              65536 + rng.Next(1u << 20);
+        return PendingBuild{uint64_t(triangles) * 56 + 1024, uint64_t(triangles) * 40 + 4096};
+    }
+
+    // Checks the plan is a permutation of the call whose batches hold one size class each and
+    // stay under the limit unless they hold a single build
+    bool CheckPlan(const BuildBatcher&            batcher,
+                   const std::vector<PendingBuild>& builds,
+                   const std::vector<uint32_t>&     order,
+                   const std::vector<BuildBatch>&   batches,
+                   uint64_t                         maxConcurrent)
+    {
+        std::vector<uint8_t> seen(builds.size(), 0);
+        for (uint32_t build : order)
+        {
+            if (build >= builds.size() || seen[build] != 0)
+            {
+                return false;
+            }
+            seen[build] = 1;
+        }
+
+        uint32_t next = 0;
+        uint64_t run  = 0;
+        for (const BuildBatch& batch : batches)
+        {
+            if (batch.first != next || batch.count == 0)
+            {
+                return false;
+            }
+            uint64_t scratch = 0;
+            for (uint32_t position = batch.first; position < batch.first + batch.count; position++)
+            {
+                scratch += (builds[order[position]].scratchSizeInBytes + (Alignment - 1)) & ~uint64_t(Alignment - 1);
+                if (batcher.SizeClass(builds[order[position]].resultSizeInBytes) != batch.sizeClass)
+                {
+                    return false;
+                }
+            }
+            run = (batch.barrierBefore ? 0 : run) + scratch;
+            if (scratch != batch.scratchBytes || (run > maxConcurrent && batch.count > 1 && maxConcurrent > 0))
+            {
+                return false;
+            }
+            next += batch.count;
+        }
+        return order.size() == builds.size() && next == order.size();
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--meshes", options.meshes);
+        parser.Add("--frames", options.frames);
+        parser.Add("--latency", options.latency);
+        parser.Add("--max-concurrent", options.maxConcurrent, "bytes");
+        parser.Add("--block-size", options.blockSize, "bytes");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.frames > 0 && options.latency > 0 && options.blockSize >= Alignment && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u meshes over %u frames, latency %u, %llu concurrent scratch bytes, %u byte result blocks\n",
+           options.meshes,
+           options.frames,
+           options.latency,
+           static_cast<unsigned long long>(options.maxConcurrent),
+           options.blockSize);
+
+    Rng          rng = {options.seed};
+    BuildBatcher batcher;
+    Strategy     strategies[2] = {};
+    strategies[0].name         = "discovery";
+    strategies[1].name         = "batched";
+    strategies[1].batched      = true;
+    for (Strategy& strategy : strategies)
+    {
+        strategy.arena   = new ScratchArena(&strategy.scratch, options.latency, options.maxConcurrent, Alignment);
+        strategy.results = new ResultPool(options.blockSize);
+    }
+
+    bool     success = true;
+    uint32_t pending = options.meshes;
+    for (uint32_t frame = 0; frame < options.frames + options.latency; frame++)
+    {
+        // Streaming discovers a random share of what is left, the last frame takes the rest
+        const uint32_t framesLeft = options.frames > frame ? options.frames - frame : 0;
+        const uint32_t meshCount  = framesLeft == 0 ? 0 :
+                                    framesLeft == 1 ? pending :
+                                                      std::min(pending, rng.Next(2 * pending / framesLeft + 1));
+        pending -= meshCount;
+
+        std::vector<PendingBuild> builds(meshCount);
+        for (PendingBuild& build : builds)
+        {
+            build = MakeMesh(rng);
+        }
+
+        for (Strategy& strategy : strategies)
+        {
+            strategy.arena->BeginFrame(frame);
+
+            // Results built latency frames ago are compacted and give their memory back
+            if (strategy.compacting.size() == options.latency)
+            {
+                for (const ResultPool::Allocation& allocation : strategy.compacting.front())
+                {
+                    strategy.results->Free(allocation);
+                }
+                strategy.compacting.pop_front();
+            }
+
+            std::vector<uint32_t>   order(meshCount);
+            std::vector<BuildBatch> batches;
+            std::vector<uint8_t>    runStarts(meshCount, 0);
+            for (uint32_t build = 0; build < meshCount; build++)
+            {
+                order[build] = build;
+            }
+            if (strategy.batched && meshCount > 0)
+            {
+                batcher.Plan(builds.data(), meshCount, options.maxConcurrent, order, batches);
+                if (CheckPlan(batcher, builds, order, batches, options.maxConcurrent) == false)
+                {
+                    printf("frame %u: plan is not a valid batching of the call\n", frame);
+                    success = false;
+                }
+                for (const BuildBatch& batch : batches)
+                {
+                    runStarts[batch.first] = batch.barrierBefore ? 1 : 0;
+                }
+            }
+
+            std::vector<uint64_t>                scratchSizes(meshCount);
+            std::vector<ScratchPlacement>        placements(meshCount);
+            std::vector<ResultPool::Allocation>  allocations(meshCount);
+            std::set<uint32_t>                   blocksBuilt;
+            for (uint32_t position = 0; position < meshCount; position++)
+            {
+                scratchSizes[position] = builds[order[position]].scratchSizeInBytes;
+                allocations[position]  = strategy.results->Allocate(static_cast<uint32_t>(builds[order[position]].resultSizeInBytes));
+                blocksBuilt.insert(allocations[position].block);
+            }
+
+            const uint64_t barriersBefore = strategy.arena->GetStats().barriers;
+            strategy.arena->PlaceBatch(scratchSizes.data(), meshCount, placements.data(), strategy.batched ? runStarts.data() : nullptr);
+            const uint64_t barriers = strategy.arena->GetStats().barriers - barriersBefore;
+
+            // Batched calls wait on every build with one global barrier, the discovery order one
+            // waited on every result block written
+            strategy.totals.builds            += meshCount;
+            strategy.totals.scratchBarriers   += barriers;
+            strategy.totals.batches           += strategy.batched ? batches.size() : (meshCount > 0 ? barriers + 1 : 0);
+            strategy.totals.postBuildBarriers += strategy.batched ? (meshCount > 0 ? 1 : 0) : blocksBuilt.size();
+
+            if (strategy.batched)
+            {
+                uint64_t planned = 0;
+                for (const BuildBatch& batch : batches)
+                {
+                    planned += batch.barrierBefore ? 1 : 0;
+                }
+                if (planned != barriers)
+                {
+                    printf("frame %u: arena recorded %llu barriers, the plan asked for %llu\n",
+                           frame,
+                           static_cast<unsigned long long>(barriers),
+                           static_cast<unsigned long long>(planned));
+                    success = false;
+                }
+            }
+            strategy.compacting.push_back(std::move(allocations));
+        }
+    }
+
+    printf("%-10s %8s %8s %16s %19s %16s %15s\n", "order", "builds", "batches", "scratch barriers", "post build barriers",
+           "scratch peak MB", "result peak MB");
+    for (Strategy& strategy : strategies)
+    {
+        printf("%-10s %8llu %8llu %16llu %19llu %16.1f %15.1f\n",
+               strategy.name,
+               static_cast<unsigned long long>(strategy.totals.builds),
+               static_cast<unsigned long long>(strategy.totals.batches),
+               static_cast<unsigned long long>(strategy.totals.scratchBarriers),
+               static_cast<unsigned long long>(strategy.totals.postBuildBarriers),
+               strategy.arena->GetStats().maxFramePeakBytes / (1024.0 * 1024.0),
+               strategy.results->GetPeakBytes() / (1024.0 * 1024.0));
+        success = success && strategy.totals.builds == options.meshes;
+        delete strategy.arena;
+        delete strategy.results;
+    }
+    printf("%s\n", success ? "all plans valid" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+/**
+ *  Compaction queue simulator.  Drives fake BLAS builds through the same state machine as
+ *  RTCompaction: builds take a run of CompactionSizeRing slots, the "GPU" writes each compacted
+ *  size into its slot when the frame executes, the sizes of every executed frame are read in one
+ *  pass, and the compaction queue drains first in first out under the transient memory budget.
+ *  Structures are removed at random along the way, including ones whose size is still in flight.
+ *  A startup burst is followed by steady streaming.  The run fails if a size is read from the wrong
+ *  slot, read twice, lost, or a live build never gets compacted.  Seeded, so the same arguments
+ *  always give the same output.
+ *
+ *  compaction_queue_sim [--startup n] [--frames n] [--per-frame n] [--latency n] [--capacity slots]
+ *                       [--budget bytes] [--remove percent] [--seed n]
+ */
+
+#include "CompactionSizeRing.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t startup  = 20000;
+        uint32_t frames   = 2000;
+        uint32_t perFrame = 40;
+        uint32_t latency  = 3;
+        uint32_t capacity = 65536;
+        uint32_t budget   = 4 * 1024 * 1024;
+        uint32_t remove   = 2;
+        uint64_t seed     = 0x853C49E6748FEA9Bull;
+    };
+
+    // The parts of ASBuffers the queues look at
+    struct Build
+    {
+        uint64_t frameIndexRequest;
+        uint32_t sizeSlot;
+        uint32_t compactedSizeInBytes;
+        uint32_t expectedSizeInBytes;
+        uint32_t sizeReads;
+        bool     requestedCompaction;
+        bool     isCompacted;
+        bool     removed;
+    };
+
+    // A batch of slot writes waiting for its frame to execute
+    struct PendingWrite
+    {
+        uint64_t frameIndex;
+        uint32_t firstSlot;
+        uint32_t count;
+    };
+
+    struct Stats
+    {
+        uint64_t builds;
+        uint64_t overflowed;
+        uint64_t compacted;
+        uint64_t removed;
+        uint64_t sizesRead;
+        uint64_t sizePasses;
+        uint32_t peakSlots;
+        uint32_t peakBacklog;
+        uint32_t errors;
+    };
+
+    class Simulation
+    {
+    public:
+
+        Simulation(const Options& options)
+            : m_options(options),
+              m_rng{options.seed},
+              m_ring(options.capacity),
+              m_readback(options.capacity, 0),
+              m_owners(options.capacity, nullptr),
+              m_frameIndex(0),
+              m_stats{}
+        {
+        }
+
+        void BuildBatch(uint32_t count)
+        {
+            const uint32_t firstSlot = m_ring.Allocate(count, m_frameIndex);
+            if (firstSlot == CompactionSizeRing::InvalidSlot)
+            {
+                m_stats.overflowed += count;
+            }
+
+            for (uint32_t build = 0; build < count; build++)
+            {
+                m_builds.emplace_back(new Build{});
+                Build* current               = m_builds.back().get();
+                current->frameIndexRequest   = m_frameIndex;
+                current->sizeSlot            = CompactionSizeRing::InvalidSlot;
+                current->expectedSizeInBytes = 256 + 256 * m_rng.Next(1024);
+                m_stats.builds++;
+
+                if (firstSlot == CompactionSizeRing::InvalidSlot)
+                {
+                    continue;
+                }
+                current->sizeSlot               = firstSlot + build;
+                current->requestedCompaction    = true;
+                m_owners[current->sizeSlot]     = current;
+                m_compactionQueue.push(current);
+            }
+            if (firstSlot != CompactionSizeRing::InvalidSlot)
+            {
+                m_pendingWrites.push_back(PendingWrite{m_frameIndex, firstSlot, count});
+            }
+        }
+
+        void NextFrame()
+        {
+            // Frames older than the latency have executed, their sizes land in the readback side
+            while (m_pendingWrites.empty() == false &&
+                   m_pendingWrites.front().frameIndex + (m_options.latency - 1) < m_frameIndex)
+            {
+                const PendingWrite& write = m_pendingWrites.front();
+                for (uint32_t slot = write.firstSlot; slot < write.firstSlot + write.count; slot++)
+                {
+                    m_readback[slot] = m_owners[slot] != nullptr ? m_owners[slot]->expectedSizeInBytes : 0;
+                }
+                m_pendingWrites.pop_front();
+            }
+
+            // Removals go through the release queue like RemoveAccelerationStructures
+            while (m_releaseQueue.empty() == false &&
+                   m_releaseQueue.front()->frameIndexRequest + (m_options.latency - 1) < m_frameIndex)
+            {
+                Build* build = m_releaseQueue.front();
+                if (build->sizeSlot != CompactionSizeRing::InvalidSlot && m_owners[build->sizeSlot] == build)
+                {
+                    m_owners[build->sizeSlot] = nullptr;
+                }
+                build->requestedCompaction = false;
+                m_releaseQueue.pop();
+            }
+
+            // The single pass over every executed frame's slots
+            if (m_frameIndex >= m_options.latency)
+            {
+                m_ring.Retire(m_frameIndex - m_options.latency, [this](uint32_t firstSlot, uint32_t count)
+                {
+                    m_stats.sizePasses++;
+                    for (uint32_t slot = firstSlot; slot < firstSlot + count; slot++)
+                    {
+                        Build* build = m_owners[slot];
+                        if (build != nullptr)
+                        {
+                            build->compactedSizeInBytes = static_cast<uint32_t>(m_readback[slot]);
+                            build->sizeSlot             = CompactionSizeRing::InvalidSlot;
+                            build->sizeReads++;
+                            m_owners[slot]              = nullptr;
+                            m_stats.sizesRead++;
+                        }
+                    }
+                });
+            }
+
+            // First in first out under the transient budget, one oversized copy always goes through
+            uint64_t transient = 0;
+            while (m_compactionQueue.empty() == false)
+            {
+                Build* build = m_compactionQueue.front();
+                if (build->frameIndexRequest + (m_options.latency - 1) >= m_frameIndex)
+                {
+                    break;
+                }
+                if (build->requestedCompaction)
+                {
+                    if (build->sizeReads != 1 || build->compactedSizeInBytes != build->expectedSizeInBytes)
+                    {
+                        m_stats.errors++;
+                    }
+                    if (transient != 0 && transient + build->compactedSizeInBytes > m_options.budget)
+                    {
+                        break;
+                    }
+                    transient          += build->compactedSizeInBytes;
+                    build->isCompacted  = true;
+                    m_stats.compacted++;
+                }
+                m_compactionQueue.pop();
+            }
+
+            if (m_ring.Validate() == false)
+            {
+                m_stats.errors++;
+            }
+            m_stats.peakSlots   = std::max(m_stats.peakSlots, m_ring.GetUsedSlots());
+            m_stats.peakBacklog = std::max(m_stats.peakBacklog, static_cast<uint32_t>(m_compactionQueue.size()));
+            m_frameIndex++;
+        }
+
+        void RemoveRandom()
+        {
+            if (m_builds.empty())
+            {
+                return;
+            }
+            Build* build = m_builds[m_rng.Next(static_cast<uint32_t>(m_builds.size()))].get();
+            if (build->removed == false)
+            {
+                build->removed           = true;
+                build->frameIndexRequest = m_frameIndex;
+                m_releaseQueue.push(build);
+                m_stats.removed++;
+            }
+        }
+
+        // Every build that was never removed and got a slot must have been compacted exactly once
+        void Finish()
+        {
+            for (const auto& build : m_builds)
+            {
+                if (build->removed == false && build->sizeReads > 1)
+                {
+                    m_stats.errors++;
+                }
+                if (build->removed == false && build->requestedCompaction && build->isCompacted == false)
+                {
+                    m_stats.errors++;
+                }
+            }
+        }
+
+        bool  Idle() const { return m_compactionQueue.empty() && m_releaseQueue.empty() && m_ring.GetUsedSlots() == 0; }
+        const Stats& GetStats() const { return m_stats; }
+        uint64_t GetFrameIndex() const { return m_frameIndex; }
+
+    private:
+
+        const Options                       m_options;
+        Rng                                 m_rng;
+        CompactionSizeRing                  m_ring;
+        std::vector<uint64_t>               m_readback;
+        std::vector<Build*>                 m_owners;
+        std::vector<std::unique_ptr<Build>> m_builds;
+        std::deque<PendingWrite>            m_pendingWrites;
+        std::queue<Build*>                  m_compactionQueue;
+        std::queue<Build*>                  m_releaseQueue;
+        uint64_t                            m_frameIndex;
+        Stats                               m_stats;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--startup", options.startup);
+        parser.Add("--frames", options.frames);
+        parser.Add("--per-frame", options.perFrame);
+        parser.Add("--latency", options.latency);
+        parser.Add("--capacity", options.capacity, "slots");
+        parser.Add("--budget", options.budget, "bytes");
+        parser.Add("--remove", options.remove, "percent");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.latency > 0 && options.capacity > 0 && options.remove <= 100 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    Simulation simulation(options);
+    Rng        rng   = {options.seed ^ 0x9E3779B97F4A7C15ull};
+    auto       start = std::chrono::steady_clock::now();
+
+    // The startup burst arrives in a few large batches, then builds stream in a frame at a time
+    for (uint32_t batch = 0; batch < 4; batch++)
+    {
+        simulation.BuildBatch(options.startup / 4 + (batch == 0 ? options.startup % 4 : 0));
+    }
+    for (uint32_t frame = 0; frame < options.frames; frame++)
+    {
+        uint32_t count = rng.Next(options.perFrame * 2 + 1);
+        if (count > 0)
+        {
+            simulation.BuildBatch(count);
+        }
+        for (uint32_t removal = 0; removal < count; removal++)
+        {
+            if (rng.Next(100) < options.remove)
+            {
+                simulation.RemoveRandom();
+            }
+        }
+        simulation.NextFrame();
+    }
+
+    // Drain whatever is still in flight
+    uint32_t drainFrames = 0;
+    while (simulation.Idle() == false && drainFrames < 1000000)
+    {
+        simulation.NextFrame();
+        drainFrames++;
+    }
+    simulation.Finish();
+
+    const double seconds = Seconds(start);
+    const Stats& stats   = simulation.GetStats();
+
+    printf("%llu builds over %llu frames (%u to drain), latency %u, %u slot ring, %u byte budget\n",
+           static_cast<unsigned long long>(stats.builds),
+           static_cast<unsigned long long>(simulation.GetFrameIndex()),
+           drainFrames,
+           options.latency,
+           options.capacity,
+           options.budget);
+    printf("compacted %llu, removed %llu, overflowed %llu, peak slots in flight %u, peak compaction backlog %u\n",
+           static_cast<unsigned long long>(stats.compacted),
+           static_cast<unsigned long long>(stats.removed),
+           static_cast<unsigned long long>(stats.overflowed),
+           stats.peakSlots,
+           stats.peakBacklog);
+    printf("%llu sizes read in %llu contiguous runs, %.2f us of simulation per frame\n",
+           static_cast<unsigned long long>(stats.sizesRead),
+           static_cast<unsigned long long>(stats.sizePasses),
+           seconds * 1e6 / simulation.GetFrameIndex());
+    printf("%s\n", stats.errors == 0 ? "every size landed once on its build" : "FAILED");
+
+    return stats.errors == 0 ? 0 : 1;
+}
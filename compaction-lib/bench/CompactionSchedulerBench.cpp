@@ -0,0 +1,318 @@
+/**
+ *  Compaction scheduling simulator.  Streams BLAS builds through the compaction pipeline frame by
+ *  frame without a device and compacts them once with the FIFO loop RTCompaction used to run and
+ *  once with CompactionScheduler.  Reports the result and scratch memory still waiting on
+ *  compaction, how long builds near the camera wait and the longest wait of any build, then times
+ *  Schedule on one large snapshot.  The run fails if a schedule exceeds a budget it had no reason
+ *  to exceed or if shuffling a snapshot changes its schedule.  Seeded, so the same arguments
+ *  always give the same output.
+ *
+ *  compaction_scheduler_bench [--frames n] [--builds n] [--latency n] [--copy-budget bytes]
+ *                             [--transient-budget bytes] [--scratch-budget bytes] [--seed n]
+ */
+
+#include "CompactionScheduler.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment      = 256;
+    constexpr float    NearDistance   = 100.0f;
+    constexpr uint32_t SnapshotBuilds = 20000;
+
+    struct Options
+    {
+        uint32_t frames          = 600;
+        uint32_t builds          = 40;
+        uint32_t latency         = 3;
+        uint64_t copyBudget      = 4 * 1024 * 1024;
+        uint64_t transientBudget = 32 * 1024 * 1024;
+        uint64_t scratchBudget   = 256 * 1024 * 1024;
+        uint64_t seed            = 0x853C49E6748FEA9Bull;
+    };
+
+    uint32_t Align(uint32_t size)
+    {
+        return (size + (Alignment - 1)) & ~(Alignment - 1);
+    }
+
+    // Uncompacted results of a few kilobytes up to a few megabytes, compacting to 30 to 70 percent
+    // with scratch about half the result
+    CompactionCandidate MakeBuild(Rng& rng, uint32_t id, uint64_t frameIndex)
+    {
+        uint32_t log2Size = 12 + rng.Next(10);
+        uint32_t result   = Align((1u << log2Size) + rng.Next(1u << log2Size));
+
+        CompactionCandidate build  = {};
+        build.id                   = id;
+        build.resultSizeInBytes    = result;
+        build.compactedSizeInBytes = Align(static_cast<uint32_t>(uint64_t(result) * (30 + rng.Next(41)) / 100));
+        build.scratchSizeInBytes   = Align(result / 2 + rng.Next(result / 2 + 1));
+        build.distanceToCamera     = static_cast<float>(rng.Next(2000));
+        build.frameIndexRequest    = frameIndex;
+        return build;
+    }
+
+    // The loop NextFrame ran before the scheduler: oldest first, stop at the first build that
+    // overruns the per frame copy budget unless nothing was copied yet
+    std::vector<uint32_t> ScheduleFifo(const std::vector<CompactionCandidate>& candidates, uint64_t copyBudget)
+    {
+        std::vector<uint32_t> ids;
+        uint64_t              copyBytes = 0;
+        for (const CompactionCandidate& candidate : candidates)
+        {
+            if (copyBytes != 0 && copyBytes + candidate.compactedSizeInBytes > copyBudget)
+            {
+                break;
+            }
+            copyBytes += candidate.compactedSizeInBytes;
+            ids.push_back(candidate.id);
+        }
+        return ids;
+    }
+
+    struct Result
+    {
+        double   waitingBytes;     // Result and scratch held by builds waiting for compaction, per frame
+        double   nearWaitFrames;   // Frames a build near the camera waits once its size is read
+        uint64_t maxWaitFrames;
+        uint64_t peakTransient;
+        uint64_t compactedBuilds;
+        bool     success;
+    };
+
+    bool WithinBudgets(const std::vector<CompactionCandidate>& candidates,
+                       const CompactionSchedule&               schedule,
+                       const CompactionBudgets&                budgets,
+                       uint64_t                                transientInFlight)
+    {
+        uint64_t scratchWaiting = 0;
+        for (const CompactionCandidate& candidate : candidates)
+        {
+            scratchWaiting += candidate.scratchSizeInBytes;
+        }
+
+        // The empty budget rule lets the first build through whatever its size
+        const bool copyOk      = schedule.stats.copyBytes <= budgets.copyBytesPerFrame ||
+                                 scratchWaiting > budgets.scratchBytes ||
+                                 schedule.stats.scheduledCount == 1;
+        const bool transientOk = schedule.stats.transientBytes <= budgets.transientBytes ||
+                                 (transientInFlight == 0 && schedule.stats.scheduledCount == 1);
+        return copyOk && transientOk;
+    }
+
+    // Shuffled snapshots must come back with the same schedule
+    bool Deterministic(const CompactionScheduler&        scheduler,
+                       std::vector<CompactionCandidate>  candidates,
+                       const CompactionSchedule&         schedule,
+                       const CompactionBudgets&          budgets,
+                       uint64_t                          transientInFlight,
+                       uint64_t                          frameIndex,
+                       Rng&                              rng)
+    {
+        for (size_t index = candidates.size(); index > 1; index--)
+        {
+            std::swap(candidates[index - 1], candidates[rng.Next(static_cast<uint32_t>(index))]);
+        }
+        return scheduler.Schedule(candidates, budgets, transientInFlight, frameIndex).ids == schedule.ids;
+    }
+
+    Result Simulate(const Options& options, bool useScheduler)
+    {
+        CompactionBudgets budgets = {};
+        budgets.copyBytesPerFrame = options.copyBudget;
+        budgets.transientBytes    = options.transientBudget;
+        budgets.scratchBytes      = options.scratchBudget;
+
+        CompactionScheduler scheduler;
+        Rng                 rng     = {options.seed};
+        Rng                 shuffle = {options.seed ^ 0x9E3779B97F4A7C15ull};
+
+        // Builds waiting for their size, builds whose size is known, and compacted builds whose
+        // result is still resident
+        std::deque<CompactionCandidate>                    building;
+        std::vector<CompactionCandidate>                   ready;
+        std::deque<std::pair<uint64_t, uint32_t>>          inFlight;
+        std::vector<uint64_t>                              readyFrame;
+        uint64_t                                           transient = 0;
+        uint32_t                                           nextId    = 0;
+
+        Result   result      = {};
+        uint64_t nearBuilds  = 0;
+        double   waitingSum  = 0.0;
+        result.success       = true;
+
+        for (uint64_t frame = 0; frame < options.frames; frame++)
+        {
+            // Copies recorded latency frames ago have executed, their results are released
+            while (inFlight.empty() == false && inFlight.front().first + options.latency <= frame)
+            {
+                transient -= inFlight.front().second;
+                inFlight.pop_front();
+            }
+            while (building.empty() == false && building.front().frameIndexRequest + options.latency <= frame)
+            {
+                readyFrame.resize(std::max<size_t>(readyFrame.size(), building.front().id + 1));
+                readyFrame[building.front().id] = frame;
+                ready.push_back(building.front());
+                building.pop_front();
+            }
+
+            // Candidate ids are snapshot positions the way RTCompaction hands them out
+            std::vector<uint32_t> buildIds(ready.size());
+            for (uint32_t index = 0; index < ready.size(); index++)
+            {
+                buildIds[index] = ready[index].id;
+                ready[index].id = index;
+            }
+
+            std::vector<uint32_t> scheduled;
+            if (useScheduler)
+            {
+                CompactionSchedule schedule = scheduler.Schedule(ready, budgets, transient, frame);
+                if (WithinBudgets(ready, schedule, budgets, transient) == false)
+                {
+                    printf("frame %llu: schedule exceeds its budgets\n", static_cast<unsigned long long>(frame));
+                    result.success = false;
+                }
+                if (frame % 50 == 0 && Deterministic(scheduler, ready, schedule, budgets, transient, frame, shuffle) == false)
+                {
+                    printf("frame %llu: shuffled snapshot scheduled differently\n", static_cast<unsigned long long>(frame));
+                    result.success = false;
+                }
+                scheduled = schedule.ids;
+            }
+            else
+            {
+                scheduled = ScheduleFifo(ready, options.copyBudget);
+            }
+
+            for (uint32_t index : scheduled)
+            {
+                const CompactionCandidate& build = ready[index];
+                const uint64_t             wait  = frame - readyFrame[buildIds[index]];
+
+                transient += build.compactedSizeInBytes;
+                inFlight.push_back(std::make_pair(frame, build.compactedSizeInBytes));
+                result.maxWaitFrames = std::max(result.maxWaitFrames, wait);
+                if (build.distanceToCamera < NearDistance)
+                {
+                    result.nearWaitFrames += static_cast<double>(wait);
+                    nearBuilds++;
+                }
+                result.compactedBuilds++;
+                ready[index].id = UINT32_MAX;
+            }
+            result.peakTransient = std::max(result.peakTransient, transient);
+
+            // Back to build ids, scheduled builds leave the snapshot in order
+            std::vector<CompactionCandidate> remaining;
+            for (uint32_t index = 0; index < ready.size(); index++)
+            {
+                if (ready[index].id != UINT32_MAX)
+                {
+                    ready[index].id = buildIds[index];
+                    remaining.push_back(ready[index]);
+                    waitingSum     += double(ready[index].resultSizeInBytes) + ready[index].scratchSizeInBytes;
+                }
+            }
+            ready.swap(remaining);
+
+            // Whatever is still waiting keeps aging
+            for (const CompactionCandidate& build : ready)
+            {
+                result.maxWaitFrames = std::max(result.maxWaitFrames, frame - readyFrame[build.id]);
+            }
+
+            for (uint32_t build = 0; build < options.builds; build++)
+            {
+                building.push_back(MakeBuild(rng, nextId++, frame));
+            }
+        }
+
+        result.waitingBytes   = waitingSum / options.frames;
+        result.nearWaitFrames = nearBuilds > 0 ? result.nearWaitFrames / nearBuilds : 0.0;
+        return result;
+    }
+
+    void PrintResult(const char* label, const Result& result)
+    {
+        printf("%-9s compacted %7llu  waiting %8.1f MB  near wait %6.2f frames  max wait %5llu frames  peak transient %6.1f MB\n",
+               label,
+               static_cast<unsigned long long>(result.compactedBuilds),
+               result.waitingBytes / (1024.0 * 1024.0),
+               result.nearWaitFrames,
+               static_cast<unsigned long long>(result.maxWaitFrames),
+               result.peakTransient / (1024.0 * 1024.0));
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--frames", options.frames);
+        parser.Add("--builds", options.builds);
+        parser.Add("--latency", options.latency);
+        parser.Add("--copy-budget", options.copyBudget, "bytes");
+        parser.Add("--transient-budget", options.transientBudget, "bytes");
+        parser.Add("--scratch-budget", options.scratchBudget, "bytes");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.frames > 0 && options.latency > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u frames, %u builds per frame, latency %u, copy budget %llu, transient budget %llu, scratch budget %llu\n",
+           options.frames,
+           options.builds,
+           options.latency,
+           static_cast<unsigned long long>(options.copyBudget),
+           static_cast<unsigned long long>(options.transientBudget),
+           static_cast<unsigned long long>(options.scratchBudget));
+
+    const Result fifo      = Simulate(options, false);
+    const Result scheduled = Simulate(options, true);
+    PrintResult("fifo", fifo);
+    PrintResult("scheduler", scheduled);
+
+    // One large snapshot, as after loading a level
+    Rng                              rng = {options.seed};
+    std::vector<CompactionCandidate> snapshot;
+    for (uint32_t id = 0; id < SnapshotBuilds; id++)
+    {
+        snapshot.push_back(MakeBuild(rng, id, rng.Next(64)));
+    }
+    CompactionBudgets budgets = {};
+    budgets.copyBytesPerFrame = options.copyBudget;
+    budgets.transientBytes    = options.transientBudget;
+    budgets.scratchBytes      = options.scratchBudget;
+
+    CompactionScheduler scheduler;
+    const uint32_t      iterations = 20;
+    size_t              selected   = 0;
+    auto                start      = std::chrono::steady_clock::now();
+    for (uint32_t iteration = 0; iteration < iterations; iteration++)
+    {
+        selected += scheduler.Schedule(snapshot, budgets, 0, 64).ids.size();
+    }
+    double microseconds = Seconds(start) * 1e6 / iterations;
+    printf("schedule of %u ready builds: %.1f us, %zu scheduled\n", SnapshotBuilds, microseconds, selected / iterations);
+
+    printf("%s\n", scheduled.success ? "all schedules within budget and deterministic" : "FAILED");
+    return scheduled.success ? 0 : 1;
+}
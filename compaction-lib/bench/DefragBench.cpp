@@ -0,0 +1,270 @@
+/**
+ *  Defragmentation simulator.  Fills a fake compaction pool with BLAS sized allocations, removes a
+ *  random share of them the way entities come and go, then runs ASDefragmenter plans frame by frame
+ *  under the byte budget until nothing is left to move.  Every plan is replayed on the pool the
+ *  way RTCompaction does it, and the run fails if a planned move doesn't land, an allocator fails
+ *  validation or the pool after a plan differs from the plan's prediction.  Seeded, so the same
+ *  arguments always give the same output.
+ *
+ *  defrag_bench [--items n] [--remove percent] [--block-size bytes] [--budget bytes] [--seed n]
+ */
+
+#include "ASDefragmenter.h"
+#include "BenchUtil.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment = 256;
+
+    struct Options
+    {
+        uint32_t items     = 20000;
+        uint32_t remove    = 60;
+        uint32_t blockSize = 4 * 1024 * 1024;
+        uint32_t budget    = 8 * 1024 * 1024;
+        uint64_t seed      = 0x853C49E6748FEA9Bull;
+    };
+
+    // Compacted BLASes, a few hundred bytes up to about a megabyte
+    uint32_t CompactedSize(Rng& rng)
+    {
+        uint32_t log2Size = 8 + rng.Next(12);
+        uint32_t size     = (1u << log2Size) + rng.Next(1u << log2Size);
+        return (size + (Alignment - 1)) & ~(Alignment - 1);
+    }
+
+    // Block management mirrors BufferSuballocator: first fit over the blocks, a new block or a
+    // dedicated one when nothing fits, and empty blocks released unless it is the last one.  The
+    // largest free range per block is cached so filling tens of thousands of blocks stays quick.
+    class Pool
+    {
+    public:
+
+        explicit Pool(uint32_t blockSize) : m_blockSize(blockSize), m_liveBlocks(0) {}
+
+        DefragItem Allocate(uint32_t id, uint32_t size)
+        {
+            for (uint32_t block = 0; block < m_blocks.size(); block++)
+            {
+                if (m_blocks[block] != nullptr && m_largestFree[block] >= size)
+                {
+                    TLSFAllocator::Allocation allocation = m_blocks[block]->Allocate(size, Alignment);
+                    m_largestFree[block]                 = m_blocks[block]->GetLargestFreeRange();
+                    return DefragItem{id, block, allocation.node};
+                }
+            }
+
+            uint32_t block = static_cast<uint32_t>(m_blocks.size());
+            for (uint32_t slot = 0; slot < m_blocks.size(); slot++)
+            {
+                if (m_blocks[slot] == nullptr)
+                {
+                    block = slot;
+                    break;
+                }
+            }
+            if (block == m_blocks.size())
+            {
+                m_blocks.emplace_back();
+                m_largestFree.push_back(0);
+            }
+            m_blocks[block].reset(new TLSFAllocator(size > m_blockSize ? size : m_blockSize, Alignment));
+            m_liveBlocks++;
+
+            DefragItem item      = {id, block, m_blocks[block]->Allocate(size, Alignment).node};
+            m_largestFree[block] = m_blocks[block]->GetLargestFreeRange();
+            return item;
+        }
+
+        bool AllocateInBlock(uint32_t block, uint32_t size, uint32_t& node)
+        {
+            node                 = m_blocks[block]->Allocate(size, Alignment).node;
+            m_largestFree[block] = m_blocks[block]->GetLargestFreeRange();
+            return node != TLSFAllocator::InvalidNode;
+        }
+
+        void Free(const DefragItem& item)
+        {
+            TLSFAllocator& allocator = *m_blocks[item.block];
+            allocator.Free(item.node);
+            m_largestFree[item.block] = allocator.GetLargestFreeRange();
+            if (allocator.GetAllocationCount() == 0 && (m_liveBlocks > 1 || allocator.GetCapacity() > m_blockSize))
+            {
+                m_blocks[item.block].reset();
+                m_largestFree[item.block] = 0;
+                m_liveBlocks--;
+            }
+        }
+
+        std::vector<const TLSFAllocator*> GetBlocks() const
+        {
+            std::vector<const TLSFAllocator*> blocks(m_blocks.size());
+            for (size_t block = 0; block < m_blocks.size(); block++)
+            {
+                blocks[block] = m_blocks[block].get();
+            }
+            return blocks;
+        }
+
+        bool Validate() const
+        {
+            for (const auto& block : m_blocks)
+            {
+                if (block != nullptr && block->Validate() == false)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+
+        uint32_t                                    m_blockSize;
+        uint32_t                                    m_liveBlocks;
+        std::vector<std::unique_ptr<TLSFAllocator>> m_blocks;
+        std::vector<uint32_t>                       m_largestFree;
+    };
+
+    void PrintStats(const char* label, const DefragStats& stats)
+    {
+        printf("%-8s blocks %6u  resident %9.1f MB  used %9.1f MB  largest free %7.1f KB  fragmentation %5.3f\n",
+               label,
+               stats.blockCount,
+               stats.residentBytes / (1024.0 * 1024.0),
+               stats.usedBytes / (1024.0 * 1024.0),
+               stats.largestFreeRange / 1024.0,
+               stats.fragmentation);
+    }
+
+    bool SameStats(const DefragStats& left, const DefragStats& right)
+    {
+        return left.blockCount == right.blockCount && left.residentBytes == right.residentBytes &&
+               left.usedBytes == right.usedBytes && left.largestFreeRange == right.largestFreeRange;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--items", options.items);
+        parser.Add("--remove", options.remove, "percent");
+        parser.Add("--block-size", options.blockSize, "bytes");
+        parser.Add("--budget", options.budget, "bytes");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.remove <= 100 && options.blockSize >= Alignment && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    Rng                     rng = {options.seed};
+    Pool                    pool(options.blockSize);
+    std::vector<DefragItem> items;
+
+    for (uint32_t id = 0; id < options.items; id++)
+    {
+        items.push_back(pool.Allocate(id, CompactedSize(rng)));
+    }
+    for (size_t index = 0; index < items.size();)
+    {
+        if (rng.Next(100) < options.remove)
+        {
+            pool.Free(items[index]);
+            items[index] = items.back();
+            items.pop_back();
+        }
+        else
+        {
+            index++;
+        }
+    }
+
+    // Ids index the live list the way compactedIndex indexes RTCompaction's list
+    for (uint32_t index = 0; index < items.size(); index++)
+    {
+        items[index].id = index;
+    }
+
+    printf("%u structures built, %zu live after removing %u%%, %u byte blocks, %u bytes per frame\n",
+           options.items,
+           items.size(),
+           options.remove,
+           options.blockSize,
+           options.budget);
+
+    ASDefragmenter defragmenter(options.budget, 0.5f, Alignment);
+    DefragStats    initial  = ASDefragmenter::Measure(pool.GetBlocks());
+    uint64_t       moved    = 0;
+    uint32_t       frames   = 0;
+    bool           success  = true;
+
+    while (true)
+    {
+        DefragPlan plan = defragmenter.Plan(pool.GetBlocks(), items);
+        if (plan.moves.empty())
+        {
+            break;
+        }
+        frames++;
+
+        // Every destination is allocated before any source is freed, as on the GPU where the
+        // sources stay alive until the copies have executed
+        std::vector<uint32_t> destinationNodes(plan.moves.size());
+        for (size_t move = 0; move < plan.moves.size() && success; move++)
+        {
+            const DefragMove& planned = plan.moves[move];
+            if (pool.AllocateInBlock(planned.destinationBlock, planned.sizeInBytes, destinationNodes[move]) == false)
+            {
+                printf("frame %u: move of %u bytes into block %u did not fit\n",
+                       frames,
+                       planned.sizeInBytes,
+                       planned.destinationBlock);
+                success = false;
+            }
+        }
+        if (success == false)
+        {
+            break;
+        }
+        for (size_t move = 0; move < plan.moves.size(); move++)
+        {
+            DefragItem& item = items[plan.moves[move].id];
+            pool.Free(item);
+            item.block = plan.moves[move].destinationBlock;
+            item.node  = destinationNodes[move];
+        }
+        moved += plan.bytesMoved;
+
+        DefragStats stats = ASDefragmenter::Measure(pool.GetBlocks());
+        if (SameStats(stats, plan.after) == false || pool.Validate() == false)
+        {
+            printf("frame %u: pool does not match the plan's prediction\n", frames);
+            success = false;
+            break;
+        }
+        if (frames <= 4 || (frames & (frames - 1)) == 0)
+        {
+            printf("frame %5u  moved %8.1f KB  evacuated %3zu  ", frames, plan.bytesMoved / 1024.0, plan.evacuatedBlocks.size());
+            PrintStats("", stats);
+        }
+    }
+
+    PrintStats("before", initial);
+    PrintStats("after", ASDefragmenter::Measure(pool.GetBlocks()));
+    printf("%u frames, %.1f MB moved, %s\n", frames, moved / (1024.0 * 1024.0), success ? "all plans landed" : "FAILED");
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/**
+ *  Instance slot churn benchmark.  Replays one stream of entity lifecycle events, a steady churn
+ *  of entities replaced every frame on top of a population that shrinks and grows back in a
+ *  triangle wave, against three ways of numbering instances: by position in the entity list the
+ *  way ResourceManager used to, by InstanceSlotAllocator slots, and by slots compacted every few
+ *  frames.  Reports the per instance mapping entries rewritten per frame, how dense the active
+ *  range stays, the compaction moves and the time per list or allocator call, and checks every
+ *  frame that each live entity owns exactly the slot its handle names and that released handles
+ *  are stale.  Seeded, so the same arguments always give the same output.
+ *
+ *  instance_slot_bench [--entities n] [--frames n] [--churn n] [--shrink-percent n] [--period n]
+ *                      [--compact-interval n] [--max-moves n] [--seed n]
+ */
+
+#include "InstanceSlotAllocator.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t entities        = 10000;
+        uint32_t frames          = 1000;
+        uint32_t churn           = 20;
+        uint32_t shrinkPercent   = 50;
+        uint32_t period          = 400;
+        uint32_t compactInterval = 30;
+        uint32_t maxMoves        = 256;
+        uint64_t seed            = 0x853C49E6748FEA9Bull;
+    };
+
+    enum class Numbering
+    {
+        Positions,
+        Slots,
+        CompactedSlots
+    };
+
+    struct Result
+    {
+        uint64_t rewrites     = 0;
+        double   densitySum   = 0.0;
+        uint32_t peakRange    = 0;
+        uint32_t finalRange   = 0;
+        uint32_t finalLive    = 0;
+        uint64_t moves        = 0;
+        uint64_t calls        = 0;
+        double   callSeconds  = 0.0;
+    };
+
+    // Population the scene heads for in a frame, a triangle wave between the full and the shrunk size
+    uint32_t TargetPopulation(const Options& options, uint32_t frame)
+    {
+        const uint32_t shrunk = options.entities - options.entities / 100 * options.shrinkPercent;
+        const uint32_t phase  = frame % options.period;
+        const uint32_t half   = options.period / 2;
+        const uint32_t depth  = phase < half ? phase : options.period - phase;
+        return options.entities - static_cast<uint32_t>(uint64_t(options.entities - shrunk) * depth / half);
+    }
+
+    // Entries of the per instance mappings that differ between two frames
+    uint64_t CountRewrites(const std::vector<uint32_t>& before, const std::vector<uint32_t>& after)
+    {
+        const size_t common   = std::min(before.size(), after.size());
+        uint64_t     rewrites = std::max(before.size(), after.size()) - common;
+        for (size_t index = 0; index < common; index++)
+        {
+            rewrites += before[index] != after[index] ? 1 : 0;
+        }
+        return rewrites;
+    }
+
+    bool Run(const Options& options, Numbering numbering, Result& result)
+    {
+        // Every numbering sees the same entities come and go, the list position an entity is
+        // inserted at comes from a generator of its own
+        Rng                   lifecycle = {options.seed};
+        Rng                   placement = {options.seed ^ 0x9E3779B97F4A7C15ull};
+        uint32_t              nextId    = 1;
+        std::vector<uint32_t> population;
+
+        std::vector<uint32_t>           order;     // Positions, entity ids in list order
+        std::vector<InstanceSlotHandle> handles;   // Slots, indexed by entity id
+        std::vector<uint32_t>           owners;    // Entity id in every instance index, 0 for a hole
+        std::vector<uint32_t>           previous;
+        std::vector<InstanceSlotMove>   moves;
+        InstanceSlotAllocator           allocator;
+        bool                            success = true;
+
+        handles.push_back(InstanceSlotHandle{0});
+        for (uint32_t frame = 0; frame < options.frames && success; frame++)
+        {
+            // Replace the churn and close the gap to the target population
+            const uint32_t target   = TargetPopulation(options, frame);
+            const uint32_t live     = static_cast<uint32_t>(population.size());
+            const uint32_t removals = std::min(live, options.churn + (live > target ? live - target : 0));
+            const uint32_t adds     = target > live - removals ? target - (live - removals) : 0;
+
+            previous = owners;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t removal = 0; removal < removals; removal++)
+            {
+                const uint32_t index = lifecycle.Next(static_cast<uint32_t>(population.size()));
+                const uint32_t id    = population[index];
+                population[index]    = population.back();
+                population.pop_back();
+
+                if (numbering == Numbering::Positions)
+                {
+                    order.erase(std::find(order.begin(), order.end(), id));
+                    result.calls++;
+                }
+                else
+                {
+                    const InstanceSlotHandle handle = handles[id];
+                    allocator.Release(handle);
+                    owners[handle.GetSlot()] = 0;
+                    handles[id]              = InstanceSlotHandle{0};
+                    success                  = success && allocator.IsLive(handle) == false;
+                    result.calls++;
+                }
+            }
+            for (uint32_t add = 0; add < adds; add++)
+            {
+                const uint32_t id = nextId++;
+                population.push_back(id);
+
+                if (numbering == Numbering::Positions)
+                {
+                    order.insert(order.begin() + placement.Next(static_cast<uint32_t>(order.size()) + 1), id);
+                    result.calls++;
+                }
+                else
+                {
+                    const InstanceSlotHandle handle = allocator.Allocate();
+                    handles.resize(id + 1, InstanceSlotHandle{0});
+                    handles[id] = handle;
+                    owners.resize(std::max<size_t>(owners.size(), handle.GetSlot() + 1), 0);
+                    owners[handle.GetSlot()] = id;
+                    result.calls++;
+                }
+            }
+            if (numbering == Numbering::CompactedSlots && (frame + 1) % options.compactInterval == 0)
+            {
+                allocator.Compact(options.maxMoves, moves);
+                for (const InstanceSlotMove& move : moves)
+                {
+                    const uint32_t id = owners[move.from];
+                    owners[move.to]   = id;
+                    owners[move.from] = 0;
+                    handles[id]       = move.handle;
+                }
+                result.moves += moves.size();
+                result.calls++;
+            }
+            result.callSeconds += Seconds(start);
+
+            if (numbering == Numbering::Positions)
+            {
+                owners = order;
+            }
+            else
+            {
+                owners.resize(allocator.GetSlotCount());
+            }
+
+            result.rewrites   += CountRewrites(previous, owners);
+            result.densitySum += owners.empty() ? 1.0 : static_cast<double>(population.size()) / owners.size();
+            result.peakRange   = std::max(result.peakRange, static_cast<uint32_t>(owners.size()));
+
+            if (numbering != Numbering::Positions)
+            {
+                success = success && allocator.Validate() && allocator.GetLiveCount() == population.size();
+                for (uint32_t id : population)
+                {
+                    const InstanceSlotHandle handle = handles[id];
+                    success = success && allocator.IsLive(handle) && owners[handle.GetSlot()] == id;
+                }
+                if (success == false)
+                {
+                    printf("frame %u: slot ownership is inconsistent\n", frame);
+                }
+            }
+        }
+
+        result.finalRange = static_cast<uint32_t>(owners.size());
+        result.finalLive  = static_cast<uint32_t>(population.size());
+        return success;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--entities", options.entities);
+        parser.Add("--frames", options.frames);
+        parser.Add("--churn", options.churn);
+        parser.Add("--shrink-percent", options.shrinkPercent);
+        parser.Add("--period", options.period);
+        parser.Add("--compact-interval", options.compactInterval);
+        parser.Add("--max-moves", options.maxMoves);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.entities > 0 && options.frames > 0 && options.shrinkPercent < 100 && options.period >= 2 &&
+               options.compactInterval > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u entities over %u frames, %u replaced per frame, shrinking %u%% every %u frames, "
+           "compacting %u slots every %u frames\n",
+           options.entities,
+           options.frames,
+           options.churn,
+           options.shrinkPercent,
+           options.period,
+           options.maxMoves,
+           options.compactInterval);
+    printf("%-16s %16s %13s %11s %11s %11s %8s %10s\n", "numbering", "rewrites/frame", "mean density", "peak range",
+           "final range", "final live", "moves", "ns/call");
+
+    const char*     names[]      = {"positions", "slots", "compacted slots"};
+    const Numbering numberings[] = {Numbering::Positions, Numbering::Slots, Numbering::CompactedSlots};
+    bool            success      = true;
+    for (uint32_t index = 0; index < 3; index++)
+    {
+        Result result;
+        success = Run(options, numberings[index], result) && success;
+        printf("%-16s %16.1f %12.1f%% %11u %11u %11u %8llu %10.1f\n",
+               names[index],
+               static_cast<double>(result.rewrites) / options.frames,
+               100.0 * result.densitySum / options.frames,
+               result.peakRange,
+               result.finalRange,
+               result.finalLive,
+               static_cast<unsigned long long>(result.moves),
+               result.calls > 0 ? 1e9 * result.callSeconds / result.calls : 0.0);
+    }
+
+    printf("%s\n", success ? "all slots consistent" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,338 @@
+/**
+ *  Instance upload simulator.  Runs a scene of entities through the per instance streams
+ *  ResourceManager uploads every frame, the instance descs with one GPU copy per frame in flight,
+ *  the world to object, model and previous transforms through a ring of upload buffers into one
+ *  GPU buffer and the normal matrices written straight into an upload buffer.  Every frame the
+ *  streams are brought up to date twice, by rewriting and copying every slot and by rewriting and
+ *  copying only the ranges InstanceUploadTracker reports, and the buffers the GPU reads are checked
+ *  against the full upload slot for slot.  Reports the bytes written into upload buffers and copied
+ *  per frame for a static, a partially animated and a fully animated scene.  Seeded, so the same
+ *  arguments always give the same output.
+ *
+ *  instance_upload_sim [--entities n] [--frames n] [--ring n] [--animated-percent n]
+ *                      [--merge-gap n] [--churn n] [--seed n]
+ */
+
+#include "InstanceUploadTracker.h"
+#include "BenchUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t entities        = 10000;
+        uint32_t frames          = 300;
+        uint32_t ring            = 3;
+        uint32_t animatedPercent = 5;
+        uint32_t mergeGap        = 4;
+        uint32_t churn           = 0;
+        uint64_t seed            = 0x853C49E6748FEA9Bull;
+    };
+
+    // Where the GPU reads a stream from
+    enum class Target
+    {
+        SharedGPU, // one default heap buffer fed from the upload buffer of the frame
+        RingGPU,   // one default heap buffer per frame in flight
+        Direct     // the upload buffer itself
+    };
+
+    struct StreamDesc
+    {
+        const char* name;
+        uint32_t    words;
+        uint32_t    trailingFrames;
+        Target      target;
+    };
+
+    // Previous transforms lag the instance descs by a frame
+    constexpr uint32_t   InstanceDescStream = 0;
+    constexpr uint32_t   PreviousStream     = 4;
+    constexpr uint32_t   TransformWords     = 12;
+    constexpr StreamDesc StreamDescs[]      = {
+        {"instance descs",  16, 0, Target::RingGPU},
+        {"world to object", 12, 0, Target::SharedGPU},
+        {"normal",           9, 0, Target::Direct},
+        {"model",           16, 0, Target::SharedGPU},
+        {"previous",        12, 1, Target::SharedGPU},
+    };
+    constexpr uint32_t StreamCount = sizeof(StreamDescs) / sizeof(StreamDescs[0]);
+
+    struct SimEntity
+    {
+        uint32_t id;
+        uint32_t generation;
+        bool     animated;
+    };
+
+    // A buffer and the frame it was last brought up to date in
+    struct Buffer
+    {
+        std::vector<uint32_t> words;
+        uint64_t              syncedFrame = 0;
+    };
+
+    struct Stream
+    {
+        std::vector<uint32_t> cpu;
+        std::vector<uint32_t> reference;
+        std::vector<Buffer>   uploads;
+        std::vector<Buffer>   gpus;
+    };
+
+    struct Totals
+    {
+        uint64_t cpuBytes     = 0;
+        uint64_t uploadBytes  = 0;
+        uint64_t copyBytes    = 0;
+        uint64_t copies       = 0;
+        uint64_t fullBytes    = 0;
+        uint64_t changedSlots = 0;
+    };
+
+    uint32_t Content(uint32_t id, uint32_t generation, uint32_t stream, uint32_t word)
+    {
+        uint64_t value = (uint64_t(id) << 32 | generation) * 0x9E3779B97F4A7C15ull + stream * 31 + word;
+        value         ^= value >> 29;
+        value         *= 0xBF58476D1CE4E5B9ull;
+        return static_cast<uint32_t>(value >> 32);
+    }
+
+    // Writes the stream's content for the entity in the slot, the previous transforms are copied
+    // from the instance descs instead
+    void WriteSlot(std::vector<uint32_t>& words, uint32_t stream, uint32_t slot, const SimEntity& entity)
+    {
+        uint32_t* destination = &words[uint64_t(slot) * StreamDescs[stream].words];
+        for (uint32_t word = 0; word < StreamDescs[stream].words; word++)
+        {
+            destination[word] = Content(entity.id, entity.generation, stream, word);
+        }
+    }
+
+    void CopySlots(std::vector<uint32_t>& destination, const std::vector<uint32_t>& source, uint32_t words, const SlotRange& range)
+    {
+        memcpy(&destination[uint64_t(range.first) * words], &source[uint64_t(range.first) * words],
+               uint64_t(range.count) * words * sizeof(uint32_t));
+    }
+
+    void CopyPrevious(std::vector<uint32_t>& previous, const std::vector<uint32_t>& instanceDescs, const SlotRange& range)
+    {
+        for (uint32_t slot = range.first; slot < range.first + range.count; slot++)
+        {
+            memcpy(&previous[uint64_t(slot) * TransformWords],
+                   &instanceDescs[uint64_t(slot) * StreamDescs[InstanceDescStream].words],
+                   TransformWords * sizeof(uint32_t));
+        }
+    }
+
+    bool SameSlots(const std::vector<uint32_t>& words, const std::vector<uint32_t>& reference, uint64_t count)
+    {
+        return memcmp(words.data(), reference.data(), count * sizeof(uint32_t)) == 0;
+    }
+
+    bool RunScene(const Options& options, const char* name, uint32_t animatedPercent)
+    {
+        Rng                    rng = {options.seed};
+        uint32_t               nextId         = 1;
+        uint32_t               nextGeneration = 1;
+        std::vector<SimEntity> entities;
+        for (uint32_t index = 0; index < options.entities; index++)
+        {
+            entities.push_back(SimEntity{nextId++, nextGeneration++, rng.Next(100) < animatedPercent});
+        }
+
+        const uint32_t        slotCount = options.entities;
+        InstanceUploadTracker tracker(options.mergeGap);
+        Stream                streams[StreamCount];
+        for (uint32_t stream = 0; stream < StreamCount; stream++)
+        {
+            const uint64_t words = uint64_t(slotCount) * StreamDescs[stream].words;
+            streams[stream].cpu.assign(words, 0);
+            streams[stream].reference.assign(words, 0);
+            streams[stream].uploads.resize(StreamDescs[stream].target == Target::Direct ? 1 : options.ring);
+            streams[stream].gpus.resize(StreamDescs[stream].target == Target::RingGPU   ? options.ring
+                                        : StreamDescs[stream].target == Target::SharedGPU ? 1
+                                                                                          : 0);
+            for (Buffer& buffer : streams[stream].uploads)
+            {
+                buffer.words.assign(words, 0);
+            }
+            for (Buffer& buffer : streams[stream].gpus)
+            {
+                buffer.words.assign(words, 0);
+            }
+        }
+
+        Totals                 totals;
+        bool                   success = true;
+        std::vector<SlotRange> ranges;
+        std::vector<SlotRange> copyRanges;
+        for (uint32_t frame = 0; frame < options.frames; frame++)
+        {
+            // Lifecycle churn moves every entity behind the one inserted or removed
+            for (uint32_t change = 0; change < options.churn && entities.empty() == false; change++)
+            {
+                entities.erase(entities.begin() + rng.Next(static_cast<uint32_t>(entities.size())));
+                entities.insert(entities.begin() + rng.Next(static_cast<uint32_t>(entities.size()) + 1),
+                                SimEntity{nextId++, nextGeneration++, rng.Next(100) < animatedPercent});
+            }
+            for (SimEntity& entity : entities)
+            {
+                if (entity.animated)
+                {
+                    entity.generation = nextGeneration++;
+                }
+            }
+
+            // Reference, every slot rewritten and the previous transforms copied wholesale
+            const std::vector<uint32_t>& instanceReference = streams[InstanceDescStream].reference;
+            CopyPrevious(streams[PreviousStream].reference, instanceReference, SlotRange{0, slotCount});
+            for (uint32_t slot = 0; slot < slotCount; slot++)
+            {
+                for (uint32_t stream = 0; stream < StreamCount; stream++)
+                {
+                    if (stream != PreviousStream)
+                    {
+                        WriteSlot(streams[stream].reference, stream, slot, entities[slot]);
+                    }
+                }
+            }
+            for (uint32_t stream = 0; stream < StreamCount; stream++)
+            {
+                const uint64_t slotBytes = uint64_t(slotCount) * StreamDescs[stream].words * sizeof(uint32_t);
+                totals.fullBytes        += StreamDescs[stream].target == Target::Direct ? slotBytes : 2 * slotBytes;
+            }
+
+            // Tracked, the previous transforms of slots changed last frame or this one catch up
+            // before the changed slots are rewritten
+            tracker.BeginFrame(slotCount);
+            for (uint32_t slot = 0; slot < slotCount; slot++)
+            {
+                tracker.Track(slot, reinterpret_cast<const void*>(uintptr_t(entities[slot].id)), entities[slot].generation);
+            }
+            totals.changedSlots += tracker.GetChangedCount();
+
+            const uint64_t currentFrame = tracker.GetFrame();
+            tracker.CollectRanges(currentFrame - 1, 1, ranges);
+            for (const SlotRange& range : ranges)
+            {
+                CopyPrevious(streams[PreviousStream].cpu, streams[InstanceDescStream].cpu, range);
+                totals.cpuBytes += uint64_t(range.count) * TransformWords * sizeof(uint32_t);
+            }
+            tracker.CollectRanges(currentFrame - 1, 0, ranges);
+            for (const SlotRange& range : ranges)
+            {
+                for (uint32_t slot = range.first; slot < range.first + range.count; slot++)
+                {
+                    for (uint32_t stream = 0; stream < StreamCount; stream++)
+                    {
+                        if (stream != PreviousStream)
+                        {
+                            WriteSlot(streams[stream].cpu, stream, slot, entities[slot]);
+                            totals.cpuBytes += StreamDescs[stream].words * sizeof(uint32_t);
+                        }
+                    }
+                }
+            }
+
+            // Upload buffers catch up on everything changed since they were last written, the
+            // shared GPU buffer only on what changed since its last copy
+            const uint32_t ringIndex = frame % options.ring;
+            for (uint32_t stream = 0; stream < StreamCount; stream++)
+            {
+                const StreamDesc& desc   = StreamDescs[stream];
+                Stream&           state  = streams[stream];
+                Buffer&           upload = state.uploads[desc.target == Target::Direct ? 0 : ringIndex];
+
+                tracker.CollectRanges(upload.syncedFrame, desc.trailingFrames, ranges);
+                for (const SlotRange& range : ranges)
+                {
+                    CopySlots(upload.words, state.cpu, desc.words, range);
+                    totals.uploadBytes += uint64_t(range.count) * desc.words * sizeof(uint32_t);
+                }
+                upload.syncedFrame = currentFrame;
+
+                const std::vector<uint32_t>* visible = &upload.words;
+                if (desc.target != Target::Direct)
+                {
+                    Buffer& gpu = state.gpus[desc.target == Target::RingGPU ? ringIndex : 0];
+                    tracker.CollectRanges(gpu.syncedFrame, desc.trailingFrames, copyRanges);
+                    for (const SlotRange& range : copyRanges)
+                    {
+                        CopySlots(gpu.words, upload.words, desc.words, range);
+                        totals.copyBytes += uint64_t(range.count) * desc.words * sizeof(uint32_t);
+                        totals.copies++;
+                    }
+                    gpu.syncedFrame = currentFrame;
+                    visible         = &gpu.words;
+                }
+
+                const uint64_t words = uint64_t(slotCount) * desc.words;
+                if (SameSlots(*visible, state.reference, words) == false)
+                {
+                    printf("%s frame %u: %s differs from a full upload\n", name, frame, desc.name);
+                    success = false;
+                }
+            }
+        }
+
+        const double frames = options.frames;
+        const double full   = totals.fullBytes / frames;
+        const double moved  = (totals.uploadBytes + totals.copyBytes) / frames;
+        printf("%-8s %14.1f %13.1f %15.1f %13.1f %12.1f %13.1f %8.2f%%\n",
+               name,
+               totals.changedSlots / frames,
+               totals.cpuBytes / frames / 1024.0,
+               totals.uploadBytes / frames / 1024.0,
+               totals.copyBytes / frames / 1024.0,
+               totals.copies / frames,
+               full / 1024.0,
+               full > 0.0 ? 100.0 * moved / full : 0.0);
+        return success;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--entities", options.entities);
+        parser.Add("--frames", options.frames);
+        parser.Add("--ring", options.ring);
+        parser.Add("--animated-percent", options.animatedPercent);
+        parser.Add("--merge-gap", options.mergeGap);
+        parser.Add("--churn", options.churn);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.frames > 0 && options.ring > 0 && options.animatedPercent <= 100 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u entities over %u frames, %u frames in flight, merge gap %u, %u entities replaced per frame\n",
+           options.entities,
+           options.frames,
+           options.ring,
+           options.mergeGap,
+           options.churn);
+    printf("%-8s %14s %13s %15s %13s %12s %13s %9s\n", "scene", "changed/frame", "cpu KB/frame", "upload KB/frame",
+           "copy KB/frame", "copies/frame", "full KB/frame", "of full");
+
+    bool success = RunScene(options, "static", 0);
+    success      = RunScene(options, "partial", options.animatedPercent) && success;
+    success      = RunScene(options, "animated", 100) && success;
+
+    printf("%s\n", success ? "all uploads match" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/**
+ *  Parallel instance writer benchmark.  Writes the per instance streams ResourceManager builds for
+ *  the changed slots of a frame, the object to world, world to object, normal and model transforms
+ *  and the instance descs with the bottom level of every slot's model, with ParallelInstanceWriter
+ *  on 1 thread and then on twice as many at a time up to --max-threads.  Reports the time per
+ *  frame, the slots written per second and the speedup over one thread, and checks every stream
+ *  byte for byte against one pass per range on the calling thread.  Seeded, so the same arguments
+ *  always give the same streams.
+ *
+ *  instance_writer_bench [--entities n] [--changed-percent n] [--models n] [--max-threads n]
+ *                        [--chunk n] [--repeats n] [--seed n]
+ */
+
+#include "ParallelInstanceWriter.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t ObjectToWorldFloats = 12;
+    constexpr uint32_t WorldToObjectFloats = 12;
+    constexpr uint32_t NormalFloats        = 9;
+    constexpr uint32_t ModelFloats         = 16;
+
+    struct Options
+    {
+        uint32_t entities       = 50000;
+        uint32_t changedPercent = 100;
+        uint32_t models         = 500;
+        uint32_t maxThreads     = std::max(std::thread::hardware_concurrency(), 1u);
+        uint32_t chunk          = 256;
+        uint32_t repeats        = 20;
+        uint64_t seed           = 0x853C49E6748FEA9Bull;
+    };
+
+    // Same layout as D3D12_RAYTRACING_INSTANCE_DESC
+    struct InstanceDesc
+    {
+        float    transform[12];
+        uint32_t instanceIdAndMask;
+        uint32_t contributionAndFlags;
+        uint64_t accelerationStructure;
+    };
+
+    struct SimEntity
+    {
+        float    world[16]; // Row major, translation in the last column
+        uint32_t model;
+    };
+
+    // Rotation about a random axis, a non uniform scale and a translation
+    SimEntity MakeEntity(Rng& rng, uint32_t modelCount)
+    {
+        float axis[3]  = {rng.NextUnit() - 0.5f, rng.NextUnit() - 0.5f, rng.NextUnit() - 0.5f};
+        float length   = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) + 1e-6f;
+        float angle    = rng.NextUnit() * 6.2831853f;
+        float c        = std::cos(angle);
+        float s        = std::sin(angle);
+        float t        = 1.0f - c;
+        float x        = axis[0] / length;
+        float y        = axis[1] / length;
+        float z        = axis[2] / length;
+        float scale[3] = {0.5f + rng.NextUnit(), 0.5f + rng.NextUnit(), 0.5f + rng.NextUnit()};
+
+        const float rotation[9] = {t * x * x + c,     t * x * y - s * z, t * x * z + s * y,
+                                   t * x * y + s * z, t * y * y + c,     t * y * z - s * x,
+                                   t * x * z - s * y, t * y * z + s * x, t * z * z + c};
+
+        SimEntity entity = {};
+        for (uint32_t row = 0; row < 3; row++)
+        {
+            for (uint32_t column = 0; column < 3; column++)
+            {
+                entity.world[row * 4 + column] = rotation[row * 3 + column] * scale[column];
+            }
+            entity.world[row * 4 + 3] = (rng.NextUnit() - 0.5f) * 2000.0f;
+        }
+        entity.world[15] = 1.0f;
+        entity.model     = rng.Next(modelCount);
+        return entity;
+    }
+
+    // The streams of every slot and the work that fills them, one writer shared by all threads
+    class StreamWriter : public InstanceChunkWriter
+    {
+    public:
+
+        StreamWriter(const std::vector<SimEntity>& entities, const std::vector<uint64_t>& blasAddresses)
+            : m_entities(entities), m_blasAddresses(blasAddresses)
+        {
+            const size_t slots = entities.size();
+            objectToWorld.resize(slots * ObjectToWorldFloats);
+            worldToObject.resize(slots * WorldToObjectFloats);
+            normal.resize(slots * NormalFloats);
+            model.resize(slots * ModelFloats);
+            descs.resize(slots);
+        }
+
+        void Clear()
+        {
+            std::fill(objectToWorld.begin(), objectToWorld.end(), -1.0f);
+            std::fill(worldToObject.begin(), worldToObject.end(), -1.0f);
+            std::fill(normal.begin(), normal.end(), -1.0f);
+            std::fill(model.begin(), model.end(), -1.0f);
+            memset(descs.data(), 0xFF, sizeof(InstanceDesc) * descs.size());
+        }
+
+        bool Matches(const StreamWriter& other) const
+        {
+            return memcmp(objectToWorld.data(), other.objectToWorld.data(), sizeof(float) * objectToWorld.size()) == 0 &&
+                   memcmp(worldToObject.data(), other.worldToObject.data(), sizeof(float) * worldToObject.size()) == 0 &&
+                   memcmp(normal.data(), other.normal.data(), sizeof(float) * normal.size()) == 0 &&
+                   memcmp(model.data(), other.model.data(), sizeof(float) * model.size()) == 0 &&
+                   memcmp(descs.data(), other.descs.data(), sizeof(InstanceDesc) * descs.size()) == 0;
+        }
+
+        void WriteChunk(uint32_t firstSlot, uint32_t slotCount) override
+        {
+            for (uint32_t slot = firstSlot; slot < firstSlot + slotCount; slot++)
+            {
+                const SimEntity& entity = m_entities[slot];
+                const float*     m      = entity.world;
+
+                memcpy(&objectToWorld[slot * ObjectToWorldFloats], m, sizeof(float) * ObjectToWorldFloats);
+                memcpy(&model[slot * ModelFloats], m, sizeof(float) * ModelFloats);
+
+                // Inverse of the 3x3 through its cofactors, the normal matrix is its transpose
+                float cofactors[9] = {m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+                                      m[2] * m[9] - m[1] * m[10], m[0] * m[10] - m[2] * m[8], m[1] * m[8] - m[0] * m[9],
+                                      m[1] * m[6] - m[2] * m[5],  m[2] * m[4] - m[0] * m[6],  m[0] * m[5] - m[1] * m[4]};
+                float determinant  = m[0] * cofactors[0] + m[1] * cofactors[1] + m[2] * cofactors[2];
+                float inverseScale = 1.0f / determinant;
+
+                float* inverse = &worldToObject[slot * WorldToObjectFloats];
+                float* normals = &normal[slot * NormalFloats];
+                for (uint32_t row = 0; row < 3; row++)
+                {
+                    for (uint32_t column = 0; column < 3; column++)
+                    {
+                        inverse[row * 4 + column] = cofactors[column * 3 + row] * inverseScale;
+                        normals[row * 3 + column] = cofactors[row * 3 + column] * inverseScale;
+                    }
+                }
+                for (uint32_t row = 0; row < 3; row++)
+                {
+                    inverse[row * 4 + 3] = -(inverse[row * 4 + 0] * m[3] + inverse[row * 4 + 1] * m[7] +
+                                             inverse[row * 4 + 2] * m[11]);
+                }
+
+                InstanceDesc& desc = descs[slot];
+                memcpy(desc.transform, m, sizeof(desc.transform));
+                desc.instanceIdAndMask     = 1u << 24;
+                desc.contributionAndFlags  = 0;
+                desc.accelerationStructure = m_blasAddresses[entity.model];
+            }
+        }
+
+        std::vector<float>        objectToWorld;
+        std::vector<float>        worldToObject;
+        std::vector<float>        normal;
+        std::vector<float>        model;
+        std::vector<InstanceDesc> descs;
+
+    private:
+
+        const std::vector<SimEntity>& m_entities;
+        const std::vector<uint64_t>&  m_blasAddresses;
+    };
+
+    // Doubles up to the maximum, which is always measured
+    uint32_t NextThreadCount(uint32_t threads, uint32_t maxThreads)
+    {
+        return threads < maxThreads ? std::min(threads * 2, maxThreads) : maxThreads + 1;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--entities", options.entities);
+        parser.Add("--changed-percent", options.changedPercent);
+        parser.Add("--models", options.models);
+        parser.Add("--max-threads", options.maxThreads);
+        parser.Add("--chunk", options.chunk);
+        parser.Add("--repeats", options.repeats);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.entities > 0 && options.changedPercent <= 100 && options.models > 0 &&
+               options.maxThreads > 0 && options.chunk > 0 && options.repeats > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    Rng                    rng = {options.seed};
+    std::vector<SimEntity> entities;
+    std::vector<uint64_t>  blasAddresses;
+    for (uint32_t index = 0; index < options.entities; index++)
+    {
+        entities.push_back(MakeEntity(rng, options.models));
+    }
+    for (uint32_t index = 0; index < options.models; index++)
+    {
+        blasAddresses.push_back(0x100000000ull + uint64_t(index) * 0x10000);
+    }
+
+    // The changed slots of a frame as ResourceManager collects them, the transform generation of
+    // the changed entities moved on since the frame before
+    InstanceUploadTracker  tracker;
+    std::vector<SlotRange> ranges;
+    tracker.BeginFrame(options.entities);
+    for (uint32_t slot = 0; slot < options.entities; slot++)
+    {
+        tracker.Track(slot, &entities[slot], 1);
+    }
+    tracker.BeginFrame(options.entities);
+    for (uint32_t slot = 0; slot < options.entities; slot++)
+    {
+        tracker.Track(slot, &entities[slot], rng.Next(100) < options.changedPercent ? 2 : 1);
+    }
+    tracker.CollectRanges(tracker.GetFrame() - 1, 0, ranges);
+    const uint64_t changedSlots = InstanceUploadTracker::CountSlots(ranges);
+
+    // The loop ResourceManager ran before, one pass per range on the caller
+    StreamWriter reference(entities, blasAddresses);
+    reference.Clear();
+    for (const SlotRange& range : ranges)
+    {
+        reference.WriteChunk(range.first, range.count);
+    }
+
+    printf("%u entities, %llu changed in %zu ranges, %u slot chunks\n",
+           options.entities,
+           static_cast<unsigned long long>(changedSlots),
+           ranges.size(),
+           options.chunk);
+    printf("%8s %12s %16s %9s %11s\n", "threads", "ms/frame", "Mslots/s", "speedup", "identical");
+
+    bool   success       = true;
+    double serialSeconds = 0.0;
+    for (uint32_t threads = 1; threads <= options.maxThreads; threads = NextThreadCount(threads, options.maxThreads))
+    {
+        StreamWriter           streams(entities, blasAddresses);
+        ParallelInstanceWriter writer(threads - 1, options.chunk);
+
+        // The first write warms the workers up and is the one compared
+        streams.Clear();
+        writer.Write(ranges, &streams);
+        bool identical = streams.Matches(reference);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t repeat = 0; repeat < options.repeats; repeat++)
+        {
+            writer.Write(ranges, &streams);
+        }
+        double seconds = Seconds(start) /
+                         options.repeats;
+        serialSeconds  = threads == 1 ? seconds : serialSeconds;
+        identical      = identical && streams.Matches(reference);
+        success        = success && identical;
+
+        printf("%8u %12.3f %16.2f %8.2fx %11s\n",
+               threads,
+               1e3 * seconds,
+               seconds > 0.0 ? changedSlots / seconds / 1e6 : 0.0,
+               seconds > 0.0 ? serialSeconds / seconds : 0.0,
+               identical ? "yes" : "no");
+    }
+
+    printf("%s\n", success ? "all thread counts match the serial write" : "FAILED");
+    return success ? 0 : 1;
+}
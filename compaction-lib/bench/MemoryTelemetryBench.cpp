@@ -0,0 +1,246 @@
+/**
+ *  Memory telemetry dump benchmark.  Writes a stream of synthetic frames to a CSV and a JSON lines
+ *  file with MemoryTelemetryWriter, times the writes and counts heap allocations made while
+ *  writing, which must be none.  Reads both files back and checks every CSV row has as many
+ *  columns as the header, every JSON line is one balanced object and the histogram buckets land
+ *  on their boundaries.  Seeded, so the same arguments always give the same output.
+ *
+ *  memory_telemetry_bench [--frames n] [--directory path] [--seed n]
+ */
+
+#include "MemoryTelemetry.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+    // Every allocation in the process goes through here once counting is switched on
+    bool     countAllocations = false;
+    uint64_t allocationCount  = 0;
+
+    struct Options
+    {
+        uint32_t    frames    = 100000;
+        std::string directory = ".";
+        uint64_t    seed      = 0x853C49E6748FEA9Bull;
+    };
+
+    void FillPool(Rng& rng, PoolTelemetry& pool)
+    {
+        pool.blockCount          = 1 + rng.Next(64);
+        pool.residentBytes       = uint64_t(pool.blockCount) * 4 * 1024 * 1024;
+        pool.usedBytes           = pool.residentBytes / 2 + rng.Next(1u << 20);
+        pool.largestFreeRange    = rng.Next(4 * 1024 * 1024);
+        pool.alignmentSavedBytes = rng.Next(1u << 30);
+        pool.liveAllocations     = rng.Next(100000);
+        pool.fragmentation       = rng.Next(1000) / 1000.0f;
+        pool.allocations        += rng.Next(100);
+        pool.frees              += rng.Next(100);
+        pool.frameAllocations    = rng.Next(100);
+        pool.frameFrees          = rng.Next(100);
+    }
+
+    void Fill(Rng& rng, uint64_t frame, MemoryTelemetry& telemetry)
+    {
+        telemetry.frameIndex = frame;
+        FillPool(rng, telemetry.result);
+        FillPool(rng, telemetry.compaction);
+        telemetry.scratchResidentBytes      = rng.Next();
+        telemetry.scratchFramePeakBytes     = rng.Next();
+        telemetry.uncompactedBytes          = uint64_t(rng.Next()) << 4;
+        telemetry.compactedBytes            = uint64_t(rng.Next()) << 3;
+        telemetry.compactionSavedBytes      = uint64_t(rng.Next()) << 3;
+        telemetry.compactionsPending        = rng.Next(10000);
+        telemetry.transientBytes            = rng.Next();
+        telemetry.frameCompactionBytes      = rng.Next();
+        telemetry.frameDefragmentationBytes = rng.Next();
+        telemetry.frameDeserializationBytes = rng.Next();
+        for (uint32_t& bucket : telemetry.bytesMovedHistogram)
+        {
+            bucket = rng.Next(1000);
+        }
+    }
+
+    bool CheckBuckets()
+    {
+        return MemoryTelemetryHistogramBucket(0)                    == 0  &&
+               MemoryTelemetryHistogramBucket(512)                  == 0  &&
+               MemoryTelemetryHistogramBucket(513)                  == 1  &&
+               MemoryTelemetryHistogramBucket(1024)                 == 1  &&
+               MemoryTelemetryHistogramBucket(8 * 1024 * 1024)      == 14 &&
+               MemoryTelemetryHistogramBucket(8 * 1024 * 1024 + 1)  == 15 &&
+               MemoryTelemetryHistogramBucket(uint64_t(1) << 40)    == 15;
+    }
+
+    // Times frames writes of one format, returns false when a write failed or allocated
+    bool WriteFrames(const Options& options, const std::string& path, MemoryTelemetryFormat format, double& microseconds)
+    {
+        MemoryTelemetryWriter writer;
+        if (writer.Open(path.c_str(), format) == false)
+        {
+            printf("%s: can't be created\n", path.c_str());
+            return false;
+        }
+
+        Rng             rng       = {options.seed};
+        MemoryTelemetry telemetry = {};
+        bool            success   = true;
+        double          elapsed   = 0.0;
+
+        allocationCount  = 0;
+        countAllocations = true;
+        for (uint32_t frame = 0; frame < options.frames && success; frame++)
+        {
+            Fill(rng, frame, telemetry);
+            auto start = std::chrono::steady_clock::now();
+            success    = writer.Write(telemetry);
+            elapsed   += Seconds(start) * 1e6;
+        }
+        countAllocations = false;
+        writer.Close();
+
+        microseconds = elapsed / options.frames;
+        if (allocationCount != 0)
+        {
+            printf("%s: %llu allocations while writing\n", path.c_str(), static_cast<unsigned long long>(allocationCount));
+            success = false;
+        }
+        return success;
+    }
+
+    size_t CountChar(const char* line, char c)
+    {
+        size_t count = 0;
+        for (; *line != '\0'; line++)
+        {
+            count += (*line == c) ? 1 : 0;
+        }
+        return count;
+    }
+
+    bool CheckCSV(const std::string& path, uint32_t frames)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        static char line[4096];
+        size_t      columns = 0;
+        uint32_t    rows    = 0;
+        bool        success = fgets(line, sizeof(line), file) != nullptr;
+        if (success)
+        {
+            columns = CountChar(line, ',');
+        }
+        while (success && fgets(line, sizeof(line), file) != nullptr)
+        {
+            if (CountChar(line, ',') != columns || strtoull(line, nullptr, 10) != rows)
+            {
+                printf("%s: row %u doesn't match the header\n", path.c_str(), rows);
+                success = false;
+            }
+            rows++;
+        }
+        fclose(file);
+        printf("%s: %zu columns, %u rows\n", path.c_str(), columns + 1, rows);
+        return success && rows == frames;
+    }
+
+    bool CheckJSON(const std::string& path, uint32_t frames)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        static char line[4096];
+        uint32_t    rows    = 0;
+        bool        success = true;
+        while (success && fgets(line, sizeof(line), file) != nullptr)
+        {
+            if (line[0] != '{' || CountChar(line, '{') != CountChar(line, '}') || CountChar(line, '[') != 1 ||
+                CountChar(line, ']') != 1 || strncmp(line, "{\"frame\":", 9) != 0 || strtoull(line + 9, nullptr, 10) != rows)
+            {
+                printf("%s: line %u is not one frame object\n", path.c_str(), rows);
+                success = false;
+            }
+            rows++;
+        }
+        fclose(file);
+        printf("%s: %u objects\n", path.c_str(), rows);
+        return success && rows == frames;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--frames", options.frames);
+        parser.Add("--directory", options.directory);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.frames > 0 && options.seed != 0;
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (countAllocations)
+    {
+        allocationCount++;
+    }
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    const std::string csvPath  = options.directory + "/memory_telemetry.csv";
+    const std::string jsonPath = options.directory + "/memory_telemetry.json";
+    double            csvTime  = 0.0;
+    double            jsonTime = 0.0;
+
+    bool success = CheckBuckets();
+    if (success == false)
+    {
+        printf("histogram buckets are off\n");
+    }
+    success = WriteFrames(options, csvPath, MemoryTelemetryFormat::CSV, csvTime) && success;
+    success = WriteFrames(options, jsonPath, MemoryTelemetryFormat::JSON, jsonTime) && success;
+    success = CheckCSV(csvPath, options.frames) && success;
+    success = CheckJSON(jsonPath, options.frames) && success;
+
+    printf("%u frames, %.2f us per CSV frame, %.2f us per JSON frame\n", options.frames, csvTime, jsonTime);
+    printf("%s\n", success ? "dumps valid, no allocations while writing" : "FAILED");
+
+    remove(csvPath.c_str());
+    remove(jsonPath.c_str());
+    return success ? 0 : 1;
+}
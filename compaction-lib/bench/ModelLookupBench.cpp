@@ -0,0 +1,284 @@
+/**
+ *  Per model lookup benchmark.  Runs the per frame model lookups ResourceManager makes for every
+ *  entity, the material and attribute descriptor indices, the bottom level and the count of
+ *  entities sharing the model, once through maps keyed by the model pointer the way it used to and
+ *  once through a dense id every model got from InstanceSlotAllocator at registration and flat
+ *  tables indexed by it.  A third of the models are released and registered again before the
+ *  frames, so the ids come off the free list with new generations.  Reports the time per entity of
+ *  both paths and the speedup for 100, 1000 and 10000 models, and checks that both paths read the
+ *  same values every frame.  Seeded, so the same arguments always give the same output.
+ *
+ *  model_lookup_bench [--entities n] [--frames n] [--seed n]
+ */
+
+#include "InstanceSlotAllocator.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        uint32_t entities = 50000;
+        uint32_t frames   = 20;
+        uint64_t seed     = 0x853C49E6748FEA9Bull;
+    };
+
+    // Stands in for Model, heap allocated one at a time like the loaded models
+    struct BenchModel
+    {
+        uint32_t index;
+        uint64_t resourceId;
+        char     payload[240];
+    };
+
+    struct ModelData
+    {
+        uint32_t material;
+        uint32_t attribute;
+        uint64_t blas;
+    };
+
+    ModelData MakeData(uint32_t index)
+    {
+        return ModelData{index * 3 + 1, index * 5 + 2, 0x100000000ull + uint64_t(index) * 0x10000};
+    }
+
+    // What one frame read, summed so the order the models are visited in does not matter
+    struct FrameSum
+    {
+        uint64_t mappings;
+        uint64_t counts;
+
+        bool operator==(const FrameSum& other) const
+        {
+            return mappings == other.mappings && counts == other.counts;
+        }
+    };
+
+    // The maps ResourceManager kept per model, looked up by pointer for every entity
+    class MapLookups
+    {
+    public:
+
+        void Register(BenchModel* model)
+        {
+            ModelData data      = MakeData(model->index);
+            m_materials[model]  = data.material;
+            m_attributes[model] = data.attribute;
+            m_blas[model]       = data.blas;
+        }
+
+        FrameSum Frame(const std::vector<BenchModel*>& entities)
+        {
+            FrameSum                   sum = {};
+            std::map<BenchModel*, int> counts;
+            for (BenchModel* model : entities)
+            {
+                sum.mappings += m_materials[model] + (uint64_t(m_attributes[model]) << 20);
+                sum.mappings ^= m_blas.find(model)->second;
+                counts[model]++;
+            }
+            for (const auto& count : counts)
+            {
+                sum.counts += uint64_t(count.first->index + 1) * count.second;
+            }
+            return sum;
+        }
+
+    private:
+
+        std::map<BenchModel*, uint32_t> m_materials;
+        std::map<BenchModel*, uint32_t> m_attributes;
+        std::map<BenchModel*, uint64_t> m_blas;
+    };
+
+    // Dense ids from the allocator, the model carries its handle and everything else is a table
+    class TableLookups
+    {
+    public:
+
+        void Register(BenchModel* model)
+        {
+            InstanceSlotHandle handle = m_ids.Allocate();
+            uint32_t           id     = handle.GetSlot();
+            model->resourceId         = handle.value;
+            if (id >= m_models.size())
+            {
+                m_models.resize(id + 1, nullptr);
+                m_materials.resize(id + 1, 0);
+                m_attributes.resize(id + 1, 0);
+                m_blas.resize(id + 1, 0);
+                m_counts.resize(id + 1, 0);
+                m_countFrames.resize(id + 1, 0);
+            }
+            ModelData data   = MakeData(model->index);
+            m_models[id]     = model;
+            m_materials[id]  = data.material;
+            m_attributes[id] = data.attribute;
+            m_blas[id]       = data.blas;
+        }
+
+        void Unregister(BenchModel* model)
+        {
+            m_models[InstanceSlotHandle{model->resourceId}.GetSlot()] = nullptr;
+            m_ids.Release(InstanceSlotHandle{model->resourceId});
+            model->resourceId = 0;
+        }
+
+        bool IsRegistered(const BenchModel* model) const
+        {
+            InstanceSlotHandle handle = {model->resourceId};
+            return m_ids.IsLive(handle) && m_models[handle.GetSlot()] == model;
+        }
+
+        FrameSum Frame(const std::vector<BenchModel*>& entities)
+        {
+            FrameSum sum = {};
+            m_frame++;
+            m_counted.clear();
+            for (BenchModel* model : entities)
+            {
+                uint32_t id   = InstanceSlotHandle{model->resourceId}.GetSlot();
+                sum.mappings += m_materials[id] + (uint64_t(m_attributes[id]) << 20);
+                sum.mappings ^= m_blas[id];
+                if (m_countFrames[id] != m_frame)
+                {
+                    m_countFrames[id] = m_frame;
+                    m_counts[id]      = 0;
+                    m_counted.push_back(id);
+                }
+                m_counts[id]++;
+            }
+            for (uint32_t id : m_counted)
+            {
+                sum.counts += uint64_t(m_models[id]->index + 1) * m_counts[id];
+            }
+            return sum;
+        }
+
+    private:
+
+        InstanceSlotAllocator    m_ids;
+        std::vector<BenchModel*> m_models;
+        std::vector<uint32_t>    m_materials;
+        std::vector<uint32_t>    m_attributes;
+        std::vector<uint64_t>    m_blas;
+        std::vector<int>         m_counts;
+        std::vector<uint64_t>    m_countFrames;
+        std::vector<uint32_t>    m_counted;
+        uint64_t                 m_frame = 0;
+    };
+
+    struct Result
+    {
+        double mapSeconds;
+        double tableSeconds;
+        bool   identical;
+    };
+
+    Result Run(const Options& options, uint32_t modelCount, Rng& rng)
+    {
+        std::vector<BenchModel*> models;
+        for (uint32_t index = 0; index < modelCount; index++)
+        {
+            models.push_back(new BenchModel{index, 0, {}});
+        }
+
+        MapLookups   maps;
+        TableLookups tables;
+        for (BenchModel* model : models)
+        {
+            maps.Register(model);
+            tables.Register(model);
+        }
+
+        Result result = {0.0, 0.0, true};
+        for (uint32_t index = 0; index < modelCount; index += 3)
+        {
+            tables.Unregister(models[index]);
+            result.identical = result.identical && tables.IsRegistered(models[index]) == false;
+        }
+        for (uint32_t index = 0; index < modelCount; index += 3)
+        {
+            tables.Register(models[index]);
+        }
+
+        std::vector<BenchModel*> entities;
+        for (uint32_t entity = 0; entity < options.entities; entity++)
+        {
+            entities.push_back(models[rng.Next(modelCount)]);
+        }
+
+        for (uint32_t frame = 0; frame < options.frames; frame++)
+        {
+            // A few entities move over to other models every frame
+            for (uint32_t change = 0; change < options.entities / 100; change++)
+            {
+                entities[rng.Next(options.entities)] = models[rng.Next(modelCount)];
+            }
+
+            auto     start        = std::chrono::steady_clock::now();
+            FrameSum mapSum       = maps.Frame(entities);
+            result.mapSeconds    += Seconds(start);
+            start                 = std::chrono::steady_clock::now();
+            FrameSum tableSum     = tables.Frame(entities);
+            result.tableSeconds  += Seconds(start);
+            result.identical      = result.identical && mapSum == tableSum;
+        }
+
+        for (BenchModel* model : models)
+        {
+            result.identical = result.identical && tables.IsRegistered(model);
+            delete model;
+        }
+        return result;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--entities", options.entities);
+        parser.Add("--frames", options.frames);
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.entities > 0 && options.frames > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u entities over %u frames\n", options.entities, options.frames);
+    printf("%8s %14s %16s %9s %11s\n", "models", "map ns/entity", "table ns/entity", "speedup", "identical");
+
+    const uint32_t modelCounts[] = {100, 1000, 10000};
+    const double   lookups       = double(options.entities) * options.frames;
+    Rng            rng           = {options.seed};
+    bool           success       = true;
+    for (uint32_t modelCount : modelCounts)
+    {
+        Result result = Run(options, modelCount, rng);
+        success       = success && result.identical;
+        printf("%8u %14.2f %16.2f %8.2fx %11s\n",
+               modelCount,
+               1e9 * result.mapSeconds / lookups,
+               1e9 * result.tableSeconds / lookups,
+               result.tableSeconds > 0.0 ? result.mapSeconds / result.tableSeconds : 0.0,
+               result.identical ? "yes" : "no");
+    }
+
+    printf("%s\n", success ? "both paths read the same values" : "FAILED");
+    return success ? 0 : 1;
+}
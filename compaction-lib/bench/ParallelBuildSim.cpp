@@ -0,0 +1,332 @@
+/**
+ *  Parallel build recording simulator.  Lays out random BLAS batches with the scratch arena and
+ *  records them with ParallelRecorder on mock command lists that log every barrier and build and
+ *  spin for a recording cost that grows with the primitive count.  Checks the hand off: every build
+ *  is recorded exactly once, lanes merged in order give back batch order, each lane was recorded
+ *  by a single thread, the merged lanes hold exactly the barriers and builds one command list
+ *  recorded by the calling thread would, and no two builds able to run concurrently share scratch.
+ *  Reports how much faster the workers record than the calling thread alone.  Seeded, so the same
+ *  arguments always give the same batches.
+ *
+ *  parallel_build_sim [--frames n] [--batches n] [--builds n] [--lanes n] [--workers n]
+ *                     [--max-concurrent bytes] [--seed n]
+ */
+
+#include "ParallelRecorder.h"
+#include "ScratchArena.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment = 256;
+
+    struct Options
+    {
+        uint32_t frames        = 40;
+        uint32_t batches       = 2;
+        uint32_t builds        = 1000;
+        uint32_t lanes         = 4;
+        uint32_t workers       = 3;
+        uint64_t maxConcurrent = 32 * 1024 * 1024;
+        uint64_t seed          = 0x853C49E6748FEA9Bull;
+    };
+
+    // Scratch never read back, addresses only need to be distinct
+    class MockScratch : public ScratchArenaBackend
+    {
+    public:
+
+        ScratchBuffer CreateBuffer(uint64_t sizeInBytes) override
+        {
+            ScratchBuffer buffer = {reinterpret_cast<void*>(m_nextAddress), m_nextAddress, sizeInBytes};
+            m_nextAddress       += (sizeInBytes + 0xFFFFF) & ~uint64_t(0xFFFFF);
+            return buffer;
+        }
+
+        void ReleaseBuffer(const ScratchBuffer&) override {}
+
+    private:
+
+        uint64_t m_nextAddress = 0x100000;
+    };
+
+    struct Batch
+    {
+        std::vector<uint64_t> primitives;
+        std::vector<uint64_t> scratchBegin;
+        std::vector<uint64_t> scratchEnd;
+        std::vector<uint8_t>  barrierBefore;
+    };
+
+    // A command list that logs what was recorded on it and by which thread
+    class MockLane : public RecordingLane
+    {
+    public:
+
+        static constexpr uint32_t Barrier = UINT32_MAX;
+
+        MockLane(const Batch* batch)
+            : m_batch(batch)
+        {
+        }
+
+        void RecordBarrier() override
+        {
+            Touch();
+            m_commands.push_back(Barrier);
+        }
+
+        void RecordBuild(uint32_t buildIndex) override
+        {
+            Touch();
+            m_commands.push_back(buildIndex);
+
+            // Filling a build desc and writing it to the command list, longer for big geometry
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::nanoseconds(500 + m_batch->primitives[buildIndex] / 16);
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+            }
+        }
+
+        const std::vector<uint32_t>& GetCommands() const { return m_commands; }
+        bool                         SingleThread() const { return m_singleThread; }
+
+    private:
+
+        void Touch()
+        {
+            if (m_commands.empty())
+            {
+                m_thread = std::this_thread::get_id();
+            }
+            m_singleThread = m_singleThread && m_thread == std::this_thread::get_id();
+        }
+
+        const Batch*          m_batch;
+        std::vector<uint32_t> m_commands;
+        std::thread::id       m_thread;
+        bool                  m_singleThread = true;
+    };
+
+    // Geometry from a few hundred triangles up to a few hundred thousand
+    Batch MakeBatch(Rng& rng, ScratchArena& arena, uint32_t buildCount)
+    {
+        Batch                         batch;
+        std::vector<uint64_t>         sizes(buildCount);
+        std::vector<ScratchPlacement> placements(buildCount);
+        batch.primitives.resize(buildCount);
+        for (uint32_t build = 0; build < buildCount; build++)
+        {
+            batch.primitives[build] = uint64_t(1) << (8 + rng.Next(11));
+            batch.primitives[build] += rng.Next(static_cast<uint32_t>(batch.primitives[build]));
+            sizes[build]            = batch.primitives[build] * 24;
+        }
+        arena.PlaceBatch(sizes.data(), buildCount, placements.data());
+        for (uint32_t build = 0; build < buildCount; build++)
+        {
+            batch.scratchBegin.push_back(placements[build].gpuVA);
+            batch.scratchEnd.push_back(placements[build].gpuVA + sizes[build]);
+            batch.barrierBefore.push_back(placements[build].barrierBefore ? 1 : 0);
+        }
+        return batch;
+    }
+
+    // Records batch on laneCount mock lanes and appends the lanes in execution order to merged
+    bool RecordBatch(ParallelRecorder& recorder, const Batch& batch, uint32_t laneCount, std::vector<uint32_t>& merged, double& seconds)
+    {
+        const uint32_t              buildCount = static_cast<uint32_t>(batch.primitives.size());
+        std::vector<MockLane>       lanes(laneCount, MockLane(&batch));
+        std::vector<RecordingLane*> lanePointers;
+        for (MockLane& lane : lanes)
+        {
+            lanePointers.push_back(&lane);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        recorder.Record(lanePointers.data(), laneCount, batch.primitives.data(), batch.barrierBefore.data(), buildCount);
+        seconds += Seconds(start);
+
+        bool     success   = true;
+        uint32_t nextBuild = 0;
+        for (const MockLane& lane : lanes)
+        {
+            success = success && lane.SingleThread();
+            for (uint32_t command : lane.GetCommands())
+            {
+                if (command != MockLane::Barrier)
+                {
+                    success = success && command == nextBuild;
+                    nextBuild++;
+                }
+                merged.push_back(command);
+            }
+        }
+        return success && nextBuild == buildCount;
+    }
+
+    // What one command list recorded by the calling thread holds, the reference for the lanes
+    void RecordSerially(const Batch& batch, std::vector<uint32_t>& merged, double& seconds)
+    {
+        MockLane lane(&batch);
+        auto     start = std::chrono::steady_clock::now();
+        for (uint32_t build = 0; build < batch.primitives.size(); build++)
+        {
+            if (batch.barrierBefore[build] != 0)
+            {
+                lane.RecordBarrier();
+            }
+            lane.RecordBuild(build);
+        }
+        seconds += Seconds(start);
+        merged.insert(merged.end(), lane.GetCommands().begin(), lane.GetCommands().end());
+    }
+
+    // Walks a frame's merged commands the way the GPU runs them, builds between two barriers may
+    // overlap in time so their scratch must not
+    bool CheckScratch(const std::vector<Batch>& batches, const std::vector<uint32_t>& merged)
+    {
+        struct Region
+        {
+            uint64_t begin;
+            uint64_t end;
+        };
+        std::vector<Region> concurrent;
+        size_t              batch      = 0;
+        uint32_t            buildCount = 0;
+        for (uint32_t command : merged)
+        {
+            if (command == MockLane::Barrier)
+            {
+                concurrent.clear();
+                continue;
+            }
+            // Builds count up from zero again once the next batch of the frame starts
+            if (buildCount == batches[batch].primitives.size())
+            {
+                batch++;
+                buildCount = 0;
+            }
+            buildCount++;
+            const Region region = {batches[batch].scratchBegin[command], batches[batch].scratchEnd[command]};
+            for (const Region& other : concurrent)
+            {
+                if (region.begin < other.end && other.begin < region.end)
+                {
+                    return false;
+                }
+            }
+            concurrent.push_back(region);
+        }
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--frames", options.frames);
+        parser.Add("--batches", options.batches);
+        parser.Add("--builds", options.builds);
+        parser.Add("--lanes", options.lanes);
+        parser.Add("--workers", options.workers);
+        parser.Add("--max-concurrent", options.maxConcurrent, "bytes");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.lanes > 0 && options.builds > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u frames of %u batches of %u builds, %u lanes, %u workers, %llu concurrent scratch bytes\n",
+           options.frames,
+           options.batches,
+           options.builds,
+           options.lanes,
+           options.workers,
+           static_cast<unsigned long long>(options.maxConcurrent));
+
+    Rng              rng = {options.seed};
+    MockScratch      scratch;
+    ScratchArena     arena(&scratch, 3, options.maxConcurrent, Alignment);
+    ParallelRecorder recorder(options.workers);
+    double           serialSeconds   = 0.0;
+    double           parallelSeconds = 0.0;
+    uint64_t         barriers        = 0;
+    bool             success         = true;
+
+    for (uint32_t frame = 0; frame < options.frames && success; frame++)
+    {
+        arena.BeginFrame(frame);
+
+        std::vector<Batch>    batches;
+        std::vector<uint32_t> serialMerged;
+        std::vector<uint32_t> parallelMerged;
+        for (uint32_t batchIndex = 0; batchIndex < options.batches; batchIndex++)
+        {
+            batches.push_back(MakeBatch(rng, arena, 1 + rng.Next(options.builds)));
+            RecordSerially(batches.back(), serialMerged, serialSeconds);
+            if (RecordBatch(recorder, batches.back(), options.lanes, parallelMerged, parallelSeconds) == false)
+            {
+                printf("frame %u: lanes don't merge back into batch order\n", frame);
+                success = false;
+            }
+        }
+
+        if (serialMerged != parallelMerged)
+        {
+            printf("frame %u: merged lanes differ from one command list\n", frame);
+            success = false;
+        }
+        if (CheckScratch(batches, parallelMerged) == false)
+        {
+            printf("frame %u: builds able to run concurrently share scratch\n", frame);
+            success = false;
+        }
+        for (uint32_t command : parallelMerged)
+        {
+            barriers += command == MockLane::Barrier ? 1 : 0;
+        }
+    }
+
+    // The same costs always give the same runs
+    std::vector<uint64_t> costs(options.builds);
+    for (uint64_t& cost : costs)
+    {
+        cost = rng.Next(100000);
+    }
+    std::vector<uint32_t> firstSplit(options.lanes + 1);
+    std::vector<uint32_t> secondSplit(options.lanes + 1);
+    ParallelRecorder::Split(costs.data(), options.builds, options.lanes, firstSplit.data());
+    ParallelRecorder::Split(costs.data(), options.builds, options.lanes, secondSplit.data());
+    for (uint32_t lane = 0; lane < options.lanes; lane++)
+    {
+        success = success && firstSplit[lane] <= firstSplit[lane + 1];
+    }
+    if (firstSplit != secondSplit || firstSplit[0] != 0 || firstSplit[options.lanes] != options.builds)
+    {
+        printf("split is not a deterministic cover of the batch\n");
+        success = false;
+    }
+
+    printf("%llu barriers, recording %.1f ms on the calling thread, %.1f ms with workers, %.2fx\n",
+           static_cast<unsigned long long>(barriers),
+           serialSeconds * 1000.0,
+           parallelSeconds * 1000.0,
+           parallelSeconds > 0.0 ? serialSeconds / parallelSeconds : 0.0);
+    printf("%s\n", success ? "all batches recorded and merged correctly" : "FAILED");
+    return success ? 0 : 1;
+}
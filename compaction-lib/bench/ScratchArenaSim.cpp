@@ -0,0 +1,279 @@
+/**
+ *  Scratch arena simulator.  Records random batches of BLAS builds frame by frame against a mock
+ *  device and checks every placement: it must lie inside a live buffer, builds not separated by a
+ *  barrier must not overlap, frames still in flight must not share bytes with the frame being
+ *  recorded and no buffer may be released while a frame in flight still uses it.  Compares the
+ *  scratch kept resident with what per build scratch held until compaction would need.  Seeded,
+ *  so the same arguments always give the same output.
+ *
+ *  scratch_arena_sim [--frames n] [--latency n] [--max-builds n] [--max-concurrent bytes] [--seed n]
+ */
+
+#include "ScratchArena.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment = 256;
+
+    struct Options
+    {
+        uint32_t frames        = 2000;
+        uint32_t latency       = 3;
+        uint32_t maxBuilds     = 64;
+        uint64_t maxConcurrent = 0;
+        uint64_t seed          = 0x853C49E6748FEA9Bull;
+    };
+
+    struct Region
+    {
+        uint64_t begin;
+        uint64_t end;
+        uint32_t segment;   // Builds between two barriers of a frame share a segment
+    };
+
+    // Hands out address ranges that never repeat so a stale placement can't land in a new buffer
+    class MockDevice : public ScratchArenaBackend
+    {
+    public:
+
+        ScratchBuffer CreateBuffer(uint64_t sizeInBytes) override
+        {
+            ScratchBuffer buffer = {reinterpret_cast<void*>(m_nextAddress), m_nextAddress, sizeInBytes};
+            m_live[buffer.gpuVA] = sizeInBytes;
+            m_liveBytes         += sizeInBytes;
+            m_nextAddress       += (sizeInBytes + 0xFFFFF) & ~uint64_t(0xFFFFF);
+            return buffer;
+        }
+
+        void ReleaseBuffer(const ScratchBuffer& buffer) override
+        {
+            auto live = m_live.find(buffer.gpuVA);
+            if (live == m_live.end() || live->second != buffer.sizeInBytes)
+            {
+                m_failed = true;
+                return;
+            }
+            m_liveBytes -= live->second;
+            m_live.erase(live);
+            m_released.push_back(buffer);
+        }
+
+        // The buffer containing the region or null when none is live
+        bool Contains(const Region& region) const
+        {
+            auto live = m_live.upper_bound(region.begin);
+            if (live == m_live.begin())
+            {
+                return false;
+            }
+            live--;
+            return region.end <= live->first + live->second;
+        }
+
+        std::vector<ScratchBuffer> TakeReleased()
+        {
+            std::vector<ScratchBuffer> released;
+            released.swap(m_released);
+            return released;
+        }
+
+        uint64_t GetLiveBytes() const { return m_liveBytes; }
+        bool     Failed() const { return m_failed; }
+
+    private:
+
+        uint64_t                     m_nextAddress = 0x100000;
+        uint64_t                     m_liveBytes   = 0;
+        bool                         m_failed      = false;
+        std::map<uint64_t, uint64_t> m_live;
+        std::vector<ScratchBuffer>   m_released;
+    };
+
+    // Scratch sizes of BLAS builds, a few kilobytes up to a few megabytes
+    uint64_t ScratchSize(Rng& rng)
+    {
+        uint32_t log2Size = 12 + rng.Next(10);
+        return (1u << log2Size) + rng.Next(1u << log2Size);
+    }
+
+    bool Overlap(const Region& left, const Region& right)
+    {
+        return left.begin < right.end && right.begin < left.end;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--frames", options.frames);
+        parser.Add("--latency", options.latency);
+        parser.Add("--max-builds", options.maxBuilds);
+        parser.Add("--max-concurrent", options.maxConcurrent, "bytes");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.latency > 0 && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u frames, latency %u, up to %u builds per batch, %llu concurrent bytes\n",
+           options.frames,
+           options.latency,
+           options.maxBuilds,
+           static_cast<unsigned long long>(options.maxConcurrent));
+
+    Rng        rng = {options.seed};
+    MockDevice device;
+    bool       success = true;
+
+    // Regions recorded by each frame still in flight, and the per build scratch the old scheme
+    // held from the build until the compaction copy latency frames later had executed
+    std::deque<std::vector<Region>> inFlight;
+    std::deque<uint64_t>            perBuildScratch;
+    uint64_t                        perBuildPeak = 0;
+    uint64_t                        arenaPeak    = 0;
+    uint64_t                        builds       = 0;
+
+    {
+        ScratchArena arena(&device, options.latency, options.maxConcurrent, Alignment);
+
+        for (uint64_t frame = 0; frame < options.frames && success; frame++)
+        {
+            arena.BeginFrame(frame);
+            if (inFlight.size() == options.latency)
+            {
+                inFlight.pop_front();
+            }
+
+            // Nothing a frame in flight reads may have been released
+            for (const ScratchBuffer& released : device.TakeReleased())
+            {
+                for (const std::vector<Region>& regions : inFlight)
+                {
+                    for (const Region& region : regions)
+                    {
+                        if (region.begin < released.gpuVA + released.sizeInBytes && released.gpuVA < region.end)
+                        {
+                            printf("frame %llu: buffer released while a frame in flight uses it\n",
+                                   static_cast<unsigned long long>(frame));
+                            success = false;
+                        }
+                    }
+                }
+            }
+
+            // Bursts of batches with idle stretches so buffers grow and get trimmed
+            const bool          idle    = (frame / 200) % 4 == 3;
+            const uint32_t      batches = idle ? 0 : rng.Next(4);
+            std::vector<Region> regions;
+            uint32_t            segment = 0;
+            uint64_t            scratch = 0;
+            for (uint32_t batch = 0; batch < batches; batch++)
+            {
+                const uint32_t                buildCount = rng.Next(options.maxBuilds + 1);
+                std::vector<uint64_t>         sizes(buildCount);
+                std::vector<ScratchPlacement> placements(buildCount);
+                for (uint64_t& size : sizes)
+                {
+                    size     = ScratchSize(rng);
+                    scratch += (size + (Alignment - 1)) & ~uint64_t(Alignment - 1);
+                }
+                arena.PlaceBatch(sizes.data(), buildCount, placements.data());
+                builds += buildCount;
+
+                for (uint32_t build = 0; build < buildCount; build++)
+                {
+                    if (placements[build].barrierBefore)
+                    {
+                        segment++;
+                    }
+                    Region region = {placements[build].gpuVA, placements[build].gpuVA + sizes[build], segment};
+                    if (placements[build].gpuVA % Alignment != 0 || device.Contains(region) == false)
+                    {
+                        printf("frame %llu: placement outside of a live buffer\n", static_cast<unsigned long long>(frame));
+                        success = false;
+                    }
+                    for (const Region& other : regions)
+                    {
+                        if (other.segment == region.segment && Overlap(other, region))
+                        {
+                            printf("frame %llu: concurrent builds share scratch\n", static_cast<unsigned long long>(frame));
+                            success = false;
+                        }
+                    }
+                    for (const std::vector<Region>& previous : inFlight)
+                    {
+                        for (const Region& other : previous)
+                        {
+                            if (Overlap(other, region))
+                            {
+                                printf("frame %llu: scratch of a frame in flight reused\n", static_cast<unsigned long long>(frame));
+                                success = false;
+                            }
+                        }
+                    }
+                    regions.push_back(region);
+                }
+            }
+            inFlight.push_back(std::move(regions));
+
+            perBuildScratch.push_back(scratch);
+            if (perBuildScratch.size() > 2 * options.latency)
+            {
+                perBuildScratch.pop_front();
+            }
+            uint64_t held = 0;
+            for (uint64_t bytes : perBuildScratch)
+            {
+                held += bytes;
+            }
+            perBuildPeak = std::max(perBuildPeak, held);
+            arenaPeak    = std::max(arenaPeak, arena.GetStats().residentBytes);
+
+            if (arena.GetStats().residentBytes != device.GetLiveBytes() || device.Failed())
+            {
+                printf("frame %llu: arena and device disagree on resident scratch\n", static_cast<unsigned long long>(frame));
+                success = false;
+            }
+            if (frame % 200 == 199)
+            {
+                const ScratchArenaStats& stats = arena.GetStats();
+                printf("frame %5llu  resident %8.1f MB  frame peak %7.1f MB  max frame peak %7.1f MB  barriers %7llu  buffers %5llu\n",
+                       static_cast<unsigned long long>(frame),
+                       stats.residentBytes / (1024.0 * 1024.0),
+                       stats.framePeakBytes / (1024.0 * 1024.0),
+                       stats.maxFramePeakBytes / (1024.0 * 1024.0),
+                       static_cast<unsigned long long>(stats.barriers),
+                       static_cast<unsigned long long>(stats.buffersCreated));
+            }
+        }
+    }
+
+    if (device.GetLiveBytes() != 0)
+    {
+        printf("arena left %llu bytes alive\n", static_cast<unsigned long long>(device.GetLiveBytes()));
+        success = false;
+    }
+
+    printf("%llu builds, peak resident scratch %.1f MB with the arena, %.1f MB held per build until compaction\n",
+           static_cast<unsigned long long>(builds),
+           arenaPeak / (1024.0 * 1024.0),
+           perBuildPeak / (1024.0 * 1024.0));
+    printf("%s\n", success ? "all placements valid" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,517 @@
+/**
+ *  Suballocator churn benchmark.  Replays a BLAS style workload of random builds and releases
+ *  against a fake heap of fixed size blocks, through the best fit free list that
+ *  BufferSuballocator used before TLSFAllocator, through TLSFAllocator blocks asked in turn and
+ *  through TLSFAllocator blocks found by a TLSFBlockIndex, and reports throughput, resident blocks
+ *  and how splintered the free space ends up.  Small block sizes give many blocks, where only the
+ *  indexed pool keeps its throughput.  Needs no device, every block is only a size.  Before the
+ *  timing it checks the SuballocationHandleTable BufferSuballocator resolves handles through: stale
+ *  handles and double frees are refused, and the block limit fails instead of wrapping.
+ *
+ *  suballocator_bench [--ops n] [--live n] [--block-size bytes] [--seed n] [--validate]
+ */
+
+#include "SuballocationHandles.h"
+#include "TLSFAllocator.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t Alignment      = 256;
+    constexpr uint32_t InvalidBlockId = UINT32_MAX;
+
+    struct Options
+    {
+        uint32_t ops       = 1000000;
+        uint32_t live      = 2000;
+        uint32_t blockSize = 4 * 1024 * 1024;
+        uint64_t seed      = 0x853C49E6748FEA9Bull;
+        bool     validate  = false;
+    };
+
+    struct Handle
+    {
+        uint32_t blockId;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t node;
+    };
+
+    struct Stats
+    {
+        double   seconds;
+        uint32_t peakBlocks;
+        uint32_t blocks;
+        uint64_t residentBytes;
+        uint64_t usedBytes;
+        uint64_t freeBytes;
+        uint64_t largestFreeBytes;
+        uint32_t freeRanges;
+        bool     valid;
+    };
+
+    uint32_t AlignUp(uint32_t value, uint32_t alignment)
+    {
+        return (value + (alignment - 1)) & ~(alignment - 1);
+    }
+
+    // Bottom level acceleration structures span a few hundred bytes for a quad up to megabytes for
+    // a dense mesh, sample log uniformly over that range
+    uint32_t BlasSize(Rng& rng)
+    {
+        uint32_t log2Size = 8 + rng.Next(13);
+        uint32_t size     = (1u << log2Size) + rng.Next(1u << log2Size);
+        return AlignUp(size, Alignment);
+    }
+
+    // The policy BufferSuballocator used before TLSF: exact fit, else least waste, else bump the
+    // block's offset, and freed chunks are pushed back whole without merging with neighbours
+    class LegacyHeap
+    {
+    public:
+
+        explicit LegacyHeap(uint32_t blockSize) : m_blockSize(blockSize), m_nextId(0), m_peakBlocks(0) {}
+
+        Handle Allocate(uint32_t size)
+        {
+            if (m_blocks.empty())
+            {
+                m_blocks.push_back(CreateBlock(std::max(size, m_blockSize)));
+            }
+
+            for (size_t blockIndex = 0; blockIndex < m_blocks.size(); blockIndex++)
+            {
+                Block& block     = m_blocks[blockIndex];
+                size_t bestChunk = block.freeList.size();
+                uint32_t bestWaste = UINT32_MAX;
+                for (size_t chunk = 0; chunk < block.freeList.size(); chunk++)
+                {
+                    if (size <= block.freeList[chunk].size && block.freeList[chunk].size - size < bestWaste)
+                    {
+                        bestChunk = chunk;
+                        bestWaste = block.freeList[chunk].size - size;
+                        if (bestWaste == 0)
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                if (bestChunk != block.freeList.size())
+                {
+                    Chunk chunk = block.freeList[bestChunk];
+                    block.freeList.erase(block.freeList.begin() + bestChunk);
+                    block.allocations++;
+                    return Handle{block.id, chunk.offset, chunk.size, 0};
+                }
+
+                if (block.currentOffset + size <= block.size)
+                {
+                    Handle handle = {block.id, block.currentOffset, size, 0};
+                    block.currentOffset += size;
+                    block.allocations++;
+                    return handle;
+                }
+
+                if (blockIndex == m_blocks.size() - 1)
+                {
+                    m_blocks.push_back(CreateBlock(std::max(size, m_blockSize)));
+                    m_peakBlocks = std::max(m_peakBlocks, static_cast<uint32_t>(m_blocks.size()));
+                }
+            }
+            return Handle{InvalidBlockId, 0, 0, 0};
+        }
+
+        void Free(const Handle& handle)
+        {
+            for (size_t blockIndex = 0; blockIndex < m_blocks.size(); blockIndex++)
+            {
+                Block& block = m_blocks[blockIndex];
+                if (block.id != handle.blockId)
+                {
+                    continue;
+                }
+
+                if (handle.size == block.size)
+                {
+                    m_blocks.erase(m_blocks.begin() + blockIndex);
+                    return;
+                }
+
+                block.freeList.push_back(Chunk{handle.offset, handle.size});
+                block.allocations--;
+                if (block.allocations == 0 && m_blocks.size() > 1)
+                {
+                    m_blocks.erase(m_blocks.begin() + blockIndex);
+                }
+                return;
+            }
+        }
+
+        Stats Collect() const
+        {
+            Stats stats      = {};
+            stats.peakBlocks = m_peakBlocks;
+            stats.blocks     = static_cast<uint32_t>(m_blocks.size());
+            stats.valid      = true;
+            for (const Block& block : m_blocks)
+            {
+                stats.residentBytes += block.size;
+                uint64_t freeBytes   = block.size - block.currentOffset;
+                stats.largestFreeBytes = std::max<uint64_t>(stats.largestFreeBytes, freeBytes);
+                stats.freeRanges      += freeBytes > 0 ? 1 : 0;
+                for (const Chunk& chunk : block.freeList)
+                {
+                    freeBytes              += chunk.size;
+                    stats.largestFreeBytes  = std::max<uint64_t>(stats.largestFreeBytes, chunk.size);
+                    stats.freeRanges++;
+                }
+                stats.freeBytes += freeBytes;
+            }
+            stats.usedBytes = stats.residentBytes - stats.freeBytes;
+            return stats;
+        }
+
+    private:
+
+        struct Chunk
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        struct Block
+        {
+            uint32_t           id;
+            uint32_t           size;
+            uint32_t           currentOffset;
+            uint32_t           allocations;
+            std::vector<Chunk> freeList;
+        };
+
+        Block CreateBlock(uint32_t size) { return Block{m_nextId++, size, 0, 0, {}}; }
+
+        uint32_t           m_blockSize;
+        uint32_t           m_nextId;
+        uint32_t           m_peakBlocks;
+        std::vector<Block> m_blocks;
+    };
+
+    // Same block management as BufferSuballocator on top of TLSFAllocator, handles carry the block
+    // slot.  Unindexed it asks every block in turn the way BufferSuballocator did before it kept a
+    // TLSFBlockIndex.
+    class TLSFHeap
+    {
+    public:
+
+        TLSFHeap(uint32_t blockSize, bool indexed)
+            : m_blockSize(blockSize), m_indexed(indexed), m_liveBlocks(0), m_peakBlocks(0), m_indexMisses(0)
+        {
+        }
+
+        Handle Allocate(uint32_t size)
+        {
+            TLSFAllocator::Allocation allocation = {0, 0, TLSFAllocator::InvalidNode};
+            uint32_t                  slot       = TLSFBlockIndex::InvalidBlock;
+            if (m_indexed)
+            {
+                uint32_t fitBin, exactBin;
+                TLSFAllocator::GetRequestBins(size, Alignment, Alignment, fitBin, exactBin);
+                slot = m_index.FindBlock(fitBin);
+                if (slot != TLSFBlockIndex::InvalidBlock)
+                {
+                    allocation     = m_blocks[slot].allocator.Allocate(size, Alignment);
+                    m_indexMisses += allocation.node == TLSFAllocator::InvalidNode ? 1 : 0;
+                }
+                else
+                {
+                    for (slot = m_index.GetFirstInBin(exactBin); slot != TLSFBlockIndex::InvalidBlock;
+                         slot = m_index.GetNextInBin(slot))
+                    {
+                        allocation = m_blocks[slot].allocator.Allocate(size, Alignment);
+                        if (allocation.node != TLSFAllocator::InvalidNode)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for (slot = 0; slot < m_blocks.size(); slot++)
+                {
+                    allocation = m_blocks[slot].allocator.Allocate(size, Alignment);
+                    if (allocation.node != TLSFAllocator::InvalidNode)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if (allocation.node == TLSFAllocator::InvalidNode)
+            {
+                slot       = CreateBlock(std::max(size, m_blockSize));
+                allocation = m_blocks[slot].allocator.Allocate(size, Alignment);
+            }
+            if (m_indexed)
+            {
+                m_index.Update(slot, m_blocks[slot].allocator);
+            }
+            return Handle{slot, allocation.offset, allocation.size, allocation.node};
+        }
+
+        void Free(const Handle& handle)
+        {
+            TLSFAllocator& allocator = m_blocks[handle.blockId].allocator;
+            allocator.Free(handle.node);
+            if (allocator.GetAllocationCount() == 0 &&
+                (m_liveBlocks > 1 || allocator.GetCapacity() > m_blockSize))
+            {
+                // An empty allocator left in a released slot can never take an allocation
+                allocator = TLSFAllocator();
+                m_unusedSlots.push_back(handle.blockId);
+                m_liveBlocks--;
+                if (m_indexed)
+                {
+                    m_index.Remove(handle.blockId);
+                }
+            }
+            else if (m_indexed)
+            {
+                m_index.Update(handle.blockId, allocator);
+            }
+        }
+
+        Stats Collect(bool validate) const
+        {
+            Stats stats      = {};
+            stats.peakBlocks = m_peakBlocks;
+            stats.blocks     = m_liveBlocks;
+            stats.valid      = m_indexMisses == 0;
+            for (const Block& block : m_blocks)
+            {
+                stats.residentBytes    += block.allocator.GetCapacity();
+                stats.freeBytes        += block.allocator.GetFreeSize();
+                stats.freeRanges       += block.allocator.GetFreeRangeCount();
+                stats.largestFreeBytes  = std::max<uint64_t>(stats.largestFreeBytes,
+                                                             block.allocator.GetLargestFreeRange());
+                if (validate && block.allocator.Validate() == false)
+                {
+                    stats.valid = false;
+                }
+            }
+            stats.usedBytes = stats.residentBytes - stats.freeBytes;
+            return stats;
+        }
+
+    private:
+
+        struct Block
+        {
+            TLSFAllocator allocator;
+        };
+
+        uint32_t CreateBlock(uint32_t size)
+        {
+            uint32_t slot = static_cast<uint32_t>(m_blocks.size());
+            if (m_unusedSlots.empty() == false)
+            {
+                slot = m_unusedSlots.back();
+                m_unusedSlots.pop_back();
+                m_blocks[slot].allocator = TLSFAllocator(size, Alignment);
+            }
+            else
+            {
+                m_blocks.push_back(Block{TLSFAllocator(size, Alignment)});
+            }
+            m_liveBlocks++;
+            m_peakBlocks = std::max(m_peakBlocks, m_liveBlocks);
+            return slot;
+        }
+
+        uint32_t              m_blockSize;
+        bool                  m_indexed;
+        uint32_t              m_liveBlocks;
+        uint32_t              m_peakBlocks;
+        uint32_t              m_indexMisses; // Blocks the index picked that then failed the allocation
+        std::vector<Block>    m_blocks;
+        std::vector<uint32_t> m_unusedSlots;
+        TLSFBlockIndex        m_index;
+    };
+
+    // Grows the live set to the target, then alternates builds and releases of random entries the
+    // way RandomInsertAndRemoveEntities churns the scene
+    template <typename Heap, typename Collect>
+    Stats Run(Heap& heap, const Options& options, Collect collect)
+    {
+        Rng                 rng = {options.seed};
+        std::vector<Handle> live;
+        live.reserve(options.live);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t op = 0; op < options.ops; op++)
+        {
+            bool grow = live.size() < options.live / 2 ||
+                        (live.size() < options.live && (rng.Next() & 1) != 0);
+            if (grow || live.empty())
+            {
+                live.push_back(heap.Allocate(BlasSize(rng)));
+            }
+            else
+            {
+                uint32_t index = rng.Next(static_cast<uint32_t>(live.size()));
+                heap.Free(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            if (options.validate && (op & 0xFFFF) == 0 && collect(heap).valid == false)
+            {
+                printf("validation failed after %u operations\n", op);
+                break;
+            }
+        }
+        double seconds = Seconds(start);
+
+        Stats stats   = collect(heap);
+        stats.seconds = seconds;
+        return stats;
+    }
+
+    void Print(const char* name, const Stats& stats, const Options& options)
+    {
+        double fragmentation = stats.freeBytes > 0
+                                   ? 1.0 - double(stats.largestFreeBytes) / double(stats.freeBytes)
+                                   : 0.0;
+        printf("%-9s %12.0f ops/s  blocks %5u (peak %5u)  resident %8.1f MB  used %8.1f MB  "
+               "free ranges %7u  fragmentation %5.3f%s\n",
+               name,
+               options.ops / stats.seconds,
+               stats.blocks,
+               stats.peakBlocks,
+               stats.residentBytes / (1024.0 * 1024.0),
+               stats.usedBytes / (1024.0 * 1024.0),
+               stats.freeRanges,
+               fragmentation,
+               options.validate ? (stats.valid ? "  valid" : "  INVALID") : "");
+    }
+
+    bool Expect(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            printf("handle check FAILED: %s\n", what);
+        }
+        return condition;
+    }
+
+    bool CheckHandles()
+    {
+        bool valid = true;
+
+        SuballocationHandle widest = SuballocationHandle::Pack(0xFFFF, 0xFFFFFF, 0xFFFF);
+        valid &= Expect(widest.GetBlockIndex() == 0xFFFF && widest.GetNode() == 0xFFFFFF &&
+                            widest.GetGeneration() == 0xFFFF,
+                        "pack and unpack round trip");
+
+        SuballocationHandleTable table;
+        valid &= Expect(table.IsLive(SuballocationHandle{0}) == false &&
+                            table.Retire(SuballocationHandle{0}) == false,
+                        "null handle refused");
+
+        uint32_t            block = table.AddBlock();
+        SuballocationHandle first = table.Issue(block, 7);
+        valid &= Expect(first.IsNull() == false && table.IsLive(first), "issued handle live");
+        valid &= Expect(table.Retire(first) && table.IsLive(first) == false, "retired handle stale");
+        valid &= Expect(table.Retire(first) == false, "double free refused");
+
+        // The node taken again must not revive the copy of the old handle
+        SuballocationHandle second = table.Issue(block, 7);
+        valid &= Expect(table.IsLive(second) && table.IsLive(first) == false &&
+                            table.Retire(first) == false && table.IsLive(second),
+                        "stale handle to a reused node refused");
+
+        table.RemoveBlock(block);
+        valid &= Expect(table.IsLive(second) == false && table.Retire(second) == false,
+                        "handles into a released block stale");
+        valid &= Expect(table.AddBlock() == block, "released slot reused");
+
+        // Past the wrap of the 16 bit counter a handle still never reads as null
+        for (uint32_t i = 0; i < 0x20000; i++)
+        {
+            SuballocationHandle handle = table.Issue(block, i & 0xFF);
+            if (handle.IsNull() || handle.GetGeneration() == 0)
+            {
+                valid &= Expect(false, "generation wrap skips zero");
+                break;
+            }
+        }
+
+        SuballocationHandleTable full;
+        uint32_t                 added = 0;
+        while (full.AddBlock() != SuballocationHandleTable::InvalidBlock)
+        {
+            added++;
+        }
+        valid &= Expect(added == SuballocationHandleTable::MaxBlockCount &&
+                            full.AddBlock() == SuballocationHandleTable::InvalidBlock,
+                        "block limit fails the allocation");
+        full.RemoveBlock(0x1234);
+        valid &= Expect(full.AddBlock() == 0x1234, "slot below the limit freed again");
+
+        return valid;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--ops", options.ops);
+        parser.Add("--live", options.live);
+        parser.Add("--block-size", options.blockSize, "bytes");
+        parser.Add("--seed", options.seed);
+        parser.Add("--validate", options.validate);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.live > 0 && options.blockSize >= Alignment && options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    if (CheckHandles() == false)
+    {
+        return 1;
+    }
+
+    printf("%u operations, %u live allocations, %u byte blocks\n",
+           options.ops,
+           options.live,
+           options.blockSize);
+
+    LegacyHeap legacy(options.blockSize);
+    Stats      legacyStats = Run(legacy, options, [](const LegacyHeap& heap) { return heap.Collect(); });
+    Print("best-fit", legacyStats, options);
+
+    TLSFHeap scan(options.blockSize, false);
+    Stats    scanStats = Run(scan, options, [&](const TLSFHeap& heap) { return heap.Collect(options.validate); });
+    Print("tlsf-scan", scanStats, options);
+
+    TLSFHeap tlsf(options.blockSize, true);
+    Stats    tlsfStats = Run(tlsf, options, [&](const TLSFHeap& heap) { return heap.Collect(options.validate); });
+    Print("tlsf", tlsfStats, options);
+
+    return scanStats.valid && tlsfStats.valid ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/**
+ *  Top level refit simulator.  Moves a share of the instances of a scene every frame, now and then
+ *  removes, spawns or swaps the bottom level of a few of them, and hands each frame to
+ *  TLASUpdatePolicy the way ResourceManager does: the instance count, whether any instance got
+ *  another bottom level and the bounds of the instance origins.  Runs the scene once rebuilding
+ *  every frame, once with the configured policy and once without a limit on refits in a row, and
+ *  reports how the builds split into rebuilds and refits, why each rebuild happened and the share
+ *  of the rebuild cost the refits saved.  Every decision is checked against the rules the policy
+ *  documents.  Seeded, so the same arguments always give the same output.
+ *
+ *  tlas_update_sim [--instances n] [--frames n] [--animated-percent n] [--speed units]
+ *                  [--churn-interval n] [--churn n] [--max-updates n] [--bounds-growth f]
+ *                  [--update-cost f] [--seed n]
+ */
+
+#include "TLASUpdatePolicy.h"
+#include "BenchUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr float Extent = 1000.0f;
+
+    struct Options
+    {
+        uint32_t instances       = 10000;
+        uint32_t frames          = 1200;
+        uint32_t animatedPercent = 10;
+        float    speed           = 0.5f;
+        uint32_t churnInterval   = 90;
+        uint32_t churn           = 16;
+        uint32_t maxUpdates      = 30;
+        float    boundsGrowth    = 1.5f;
+        float    updateCost      = 0.3f;
+        uint64_t seed            = 0x853C49E6748FEA9Bull;
+    };
+
+    struct Instance
+    {
+        float position[3];
+        float velocity[3];
+    };
+
+    Instance MakeInstance(Rng& rng, const Options& options)
+    {
+        Instance instance;
+        bool     animated = rng.Next(100) < options.animatedPercent;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            instance.position[axis] = (rng.NextSigned() + 1.0f) * 0.5f * Extent;
+            instance.velocity[axis] = animated ? rng.NextSigned() * options.speed : 0.0f;
+        }
+        return instance;
+    }
+
+    struct Result
+    {
+        TLASUpdateStats stats;
+        double          decideSeconds;
+    };
+
+    bool Run(const Options& options, const TLASUpdateSettings& settings, Result& result)
+    {
+        Rng                   rng = {options.seed};
+        std::vector<Instance> instances;
+        for (uint32_t index = 0; index < options.instances; index++)
+        {
+            instances.push_back(MakeInstance(rng, options));
+        }
+
+        TLASUpdatePolicy policy(settings);
+        bool             success       = true;
+        uint32_t         lastCount     = 0;
+        uint32_t         updatesInARow = 0;
+        float            rebuildArea   = 0.0f;
+        result.decideSeconds           = 0.0;
+
+        for (uint32_t frame = 0; frame < options.frames && success; frame++)
+        {
+            // Churn cycles through removing instances, spawning them and pointing some at another
+            // bottom level, which changes the topology without changing the count
+            TLASFrameInputs inputs = {};
+            inputs.sourceAvailable = frame > 0;
+            if (options.churnInterval > 0 && frame > 0 && frame % options.churnInterval == 0)
+            {
+                uint32_t phase = (frame / options.churnInterval) % 3;
+                for (uint32_t index = 0; index < options.churn; index++)
+                {
+                    if (phase == 1)
+                    {
+                        instances.push_back(MakeInstance(rng, options));
+                    }
+                    else if (phase == 0 && instances.empty() == false)
+                    {
+                        uint32_t removed   = rng.Next(static_cast<uint32_t>(instances.size()));
+                        instances[removed] = instances.back();
+                        instances.pop_back();
+                    }
+                }
+                inputs.topologyChanged = options.churn > 0;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            inputs.instanceCount = static_cast<uint32_t>(instances.size());
+            inputs.bounds.Reset();
+            for (Instance& instance : instances)
+            {
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    instance.position[axis] += instance.velocity[axis];
+                }
+                inputs.bounds.Grow(instance.position[0], instance.position[1], instance.position[2]);
+            }
+            TLASBuildDecision decision = policy.Decide(inputs);
+            result.decideSeconds += Seconds(start);
+
+            // The build the documented rules call for
+            const float area     = inputs.bounds.SurfaceArea();
+            bool        canRefit = inputs.sourceAvailable && inputs.topologyChanged == false &&
+                                   inputs.instanceCount == lastCount && updatesInARow < settings.maxUpdates &&
+                                   area <= rebuildArea * settings.maxBoundsGrowth;
+            TLASBuildMode expected = canRefit ? TLASBuildMode::Update : TLASBuildMode::Rebuild;
+            if (decision.mode != expected || (decision.reason == TLASRebuildReason::None) != canRefit)
+            {
+                printf("frame %u: %s where the rules call for a %s\n",
+                       frame,
+                       decision.mode == TLASBuildMode::Update ? "refit" : "rebuild",
+                       canRefit ? "refit" : "rebuild");
+                success = false;
+            }
+
+            lastCount     = inputs.instanceCount;
+            updatesInARow = canRefit ? updatesInARow + 1 : 0;
+            rebuildArea   = canRefit ? rebuildArea : area;
+            success       = success && policy.GetUpdatesSinceRebuild() == updatesInARow;
+        }
+
+        result.stats = policy.GetStats();
+        success      = success && result.stats.rebuilds + result.stats.updates == options.frames;
+        return success;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        OptionParser parser;
+        parser.Add("--instances", options.instances);
+        parser.Add("--frames", options.frames);
+        parser.Add("--animated-percent", options.animatedPercent);
+        parser.Add("--speed", options.speed, "units");
+        parser.Add("--churn-interval", options.churnInterval);
+        parser.Add("--churn", options.churn);
+        parser.Add("--max-updates", options.maxUpdates);
+        parser.Add("--bounds-growth", options.boundsGrowth, "f");
+        parser.Add("--update-cost", options.updateCost, "f");
+        parser.Add("--seed", options.seed);
+        if (parser.Parse(argc, argv) == false)
+        {
+            return false;
+        }
+        return options.instances > 0 && options.frames > 0 && options.animatedPercent <= 100 &&
+               options.boundsGrowth >= 1.0f && options.updateCost >= 0.0f && options.updateCost <= 1.0f &&
+               options.seed != 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (ParseOptions(argc, argv, options) == false)
+    {
+        return 1;
+    }
+
+    printf("%u instances over %u frames, %u%% moving at up to %.2f units per frame, %u removed, spawned or "
+           "swapped every %u frames\n",
+           options.instances,
+           options.frames,
+           options.animatedPercent,
+           options.speed,
+           options.churn,
+           options.churnInterval);
+    printf("%-16s %9s %9s %15s %9s %9s %9s %11s %12s\n", "policy", "rebuilds", "refits", "rebuild:refit",
+           "topology", "limit", "bounds", "cost saved", "ns/instance");
+
+    const char*        names[]  = {"rebuild always", "policy", "no refit limit"};
+    TLASUpdateSettings settings = {};
+    settings.maxBoundsGrowth    = options.boundsGrowth;
+    settings.updateCost         = options.updateCost;
+    const uint32_t     limits[] = {0, options.maxUpdates, UINT32_MAX};
+    bool               success  = true;
+    for (uint32_t index = 0; index < 3; index++)
+    {
+        Result result;
+        settings.maxUpdates = limits[index];
+        success             = Run(options, settings, result) && success;
+
+        const TLASUpdateStats& stats = result.stats;
+        printf("%-16s %9llu %9llu %15.3f %9llu %9llu %9llu %10.2f%% %12.2f\n",
+               names[index],
+               static_cast<unsigned long long>(stats.rebuilds),
+               static_cast<unsigned long long>(stats.updates),
+               TLASUpdatePolicy::RebuildToUpdateRatio(stats),
+               static_cast<unsigned long long>(stats.topologyRebuilds),
+               static_cast<unsigned long long>(stats.updateLimitRebuilds),
+               static_cast<unsigned long long>(stats.boundsRebuilds),
+               100.0 * TLASUpdatePolicy::SavedFraction(stats),
+               stats.rebuildOnlyCost > 0.0 ? 1e9 * result.decideSeconds / stats.rebuildOnlyCost : 0.0);
+    }
+
+    printf("%s\n", success ? "all decisions follow the rules" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "TLSFAllocator.h"
+#include <cstdint>
+#include <vector>
+
+// Incremental defragmentation of an acceleration structure pool.  The planner only looks at the
+// offset allocators of the pool's blocks and the live acceleration structures inside them, so it
+// runs without a device.  Each plan evacuates the emptiest blocks into the fullest ones, moving at
+// most the per frame byte budget, and the caller replays the moves in order on the real pool: the
+// allocators are deterministic so every destination range it gets matches the planned one.
+
+// Copies recorded for a plan, RTCompaction implements it on a D3D12 command list
+class ASCopyCommands
+{
+public:
+
+    virtual ~ASCopyCommands() = default;
+
+    // Clone mode copy, the destination must be at least as large as the source
+    virtual void CloneAccelerationStructure(uint64_t destinationGpuVA, uint64_t sourceGpuVA) = 0;
+};
+
+// One live acceleration structure, id is the caller's and comes back in the move
+struct DefragItem
+{
+    uint32_t id;
+    uint32_t block;
+    uint32_t node;
+};
+
+struct DefragMove
+{
+    uint32_t id;
+    uint32_t sourceBlock;
+    uint32_t destinationBlock;
+    uint32_t sizeInBytes;
+};
+
+struct DefragStats
+{
+    uint32_t blockCount;
+    uint64_t residentBytes;
+    uint64_t usedBytes;
+    uint64_t largestFreeRange;
+    // 1 - largest free range / free bytes, 0 when all free space is one range
+    float    fragmentation;
+};
+
+struct DefragPlan
+{
+    std::vector<DefragMove> moves;
+    std::vector<uint32_t>   evacuatedBlocks; // Blocks left empty once every move has landed
+    uint64_t                bytesMoved;
+    DefragStats             before;
+    DefragStats             after;           // Predicted for when the moved sources are freed
+};
+
+class ASDefragmenter
+{
+public:
+
+    // Blocks filled to less than occupancyThreshold of their capacity are evacuated
+    ASDefragmenter(uint32_t bytesPerFrameBudget,
+                   float    occupancyThreshold = 0.5f,
+                   uint32_t alignmentInBytes   = 256);
+
+    // blocks is indexed by block slot with null for released slots, items are every live
+    // acceleration structure the plan may move
+    DefragPlan         Plan(const std::vector<const TLSFAllocator*>& blocks,
+                            const std::vector<DefragItem>&           items) const;
+
+    static DefragStats Measure(const std::vector<const TLSFAllocator*>& blocks);
+
+    uint32_t           GetBytesPerFrameBudget() const;
+
+private:
+
+    uint32_t m_bytesPerFrameBudget;
+    float    m_occupancyThreshold;
+    uint32_t m_alignment;
+};
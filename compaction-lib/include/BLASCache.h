@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Persistent cache of serialized bottom level acceleration structures.  Builds are keyed by a hash
+// of everything that changes the built structure: vertex positions, indices, formats, geometry and
+// build flags.  The whole cache belongs to one device key, derived by the caller from the adapter and
+// driver version, and is thrown away as soon as it is opened with a different one.  Files are only
+// read and written here, the serialized blobs themselves come from and go to the device through
+// RTCompaction, so everything in this file runs without a device.
+//
+// Layout on disk, all little endian:
+//   index.bin        IndexHeader followed by entryCount IndexEntry records
+//   <key in hex>.as  EntryHeader followed by the serialized acceleration structure
+
+// One geometry desc as the CPU sees it.  Positions are read vertexStride bytes apart and the first
+// positionSize bytes of each are hashed.  Indices are read as indexSize byte integers, a null index
+// pointer hashes a non indexed desc.  The formats and flags are hashed as values so a change in how
+// the same data is handed to the builder changes the key.
+struct BLASGeometry
+{
+    const void* vertices;
+    uint32_t    vertexCount;
+    uint32_t    vertexStride;
+    uint32_t    positionSize;
+    uint32_t    vertexFormat;  // DXGI_FORMAT of the positions given to the builder
+    const void* indices;
+    uint32_t    indexCount;
+    uint32_t    indexSize;
+    uint32_t    indexFormat;   // DXGI_FORMAT of the indices given to the builder
+    uint32_t    flags;         // D3D12_RAYTRACING_GEOMETRY_FLAGS
+};
+
+// Tells whether a serialized blob can be handed back to the current driver, the D3D12 backend
+// checks the driver matching identifier in the blob's header
+class BLASSerializationBackend
+{
+public:
+
+    virtual ~BLASSerializationBackend() = default;
+
+    virtual bool IsCompatible(const uint8_t* payload, size_t sizeInBytes) const = 0;
+};
+
+struct BLASCacheStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t entriesDropped;   // Corrupt or missing entry files
+    uint64_t invalidations;    // Whole cache thrown away on a device, driver or format change
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+};
+
+class BLASCache
+{
+public:
+
+    // Bumped whenever the hashing or the file layout changes, older caches are then discarded
+    static constexpr uint32_t FormatVersion = 1;
+
+    // Opens or creates the cache in directory.  An index written with another format version or
+    // device key, or one that can't be read, discards every cached entry.
+    BLASCache(const std::string&              directory,
+              uint64_t                        deviceKey,
+              const BLASSerializationBackend* backend);
+
+    // Key of one build, zero is never returned so callers can use it for uncached builds
+    static uint64_t HashGeometry(const BLASGeometry* geometry,
+                                 uint32_t            geometryCount,
+                                 uint32_t            buildFlags);
+
+    // Hash of arbitrary bytes with a seed, used for device keys and payload checksums
+    static uint64_t HashBytes(const void* data, size_t sizeInBytes, uint64_t seed = 0);
+
+    bool            Contains(uint64_t key) const;
+
+    // Reads the entry into payload.  A corrupt entry is dropped and reported as a miss, a payload
+    // the backend rejects means the driver changed under the same device key so the whole cache
+    // is invalidated.
+    bool            Load(uint64_t key, std::vector<uint8_t>& payload);
+
+    // Writes the entry file, the index is only rewritten by Flush
+    bool            Store(uint64_t key, const uint8_t* payload, size_t sizeInBytes);
+
+    // Rewrites the index if entries were stored or dropped since the last flush
+    bool            Flush();
+
+    // Removes every entry file and empties the index
+    void            Invalidate();
+
+    size_t          GetEntryCount() const;
+    uint64_t        GetDeviceKey() const;
+    const BLASCacheStats& GetStats() const;
+
+private:
+
+    struct Entry
+    {
+        uint64_t payloadSize;
+        uint64_t payloadHash;
+    };
+
+    std::string EntryPath(uint64_t key) const;
+    std::string IndexPath() const;
+    bool        ReadIndex();
+    void        DropEntry(uint64_t key);
+
+    std::string                         m_directory;
+    uint64_t                            m_deviceKey;
+    const BLASSerializationBackend*     m_backend;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    bool                                m_indexDirty;
+    BLASCacheStats                      m_stats;
+};
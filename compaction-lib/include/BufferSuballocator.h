@@ -1,61 +1,91 @@
+#include "MemoryTelemetry.h"
+#include "SuballocationHandles.h"
+#include "TLSFAllocator.h"
 #include <vector>
 #include <d3d12.h>
 
-struct FreeMemChunk
-{
-    uint32_t offset;
-    uint32_t size;
-};
-
+// Committed buffer plus the offset allocator that hands out ranges of it.  Released blocks keep
+// their slot with a null buffer so handles into the other blocks stay valid.
 struct SuballocatorBlock
 {
     ID3D12Resource*           suballocatingBuffer;
-    std::vector<FreeMemChunk> freeList;
-    uint32_t                  currentOffset;
+    TLSFAllocator             allocator;
     uint32_t                  memoryBlockSize;
-    uint32_t                  totalAllocations;
 };
 
+// What callers hold on to, the address is resolved once at allocation since blocks never move
 struct Suballocation
 {
-    ID3D12Resource*    parentResource;
-    uint32_t           parentResourceOffset;
-    uint32_t           alignedBufferSizeInBytes;
+    SuballocationHandle       handle;
+    D3D12_GPU_VIRTUAL_ADDRESS gpuVA;
 
     D3D12_GPU_VIRTUAL_ADDRESS GetGPUVA()
     {
-        return parentResource->GetGPUVirtualAddress() +
-               static_cast<D3D12_GPU_VIRTUAL_ADDRESS>(parentResourceOffset);
+        return gpuVA;
     }
 };
 
+static_assert(sizeof(Suballocation) == 16, "Suballocation is expected to pack into 16 bytes");
+
 class BufferSuballocator
 {
 public:
 
+    // Every block is carved up in multiples of minimumAlignmentInBytes
     BufferSuballocator(ID3D12Device*         device,
                        uint32_t              bufferSizeInBytes,
                        D3D12_RESOURCE_STATES resourceState,
-                       D3D12_HEAP_TYPE       heapType);
+                       D3D12_HEAP_TYPE       heapType,
+                       uint32_t              minimumAlignmentInBytes = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
 
+    // Returns a null suballocation when a new block is needed and can't be created, either the
+    // device refused it or every block slot a handle can name is taken
     Suballocation                   CreateSubAllocation(ID3D12Device* device,
                                                         uint32_t      suballocationSizeInBytes,
                                                         uint32_t      memoryAlignmentInBytes);
 
+    // Allocates from one specific block without growing the pool, returns a null suballocation
+    // when it doesn't fit.  Used to replay defragmentation plans.
+    Suballocation                   CreateSubAllocationInBlock(uint32_t blockIndex,
+                                                               uint32_t suballocationSizeInBytes,
+                                                               uint32_t memoryAlignmentInBytes);
+
+    // Nulls the suballocation, a null one is ignored and a stale copy of a freed handle asserts in
+    // debug builds
     void                            FreeSubAllocation(Suballocation& suballocation);
+
+    // Constant time lookups, only valid while the handle is live
+    bool                            IsLive(SuballocationHandle handle) const;
+    ID3D12Resource*                 GetResource(SuballocationHandle handle) const;
+    uint32_t                        GetOffset(SuballocationHandle handle) const;
+    uint32_t                        GetSize(SuballocationHandle handle) const;
+
     std::vector<SuballocatorBlock>& GetSuballocators();
+    // Offset allocator of every block slot, null for released slots
+    void                            GetBlockAllocators(std::vector<const TLSFAllocator*>& allocators) const;
     uint32_t                        GetSuballocatorSize();
     uint32_t                        GetFreeSuballocationsSize();
     uint32_t                        GetAlignmentSavingSize();
+    // Totals over the live blocks and the allocation counters, the frame counts are left to the caller
+    void                            GetTelemetry(PoolTelemetry& telemetry) const;
 
 private:
 
-    SuballocatorBlock              CreateSuballocatorBlock(ID3D12Device* device,
+    // Returns the slot the new block was placed in, InvalidBlock when it couldn't be created
+    uint32_t                       CreateSuballocatorBlock(ID3D12Device* device,
                                                            uint32_t      bufferSizeInBytes = 0);
+    void                           ReleaseSuballocatorBlock(uint32_t blockIndex);
+    Suballocation                  CreateHandle(uint32_t blockIndex, const TLSFAllocator::Allocation& allocation);
 
     uint32_t                       m_suballocationAlignmentMemorySavings;
     uint32_t                       m_memoryBlockSize;
+    uint32_t                       m_minimumAlignment;
+    uint32_t                       m_liveBlockCount;
+    uint64_t                       m_allocationCount;
+    uint64_t                       m_freeCount;
     D3D12_RESOURCE_STATES          m_resourceState;
     D3D12_HEAP_TYPE                m_heapType;
     std::vector<SuballocatorBlock> m_blocks;
+    SuballocationHandleTable       m_handles;
+    TLSFBlockIndex                 m_freeBlocks; // Live blocks by their largest free range
 };
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Orders a frame's pending BLAS builds so builds of the same size are recorded together.  Builds
+// are bucketed into size classes by their prebuild result size, largest class first, and every
+// class is packed first fit decreasing into batches whose scratch fits the concurrent scratch
+// limit.  The builds of a batch run concurrently on disjoint scratch and at most one UAV barrier
+// precedes a batch, so the barrier count follows the scratch the frame needs instead of the order
+// builds were discovered in.  Result allocations made in the same order land next to builds
+// of their own size class.
+
+// One build waiting to be recorded, sizes come from its prebuild info
+struct PendingBuild
+{
+    uint64_t resultSizeInBytes;
+    uint64_t scratchSizeInBytes;
+};
+
+// Builds of one size class whose scratch fits the limit together, first and count index the
+// planned order.  barrierBefore starts a new run of scratch at offset zero, batches without it
+// follow the previous one in the same run.
+struct BuildBatch
+{
+    uint32_t first;
+    uint32_t count;
+    uint32_t sizeClass;
+    uint64_t scratchBytes;
+    uint64_t resultBytes;
+    bool     barrierBefore;
+};
+
+class BuildBatcher
+{
+public:
+
+    // Class 0 holds results up to smallestClassBytes, every further class classRatioLog2 powers of
+    // two more and the last one everything bigger
+    BuildBatcher(uint64_t smallestClassBytes = 64 * 1024,
+                 uint32_t classCount         = 4,
+                 uint32_t classRatioLog2     = 4,
+                 uint32_t alignmentInBytes   = 256);
+
+    // Fills order with the indices of builds in the order to record them and batches with the runs
+    // of it.  A maxConcurrentScratchBytes of zero never asks for a barrier, a build needing more
+    // than the limit gets a batch of its own.
+    void     Plan(const PendingBuild*      builds,
+                  uint32_t                 buildCount,
+                  uint64_t                 maxConcurrentScratchBytes,
+                  std::vector<uint32_t>&   order,
+                  std::vector<BuildBatch>& batches) const;
+
+    uint32_t SizeClass(uint64_t resultSizeInBytes) const;
+    uint32_t GetClassCount() const;
+
+private:
+
+    uint64_t AlignSize(uint64_t sizeInBytes) const;
+
+    uint64_t m_smallestClassBytes;
+    uint32_t m_classCount;
+    uint32_t m_classRatioLog2;
+    uint32_t m_alignment;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Picks which of the builds waiting for compaction are compacted this frame.  Schedule is a pure
+// function of a snapshot of the ready builds, so the policy runs and is measured without a device.
+// Builds are ranked by the memory compaction gives back per byte copied, how close they are to the
+// camera and how long they have waited, then taken greedily under three budgets:
+//   transient  compacted copies whose uncompacted result is still resident, across frames
+//   copy       bytes written by compaction copies this frame
+//   scratch    scratch memory held by builds still waiting, the copy budget is overrun while the
+//              waiting builds hold more than this
+
+// One build whose compacted size has been read back, id is the caller's and comes back in the schedule
+struct CompactionCandidate
+{
+    uint32_t id;
+    uint32_t resultSizeInBytes;    // Uncompacted size from the prebuild info
+    uint32_t compactedSizeInBytes;
+    uint32_t scratchSizeInBytes;   // Released along with the result once compacted
+    float    distanceToCamera;
+    uint64_t frameIndexRequest;
+};
+
+struct CompactionBudgets
+{
+    uint64_t transientBytes    = UINT64_MAX;
+    uint64_t copyBytesPerFrame = UINT64_MAX;
+    uint64_t scratchBytes      = UINT64_MAX;
+};
+
+struct CompactionWeights
+{
+    float savings       = 1.0f;  // Per unit of (result + scratch - compacted) / compacted
+    float distance      = 1.0f;  // At the camera, halved at distanceScale
+    float distanceScale = 50.0f;
+    float age           = 0.1f;  // Per frame waited, keeps far and poor savings builds from starving
+};
+
+struct CompactionFrameStats
+{
+    uint32_t readyCount;
+    uint32_t scheduledCount;
+    uint32_t deferredCount;
+    uint64_t copyBytes;
+    uint64_t transientBytes;       // In flight once this frame's copies are added
+    uint64_t reclaimedBytes;       // Result and scratch memory the scheduled copies give back
+    uint64_t scratchWaitingBytes;  // Held by builds still waiting after this frame
+    uint64_t oldestDeferredFrames; // Age of the oldest build left waiting
+};
+
+struct CompactionSchedule
+{
+    std::vector<uint32_t> ids;     // Scheduled candidates in priority order
+    CompactionFrameStats  stats;
+};
+
+class CompactionScheduler
+{
+public:
+
+    explicit CompactionScheduler(const CompactionWeights& weights = CompactionWeights());
+
+    // transientInFlight is what earlier frames' copies still hold
+    CompactionSchedule Schedule(const std::vector<CompactionCandidate>& candidates,
+                                const CompactionBudgets&                budgets,
+                                uint64_t                                transientInFlight,
+                                uint64_t                                frameIndex) const;
+
+    float              Score(const CompactionCandidate& candidate, uint64_t frameIndex) const;
+
+private:
+
+    CompactionWeights m_weights;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Slot bookkeeping for the compaction size readback.  Every compacting build writes its compacted
+// size descriptor into one slot, the builds of a frame get one contiguous run of slots so a single
+// copy moves them all to the persistently mapped readback buffer, and a run is handed back in one
+// pass once the frame that wrote it has executed.  The ring only tracks slot indices, RTCompaction
+// owns the buffers, so it runs without a device.
+class CompactionSizeRing
+{
+public:
+
+    static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+    explicit CompactionSizeRing(uint32_t capacity);
+
+    // Reserves count contiguous slots for builds recorded on frameIndex, a run never wraps past the
+    // end.  Returns InvalidSlot when the free space can't hold it.
+    uint32_t Allocate(uint32_t count, uint64_t frameIndex);
+
+    // Hands every run recorded on or before completedFrameIndex to consume(firstSlot, count),
+    // oldest first, and frees it
+    template <typename Consume>
+    void     Retire(uint64_t completedFrameIndex, Consume&& consume)
+    {
+        while (m_regions.empty() == false && m_regions.front().frameIndex <= completedFrameIndex)
+        {
+            const Region region = m_regions.front();
+            m_regions.pop_front();
+            m_usedSlots -= region.count;
+            consume(region.firstSlot, region.count);
+        }
+        if (m_regions.empty())
+        {
+            m_head = 0;
+        }
+    }
+
+    uint32_t GetCapacity() const;
+    uint32_t GetUsedSlots() const;
+    uint32_t GetRegionCount() const;
+
+    // Checks that the runs in flight are ordered, in range and don't overlap
+    bool     Validate() const;
+
+private:
+
+    struct Region
+    {
+        uint32_t firstSlot;
+        uint32_t count;
+        uint64_t frameIndex;
+    };
+
+    uint32_t           m_capacity;
+    uint32_t           m_head;
+    uint32_t           m_usedSlots;
+    std::deque<Region> m_regions;
+};
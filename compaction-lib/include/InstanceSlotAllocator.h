@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <vector>
+
+// Persistent instance indices for the top level.  Every entity holds on to one slot from the frame
+// it shows up until it goes away, so the instance descs and the per instance buffers indexed by
+// the slot only change on lifecycle events instead of shifting whenever an entity before it comes
+// or goes.  Released slots go on a free list that hands out the lowest slot first, trailing free
+// slots leave the active range and an optional compaction moves the last live slots into the
+// lowest holes once too much of the range is free.  Only slot numbers are tracked, so it runs
+// without a device.  ResourceManager also hands out the dense model ids its per model tables are
+// indexed by from one.
+
+// Packed reference to one slot.  Bits 0-31 hold the slot and 32-63 a generation stamped at
+// allocation, which never is zero, so a zero handle is null and a handle whose generation no longer
+// matches its slot has been released or moved by compaction.
+struct InstanceSlotHandle
+{
+    uint64_t value;
+
+    static InstanceSlotHandle Pack(uint32_t slot, uint32_t generation)
+    {
+        return InstanceSlotHandle{static_cast<uint64_t>(slot) | (static_cast<uint64_t>(generation) << 32)};
+    }
+
+    bool     IsNull()        const { return value == 0; }
+    uint32_t GetSlot()       const { return static_cast<uint32_t>(value); }
+    uint32_t GetGeneration() const { return static_cast<uint32_t>(value >> 32); }
+};
+
+// A live slot compaction moved, the owner of from now holds handle
+struct InstanceSlotMove
+{
+    uint32_t           from;
+    uint32_t           to;
+    InstanceSlotHandle handle;
+};
+
+class InstanceSlotAllocator
+{
+public:
+
+    // Compact only moves slots once more than maxFreeFraction of the active range is free
+    explicit InstanceSlotAllocator(float maxFreeFraction = 0.25f);
+
+    // Lowest free slot, or a new one at the end of the active range
+    InstanceSlotHandle Allocate();
+
+    // Frees the slot, trailing free slots leave the active range.  A null handle is ignored and a
+    // stale one asserts in debug builds.
+    void               Release(InstanceSlotHandle handle);
+
+    bool               IsLive(InstanceSlotHandle handle) const;
+
+    // Handle of the live allocation in the slot, null for a free slot
+    InstanceSlotHandle GetHandle(uint32_t slot) const;
+
+    // Moves at most maxMoves live slots from the end of the active range into the lowest free
+    // slots when the free fraction is above the limit.  Moved slots get the handles in moves,
+    // handles to where they were go stale.
+    void               Compact(uint32_t maxMoves, std::vector<InstanceSlotMove>& moves);
+
+    // Every live slot is below the slot count, the slots below it that aren't live are free
+    uint32_t           GetSlotCount() const;
+    uint32_t           GetLiveCount() const;
+
+    // Checks the free list against the generations and that the active range ends on a live slot
+    bool               Validate() const;
+
+private:
+
+    uint32_t           NextGeneration();
+    void               TrimFreeTail();
+
+    std::vector<uint32_t> m_generations; // Generation of the live allocation in each slot, 0 when free
+    std::set<uint32_t>    m_freeSlots;   // Free slots below the slot count, lowest first
+    uint32_t              m_slotCount;
+    uint32_t              m_liveCount;
+    uint32_t              m_generation;
+    float                 m_maxFreeFraction;
+};
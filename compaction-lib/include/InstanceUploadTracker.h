@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Change tracking for the per instance upload buffers.  Every instance slot remembers the entity
+// that last filled it and the transform generation it was filled from, and is stamped with the
+// frame its content last changed.  A buffer that remembers the frame it was last brought up to date
+// in only needs the slots stamped after it, so static instances are written once and a ring of
+// upload buffers each catch up on whatever changed while they were in flight.  Changed slots are
+// handed out as ranges, with ranges a few slots apart joined so a frame issues few copies.  The
+// tracker only knows slots and frames, ResourceManager owns the buffers.
+
+// Slots [first, first + count)
+struct SlotRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+class InstanceUploadTracker
+{
+public:
+
+    // Changed ranges at most mergeGapSlots unchanged slots apart are joined into one
+    explicit InstanceUploadTracker(uint32_t mergeGapSlots = 4);
+
+    // Starts the next frame with slotCount live slots, slots past the previous count start out
+    // changed
+    void     BeginFrame(uint32_t slotCount);
+
+    // Stamps the slot changed this frame when owner or generation differ from what it was last
+    // tracked with, true when it changed
+    bool     Track(uint32_t slot, const void* owner, uint32_t generation);
+
+    // Stamps the slot changed this frame whatever it holds, for content the generation doesn't cover
+    void     Invalidate(uint32_t slot);
+
+    // Fills ranges with the live slots whose content changed after sinceFrame.  trailingFrames
+    // extends every change over that many following frames for streams that lag the transforms,
+    // such as the previous frame's transforms.  A sinceFrame of zero returns every live slot.
+    void     CollectRanges(uint64_t sinceFrame, uint32_t trailingFrames, std::vector<SlotRange>& ranges) const;
+
+    uint64_t GetFrame() const;
+    uint32_t GetSlotCount() const;
+
+    // Slots stamped changed in the current frame
+    uint32_t GetChangedCount() const;
+
+    static uint64_t CountSlots(const std::vector<SlotRange>& ranges);
+
+private:
+
+    std::vector<const void*> m_owners;
+    std::vector<uint32_t>    m_generations;
+    std::vector<uint64_t>    m_changedFrames;
+    uint64_t                 m_frame;
+    uint32_t                 m_slotCount;
+    uint32_t                 m_changedCount;
+    uint32_t                 m_mergeGap;
+};
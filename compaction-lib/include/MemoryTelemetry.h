@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+// Plain structs describing the acceleration structure memory of one frame, filled by RTCompaction
+// at the end of every NextFrame from counters the pools keep anyway, so sampling walks the blocks
+// once and never allocates.  MemoryTelemetryWriter appends frames to a CSV file or to a JSON file
+// with one object per line, formatting into a fixed buffer so a dump doesn't allocate either.
+
+// Copies are counted by log2 of their size, bucket 0 holds everything up to 512 bytes and the last
+// everything from 8 MB up
+constexpr uint32_t MemoryTelemetryHistogramBuckets = 16;
+
+inline uint32_t MemoryTelemetryHistogramBucket(uint64_t sizeInBytes)
+{
+    uint32_t bucket = 0;
+    while (bucket + 1 < MemoryTelemetryHistogramBuckets && (uint64_t(512) << bucket) < sizeInBytes)
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+struct PoolTelemetry
+{
+    uint64_t residentBytes;
+    uint64_t usedBytes;
+    uint64_t largestFreeRange;
+    uint64_t alignmentSavedBytes;  // Compared to every allocation being its own committed resource
+    uint32_t blockCount;
+    uint32_t liveAllocations;
+    float    fragmentation;        // 1 - largest free range / free bytes, 0 when free space is one range
+    uint64_t allocations;          // Since the pool was created
+    uint64_t frees;
+    uint32_t frameAllocations;     // Since the previous sample
+    uint32_t frameFrees;
+};
+
+struct MemoryTelemetry
+{
+    uint64_t      frameIndex;
+    PoolTelemetry result;
+    PoolTelemetry compaction;
+
+    uint64_t      scratchResidentBytes;
+    uint64_t      scratchFramePeakBytes;
+
+    uint64_t      uncompactedBytes;    // Every live structure at its uncompacted size
+    uint64_t      compactedBytes;
+    uint64_t      compactionSavedBytes;
+    uint32_t      compactionsPending;  // Waiting for their size or for the scheduler
+    uint64_t      transientBytes;      // Compacted copies whose uncompacted result isn't freed yet
+
+    // Copies recorded since the previous sample: compaction, defragmentation and cache
+    // deserialization, with the sizes of all of them in the histogram
+    uint64_t      frameCompactionBytes;
+    uint64_t      frameDefragmentationBytes;
+    uint64_t      frameDeserializationBytes;
+    uint32_t      bytesMovedHistogram[MemoryTelemetryHistogramBuckets];
+};
+
+enum class MemoryTelemetryFormat
+{
+    CSV,
+    JSON
+};
+
+class MemoryTelemetryWriter
+{
+public:
+
+    MemoryTelemetryWriter();
+    ~MemoryTelemetryWriter();
+
+    // Truncates path and writes the CSV header, returns false when the file can't be created
+    bool Open(const char* path, MemoryTelemetryFormat format);
+    void Close();
+    bool IsOpen() const;
+
+    // Appends one frame, returns false once a write failed
+    bool Write(const MemoryTelemetry& telemetry);
+
+    // Formats one frame into buffer the way Write does, returns the length or 0 when it doesn't fit
+    static size_t Format(const MemoryTelemetry& telemetry, MemoryTelemetryFormat format, char* buffer, size_t bufferSize);
+    static size_t FormatHeader(MemoryTelemetryFormat format, char* buffer, size_t bufferSize);
+
+private:
+
+    static constexpr size_t LineSize = 2048;
+
+    FILE*                 m_file;
+    MemoryTelemetryFormat m_format;
+    bool                  m_failed;
+    char                  m_line[LineSize];
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "InstanceUploadTracker.h"
+#include "ParallelRecorder.h"
+#include <cstdint>
+#include <vector>
+
+// Writes the instance slots changed in a frame on several threads.  The changed ranges are cut into
+// chunks of at most a fixed number of slots, the chunks into contiguous runs of about the same
+// slot count, one run per thread, and the runs are handed to the ParallelRecorder workers with the
+// caller taking one too.  Every slot lands in exactly one chunk and every stream a chunk writes is
+// indexed by slot, so chunks write straight into their own part of the streams without locks and
+// the streams come out byte for byte the same whatever the thread count.
+
+// The per slot work, called concurrently for disjoint chunks
+class InstanceChunkWriter
+{
+public:
+
+    virtual ~InstanceChunkWriter() = default;
+
+    // Writes every stream of slots [firstSlot, firstSlot + slotCount)
+    virtual void WriteChunk(uint32_t firstSlot, uint32_t slotCount) = 0;
+};
+
+class ParallelInstanceWriter
+{
+public:
+
+    // workerCount threads write chunks besides the caller, zero writes everything on the caller
+    explicit ParallelInstanceWriter(uint32_t workerCount, uint32_t chunkSlots = 256);
+
+    // Returns once every slot in ranges is written
+    void        Write(const std::vector<SlotRange>& ranges, InstanceChunkWriter* writer);
+
+    uint32_t    GetThreadCount() const;
+
+    // Cuts ranges into chunks of at most chunkSlots slots, in slot order
+    static void SplitChunks(const std::vector<SlotRange>& ranges,
+                            uint32_t                      chunkSlots,
+                            std::vector<SlotRange>&       chunks);
+
+private:
+
+    // One thread's run of chunks, recording a build writes a chunk
+    class ChunkLane : public RecordingLane
+    {
+    public:
+
+        ChunkLane(const SlotRange* chunks, InstanceChunkWriter* writer);
+
+        void RecordBarrier() override;
+        void RecordBuild(uint32_t chunkIndex) override;
+
+    private:
+
+        const SlotRange*     m_chunks;
+        InstanceChunkWriter* m_writer;
+    };
+
+    ParallelRecorder            m_recorder;
+    uint32_t                    m_chunkSlots;
+    std::vector<SlotRange>      m_chunks;
+    std::vector<uint64_t>       m_costs;
+    std::vector<uint8_t>        m_barrierBefore;
+    std::vector<ChunkLane>      m_lanes;
+    std::vector<RecordingLane*> m_lanePointers;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Records a batch of acceleration structure builds on several command lists at once.  The batch is
+// cut into contiguous runs of builds balanced by cost, one run per lane, and every lane is recorded
+// start to finish by one thread: the caller takes lanes alongside a few persistent workers and
+// returns once all of them are recorded.  Lanes are executed back to back in lane order, so the GPU
+// sees the same builds and barriers as if the batch were recorded on one list and a barrier the
+// arena asked for still waits on the builds of earlier lanes.  The command lists hide behind
+// RecordingLane so the hand off runs against a mock recorder.
+
+// One command list of a batch, only ever used by the thread recording its lane
+class RecordingLane
+{
+public:
+
+    virtual ~RecordingLane() = default;
+
+    // A UAV barrier waiting for every build recorded ahead of it
+    virtual void RecordBarrier() = 0;
+    virtual void RecordBuild(uint32_t buildIndex) = 0;
+};
+
+class ParallelRecorder
+{
+public:
+
+    // workerCount threads record lanes besides the caller, zero records everything on the caller
+    explicit ParallelRecorder(uint32_t workerCount);
+    ~ParallelRecorder();
+
+    // Records builds [0, buildCount) on laneCount lanes split by Split, with a barrier ahead of
+    // every build whose barrierBefore is non zero.
+    void     Record(RecordingLane* const* lanes,
+                    uint32_t              laneCount,
+                    const uint64_t*       costs,
+                    const uint8_t*        barrierBefore,
+                    uint32_t              buildCount);
+
+    uint32_t GetWorkerCount() const;
+
+    // Cuts builds into laneCount contiguous runs of about the same cost, lane l records
+    // [laneStarts[l], laneStarts[l + 1]).  laneStarts holds laneCount + 1 entries.
+    static void Split(const uint64_t* costs,
+                      uint32_t        buildCount,
+                      uint32_t        laneCount,
+                      uint32_t*       laneStarts);
+
+private:
+
+    void WorkerLoop();
+
+    // Takes the next lane of the current batch and records it, false once none is left
+    bool RecordNextLane();
+
+    std::vector<std::thread> m_workers;
+    std::mutex               m_mutex;
+    std::condition_variable  m_wake;
+    std::condition_variable  m_done;
+    uint64_t                 m_generation;
+    bool                     m_stop;
+
+    // The batch being recorded, written by Record before waking the workers
+    RecordingLane* const*    m_lanes;
+    const uint8_t*           m_barrierBefore;
+    std::vector<uint32_t>    m_laneStarts;
+    uint32_t                 m_laneCount;
+    uint32_t                 m_nextLane;
+    uint32_t                 m_lanesLeft;
+};
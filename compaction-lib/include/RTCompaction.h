@@ -1,5 +1,7 @@
 #pragma once
 #include "BufferSuballocator.h"
+#include "CompactionScheduler.h"
+#include "MemoryTelemetry.h"
 
 // The design of this library is to allow developers to use compaction and suballocation of
 // acceleration structure buffers to reduce the memory footprint.  Compaction is proven to reduce the total memory
@@ -18,15 +20,17 @@ namespace RTCompaction
 {
     struct ASBuffers
     {
-        Suballocation scratchGpuMemory;
         Suballocation resultGpuMemory;
         Suballocation compactionGpuMemory;
-        Suballocation compactionSizeGpuMemory;
-        Suballocation compactionSizeCpuMemory;
-        bool          isCompacted;
-        bool          requestedCompaction;
         uint64_t      frameIndexRequest;
         uint32_t      numTriangles;
+        uint32_t      resultSizeInBytes;
+        uint32_t      compactionSizeSlot;   // Slot the builder writes the compacted size into, until it is read
+        uint32_t      compactedSizeInBytes; // Read back once the build executed
+        uint32_t      compactedIndex; // Slot in the list of compacted structures the defragmenter may move
+        float         priorityDistance; // Distance to the camera set by the application, nearer builds compact first
+        bool          isCompacted;
+        bool          requestedCompaction;
 
         D3D12_GPU_VIRTUAL_ADDRESS GetASBuffer()
         {
@@ -37,11 +41,23 @@ namespace RTCompaction
 
     // Initializes all of the suballocators used to tightly pack the acceleration structure buffers
     // as well as the command buffer latency used to indicate compaction can be done
+    // Build scratch comes from a per frame arena reused once the frame's command list executed
     // Suballocator block size is also an optional field
+    // A non zero defragmentation budget moves up to that many bytes of compacted acceleration
+    // structures per frame out of sparse blocks so they can be released
+    // A non zero concurrent scratch limit batches builds by size class so no more than that much
+    // scratch is in use between two UAV barriers, zero lets every build of a call run at once
     void       Initialize(ID3D12Device5* const device,
                           uint32_t             commandListLatency,
                           uint32_t             suballocatorBlockSize,
-                          uint32_t             maxTransientCompactionMemory);
+                          uint32_t             maxTransientCompactionMemory,
+                          uint32_t             maxDefragmentationBytesPerFrame = 0,
+                          uint64_t             maxConcurrentScratchBytes       = 0);
+
+    // Replaces the compaction budgets and weights, maxTransientCompactionMemory passed to Initialize
+    // becomes the per frame copy budget with the other budgets unlimited
+    void       SetCompactionPolicy(const CompactionBudgets& budgets,
+                                   const CompactionWeights& weights = CompactionWeights());
 
     // Used to indicate when compaction and release steps can be performed under the hood
     void       NextFrame(ID3D12Device5* const device,
@@ -51,12 +67,45 @@ namespace RTCompaction
     void       RemoveAccelerationStructures(ASBuffers**    buffers,
                                             const uint32_t removeCount);
 
+    // Keeps serialized compacted acceleration structures in directory so later runs deserialize
+    // them instead of building.  deviceKey should change with the adapter and driver version, a
+    // cache written under another key is discarded.
+    void       EnableBLASCache(ID3D12Device5* const device,
+                               const char*          directory,
+                               uint64_t             deviceKey);
+
     // BuildAccelerationStructures takes in an array of build inputs and compacts each one if requested
-    // then returns an array of ASBuffers
+    // then returns an array of ASBuffers in the order of the inputs.  Builds are recorded grouped by
+    // size class, largest first.
+    // With the BLAS cache enabled, cacheKeys holds a BLASCache::HashGeometry key per build, zero
+    // for builds that shouldn't be cached.  Hits are deserialized already compacted and compacted
+    // misses are written to the cache a few frames later.
+    // With worker command lists the builds are split into contiguous runs recorded on them by
+    // several threads, cache deserialization and compaction size copies stay on commandList.  The
+    // worker lists must hold nothing else of the frame and be executed in order on commandList's
+    // queue right ahead of it.
     ASBuffers* BuildAccelerationStructures(ID3D12Device5* const                                        device,
                                            ID3D12GraphicsCommandList4* const                           commandList,
                                            const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* bottomLevelInputs,
-                                           const uint32_t                                              buildCount);
+                                           const uint32_t                                              buildCount,
+                                           const uint64_t*                                             cacheKeys              = nullptr,
+                                           ID3D12GraphicsCommandList4* const*                          workerCommandLists     = nullptr,
+                                           const uint32_t                                              workerCommandListCount = 0);
+
+    // Returns the suballocator block holding the structure as built, the uncompacted result or
+    // the compacted one for cache hits, used for UAV barriers after building
+    ID3D12Resource* GetResultResource(const ASBuffers& buffers);
+
+    // Returns what the compaction scheduler did on the last frame
+    const CompactionFrameStats& GetCompactionStats();
+
+    // Returns the memory telemetry sampled at the end of the last NextFrame
+    const MemoryTelemetry&      GetMemoryTelemetry();
+
+    // Appends every frame's telemetry to path from the next NextFrame on, a null path stops it.
+    // Returns false when the file can't be created.
+    bool       EnableMemoryTelemetryDump(const char*           path,
+                                         MemoryTelemetryFormat format);
 
     // Returns current command lists build and compaction stats
     const char* GetLog();
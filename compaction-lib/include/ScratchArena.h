@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Frame scoped scratch memory for acceleration structure builds.  Scratch is only read while a
+// build executes, so instead of every build holding its own range until compaction the builds of a
+// frame share one buffer per frame in flight.  Builds recorded back to back run concurrently and
+// get disjoint regions, a UAV barrier starts the layout over at offset zero, and a frame's buffer
+// is reused once that frame's fence has passed.  Buffers come from a backend so the arena runs
+// against a mock device.
+
+// A scratch buffer, resource is the backend's own handle
+struct ScratchBuffer
+{
+    void*    resource;
+    uint64_t gpuVA;
+    uint64_t sizeInBytes;
+};
+
+// Creates and releases the arena's buffers, RTCompaction implements it with committed resources
+class ScratchArenaBackend
+{
+public:
+
+    virtual ~ScratchArenaBackend() = default;
+
+    virtual ScratchBuffer CreateBuffer(uint64_t sizeInBytes) = 0;
+    virtual void          ReleaseBuffer(const ScratchBuffer& buffer) = 0;
+};
+
+// Where one build's scratch went, barrierBefore asks for a UAV barrier ahead of the build so it
+// can reuse the regions of the builds recorded before it
+struct ScratchPlacement
+{
+    uint64_t gpuVA;
+    bool     barrierBefore;
+};
+
+struct ScratchArenaStats
+{
+    uint64_t framePeakBytes;     // Largest span of scratch in use at once on the current frame
+    uint64_t lastFramePeakBytes; // Same for the frame before it
+    uint64_t maxFramePeakBytes;
+    uint64_t residentBytes;      // Every buffer the arena holds, retired ones included
+    uint64_t barriers;           // UAV barriers requested between builds sharing scratch
+    uint64_t buffersCreated;
+};
+
+class ScratchArena
+{
+public:
+
+    // frameCount is the number of frames in flight, the command list latency.  A run of concurrent
+    // builds is cut by a UAV barrier once it needs more than maxConcurrentBytes, zero never cuts.
+    ScratchArena(ScratchArenaBackend* backend,
+                 uint32_t             frameCount,
+                 uint64_t             maxConcurrentBytes = 0,
+                 uint32_t             alignmentInBytes   = 256,
+                 uint64_t             granularityInBytes = 65536);
+    ~ScratchArena();
+
+    // Starts recording frameIndex, the buffer last used frameCount frames earlier is free again
+    void                     BeginFrame(uint64_t frameIndex);
+
+    // Lays out the scratch of builds recorded in order on the current frame.  Growing a buffer
+    // retires the old one until its frame has executed.  A non zero runStarts entry starts that
+    // build's run over at offset zero behind a barrier, for callers that batch builds themselves.
+    void                     PlaceBatch(const uint64_t*   scratchSizes,
+                                        uint32_t          buildCount,
+                                        ScratchPlacement* placements,
+                                        const uint8_t*    runStarts = nullptr);
+
+    uint64_t                 GetMaxConcurrentBytes() const;
+
+    const ScratchArenaStats& GetStats() const;
+
+private:
+
+    struct Retired
+    {
+        ScratchBuffer buffer;
+        uint64_t      frameIndex;
+    };
+
+    static constexpr uint32_t IdleRoundsBeforeRelease = 8;
+
+    // One buffer per frame in flight, used once the frame it is recording placed a batch
+    struct Slot
+    {
+        ScratchBuffer buffer;
+        uint32_t      idleRounds;
+        bool          used;
+    };
+
+    uint64_t AlignSize(uint64_t sizeInBytes) const;
+
+    ScratchArenaBackend* m_backend;
+    uint64_t             m_maxConcurrentBytes;
+    uint32_t             m_alignment;
+    uint64_t             m_granularity;
+    uint64_t             m_frameIndex;
+    std::vector<Slot>    m_slots;
+    std::deque<Retired>  m_retired;
+    ScratchArenaStats    m_stats;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Handle bookkeeping for BufferSuballocator.  Every block the pool commits takes a slot that the
+// handles into it name, released slots are reused, and every node of a block remembers the
+// generation of the allocation living on it so a handle can be checked in constant time.  Only
+// slot and node numbers are tracked, so it runs without a device.
+
+// Packed reference to one suballocation, resolved by the owning BufferSuballocator without any
+// search.  Bits 0-15 hold the block slot, 16-39 the allocator node and 48-63 a generation stamped
+// at allocation, which never is zero, so a zero handle is null and a handle whose generation no
+// longer matches its node has been freed.  Bits 40-47 are unused.
+struct SuballocationHandle
+{
+    uint64_t value;
+
+    static SuballocationHandle Pack(uint32_t blockIndex, uint32_t node, uint16_t generation)
+    {
+        return SuballocationHandle{(static_cast<uint64_t>(blockIndex) & 0xFFFF)          |
+                                   ((static_cast<uint64_t>(node)      & 0xFFFFFF) << 16) |
+                                   (static_cast<uint64_t>(generation)             << 48)};
+    }
+
+    bool     IsNull()        const { return value == 0; }
+    uint32_t GetBlockIndex() const { return static_cast<uint32_t>(value & 0xFFFF); }
+    uint32_t GetNode()       const { return static_cast<uint32_t>((value >> 16) & 0xFFFFFF); }
+    uint16_t GetGeneration() const { return static_cast<uint16_t>(value >> 48); }
+};
+
+class SuballocationHandleTable
+{
+public:
+
+    // Every slot the 16 bits of a handle can name
+    static constexpr uint32_t MaxBlockCount = 0x10000;
+    static constexpr uint32_t InvalidBlock  = UINT32_MAX;
+
+    SuballocationHandleTable();
+
+    // Slot for a new block, the most recently released one first.  Returns InvalidBlock once all
+    // MaxBlockCount slots are taken.
+    uint32_t            AddBlock();
+
+    // Every handle into the block goes stale and the slot is handed out again
+    void                RemoveBlock(uint32_t blockIndex);
+
+    // Stamps the allocation on the node with the next generation
+    SuballocationHandle Issue(uint32_t blockIndex, uint32_t node);
+
+    // Marks the handle's node free.  Returns false and changes nothing for a null handle or one
+    // that isn't live, which is how a double free through a stale copy shows up.
+    bool                Retire(SuballocationHandle handle);
+
+    bool                IsLive(SuballocationHandle handle) const;
+
+    // Slots handed out so far, including released ones
+    uint32_t            GetBlockSlotCount() const;
+
+private:
+
+    // Per slot, the generation of the live allocation on each node and 0 for a free node
+    std::vector<std::vector<uint16_t>> m_nodeGenerations;
+    std::vector<uint32_t>              m_unusedBlockSlots;
+    uint16_t                           m_generation;
+};
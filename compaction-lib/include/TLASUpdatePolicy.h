@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+
+// Decides per frame whether the top level is rebuilt or refit from the one built the frame before.
+// A refit keeps the tree of the last rebuild and only grows its boxes around the moved instances,
+// so it is only possible while the instance count and the bottom level every instance points at
+// stay the same, and the tree gets looser the further instances wander from where they were.  A
+// rebuild is forced on any topology change, after a number of refits in a row and once the bounds
+// of the instances have grown past a factor of their bounds at the last rebuild.  Only counts and
+// bounds go in, so the policy and its stats run without a device.
+
+// Axis aligned box around the instances of one frame, empty until the first Grow
+struct InstanceBounds
+{
+    float min[3];
+    float max[3];
+
+    void  Reset();
+    void  Grow(float x, float y, float z);
+    bool  IsEmpty()     const;
+    float SurfaceArea() const;
+};
+
+struct TLASUpdateSettings
+{
+    uint32_t maxUpdates      = 30;    // Refits in a row before a rebuild is forced
+    float    maxBoundsGrowth = 1.5f;  // Surface area over the one at the last rebuild
+    float    updateCost      = 0.3f;  // Refit cost as a fraction of a rebuild of the same instances
+};
+
+struct TLASFrameInputs
+{
+    uint32_t       instanceCount;
+    bool           topologyChanged;  // An instance got another bottom level, or the count changed
+    bool           sourceAvailable;  // A top level built with updates allowed is there to refit
+    InstanceBounds bounds;
+};
+
+enum class TLASBuildMode
+{
+    Rebuild,
+    Update
+};
+
+enum class TLASRebuildReason
+{
+    None,            // Refit
+    NoSource,
+    Topology,
+    UpdateLimit,
+    BoundsGrowth
+};
+
+struct TLASBuildDecision
+{
+    TLASBuildMode     mode;
+    TLASRebuildReason reason;
+};
+
+// Costs are in instances built, a rebuild of n instances costs n and a refit n times updateCost
+struct TLASUpdateStats
+{
+    uint64_t rebuilds;
+    uint64_t updates;
+    uint64_t noSourceRebuilds;
+    uint64_t topologyRebuilds;
+    uint64_t updateLimitRebuilds;
+    uint64_t boundsRebuilds;
+    double   rebuildOnlyCost;   // Had every frame been rebuilt
+    double   estimatedCost;
+};
+
+class TLASUpdatePolicy
+{
+public:
+
+    explicit TLASUpdatePolicy(const TLASUpdateSettings& settings = TLASUpdateSettings());
+
+    // Call once per top level build, the caller builds with the returned mode
+    TLASBuildDecision      Decide(const TLASFrameInputs& inputs);
+
+    // Forget the last build, the next decision is a rebuild
+    void                   Reset();
+
+    uint32_t               GetUpdatesSinceRebuild() const;
+    const TLASUpdateStats& GetStats() const;
+
+    // Rebuilds per refit, or the rebuild count without refits, and the share of the rebuild only
+    // cost the refits saved
+    static double          RebuildToUpdateRatio(const TLASUpdateStats& stats);
+    static double          SavedFraction(const TLASUpdateStats& stats);
+
+private:
+
+    TLASUpdateSettings m_settings;
+    TLASUpdateStats    m_stats;
+    uint32_t           m_lastInstanceCount;
+    uint32_t           m_updatesSinceRebuild;
+    float              m_rebuildSurfaceArea;
+    bool               m_hasBuild;
+};
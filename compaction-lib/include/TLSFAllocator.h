@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Two level segregated fit offset allocator (Masmano et al. 2004).  Manages offsets and sizes
+// inside one contiguous range and knows nothing about the memory behind it, so the D3D12
+// suballocator puts one of these on each committed buffer and tools can drive it against a fake
+// heap.  Allocate and Free are O(1): free ranges are binned by a first level power of two and
+// SecondLevelCount linear subdivisions with a bitmap per level, and a freed range merges with its
+// physical neighbours immediately so free space never splinters into adjacent pieces.
+
+class TLSFAllocator
+{
+public:
+
+    static constexpr uint32_t InvalidNode      = UINT32_MAX;
+    static constexpr uint32_t SecondLevelLog2  = 5;
+    static constexpr uint32_t SecondLevelCount = 1u << SecondLevelLog2;
+    static constexpr uint32_t FirstLevelCount  = 32 - SecondLevelLog2 + 1;
+
+    // Free list bins are numbered firstLevel * SecondLevelCount + secondLevel, which orders them
+    // by the sizes they hold, so allocators sharing a granularity can compare bins directly
+    static constexpr uint32_t BinCount   = FirstLevelCount * SecondLevelCount;
+    static constexpr uint32_t InvalidBin = UINT32_MAX;
+
+    struct Allocation
+    {
+        uint32_t offset;
+        uint32_t size; // Rounded up to the granularity
+        uint32_t node; // Passed back to Free, InvalidNode when the allocation failed
+    };
+
+    // Offsets and sizes are kept in multiples of granularity, which must be a power of two.
+    // Alignments up to the granularity cost nothing, larger ones split off the front padding.
+    TLSFAllocator(uint32_t capacityInBytes = 0, uint32_t granularityInBytes = 256);
+
+    Allocation Allocate(uint32_t sizeInBytes, uint32_t alignmentInBytes = 0);
+    void       Free(uint32_t node);
+    void       Reset();
+
+    uint32_t   GetCapacity() const;
+    uint32_t   GetGranularity() const;
+    uint32_t   GetUsedSize() const;
+    uint32_t   GetFreeSize() const;
+    uint32_t   GetAllocationCount() const;
+    uint32_t   GetFreeRangeCount() const;
+    // Largest single allocation that would currently succeed at the granularity
+    uint32_t   GetLargestFreeRange() const;
+    // Bin the largest free range is filed in, InvalidBin when nothing is free
+    uint32_t   GetLargestFreeBin() const;
+    uint32_t   GetNodeOffset(uint32_t node) const;
+    uint32_t   GetNodeSize(uint32_t node) const;
+
+    // Walks every range and checks the physical chain, free lists, bitmaps and totals agree
+    bool       Validate() const;
+
+    // Bins Allocate would search for this request, with the same alignment padding and rounding.
+    // An allocator whose largest free bin is at least fitBin always satisfies it, one whose
+    // largest free bin is exactBin only might.  InvalidBin when no bin is large enough.
+    static void GetRequestBins(uint32_t  sizeInBytes,
+                               uint32_t  alignmentInBytes,
+                               uint32_t  granularityInBytes,
+                               uint32_t& fitBin,
+                               uint32_t& exactBin);
+
+private:
+
+    struct Node
+    {
+        uint32_t offset;       // In granules
+        uint32_t size;         // In granules
+        uint32_t prevPhysical;
+        uint32_t nextPhysical;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool     isFree;
+    };
+
+    static void MappingInsert(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+    static bool MappingSearch(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+    uint32_t   FindFreeNode(uint32_t size) const;
+    void       InsertFreeNode(uint32_t node);
+    void       RemoveFreeNode(uint32_t node);
+    uint32_t   CreateNode(uint32_t offset, uint32_t size, uint32_t prevPhysical, uint32_t nextPhysical);
+    void       ReleaseNode(uint32_t node);
+
+    uint32_t              m_capacity;    // In granules
+    uint32_t              m_granularityLog2;
+    uint32_t              m_usedSize;    // In granules
+    uint32_t              m_allocationCount;
+    uint32_t              m_freeRangeCount;
+    uint32_t              m_firstLevelBitmap;
+    uint32_t              m_secondLevelBitmaps[FirstLevelCount];
+    uint32_t              m_freeHeads[FirstLevelCount][SecondLevelCount];
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_unusedNodes; // Recycled node slots so steady state churn never allocates
+};
+
+// Pool level index over the blocks of a TLSFAllocator pool, so finding a block that can take a
+// request doesn't ask every block in turn.  Each block is linked into the list of the bin its
+// largest free range is filed in, and a bitmap per level over those lists finds the lowest one at
+// or above a request's bin in constant time, the same search the allocator does inside a block.
+class TLSFBlockIndex
+{
+public:
+
+    static constexpr uint32_t InvalidBlock = UINT32_MAX;
+
+    TLSFBlockIndex();
+
+    // Refiles the block under its allocator's largest free range, call after every allocation
+    // from or free into it.  A full allocator drops out of the index.
+    void     Update(uint32_t block, const TLSFAllocator& allocator);
+    void     Remove(uint32_t block);
+
+    // A block filed at or above the bin, InvalidBlock when there is none
+    uint32_t FindBlock(uint32_t bin) const;
+    // Walks the blocks filed in exactly this bin
+    uint32_t GetFirstInBin(uint32_t bin) const;
+    uint32_t GetNextInBin(uint32_t block) const;
+
+private:
+
+    struct Entry
+    {
+        uint32_t bin;
+        uint32_t prevInBin;
+        uint32_t nextInBin;
+    };
+
+    void Link(uint32_t block, uint32_t bin);
+    void Unlink(uint32_t block);
+
+    uint32_t           m_firstLevelBitmap;
+    uint32_t           m_secondLevelBitmaps[TLSFAllocator::FirstLevelCount];
+    uint32_t           m_binHeads[TLSFAllocator::BinCount];
+    std::vector<Entry> m_entries; // Per block slot, bin is InvalidBin while the block isn't filed
+};
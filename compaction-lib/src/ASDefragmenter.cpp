@@ -0,0 +1,210 @@
+#include "ASDefragmenter.h"
+#include <algorithm>
+#include <memory>
+
+ASDefragmenter::ASDefragmenter(uint32_t bytesPerFrameBudget,
+                               float    occupancyThreshold,
+                               uint32_t alignmentInBytes)
+{
+    m_bytesPerFrameBudget = bytesPerFrameBudget;
+    m_occupancyThreshold  = occupancyThreshold;
+    m_alignment           = alignmentInBytes;
+}
+
+DefragPlan ASDefragmenter::Plan(const std::vector<const TLSFAllocator*>& blocks,
+                                const std::vector<DefragItem>&           items) const
+{
+    DefragPlan plan = {};
+    plan.before     = Measure(blocks);
+    plan.after      = plan.before;
+
+    std::vector<uint32_t> order;
+    for (uint32_t block = 0; block < blocks.size(); block++)
+    {
+        if (blocks[block] != nullptr && blocks[block]->GetAllocationCount() > 0)
+        {
+            order.push_back(block);
+        }
+    }
+    if (order.size() < 2 || m_bytesPerFrameBudget == 0)
+    {
+        return plan;
+    }
+
+    // Blocks are copied the first time a planned move touches them so later moves see the space
+    // earlier ones took, everything else is read in place
+    std::vector<std::unique_ptr<TLSFAllocator>> modified(blocks.size());
+    auto view = [&](uint32_t block) -> const TLSFAllocator&
+    {
+        return modified[block] != nullptr ? *modified[block] : *blocks[block];
+    };
+    auto edit = [&](uint32_t block) -> TLSFAllocator&
+    {
+        if (modified[block] == nullptr)
+        {
+            modified[block].reset(new TLSFAllocator(*blocks[block]));
+        }
+        return *modified[block];
+    };
+
+    // Largest free range of every block, a range at least the size is all Allocate needs at this
+    // alignment so destinations that can't take an allocation are skipped without touching them
+    std::vector<uint32_t> largestFree(blocks.size(), 0);
+    for (uint32_t block : order)
+    {
+        largestFree[block] = blocks[block]->GetLargestFreeRange();
+    }
+
+    // Emptiest first, the stable sort keeps slot order on ties so plans are deterministic.  The
+    // fullest blocks are filled first.
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t left, uint32_t right)
+    {
+        return blocks[left]->GetUsedSize() < blocks[right]->GetUsedSize();
+    });
+    const std::vector<uint32_t> destinations(order.rbegin(), order.rend());
+
+    std::vector<std::vector<const DefragItem*>> blockItems(blocks.size());
+    for (const DefragItem& item : items)
+    {
+        if (item.block < blocks.size() && blocks[item.block] != nullptr)
+        {
+            blockItems[item.block].push_back(&item);
+        }
+    }
+
+    std::vector<bool> isSource(blocks.size(), false);
+    std::vector<bool> isDestination(blocks.size(), false);
+    bool              budgetSpent = false;
+
+    for (size_t candidate = 0; candidate < order.size() && budgetSpent == false; candidate++)
+    {
+        const uint32_t       source      = order[candidate];
+        const TLSFAllocator& sourceState = view(source);
+
+        // A block that took moves stays put, otherwise two sparse blocks could trade contents
+        // forever.  Blocks holding allocations the caller didn't list can never be emptied.
+        float occupancy = static_cast<float>(sourceState.GetUsedSize()) / sourceState.GetCapacity();
+        if (isDestination[source] || occupancy >= m_occupancyThreshold ||
+            blockItems[source].size() != sourceState.GetAllocationCount())
+        {
+            continue;
+        }
+
+        // Largest first so the big structures find room while it is still contiguous
+        std::vector<const DefragItem*>& sourceItems = blockItems[source];
+        std::stable_sort(sourceItems.begin(), sourceItems.end(), [&](const DefragItem* left, const DefragItem* right)
+        {
+            return sourceState.GetNodeSize(left->node) > sourceState.GetNodeSize(right->node);
+        });
+
+        // Only start on a block when all of it fits elsewhere, moving part of a block that can
+        // never be released just spends budget.  The trial copies a destination only once it
+        // accepts an allocation.
+        std::vector<std::pair<uint32_t, std::unique_ptr<TLSFAllocator>>> trial;
+        std::vector<uint32_t>                                            placement(sourceItems.size());
+        bool                                                             fits = true;
+        for (size_t itemIndex = 0; itemIndex < sourceItems.size() && fits; itemIndex++)
+        {
+            const uint32_t sizeInBytes = sourceState.GetNodeSize(sourceItems[itemIndex]->node);
+            fits                       = false;
+            for (uint32_t destination : destinations)
+            {
+                if (largestFree[destination] < sizeInBytes || destination == source || isSource[destination])
+                {
+                    continue;
+                }
+
+                // Trial copies shadow the cached range until the trial is over
+                auto copy = std::find_if(trial.begin(), trial.end(), [&](const auto& entry) { return entry.first == destination; });
+                if (copy == trial.end())
+                {
+                    trial.emplace_back(destination, std::unique_ptr<TLSFAllocator>(new TLSFAllocator(view(destination))));
+                    copy = trial.end() - 1;
+                }
+                else if (copy->second->GetLargestFreeRange() < sizeInBytes)
+                {
+                    continue;
+                }
+
+                if (copy->second->Allocate(sizeInBytes, m_alignment).node != TLSFAllocator::InvalidNode)
+                {
+                    placement[itemIndex] = destination;
+                    fits                 = true;
+                    break;
+                }
+            }
+        }
+        if (fits == false)
+        {
+            continue;
+        }
+
+        // Commit in the trial's order until the budget runs out, the rest of the block follows in
+        // later plans.  A single structure larger than the budget still moves on its own.
+        isSource[source] = true;
+        size_t committed = 0;
+        for (; committed < sourceItems.size(); committed++)
+        {
+            const DefragItem* item        = sourceItems[committed];
+            const uint32_t    sizeInBytes = view(source).GetNodeSize(item->node);
+            if (plan.bytesMoved + sizeInBytes > m_bytesPerFrameBudget && plan.moves.empty() == false)
+            {
+                budgetSpent = true;
+                break;
+            }
+
+            const uint32_t destination = placement[committed];
+            TLSFAllocator& target      = edit(destination);
+            target.Allocate(sizeInBytes, m_alignment);
+            edit(source).Free(item->node);
+            largestFree[destination]   = target.GetLargestFreeRange();
+            isDestination[destination] = true;
+
+            plan.moves.push_back(DefragMove{item->id, source, destination, sizeInBytes});
+            plan.bytesMoved += sizeInBytes;
+        }
+
+        if (committed == sourceItems.size())
+        {
+            plan.evacuatedBlocks.push_back(source);
+        }
+    }
+
+    // Evacuated blocks are released by the pool once their last range is freed
+    std::vector<const TLSFAllocator*> after(blocks.size(), nullptr);
+    for (uint32_t block = 0; block < blocks.size(); block++)
+    {
+        if (blocks[block] != nullptr && (blocks[block]->GetAllocationCount() == 0 || view(block).GetAllocationCount() > 0))
+        {
+            after[block] = &view(block);
+        }
+    }
+    plan.after = Measure(after);
+
+    return plan;
+}
+
+DefragStats ASDefragmenter::Measure(const std::vector<const TLSFAllocator*>& blocks)
+{
+    DefragStats stats = {};
+    uint64_t    freeBytes = 0;
+    for (const TLSFAllocator* block : blocks)
+    {
+        if (block == nullptr || block->GetCapacity() == 0)
+        {
+            continue;
+        }
+        stats.blockCount++;
+        stats.residentBytes    += block->GetCapacity();
+        stats.usedBytes        += block->GetUsedSize();
+        stats.largestFreeRange  = std::max<uint64_t>(stats.largestFreeRange, block->GetLargestFreeRange());
+        freeBytes              += block->GetFreeSize();
+    }
+    stats.fragmentation = freeBytes > 0 ? 1.0f - static_cast<float>(stats.largestFreeRange) / freeBytes : 0.0f;
+    return stats;
+}
+
+uint32_t ASDefragmenter::GetBytesPerFrameBudget() const
+{
+    return m_bytesPerFrameBudget;
+}
@@ -0,0 +1,392 @@
+#include "BLASCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    constexpr uint32_t IndexMagic = 0x49434C42; // "BLCI"
+    constexpr uint32_t EntryMagic = 0x45434C42; // "BLCE"
+
+    struct IndexHeader
+    {
+        uint32_t magic;
+        uint32_t formatVersion;
+        uint64_t deviceKey;
+        uint64_t entryCount;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t key;
+        uint64_t payloadSize;
+        uint64_t payloadHash;
+    };
+
+    // Repeats everything the index knows so a stale or foreign file is caught before its payload
+    // is read
+    struct EntryHeader
+    {
+        uint32_t magic;
+        uint32_t formatVersion;
+        uint64_t deviceKey;
+        uint64_t key;
+        uint64_t payloadSize;
+        uint64_t payloadHash;
+    };
+
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+
+    inline uint64_t Rotl(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Streaming 64 bit hash working on 8 byte words with xxHash64's round and avalanche.  Tails
+    // shorter than a word are zero padded, the total length goes into the final mix so padding
+    // can't collide with real zeros.
+    class Hasher
+    {
+    public:
+
+        explicit Hasher(uint64_t seed) : m_state(seed + Prime3), m_length(0) {}
+
+        void Add(uint64_t value)
+        {
+            m_state   ^= Rotl(value * Prime2, 31) * Prime1;
+            m_state    = Rotl(m_state, 27) * Prime1 + Prime3;
+            m_length  += 8;
+        }
+
+        void AddBytes(const void* data, size_t sizeInBytes)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (; sizeInBytes >= 8; bytes += 8, sizeInBytes -= 8)
+            {
+                uint64_t word;
+                memcpy(&word, bytes, 8);
+                Add(word);
+            }
+            if (sizeInBytes > 0)
+            {
+                uint64_t word = 0;
+                memcpy(&word, bytes, sizeInBytes);
+                Add(word);
+                m_length -= 8 - sizeInBytes;
+            }
+        }
+
+        uint64_t Finish() const
+        {
+            uint64_t hash = m_state ^ m_length;
+            hash ^= hash >> 33;
+            hash *= Prime2;
+            hash ^= hash >> 29;
+            hash *= Prime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+    private:
+
+        uint64_t m_state;
+        uint64_t m_length;
+    };
+
+    template <typename T>
+    bool ReadValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename T>
+    void WriteValue(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Writes next to the destination and renames over it, a crash mid write never leaves a
+    // truncated file under the real name
+    bool ReplaceFile(const std::string& path, const std::string& temporaryPath)
+    {
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+}
+
+BLASCache::BLASCache(const std::string&              directory,
+                     uint64_t                        deviceKey,
+                     const BLASSerializationBackend* backend)
+{
+    m_directory  = directory;
+    m_deviceKey  = deviceKey;
+    m_backend    = backend;
+    m_indexDirty = false;
+    m_stats      = {};
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    if (std::filesystem::exists(IndexPath(), error) && ReadIndex() == false)
+    {
+        Invalidate();
+        Flush();
+    }
+}
+
+uint64_t BLASCache::HashGeometry(const BLASGeometry* geometry,
+                                 uint32_t            geometryCount,
+                                 uint32_t            buildFlags)
+{
+    Hasher hasher(FormatVersion);
+    hasher.Add(buildFlags);
+    hasher.Add(geometryCount);
+
+    for (uint32_t geometryIndex = 0; geometryIndex < geometryCount; geometryIndex++)
+    {
+        const BLASGeometry& desc = geometry[geometryIndex];
+        hasher.Add((uint64_t(desc.vertexFormat) << 32) | desc.flags);
+        hasher.Add((uint64_t(desc.vertexCount)  << 32) | desc.positionSize);
+        hasher.Add((uint64_t(desc.indexCount)   << 32) | desc.indexFormat);
+        hasher.Add(desc.indices != nullptr ? desc.indexSize : 0);
+
+        const uint8_t* vertices = static_cast<const uint8_t*>(desc.vertices);
+        for (uint32_t vertex = 0; vertex < desc.vertexCount; vertex++)
+        {
+            hasher.AddBytes(vertices + size_t(vertex) * desc.vertexStride, desc.positionSize);
+        }
+        if (desc.indices != nullptr)
+        {
+            hasher.AddBytes(desc.indices, size_t(desc.indexCount) * desc.indexSize);
+        }
+    }
+
+    uint64_t key = hasher.Finish();
+    return key != 0 ? key : 1;
+}
+
+uint64_t BLASCache::HashBytes(const void* data, size_t sizeInBytes, uint64_t seed)
+{
+    Hasher hasher(seed);
+    hasher.AddBytes(data, sizeInBytes);
+    return hasher.Finish();
+}
+
+bool BLASCache::Contains(uint64_t key) const
+{
+    return m_entries.find(key) != m_entries.end();
+}
+
+bool BLASCache::Load(uint64_t key, std::vector<uint8_t>& payload)
+{
+    auto entry = m_entries.find(key);
+    if (entry == m_entries.end())
+    {
+        m_stats.misses++;
+        return false;
+    }
+
+    std::ifstream file(EntryPath(key), std::ios::binary);
+    EntryHeader   header = {};
+    bool          valid  = file.is_open() && ReadValue(file, header) &&
+                           header.magic         == EntryMagic &&
+                           header.formatVersion == FormatVersion &&
+                           header.deviceKey     == m_deviceKey &&
+                           header.key           == key &&
+                           header.payloadSize   == entry->second.payloadSize &&
+                           header.payloadHash   == entry->second.payloadHash;
+    if (valid)
+    {
+        payload.resize(header.payloadSize);
+        valid = static_cast<bool>(file.read(reinterpret_cast<char*>(payload.data()), payload.size())) &&
+                HashBytes(payload.data(), payload.size()) == header.payloadHash;
+    }
+    if (valid == false)
+    {
+        DropEntry(key);
+        m_stats.misses++;
+        return false;
+    }
+
+    // Same device key but the driver can't take the blob back, nothing else in here will be
+    // accepted either
+    if (m_backend != nullptr && m_backend->IsCompatible(payload.data(), payload.size()) == false)
+    {
+        Invalidate();
+        m_stats.misses++;
+        return false;
+    }
+
+    m_stats.hits++;
+    m_stats.bytesRead += payload.size();
+    return true;
+}
+
+bool BLASCache::Store(uint64_t key, const uint8_t* payload, size_t sizeInBytes)
+{
+    EntryHeader header   = {};
+    header.magic         = EntryMagic;
+    header.formatVersion = FormatVersion;
+    header.deviceKey     = m_deviceKey;
+    header.key           = key;
+    header.payloadSize   = sizeInBytes;
+    header.payloadHash   = HashBytes(payload, sizeInBytes);
+
+    const std::string path          = EntryPath(key);
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        WriteValue(file, header);
+        file.write(reinterpret_cast<const char*>(payload), sizeInBytes);
+        if (file.good() == false)
+        {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    if (ReplaceFile(path, temporaryPath) == false)
+    {
+        return false;
+    }
+
+    m_entries[key] = Entry{header.payloadSize, header.payloadHash};
+    m_indexDirty   = true;
+    m_stats.stores++;
+    m_stats.bytesWritten += sizeof(EntryHeader) + sizeInBytes;
+    return true;
+}
+
+bool BLASCache::Flush()
+{
+    if (m_indexDirty == false)
+    {
+        return true;
+    }
+
+    // Sorted so the same contents always write the same file
+    std::vector<IndexEntry> entries;
+    entries.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+        entries.push_back(IndexEntry{entry.first, entry.second.payloadSize, entry.second.payloadHash});
+    }
+    std::sort(entries.begin(), entries.end(), [](const IndexEntry& left, const IndexEntry& right)
+    {
+        return left.key < right.key;
+    });
+
+    IndexHeader header   = {};
+    header.magic         = IndexMagic;
+    header.formatVersion = FormatVersion;
+    header.deviceKey     = m_deviceKey;
+    header.entryCount    = entries.size();
+
+    const std::string temporaryPath = IndexPath() + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        WriteValue(file, header);
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(IndexEntry));
+        if (file.good() == false)
+        {
+            return false;
+        }
+    }
+    if (ReplaceFile(IndexPath(), temporaryPath) == false)
+    {
+        return false;
+    }
+
+    m_indexDirty = false;
+    return true;
+}
+
+void BLASCache::Invalidate()
+{
+    // Every entry file goes, including ones a crash left out of the index
+    std::error_code error;
+    for (std::filesystem::directory_iterator file(m_directory, error), end; error.value() == 0 && file != end; file.increment(error))
+    {
+        if (file->path().extension() == ".as")
+        {
+            std::error_code removeError;
+            std::filesystem::remove(file->path(), removeError);
+        }
+    }
+
+    m_entries.clear();
+    m_indexDirty = true;
+    m_stats.invalidations++;
+}
+
+size_t BLASCache::GetEntryCount() const
+{
+    return m_entries.size();
+}
+
+uint64_t BLASCache::GetDeviceKey() const
+{
+    return m_deviceKey;
+}
+
+const BLASCacheStats& BLASCache::GetStats() const
+{
+    return m_stats;
+}
+
+std::string BLASCache::EntryPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.as", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+std::string BLASCache::IndexPath() const
+{
+    return (std::filesystem::path(m_directory) / "index.bin").string();
+}
+
+bool BLASCache::ReadIndex()
+{
+    std::ifstream file(IndexPath(), std::ios::binary);
+    IndexHeader   header = {};
+    if (file.is_open() == false || ReadValue(file, header) == false ||
+        header.magic         != IndexMagic    ||
+        header.formatVersion != FormatVersion ||
+        header.deviceKey     != m_deviceKey)
+    {
+        return false;
+    }
+
+    for (uint64_t entryIndex = 0; entryIndex < header.entryCount; entryIndex++)
+    {
+        IndexEntry entry = {};
+        if (ReadValue(file, entry) == false)
+        {
+            m_entries.clear();
+            return false;
+        }
+        m_entries[entry.key] = Entry{entry.payloadSize, entry.payloadHash};
+    }
+    return true;
+}
+
+void BLASCache::DropEntry(uint64_t key)
+{
+    std::error_code error;
+    std::filesystem::remove(EntryPath(key), error);
+    m_entries.erase(key);
+    m_indexDirty = true;
+    m_stats.entriesDropped++;
+}
@@ -1,17 +1,24 @@
 #include "BufferSuballocator.h"
+#include <algorithm>
+#include <cassert>
 
 BufferSuballocator::BufferSuballocator(ID3D12Device*         device,
                                        uint32_t              bufferSizeInBytes,
                                        D3D12_RESOURCE_STATES resourceState,
-                                       D3D12_HEAP_TYPE       heapType)
+                                       D3D12_HEAP_TYPE       heapType,
+                                       uint32_t              minimumAlignmentInBytes)
 {
     m_suballocationAlignmentMemorySavings = 0;
     m_memoryBlockSize                     = bufferSizeInBytes;
+    m_minimumAlignment                    = minimumAlignmentInBytes;
+    m_liveBlockCount                      = 0;
+    m_allocationCount                     = 0;
+    m_freeCount                           = 0;
     m_resourceState                       = resourceState;
     m_heapType                            = heapType;
 }
 
-SuballocatorBlock BufferSuballocator::CreateSuballocatorBlock(ID3D12Device* device,
+uint32_t BufferSuballocator::CreateSuballocatorBlock(ID3D12Device* device,
                                                               uint32_t      bufferSizeInBytes)
 {
     UINT64 blockAllocationInBytes = bufferSizeInBytes;
@@ -20,6 +27,13 @@ SuballocatorBlock BufferSuballocator::CreateSuballocatorBlock(ID3D12Device* devi
         blockAllocationInBytes = m_memoryBlockSize;
     }
 
+    // Reuse the slot of a released block before growing the list, handles have 16 bits for it
+    const uint32_t blockIndex = m_handles.AddBlock();
+    if (blockIndex == SuballocationHandleTable::InvalidBlock)
+    {
+        return SuballocationHandleTable::InvalidBlock;
+    }
+
     D3D12_RESOURCE_DESC desc = {};
     desc.Dimension           = D3D12_RESOURCE_DIMENSION_BUFFER;
     desc.Alignment           = 0;
@@ -55,14 +69,39 @@ SuballocatorBlock BufferSuballocator::CreateSuballocatorBlock(ID3D12Device* devi
                                     m_resourceState,
                                     nullptr,
                                     IID_PPV_ARGS(&buffer));
+    if (buffer == nullptr)
+    {
+        m_handles.RemoveBlock(blockIndex);
+        return SuballocationHandleTable::InvalidBlock;
+    }
 
     SuballocatorBlock suballocatorBlock   = {};
     suballocatorBlock.suballocatingBuffer = buffer;
-    suballocatorBlock.currentOffset       = 0;
-    suballocatorBlock.memoryBlockSize     = blockAllocationInBytes;
-    suballocatorBlock.totalAllocations    = 0;
+    suballocatorBlock.allocator           = TLSFAllocator(static_cast<uint32_t>(blockAllocationInBytes), m_minimumAlignment);
+    suballocatorBlock.memoryBlockSize     = static_cast<uint32_t>(blockAllocationInBytes);
+
+    if (blockIndex < m_blocks.size())
+    {
+        m_blocks[blockIndex] = std::move(suballocatorBlock);
+    }
+    else
+    {
+        m_blocks.push_back(std::move(suballocatorBlock));
+    }
+    m_liveBlockCount++;
+    m_freeBlocks.Update(blockIndex, m_blocks[blockIndex].allocator);
 
-    return suballocatorBlock;
+    return blockIndex;
+}
+
+void BufferSuballocator::ReleaseSuballocatorBlock(uint32_t blockIndex)
+{
+    SuballocatorBlock& suballocatorBlock = m_blocks[blockIndex];
+    suballocatorBlock.suballocatingBuffer->Release();
+    suballocatorBlock = {};
+    m_freeBlocks.Remove(blockIndex);
+    m_handles.RemoveBlock(blockIndex);
+    m_liveBlockCount--;
 }
 
 Suballocation BufferSuballocator::CreateSubAllocation(ID3D12Device* device,
@@ -71,165 +110,162 @@ Suballocation BufferSuballocator::CreateSubAllocation(ID3D12Device* device,
 {
     const uint32_t sizeInBytes = ((suballocationSizeInBytes + (memoryAlignmentInBytes - 1)) &
                                  ~(memoryAlignmentInBytes - 1));
-    if (m_blocks.size() == 0)
-    {
-        UINT64 blockAllocationInBytes = m_memoryBlockSize;
-        if (sizeInBytes > blockAllocationInBytes)
-        {
-            blockAllocationInBytes = sizeInBytes;
-        }
-        m_blocks.push_back(CreateSuballocatorBlock(device, blockAllocationInBytes));
-    }
 
-    Suballocation  subAllocationBuffer = {};
-    uint32_t       numSuballocators    = m_blocks.size();
+    TLSFAllocator::Allocation allocation = {0, 0, TLSFAllocator::InvalidNode};
+    uint32_t                  fitBin, exactBin;
+    TLSFAllocator::GetRequestBins(sizeInBytes, memoryAlignmentInBytes, m_minimumAlignment, fitBin, exactBin);
 
-    for (uint32_t subAllocatorIndex = 0; subAllocatorIndex < numSuballocators; subAllocatorIndex++)
+    // Any block filed at or above the rounded bin takes the request, so the block count doesn't
+    // matter.  The blocks filed in the request's own bin might still fit it, they are only asked
+    // once nothing larger is free the way the allocator falls back inside a block.
+    uint32_t blockIndex = m_freeBlocks.FindBlock(fitBin);
+    if (blockIndex != TLSFBlockIndex::InvalidBlock)
     {
-        bool                                nextSuballocatorResource     = false;
-        SuballocatorBlock&                  suballocatorBlock            = m_blocks[subAllocatorIndex];
-        bool                                foundFreeSuballocation       = false;
-        std::vector<FreeMemChunk>::iterator minUnusedMemoryIter          = suballocatorBlock.freeList.end();
-        std::vector<FreeMemChunk>::iterator freeSuballocationIter        = suballocatorBlock.freeList.begin();
-        uint32_t                            minUnusedMemorySuballocation = UINT_MAX;
-
-        while (freeSuballocationIter != suballocatorBlock.freeList.end())
+        allocation = m_blocks[blockIndex].allocator.Allocate(sizeInBytes, memoryAlignmentInBytes);
+        assert(allocation.node != TLSFAllocator::InvalidNode);
+    }
+    else
+    {
+        for (blockIndex = m_freeBlocks.GetFirstInBin(exactBin); blockIndex != TLSFBlockIndex::InvalidBlock;
+             blockIndex = m_freeBlocks.GetNextInBin(blockIndex))
         {
-            if (sizeInBytes <= freeSuballocationIter->size)
+            allocation = m_blocks[blockIndex].allocator.Allocate(sizeInBytes, memoryAlignmentInBytes);
+            if (allocation.node != TLSFAllocator::InvalidNode)
             {
-                // Attempt to find the exact fit and if not fallback to the least wasted unused
-                // memory
-                if (freeSuballocationIter->size - sizeInBytes == 0)
-                {
-                    // Keep previous allocation size
-                    subAllocationBuffer.alignedBufferSizeInBytes = freeSuballocationIter->size;
-                    subAllocationBuffer.parentResourceOffset     = freeSuballocationIter->offset;
-                    foundFreeSuballocation                       = true;
-
-                    // Remove from the list
-                    suballocatorBlock.freeList.erase(freeSuballocationIter);
-                    suballocatorBlock.totalAllocations++;
-                    break;
-                }
-                else
-                {
-                    const uint32_t unusedMemory = freeSuballocationIter->size - sizeInBytes;
-                    if (unusedMemory < minUnusedMemorySuballocation)
-                    {
-                        minUnusedMemoryIter          = freeSuballocationIter;
-                        minUnusedMemorySuballocation = unusedMemory;
-                    }
-                }
+                break;
             }
-            freeSuballocationIter++;
         }
+    }
 
-        // No perfect memory matches
-        if (!foundFreeSuballocation)
+    // If none of the suballocators have a fit then create a new one
+    if (allocation.node == TLSFAllocator::InvalidNode)
+    {
+        // If suballocation block size is too small then do custom allocation of
+        // individual blocks that match the resources size
+        if (sizeInBytes > m_memoryBlockSize)
         {
-            // Didn't find a perfect equivalent memory candidate but take the best fit
-            if (minUnusedMemoryIter != suballocatorBlock.freeList.end())
-            {
-                // Keep previous allocation size
-                subAllocationBuffer.alignedBufferSizeInBytes = minUnusedMemoryIter->size;
-                subAllocationBuffer.parentResourceOffset     = minUnusedMemoryIter->offset;
-                foundFreeSuballocation                       = true;
-
-                // Remove from the list
-                suballocatorBlock.freeList.erase(minUnusedMemoryIter);
-                suballocatorBlock.totalAllocations++;
-            }
-            else
-            {
-                const uint32_t offsetInBytes = suballocatorBlock.currentOffset + sizeInBytes;
-
-                if (offsetInBytes <= suballocatorBlock.memoryBlockSize)
-                {
-                    // Only ever change the memory size if this is a new allocation
-                    subAllocationBuffer.alignedBufferSizeInBytes = sizeInBytes;
-                    subAllocationBuffer.parentResourceOffset     = suballocatorBlock.currentOffset;
-                    suballocatorBlock.currentOffset              = offsetInBytes;
-                    suballocatorBlock.totalAllocations++;
-                }
-                else
-                {
-                    // If none of the suballocators have a fit then create a new one
-                    if (subAllocatorIndex == numSuballocators - 1)
-                    {
-                        // If suballocation block size is too small then do custom allocation of
-                        // individual blocks that match the resources size
-                        if ((sizeInBytes > m_memoryBlockSize))
-                        {
-                            m_blocks.push_back(CreateSuballocatorBlock(device, sizeInBytes));
-                        }
-                        else
-                        {
-                            m_blocks.push_back(CreateSuballocatorBlock(device));
-                        }
-                        numSuballocators++;
-                    }
-                    nextSuballocatorResource = true;
-                }
-            }
+            blockIndex = CreateSuballocatorBlock(device, sizeInBytes);
         }
-
-        if (!nextSuballocatorResource)
+        else
         {
-            const uint32_t memoryAlignedSize = ((subAllocationBuffer.alignedBufferSizeInBytes + (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)) &
-                                                ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1));
-            m_suballocationAlignmentMemorySavings += (memoryAlignedSize - subAllocationBuffer.alignedBufferSizeInBytes);
-
-            subAllocationBuffer.parentResource = suballocatorBlock.suballocatingBuffer;
-            break;
+            blockIndex = CreateSuballocatorBlock(device);
         }
+        if (blockIndex == SuballocationHandleTable::InvalidBlock)
+        {
+            return Suballocation{};
+        }
+        allocation = m_blocks[blockIndex].allocator.Allocate(sizeInBytes, memoryAlignmentInBytes);
+    }
+    m_freeBlocks.Update(blockIndex, m_blocks[blockIndex].allocator);
+
+    return CreateHandle(blockIndex, allocation);
+}
+
+Suballocation BufferSuballocator::CreateSubAllocationInBlock(uint32_t blockIndex,
+                                                             uint32_t suballocationSizeInBytes,
+                                                             uint32_t memoryAlignmentInBytes)
+{
+    const uint32_t sizeInBytes = ((suballocationSizeInBytes + (memoryAlignmentInBytes - 1)) &
+                                 ~(memoryAlignmentInBytes - 1));
+
+    if (blockIndex >= m_blocks.size() || m_blocks[blockIndex].suballocatingBuffer == nullptr)
+    {
+        return Suballocation{};
     }
 
-    return subAllocationBuffer;
+    TLSFAllocator::Allocation allocation = m_blocks[blockIndex].allocator.Allocate(sizeInBytes, memoryAlignmentInBytes);
+    if (allocation.node == TLSFAllocator::InvalidNode)
+    {
+        return Suballocation{};
+    }
+    m_freeBlocks.Update(blockIndex, m_blocks[blockIndex].allocator);
+    return CreateHandle(blockIndex, allocation);
+}
+
+Suballocation BufferSuballocator::CreateHandle(uint32_t blockIndex, const TLSFAllocator::Allocation& allocation)
+{
+    SuballocatorBlock& suballocatorBlock = m_blocks[blockIndex];
+
+    Suballocation suballocation = {};
+    suballocation.handle        = m_handles.Issue(blockIndex, allocation.node);
+    suballocation.gpuVA         = suballocatorBlock.suballocatingBuffer->GetGPUVirtualAddress() +
+                                  static_cast<D3D12_GPU_VIRTUAL_ADDRESS>(allocation.offset);
+
+    const uint32_t memoryAlignedSize = ((allocation.size + (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)) &
+                                        ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1));
+    m_suballocationAlignmentMemorySavings += (memoryAlignedSize - allocation.size);
+    m_allocationCount++;
+
+    return suballocation;
 }
 
 void BufferSuballocator::FreeSubAllocation(Suballocation& suballocation)
 {
-    uint32_t blockIndex = 0;
-    for (SuballocatorBlock& suballocatorBlock : m_blocks)
+    // Freeing clears the caller's copy so a repeat through the same suballocation is a no op,
+    // anything else that isn't live is a double free through a stale copy of the handle
+    if (suballocation.handle.IsNull())
     {
-        if (suballocatorBlock.suballocatingBuffer == suballocation.parentResource)
-        {
-            // Release the big chunks that are a single resource
-            if (suballocation.alignedBufferSizeInBytes == suballocatorBlock.memoryBlockSize)
-            {
-                suballocatorBlock.suballocatingBuffer->Release();
-                m_blocks.erase(m_blocks.begin() + blockIndex);
-                suballocation.parentResource = nullptr;
-            }
-            else
-            {
-                struct FreeMemChunk freeSuballocation = {suballocation.parentResourceOffset,
-                                                         suballocation.alignedBufferSizeInBytes};
-                suballocatorBlock.freeList.push_back(freeSuballocation);
+        return;
+    }
+    const bool retired = m_handles.Retire(suballocation.handle);
+    assert(retired);
+    if (retired == false)
+    {
+        return;
+    }
 
-                suballocatorBlock.totalAllocations--;
+    const uint32_t     blockIndex        = suballocation.handle.GetBlockIndex();
+    const uint32_t     node              = suballocation.handle.GetNode();
+    SuballocatorBlock& suballocatorBlock = m_blocks[blockIndex];
+    const uint32_t     sizeInBytes       = suballocatorBlock.allocator.GetNodeSize(node);
 
-                // If this suballocation was the final remaining allocation then release the suballocator block
-                // but only if there is more than one block
-                if (suballocatorBlock.totalAllocations == 0 &&
-                    m_blocks.size() > 1)
-                {
-                    suballocatorBlock.suballocatingBuffer->Release();
-                    m_blocks.erase(m_blocks.begin() + blockIndex);
-                }
+    // Neighbouring free ranges merge back together inside the allocator
+    suballocatorBlock.allocator.Free(node);
 
-                suballocation.parentResource = nullptr;
+    const uint32_t memoryAlignedSize = ((sizeInBytes + (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)) &
+                                        ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1));
+    m_suballocationAlignmentMemorySavings -= (memoryAlignedSize - sizeInBytes);
+    m_freeCount++;
 
-            }
-            const uint32_t memoryAlignedSize = ((suballocation.alignedBufferSizeInBytes + (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1)) &
-                                                   ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1));
-            m_suballocationAlignmentMemorySavings -= (memoryAlignedSize - suballocation.alignedBufferSizeInBytes);
+    // Release the big chunks that are a single resource and any block left empty as long
+    // as it isn't the final one
+    if (suballocatorBlock.allocator.GetAllocationCount() == 0 &&
+        (m_liveBlockCount > 1 || suballocatorBlock.memoryBlockSize > m_memoryBlockSize))
+    {
+        ReleaseSuballocatorBlock(blockIndex);
+    }
+    else
+    {
+        m_freeBlocks.Update(blockIndex, suballocatorBlock.allocator);
+    }
 
-            break;
-        }
+    suballocation = {};
+}
 
-        blockIndex++;
+bool BufferSuballocator::IsLive(SuballocationHandle handle) const
+{
+    return m_handles.IsLive(handle);
+}
+
+ID3D12Resource* BufferSuballocator::GetResource(SuballocationHandle handle) const
+{
+    assert(IsLive(handle));
+    return m_blocks[handle.GetBlockIndex()].suballocatingBuffer;
+}
+
+uint32_t BufferSuballocator::GetOffset(SuballocationHandle handle) const
+{
+    assert(IsLive(handle));
+    return m_blocks[handle.GetBlockIndex()].allocator.GetNodeOffset(handle.GetNode());
+}
+
+uint32_t BufferSuballocator::GetSize(SuballocationHandle handle) const
+{
+    if (IsLive(handle) == false)
+    {
+        return 0;
     }
+    return m_blocks[handle.GetBlockIndex()].allocator.GetNodeSize(handle.GetNode());
 }
 
 std::vector<SuballocatorBlock>& BufferSuballocator::GetSuballocators()
@@ -237,6 +273,15 @@ std::vector<SuballocatorBlock>& BufferSuballocator::GetSuballocators()
     return m_blocks;
 }
 
+void BufferSuballocator::GetBlockAllocators(std::vector<const TLSFAllocator*>& allocators) const
+{
+    allocators.resize(m_blocks.size());
+    for (uint32_t blockIndex = 0; blockIndex < m_blocks.size(); blockIndex++)
+    {
+        allocators[blockIndex] = m_blocks[blockIndex].suballocatingBuffer != nullptr ? &m_blocks[blockIndex].allocator : nullptr;
+    }
+}
+
 uint32_t BufferSuballocator::GetSuballocatorSize()
 {
     uint32_t residentMemoryInBytes = 0;
@@ -249,18 +294,38 @@ uint32_t BufferSuballocator::GetSuballocatorSize()
 
 uint32_t BufferSuballocator::GetFreeSuballocationsSize()
 {
-    uint32_t releasedSuballocationMemoryNotInUse = 0;
+    uint32_t suballocationMemoryNotInUse = 0;
     for (SuballocatorBlock& suballocatorBlock : m_blocks)
     {
-        for (auto& freeSuballocation : suballocatorBlock.freeList)
-        {
-            releasedSuballocationMemoryNotInUse += freeSuballocation.size;
-        }
+        suballocationMemoryNotInUse += suballocatorBlock.allocator.GetFreeSize();
     }
-    return releasedSuballocationMemoryNotInUse;
+    return suballocationMemoryNotInUse;
 }
 
 uint32_t BufferSuballocator::GetAlignmentSavingSize()
 {
     return m_suballocationAlignmentMemorySavings;
-}
\ No newline at end of file
+}
+
+void BufferSuballocator::GetTelemetry(PoolTelemetry& telemetry) const
+{
+    uint64_t freeBytes = 0;
+    telemetry          = {};
+    for (const SuballocatorBlock& suballocatorBlock : m_blocks)
+    {
+        if (suballocatorBlock.suballocatingBuffer == nullptr)
+        {
+            continue;
+        }
+        telemetry.blockCount++;
+        telemetry.residentBytes    += suballocatorBlock.memoryBlockSize;
+        telemetry.usedBytes        += suballocatorBlock.allocator.GetUsedSize();
+        telemetry.liveAllocations  += suballocatorBlock.allocator.GetAllocationCount();
+        telemetry.largestFreeRange  = std::max<uint64_t>(telemetry.largestFreeRange, suballocatorBlock.allocator.GetLargestFreeRange());
+        freeBytes                  += suballocatorBlock.allocator.GetFreeSize();
+    }
+    telemetry.fragmentation       = freeBytes > 0 ? 1.0f - static_cast<float>(telemetry.largestFreeRange) / freeBytes : 0.0f;
+    telemetry.alignmentSavedBytes = m_suballocationAlignmentMemorySavings;
+    telemetry.allocations         = m_allocationCount;
+    telemetry.frees               = m_freeCount;
+}
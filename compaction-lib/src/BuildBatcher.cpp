@@ -0,0 +1,114 @@
+#include "BuildBatcher.h"
+#include <algorithm>
+
+BuildBatcher::BuildBatcher(uint64_t smallestClassBytes,
+                           uint32_t classCount,
+                           uint32_t classRatioLog2,
+                           uint32_t alignmentInBytes)
+{
+    m_smallestClassBytes = smallestClassBytes;
+    m_classCount         = std::max(classCount, 1u);
+    m_classRatioLog2     = classRatioLog2;
+    m_alignment          = alignmentInBytes;
+}
+
+void BuildBatcher::Plan(const PendingBuild*      builds,
+                        uint32_t                 buildCount,
+                        uint64_t                 maxConcurrentScratchBytes,
+                        std::vector<uint32_t>&   order,
+                        std::vector<BuildBatch>& batches) const
+{
+    order.clear();
+    batches.clear();
+
+    std::vector<std::vector<uint32_t>> classes(m_classCount);
+    for (uint32_t build = 0; build < buildCount; build++)
+    {
+        classes[SizeClass(builds[build].resultSizeInBytes)].push_back(build);
+    }
+
+    // Scratch bytes of the run the next batch would join
+    uint64_t runBytes = 0;
+
+    struct Bin
+    {
+        uint64_t              scratchBytes;
+        uint64_t              resultBytes;
+        std::vector<uint32_t> builds;
+    };
+    std::vector<Bin> bins;
+
+    // Big builds take longest on the GPU, they go first so small ones fill in behind them
+    for (uint32_t sizeClass = m_classCount; sizeClass-- > 0;)
+    {
+        std::vector<uint32_t>& members = classes[sizeClass];
+        if (members.empty())
+        {
+            continue;
+        }
+
+        // First fit decreasing, ties keep discovery order so the plan only depends on the input
+        std::stable_sort(members.begin(), members.end(), [&](uint32_t left, uint32_t right)
+        {
+            return builds[left].scratchSizeInBytes > builds[right].scratchSizeInBytes;
+        });
+        bins.clear();
+        for (uint32_t build : members)
+        {
+            const uint64_t scratch = AlignSize(builds[build].scratchSizeInBytes);
+
+            size_t bin = 0;
+            while (maxConcurrentScratchBytes > 0 && bin < bins.size() &&
+                   bins[bin].scratchBytes + scratch > maxConcurrentScratchBytes)
+            {
+                bin++;
+            }
+            if (bin == bins.size())
+            {
+                bins.push_back(Bin{});
+            }
+            bins[bin].scratchBytes += scratch;
+            bins[bin].resultBytes  += builds[build].resultSizeInBytes;
+            bins[bin].builds.push_back(build);
+        }
+
+        for (Bin& bin : bins)
+        {
+            BuildBatch batch    = {};
+            batch.first         = static_cast<uint32_t>(order.size());
+            batch.count         = static_cast<uint32_t>(bin.builds.size());
+            batch.sizeClass     = sizeClass;
+            batch.scratchBytes  = bin.scratchBytes;
+            batch.resultBytes   = bin.resultBytes;
+            batch.barrierBefore = maxConcurrentScratchBytes > 0 && runBytes > 0 &&
+                                  runBytes + bin.scratchBytes > maxConcurrentScratchBytes;
+            runBytes            = (batch.barrierBefore ? 0 : runBytes) + bin.scratchBytes;
+
+            std::sort(bin.builds.begin(), bin.builds.end());
+            order.insert(order.end(), bin.builds.begin(), bin.builds.end());
+            batches.push_back(batch);
+        }
+    }
+}
+
+uint32_t BuildBatcher::SizeClass(uint64_t resultSizeInBytes) const
+{
+    uint32_t sizeClass = 0;
+    uint64_t bound     = m_smallestClassBytes;
+    while (sizeClass + 1 < m_classCount && resultSizeInBytes > bound)
+    {
+        bound <<= m_classRatioLog2;
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+uint32_t BuildBatcher::GetClassCount() const
+{
+    return m_classCount;
+}
+
+uint64_t BuildBatcher::AlignSize(uint64_t sizeInBytes) const
+{
+    return (sizeInBytes + (m_alignment - 1)) & ~uint64_t(m_alignment - 1);
+}
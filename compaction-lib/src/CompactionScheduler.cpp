@@ -0,0 +1,82 @@
+#include "CompactionScheduler.h"
+#include <algorithm>
+
+CompactionScheduler::CompactionScheduler(const CompactionWeights& weights)
+{
+    m_weights = weights;
+}
+
+CompactionSchedule CompactionScheduler::Schedule(const std::vector<CompactionCandidate>& candidates,
+                                                 const CompactionBudgets&                budgets,
+                                                 uint64_t                                transientInFlight,
+                                                 uint64_t                                frameIndex) const
+{
+    CompactionSchedule schedule = {};
+    schedule.stats.readyCount   = static_cast<uint32_t>(candidates.size());
+
+    // Scores are computed once, ids break ties so the schedule doesn't depend on snapshot order
+    struct Ranked
+    {
+        float    score;
+        uint32_t index;
+    };
+    std::vector<Ranked> order(candidates.size());
+    uint64_t            scratchWaiting = 0;
+    for (uint32_t index = 0; index < candidates.size(); index++)
+    {
+        order[index]    = Ranked{Score(candidates[index], frameIndex), index};
+        scratchWaiting += candidates[index].scratchSizeInBytes;
+    }
+    std::sort(order.begin(), order.end(), [&](const Ranked& left, const Ranked& right)
+    {
+        if (left.score != right.score)
+        {
+            return left.score > right.score;
+        }
+        return candidates[left.index].id < candidates[right.index].id;
+    });
+
+    uint64_t transient = transientInFlight;
+    for (const Ranked& ranked : order)
+    {
+        const CompactionCandidate& candidate = candidates[ranked.index];
+        const uint64_t             size      = candidate.compactedSizeInBytes;
+
+        // An empty budget always takes one build, so a budget smaller than a single compacted
+        // structure can't stall compaction.  Smaller builds further down may still fit, so a build
+        // that doesn't is skipped rather than ending the frame.
+        const bool fitsTransient    = transient == 0 || transient + size <= budgets.transientBytes;
+        const bool fitsCopy         = schedule.stats.copyBytes == 0 || schedule.stats.copyBytes + size <= budgets.copyBytesPerFrame;
+        const bool scratchPressured = scratchWaiting > budgets.scratchBytes;
+        if (fitsTransient == false || (fitsCopy == false && scratchPressured == false))
+        {
+            const uint64_t age = frameIndex > candidate.frameIndexRequest ? frameIndex - candidate.frameIndexRequest : 0;
+            schedule.stats.oldestDeferredFrames = std::max(schedule.stats.oldestDeferredFrames, age);
+            continue;
+        }
+
+        schedule.ids.push_back(candidate.id);
+        transient                      += size;
+        scratchWaiting                 -= candidate.scratchSizeInBytes;
+        schedule.stats.copyBytes       += size;
+        schedule.stats.reclaimedBytes  += uint64_t(candidate.resultSizeInBytes) + candidate.scratchSizeInBytes -
+                                          std::min<uint64_t>(size, uint64_t(candidate.resultSizeInBytes) + candidate.scratchSizeInBytes);
+    }
+
+    schedule.stats.scheduledCount      = static_cast<uint32_t>(schedule.ids.size());
+    schedule.stats.deferredCount       = schedule.stats.readyCount - schedule.stats.scheduledCount;
+    schedule.stats.transientBytes      = transient;
+    schedule.stats.scratchWaitingBytes = scratchWaiting;
+    return schedule;
+}
+
+float CompactionScheduler::Score(const CompactionCandidate& candidate, uint64_t frameIndex) const
+{
+    const float compacted = static_cast<float>(std::max(candidate.compactedSizeInBytes, 1u));
+    const float freed     = static_cast<float>(candidate.resultSizeInBytes) + candidate.scratchSizeInBytes - compacted;
+    const float age       = frameIndex > candidate.frameIndexRequest ? static_cast<float>(frameIndex - candidate.frameIndexRequest) : 0.0f;
+
+    return m_weights.savings  * std::max(freed, 0.0f) / compacted +
+           m_weights.distance / (1.0f + std::max(candidate.distanceToCamera, 0.0f) / m_weights.distanceScale) +
+           m_weights.age      * age;
+}
@@ -0,0 +1,122 @@
+#include "CompactionSizeRing.h"
+
+CompactionSizeRing::CompactionSizeRing(uint32_t capacity)
+{
+    m_capacity  = capacity;
+    m_head      = 0;
+    m_usedSlots = 0;
+}
+
+uint32_t CompactionSizeRing::Allocate(uint32_t count, uint64_t frameIndex)
+{
+    if (count == 0 || count > m_capacity)
+    {
+        return InvalidSlot;
+    }
+
+    uint32_t firstSlot = InvalidSlot;
+    if (m_regions.empty())
+    {
+        firstSlot = 0;
+    }
+    else
+    {
+        const uint32_t tail = m_regions.front().firstSlot;
+        if (m_head > tail)
+        {
+            // Free space is the end of the ring and then its start up to the oldest run, a run
+            // that doesn't fit at the end skips the rest of it
+            if (m_capacity - m_head >= count)
+            {
+                firstSlot = m_head;
+            }
+            else if (tail >= count)
+            {
+                firstSlot = 0;
+            }
+        }
+        else if (tail - m_head >= count) // Head meets the oldest run when the ring is full
+        {
+            firstSlot = m_head;
+        }
+    }
+    if (firstSlot == InvalidSlot)
+    {
+        return InvalidSlot;
+    }
+
+    // Several batches in one frame extend the frame's run when they land right behind it
+    if (m_regions.empty() == false && m_regions.back().frameIndex == frameIndex &&
+        m_regions.back().firstSlot + m_regions.back().count == firstSlot)
+    {
+        m_regions.back().count += count;
+    }
+    else
+    {
+        m_regions.push_back(Region{firstSlot, count, frameIndex});
+    }
+
+    m_head       = firstSlot + count;
+    m_usedSlots += count;
+    if (m_head == m_capacity)
+    {
+        m_head = 0;
+    }
+    return firstSlot;
+}
+
+uint32_t CompactionSizeRing::GetCapacity() const
+{
+    return m_capacity;
+}
+
+uint32_t CompactionSizeRing::GetUsedSlots() const
+{
+    return m_usedSlots;
+}
+
+uint32_t CompactionSizeRing::GetRegionCount() const
+{
+    return static_cast<uint32_t>(m_regions.size());
+}
+
+bool CompactionSizeRing::Validate() const
+{
+    uint32_t usedSlots = 0;
+    bool     wrapped   = false;
+    for (size_t region = 0; region < m_regions.size(); region++)
+    {
+        const Region& current = m_regions[region];
+        if (current.count == 0 || current.firstSlot + current.count > m_capacity)
+        {
+            return false;
+        }
+        usedSlots += current.count;
+
+        if (region == 0)
+        {
+            continue;
+        }
+
+        // Runs follow each other in slot order, wrapping back to the start at most once and never
+        // reaching the oldest run again
+        const Region& previous = m_regions[region - 1];
+        if (current.frameIndex < previous.frameIndex)
+        {
+            return false;
+        }
+        if (current.firstSlot < previous.firstSlot + previous.count)
+        {
+            if (wrapped || current.firstSlot + current.count > m_regions.front().firstSlot)
+            {
+                return false;
+            }
+            wrapped = true;
+        }
+        else if (wrapped && current.firstSlot + current.count > m_regions.front().firstSlot)
+        {
+            return false;
+        }
+    }
+    return usedSlots == m_usedSlots;
+}
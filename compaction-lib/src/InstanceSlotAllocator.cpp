@@ -0,0 +1,154 @@
+#include "InstanceSlotAllocator.h"
+#include <cassert>
+
+InstanceSlotAllocator::InstanceSlotAllocator(float maxFreeFraction)
+{
+    m_slotCount       = 0;
+    m_liveCount       = 0;
+    m_generation      = 0;
+    m_maxFreeFraction = maxFreeFraction;
+}
+
+InstanceSlotHandle InstanceSlotAllocator::Allocate()
+{
+    uint32_t slot = m_slotCount;
+    if (m_freeSlots.empty() == false)
+    {
+        slot = *m_freeSlots.begin();
+        m_freeSlots.erase(m_freeSlots.begin());
+    }
+    else
+    {
+        m_slotCount++;
+        if (m_slotCount > m_generations.size())
+        {
+            m_generations.push_back(0);
+        }
+    }
+
+    const uint32_t generation = NextGeneration();
+    m_generations[slot]       = generation;
+    m_liveCount++;
+    return InstanceSlotHandle::Pack(slot, generation);
+}
+
+void InstanceSlotAllocator::Release(InstanceSlotHandle handle)
+{
+    if (handle.IsNull())
+    {
+        return;
+    }
+    assert(IsLive(handle));
+
+    const uint32_t slot = handle.GetSlot();
+    m_generations[slot] = 0;
+    m_liveCount--;
+
+    if (slot + 1 == m_slotCount)
+    {
+        m_slotCount--;
+        TrimFreeTail();
+    }
+    else
+    {
+        m_freeSlots.insert(slot);
+    }
+}
+
+bool InstanceSlotAllocator::IsLive(InstanceSlotHandle handle) const
+{
+    return handle.IsNull() == false && handle.GetSlot() < m_slotCount &&
+           m_generations[handle.GetSlot()] == handle.GetGeneration();
+}
+
+InstanceSlotHandle InstanceSlotAllocator::GetHandle(uint32_t slot) const
+{
+    if (slot >= m_slotCount || m_generations[slot] == 0)
+    {
+        return InstanceSlotHandle{0};
+    }
+    return InstanceSlotHandle::Pack(slot, m_generations[slot]);
+}
+
+void InstanceSlotAllocator::Compact(uint32_t maxMoves, std::vector<InstanceSlotMove>& moves)
+{
+    moves.clear();
+
+    const uint32_t freeCount = m_slotCount - m_liveCount;
+    if (freeCount == 0 || static_cast<float>(freeCount) <= m_maxFreeFraction * m_slotCount)
+    {
+        return;
+    }
+
+    // The active range always ends on a live slot, so the lowest free slot is below it
+    while (moves.size() < maxMoves && m_freeSlots.empty() == false)
+    {
+        const uint32_t from = m_slotCount - 1;
+        const uint32_t to   = *m_freeSlots.begin();
+        m_freeSlots.erase(m_freeSlots.begin());
+
+        const uint32_t generation = NextGeneration();
+        m_generations[to]         = generation;
+        m_generations[from]       = 0;
+        m_slotCount--;
+        TrimFreeTail();
+
+        moves.push_back(InstanceSlotMove{from, to, InstanceSlotHandle::Pack(to, generation)});
+    }
+}
+
+uint32_t InstanceSlotAllocator::GetSlotCount() const
+{
+    return m_slotCount;
+}
+
+uint32_t InstanceSlotAllocator::GetLiveCount() const
+{
+    return m_liveCount;
+}
+
+bool InstanceSlotAllocator::Validate() const
+{
+    if (m_slotCount > 0 && m_generations[m_slotCount - 1] == 0)
+    {
+        return false;
+    }
+    if (m_freeSlots.size() != m_slotCount - m_liveCount)
+    {
+        return false;
+    }
+    for (uint32_t slot : m_freeSlots)
+    {
+        if (slot >= m_slotCount || m_generations[slot] != 0)
+        {
+            return false;
+        }
+    }
+
+    uint32_t liveCount = 0;
+    for (uint32_t slot = 0; slot < m_slotCount; slot++)
+    {
+        liveCount += m_generations[slot] != 0 ? 1 : 0;
+    }
+    return liveCount == m_liveCount;
+}
+
+uint32_t InstanceSlotAllocator::NextGeneration()
+{
+    // Zero marks free slots and null handles
+    m_generation++;
+    if (m_generation == 0)
+    {
+        m_generation++;
+    }
+    return m_generation;
+}
+
+void InstanceSlotAllocator::TrimFreeTail()
+{
+    while (m_slotCount > 0 && m_generations[m_slotCount - 1] == 0)
+    {
+        m_freeSlots.erase(m_slotCount - 1);
+        m_slotCount--;
+    }
+}
@@ -0,0 +1,102 @@
+#include "InstanceUploadTracker.h"
+
+InstanceUploadTracker::InstanceUploadTracker(uint32_t mergeGapSlots)
+{
+    m_frame        = 0;
+    m_slotCount    = 0;
+    m_changedCount = 0;
+    m_mergeGap     = mergeGapSlots;
+}
+
+void InstanceUploadTracker::BeginFrame(uint32_t slotCount)
+{
+    m_frame++;
+    m_changedCount = 0;
+
+    if (slotCount > m_owners.size())
+    {
+        m_owners.resize(slotCount);
+        m_generations.resize(slotCount);
+        m_changedFrames.resize(slotCount);
+    }
+
+    // Slots coming back into use hold nothing a buffer can rely on
+    for (uint32_t slot = m_slotCount; slot < slotCount; slot++)
+    {
+        m_owners[slot]        = nullptr;
+        m_generations[slot]   = 0;
+        m_changedFrames[slot] = m_frame;
+        m_changedCount++;
+    }
+    m_slotCount = slotCount;
+}
+
+bool InstanceUploadTracker::Track(uint32_t slot, const void* owner, uint32_t generation)
+{
+    if (m_owners[slot] == owner && m_generations[slot] == generation)
+    {
+        return false;
+    }
+    m_owners[slot]      = owner;
+    m_generations[slot] = generation;
+    Invalidate(slot);
+    return true;
+}
+
+void InstanceUploadTracker::Invalidate(uint32_t slot)
+{
+    if (m_changedFrames[slot] != m_frame)
+    {
+        m_changedFrames[slot] = m_frame;
+        m_changedCount++;
+    }
+}
+
+void InstanceUploadTracker::CollectRanges(uint64_t                sinceFrame,
+                                          uint32_t                trailingFrames,
+                                          std::vector<SlotRange>& ranges) const
+{
+    ranges.clear();
+    for (uint32_t slot = 0; slot < m_slotCount; slot++)
+    {
+        if (m_changedFrames[slot] + trailingFrames <= sinceFrame)
+        {
+            continue;
+        }
+
+        // Copying a few unchanged slots is cheaper than another copy call
+        if (ranges.empty() == false && slot - (ranges.back().first + ranges.back().count) <= m_mergeGap)
+        {
+            ranges.back().count = slot - ranges.back().first + 1;
+        }
+        else
+        {
+            ranges.push_back(SlotRange{slot, 1});
+        }
+    }
+}
+
+uint64_t InstanceUploadTracker::GetFrame() const
+{
+    return m_frame;
+}
+
+uint32_t InstanceUploadTracker::GetSlotCount() const
+{
+    return m_slotCount;
+}
+
+uint32_t InstanceUploadTracker::GetChangedCount() const
+{
+    return m_changedCount;
+}
+
+uint64_t InstanceUploadTracker::CountSlots(const std::vector<SlotRange>& ranges)
+{
+    uint64_t slots = 0;
+    for (const SlotRange& range : ranges)
+    {
+        slots += range.count;
+    }
+    return slots;
+}
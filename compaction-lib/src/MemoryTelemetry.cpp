@@ -0,0 +1,161 @@
+#include "MemoryTelemetry.h"
+#include <cinttypes>
+#include <cstdarg>
+
+namespace
+{
+    // Appends to buffer and advances used, a line that overflows comes out as zero length
+    void Append(char* buffer, size_t bufferSize, size_t& used, const char* format, ...)
+    {
+        if (used >= bufferSize)
+        {
+            return;
+        }
+        va_list arguments;
+        va_start(arguments, format);
+        int written = vsnprintf(buffer + used, bufferSize - used, format, arguments);
+        va_end(arguments);
+        used = (written < 0) ? bufferSize : used + static_cast<size_t>(written);
+    }
+
+    void AppendPoolHeader(char* buffer, size_t bufferSize, size_t& used, const char* pool)
+    {
+        const char* fields[] = {"resident_bytes", "used_bytes", "largest_free_range", "alignment_saved_bytes",
+                                "blocks", "live_allocations", "fragmentation", "allocations", "frees",
+                                "frame_allocations", "frame_frees"};
+        for (const char* field : fields)
+        {
+            Append(buffer, bufferSize, used, ",%s_%s", pool, field);
+        }
+    }
+
+    void AppendPool(char* buffer, size_t bufferSize, size_t& used, MemoryTelemetryFormat format, const char* pool, const PoolTelemetry& telemetry)
+    {
+        if (format == MemoryTelemetryFormat::CSV)
+        {
+            Append(buffer, bufferSize, used, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u,%u,%.4f,%" PRIu64 ",%" PRIu64 ",%u,%u",
+                   telemetry.residentBytes, telemetry.usedBytes, telemetry.largestFreeRange, telemetry.alignmentSavedBytes,
+                   telemetry.blockCount, telemetry.liveAllocations, telemetry.fragmentation, telemetry.allocations,
+                   telemetry.frees, telemetry.frameAllocations, telemetry.frameFrees);
+        }
+        else
+        {
+            Append(buffer, bufferSize, used,
+                   ",\"%s\":{\"resident_bytes\":%" PRIu64 ",\"used_bytes\":%" PRIu64 ",\"largest_free_range\":%" PRIu64
+                   ",\"alignment_saved_bytes\":%" PRIu64 ",\"blocks\":%u,\"live_allocations\":%u,\"fragmentation\":%.4f"
+                   ",\"allocations\":%" PRIu64 ",\"frees\":%" PRIu64 ",\"frame_allocations\":%u,\"frame_frees\":%u}",
+                   pool, telemetry.residentBytes, telemetry.usedBytes, telemetry.largestFreeRange, telemetry.alignmentSavedBytes,
+                   telemetry.blockCount, telemetry.liveAllocations, telemetry.fragmentation, telemetry.allocations,
+                   telemetry.frees, telemetry.frameAllocations, telemetry.frameFrees);
+        }
+    }
+}
+
+MemoryTelemetryWriter::MemoryTelemetryWriter()
+{
+    m_file   = nullptr;
+    m_format = MemoryTelemetryFormat::CSV;
+    m_failed = false;
+}
+
+MemoryTelemetryWriter::~MemoryTelemetryWriter()
+{
+    Close();
+}
+
+bool MemoryTelemetryWriter::Open(const char* path, MemoryTelemetryFormat format)
+{
+    Close();
+    m_file = fopen(path, "wb");
+    if (m_file == nullptr)
+    {
+        return false;
+    }
+    m_format = format;
+    m_failed = false;
+
+    const size_t length = FormatHeader(format, m_line, LineSize);
+    if (length > 0 && fwrite(m_line, 1, length, m_file) != length)
+    {
+        m_failed = true;
+    }
+    return m_failed == false;
+}
+
+void MemoryTelemetryWriter::Close()
+{
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool MemoryTelemetryWriter::IsOpen() const
+{
+    return m_file != nullptr;
+}
+
+bool MemoryTelemetryWriter::Write(const MemoryTelemetry& telemetry)
+{
+    if (m_file == nullptr || m_failed)
+    {
+        return false;
+    }
+    const size_t length = Format(telemetry, m_format, m_line, LineSize);
+    if (length == 0 || fwrite(m_line, 1, length, m_file) != length)
+    {
+        m_failed = true;
+    }
+    return m_failed == false;
+}
+
+size_t MemoryTelemetryWriter::FormatHeader(MemoryTelemetryFormat format, char* buffer, size_t bufferSize)
+{
+    // JSON lines describe themselves
+    if (format == MemoryTelemetryFormat::JSON)
+    {
+        return 0;
+    }
+
+    size_t used = 0;
+    Append(buffer, bufferSize, used, "frame");
+    AppendPoolHeader(buffer, bufferSize, used, "result");
+    AppendPoolHeader(buffer, bufferSize, used, "compaction");
+    Append(buffer, bufferSize, used,
+           ",scratch_resident_bytes,scratch_frame_peak_bytes,uncompacted_bytes,compacted_bytes,compaction_saved_bytes"
+           ",compactions_pending,transient_bytes,frame_compaction_bytes,frame_defragmentation_bytes,frame_deserialization_bytes");
+    for (uint32_t bucket = 0; bucket < MemoryTelemetryHistogramBuckets; bucket++)
+    {
+        Append(buffer, bufferSize, used, ",moved_%u", bucket);
+    }
+    Append(buffer, bufferSize, used, "\n");
+    return used < bufferSize ? used : 0;
+}
+
+size_t MemoryTelemetryWriter::Format(const MemoryTelemetry& telemetry, MemoryTelemetryFormat format, char* buffer, size_t bufferSize)
+{
+    const bool csv  = format == MemoryTelemetryFormat::CSV;
+    size_t     used = 0;
+
+    Append(buffer, bufferSize, used, csv ? "%" PRIu64 : "{\"frame\":%" PRIu64, telemetry.frameIndex);
+    AppendPool(buffer, bufferSize, used, format, "result", telemetry.result);
+    AppendPool(buffer, bufferSize, used, format, "compaction", telemetry.compaction);
+    Append(buffer, bufferSize, used,
+           csv ? ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 :
+                 ",\"scratch_resident_bytes\":%" PRIu64 ",\"scratch_frame_peak_bytes\":%" PRIu64 ",\"uncompacted_bytes\":%" PRIu64
+                 ",\"compacted_bytes\":%" PRIu64 ",\"compaction_saved_bytes\":%" PRIu64 ",\"compactions_pending\":%u"
+                 ",\"transient_bytes\":%" PRIu64 ",\"frame_compaction_bytes\":%" PRIu64 ",\"frame_defragmentation_bytes\":%" PRIu64
+                 ",\"frame_deserialization_bytes\":%" PRIu64,
+           telemetry.scratchResidentBytes, telemetry.scratchFramePeakBytes, telemetry.uncompactedBytes, telemetry.compactedBytes,
+           telemetry.compactionSavedBytes, telemetry.compactionsPending, telemetry.transientBytes, telemetry.frameCompactionBytes,
+           telemetry.frameDefragmentationBytes, telemetry.frameDeserializationBytes);
+
+    Append(buffer, bufferSize, used, csv ? "" : ",\"moved_histogram\":[");
+    for (uint32_t bucket = 0; bucket < MemoryTelemetryHistogramBuckets; bucket++)
+    {
+        Append(buffer, bufferSize, used, (csv || bucket > 0) ? ",%u" : "%u", telemetry.bytesMovedHistogram[bucket]);
+    }
+    Append(buffer, bufferSize, used, csv ? "\n" : "]}\n");
+    return used < bufferSize ? used : 0;
+}
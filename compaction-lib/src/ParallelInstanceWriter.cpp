@@ -0,0 +1,69 @@
+#include "ParallelInstanceWriter.h"
+#include <algorithm>
+
+ParallelInstanceWriter::ChunkLane::ChunkLane(const SlotRange* chunks, InstanceChunkWriter* writer)
+{
+    m_chunks = chunks;
+    m_writer = writer;
+}
+
+void ParallelInstanceWriter::ChunkLane::RecordBarrier()
+{
+    // Chunks never wait on each other
+}
+
+void ParallelInstanceWriter::ChunkLane::RecordBuild(uint32_t chunkIndex)
+{
+    m_writer->WriteChunk(m_chunks[chunkIndex].first, m_chunks[chunkIndex].count);
+}
+
+ParallelInstanceWriter::ParallelInstanceWriter(uint32_t workerCount, uint32_t chunkSlots)
+    : m_recorder(workerCount)
+{
+    m_chunkSlots = std::max(chunkSlots, 1u);
+}
+
+void ParallelInstanceWriter::Write(const std::vector<SlotRange>& ranges, InstanceChunkWriter* writer)
+{
+    SplitChunks(ranges, m_chunkSlots, m_chunks);
+
+    const uint32_t chunkCount = static_cast<uint32_t>(m_chunks.size());
+    m_costs.resize(chunkCount);
+    m_barrierBefore.assign(chunkCount, 0);
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        m_costs[chunk] = m_chunks[chunk].count;
+    }
+
+    // A lane per thread, a single lane is written on the caller without waking the workers
+    const uint32_t laneCount = std::min(GetThreadCount(), chunkCount);
+    m_lanes.clear();
+    m_lanePointers.clear();
+    m_lanes.reserve(laneCount);
+    for (uint32_t lane = 0; lane < laneCount; lane++)
+    {
+        m_lanes.emplace_back(m_chunks.data(), writer);
+        m_lanePointers.push_back(&m_lanes.back());
+    }
+
+    m_recorder.Record(m_lanePointers.data(), laneCount, m_costs.data(), m_barrierBefore.data(), chunkCount);
+}
+
+uint32_t ParallelInstanceWriter::GetThreadCount() const
+{
+    return m_recorder.GetWorkerCount() + 1;
+}
+
+void ParallelInstanceWriter::SplitChunks(const std::vector<SlotRange>& ranges,
+                                         uint32_t                      chunkSlots,
+                                         std::vector<SlotRange>&       chunks)
+{
+    chunks.clear();
+    for (const SlotRange& range : ranges)
+    {
+        for (uint32_t offset = 0; offset < range.count; offset += chunkSlots)
+        {
+            chunks.push_back(SlotRange{range.first + offset, std::min(chunkSlots, range.count - offset)});
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include "ParallelRecorder.h"
+#include <algorithm>
+
+ParallelRecorder::ParallelRecorder(uint32_t workerCount)
+{
+    m_generation    = 0;
+    m_stop          = false;
+    m_lanes         = nullptr;
+    m_barrierBefore = nullptr;
+    m_laneCount     = 0;
+    m_nextLane      = 0;
+    m_lanesLeft     = 0;
+
+    for (uint32_t worker = 0; worker < workerCount; worker++)
+    {
+        m_workers.emplace_back(&ParallelRecorder::WorkerLoop, this);
+    }
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ParallelRecorder::Record(RecordingLane* const* lanes,
+                              uint32_t              laneCount,
+                              const uint64_t*       costs,
+                              const uint8_t*        barrierBefore,
+                              uint32_t              buildCount)
+{
+    if (laneCount == 0 || buildCount == 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_laneStarts.resize(laneCount + 1);
+    Split(costs, buildCount, laneCount, m_laneStarts.data());
+
+    m_lanes         = lanes;
+    m_barrierBefore = barrierBefore;
+    m_laneCount     = laneCount;
+    m_nextLane      = 0;
+    m_lanesLeft     = laneCount;
+    m_generation++;
+    lock.unlock();
+
+    if (m_workers.empty() == false && laneCount > 1)
+    {
+        m_wake.notify_all();
+    }
+
+    // The caller records lanes too instead of idling until the workers are done
+    while (RecordNextLane())
+    {
+    }
+
+    lock.lock();
+    m_done.wait(lock, [this] { return m_lanesLeft == 0; });
+    m_lanes         = nullptr;
+    m_barrierBefore = nullptr;
+}
+
+uint32_t ParallelRecorder::GetWorkerCount() const
+{
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+void ParallelRecorder::Split(const uint64_t* costs,
+                             uint32_t        buildCount,
+                             uint32_t        laneCount,
+                             uint32_t*       laneStarts)
+{
+    // Every build costs something to record even when its geometry is empty
+    uint64_t totalCost = 0;
+    for (uint32_t build = 0; build < buildCount; build++)
+    {
+        totalCost += std::max<uint64_t>(costs[build], 1);
+    }
+
+    // Lane l starts at the first build whose cost prefix reaches l / laneCount of the total
+    uint64_t prefixCost = 0;
+    uint32_t build      = 0;
+    laneStarts[0]       = 0;
+    for (uint32_t lane = 1; lane < laneCount; lane++)
+    {
+        const uint64_t target = totalCost / laneCount * lane + totalCost % laneCount * lane / laneCount;
+        while (build < buildCount && prefixCost < target)
+        {
+            prefixCost += std::max<uint64_t>(costs[build], 1);
+            build++;
+        }
+        laneStarts[lane] = build;
+    }
+    laneStarts[laneCount] = buildCount;
+}
+
+void ParallelRecorder::WorkerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+            if (m_stop)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+        while (RecordNextLane())
+        {
+        }
+    }
+}
+
+bool ParallelRecorder::RecordNextLane()
+{
+    uint32_t lane = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_nextLane >= m_laneCount || m_lanes == nullptr)
+        {
+            return false;
+        }
+        lane = m_nextLane++;
+    }
+
+    RecordingLane* const recorder = m_lanes[lane];
+    const uint32_t       start    = m_laneStarts[lane];
+    const uint32_t       end      = m_laneStarts[lane + 1];
+    for (uint32_t build = start; build < end; build++)
+    {
+        if (m_barrierBefore[build] != 0)
+        {
+            recorder->RecordBarrier();
+        }
+        recorder->RecordBuild(build);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_lanesLeft == 0)
+    {
+        m_done.notify_all();
+    }
+    return true;
+}
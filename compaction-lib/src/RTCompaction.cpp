@@ -1,22 +1,58 @@
 #include "RTCompaction.h"
+#include "ASDefragmenter.h"
+#include "BLASCache.h"
+#include "BuildBatcher.h"
+#include "CompactionSizeRing.h"
+#include "ParallelRecorder.h"
+#include "ScratchArena.h"
+#include <algorithm>
 #include <string>
+#include <thread>
 #include <queue>
+#include <unordered_map>
 #include <iostream>
 
 namespace RTCompaction
 {
     // Suballocation buffers
-    extern BufferSuballocator* _scratchPool;
     extern BufferSuballocator* _resultPool;
     extern BufferSuballocator* _compactionPool;
-    extern BufferSuballocator* _compactionSizeGpuPool;
-    extern BufferSuballocator* _compactionSizeCpuPool;
 
-    // Logger that gets cleared every call to NextFrame
+    // Build scratch, shared by the builds of a frame and reused once the frame executed
+    extern ScratchArenaBackend* _scratchArenaBackend;
+    extern ScratchArena*        _scratchArena;
+
+    // Records build batches across worker command lists, created by the first batch given some
+    extern ParallelRecorder* _parallelRecorder;
+
+    // Groups the builds of a call by size class into batches sharing scratch without a barrier
+    extern BuildBatcher _buildBatcher;
+    extern uint64_t     _buildBatchCount;
+
+    // Compacted size descriptors of every compacting build.  Builds write them into the gpu
+    // buffer, one copy per batch moves the batch's run of slots over to the readback buffer which
+    // stays mapped for the library's lifetime, and the sizes of a frame are read in one pass once
+    // that frame has executed.
+    extern CompactionSizeRing*     _compactionSizeRing;
+    extern ID3D12Resource*         _compactionSizeGpuBuffer;
+    extern ID3D12Resource*         _compactionSizeReadbackBuffer;
+    extern const uint64_t*         _compactionSizeReadback;
+    extern std::vector<ASBuffers*> _compactionSizeOwners;   // Build waiting on each slot, null once released
+    extern uint64_t                _compactionSizeOverflows; // Builds left uncompacted because the ring was full
+
+    // Logger that is rebuilt at most once per frame when the log is requested
     extern std::string _buildLogger;
+    extern uint64_t    _buildLoggerFrameIndex;
     extern uint32_t    _uncompactedMemory;
     extern uint32_t    _compactedMemory;
 
+    // Telemetry published at the end of every frame, the frame's copies accumulate in
+    // _frameTelemetry until then
+    extern MemoryTelemetry        _memoryTelemetry;
+    extern MemoryTelemetry        _frameTelemetry;
+    extern MemoryTelemetryWriter* _telemetryWriter;
+    extern uint64_t               _totalCompactionSavings; // Result bytes given back by compaction copies of live structures
+
     // Indicates to the library the command list latency for
     // finished execution of an acceleration structure build on the
     // original commmand buffer.  Typically an engine will have double
@@ -26,46 +62,341 @@ namespace RTCompaction
     extern uint32_t _commandListLatency;
     extern uint64_t _commandListIndex;
 
-    // The maximum amount of resident memory that can be used for compaction copies
-    // to reduce the overall memory occupancy of the result and compaction buffer
-    // both being transiently in memory.
-    extern uint32_t _maxTransientCompactionMemory;
+    // Budgets limiting how much compaction copies write per frame and how much memory is held by
+    // compacted copies whose result buffer isn't released yet, result and compaction buffer both
+    // being transiently in memory.
+    extern CompactionBudgets    _compactionBudgets;
+    extern CompactionScheduler  _compactionScheduler;
+    extern CompactionFrameStats _compactionStats;
+    extern uint64_t             _transientCompactionInFlight;
 
     // Every suballocator block gets allocated with a configurable size
     extern uint32_t _suballocationBlockSize;
 
-    // Limits the amount of transient compaction buffer memory
-    extern uint32_t _currentCompactionMemorySize;
+    // Builds waiting for compaction, the scheduler picks among those whose size has been read
+    extern std::vector<ASBuffers*> _compactionPending;
 
     // Queues used to manage compaction events
-    extern std::queue<ASBuffers*> _asBufferCompactionQueue;
     extern std::queue<ASBuffers*> _asBufferCompleteQueue;
     extern std::queue<ASBuffers*> _asBufferReleaseQueue;
 
     extern uint64_t _totalTriangles;
 
-    constexpr uint32_t SizeOfCompactionDescriptor           = sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC);
-    constexpr uint32_t CompactionSizeSuballocationBlockSize = 2097152;
+    // A compacted acceleration structure being moved by the defragmenter.  The clone copy was
+    // recorded on frameIndexRequest and the ASBuffers switch to the destination once it executed.
+    struct Relocation
+    {
+        ASBuffers*    buffers;
+        Suballocation destination;
+        uint64_t      frameIndexRequest;
+    };
+
+    // Ranges left behind by a relocation, frames recorded before the switch may still read them
+    struct RetiredSuballocation
+    {
+        Suballocation suballocation;
+        uint64_t      frameIndexRequest;
+    };
+
+    // Every live compacted acceleration structure, ASBuffers::compactedIndex points back in here
+    extern std::vector<ASBuffers*> _compactedBuffers;
+
+    // Plans the moves out of sparse compaction pool blocks, null when defragmentation is disabled
+    extern ASDefragmenter*                  _defragmenter;
+    extern std::vector<Relocation>          _pendingRelocations;
+    extern std::queue<RetiredSuballocation> _retiredCompactions;
+    extern uint64_t                         _totalDefragmentedMemory;
+
+    // Compacted acceleration structures on their way to the disk cache.  Serialized sizes are
+    // queried on the frame of the compaction copy, the serialization copies are recorded once the
+    // sizes are readable and the blobs are stored once those copies executed.
+    struct SerializationBatch
+    {
+        std::vector<ASBuffers*> buffers;        // Null once the acceleration structure is released
+        std::vector<uint64_t>   cacheKeys;
+        std::vector<uint64_t>   offsets;        // Blob offsets in the readback buffer, set when serialized
+        std::vector<uint64_t>   sizesInBytes;
+        ID3D12Resource*         gpuBuffer;
+        ID3D12Resource*         readbackBuffer;
+        uint64_t                frameIndexRequest;
+        bool                    serialized;
+    };
+
+    // Upload buffer holding cached blobs until their deserialization copies executed
+    struct CacheUpload
+    {
+        ID3D12Resource* uploadBuffer;
+        uint64_t        frameIndexRequest;
+    };
+
+    // Disk cache of serialized compacted acceleration structures, null until EnableBLASCache
+    extern BLASCache*                              _blasCache;
+    extern BLASSerializationBackend*               _serializationBackend;
+    extern std::unordered_map<ASBuffers*, uint64_t> _pendingCacheStores;
+    extern SerializationBatch                      _serializationQueries;
+    extern std::vector<SerializationBatch>         _serializationBatches;
+    extern std::queue<CacheUpload>                 _cacheUploads;
+
+    // Accepts cached blobs whose driver matching identifier the device still recognizes
+    class D3D12SerializationBackend : public BLASSerializationBackend
+    {
+    public:
+
+        D3D12SerializationBackend(ID3D12Device5* const device)
+            : m_device(device)
+        {
+        }
+
+        bool IsCompatible(const uint8_t* payload, size_t sizeInBytes) const override
+        {
+            if (sizeInBytes < sizeof(D3D12_SERIALIZED_RAYTRACING_ACCELERATION_STRUCTURE_HEADER))
+            {
+                return false;
+            }
+            const D3D12_SERIALIZED_RAYTRACING_ACCELERATION_STRUCTURE_HEADER* header =
+                reinterpret_cast<const D3D12_SERIALIZED_RAYTRACING_ACCELERATION_STRUCTURE_HEADER*>(payload);
+
+            return header->SerializedSizeInBytesIncludingHeader             == sizeInBytes &&
+                   header->NumBottomLevelAccelerationStructurePointersAfterHeader == 0 &&
+                   m_device->CheckDriverMatchingIdentifier(D3D12_SERIALIZED_DATA_RAYTRACING_ACCELERATION_STRUCTURE,
+                                                           &header->DriverMatchingIdentifier) ==
+                       D3D12_DRIVER_MATCHING_IDENTIFIER_COMPATIBLE_WITH_DEVICE;
+        }
+
+    private:
+
+        ID3D12Device5* const m_device;
+    };
+
+    // Scratch arena buffers are committed resources of their own
+    class D3D12ScratchArenaBackend : public ScratchArenaBackend
+    {
+    public:
+
+        D3D12ScratchArenaBackend(ID3D12Device5* const device)
+            : m_device(device)
+        {
+        }
+
+        ScratchBuffer CreateBuffer(uint64_t sizeInBytes) override;
+
+        void ReleaseBuffer(const ScratchBuffer& buffer) override
+        {
+            static_cast<ID3D12Resource*>(buffer.resource)->Release();
+        }
+
+    private:
+
+        ID3D12Device5* const m_device;
+    };
+
+    // A build planned by BuildAccelerationStructures, recorded once the whole batch is planned
+    struct PlannedBuild
+    {
+        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC          desc;
+        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postBuildInfo;
+        uint32_t                                                    postBuildInfoCount;
+        bool                                                        deserialized; // Cache hit, copied in instead of built
+    };
+
+    // Records one lane of planned builds on its own command list
+    class D3D12RecordingLane : public RecordingLane
+    {
+    public:
+
+        D3D12RecordingLane(ID3D12GraphicsCommandList4* const commandList,
+                           const PlannedBuild*               plannedBuilds)
+            : m_commandList(commandList),
+              m_plannedBuilds(plannedBuilds)
+        {
+        }
+
+        void RecordBarrier() override
+        {
+            D3D12_RESOURCE_BARRIER rb = {};
+            rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            rb.UAV.pResource          = nullptr;
+            m_commandList->ResourceBarrier(1, &rb);
+        }
+
+        void RecordBuild(uint32_t buildIndex) override
+        {
+            const PlannedBuild& build = m_plannedBuilds[buildIndex];
+            if (build.deserialized == false)
+            {
+                m_commandList->BuildRaytracingAccelerationStructure(&build.desc,
+                                                                    build.postBuildInfoCount,
+                                                                    build.postBuildInfoCount > 0 ? &build.postBuildInfo : nullptr);
+            }
+        }
+
+    private:
+
+        ID3D12GraphicsCommandList4* const m_commandList;
+        const PlannedBuild* const         m_plannedBuilds;
+    };
+
+    // Records the defragmenter's copies on the frame's command list
+    class D3D12ASCopyCommands : public ASCopyCommands
+    {
+    public:
+
+        D3D12ASCopyCommands(ID3D12GraphicsCommandList4* const commandList)
+            : m_commandList(commandList)
+        {
+        }
+
+        void CloneAccelerationStructure(uint64_t destinationGpuVA, uint64_t sourceGpuVA) override
+        {
+            m_commandList->CopyRaytracingAccelerationStructure(destinationGpuVA,
+                                                               sourceGpuVA,
+                                                               D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_CLONE);
+        }
+
+    private:
+
+        ID3D12GraphicsCommandList4* const m_commandList;
+    };
+
+    constexpr uint32_t SizeOfCompactionDescriptor = sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC);
+    constexpr uint32_t CompactionSizeRingCapacity = 65536;
 
-    BufferSuballocator*    _scratchPool                  = nullptr;
     BufferSuballocator*    _resultPool                   = nullptr;
     BufferSuballocator*    _compactionPool               = nullptr;
-    BufferSuballocator*    _compactionSizeGpuPool        = nullptr;
-    BufferSuballocator*    _compactionSizeCpuPool        = nullptr;
     std::string            _buildLogger                  = "";
+    uint64_t               _buildLoggerFrameIndex        = UINT64_MAX;
     uint32_t               _commandListLatency           = 0;
     uint64_t               _commandListIndex             = 0;
-    uint32_t               _maxTransientCompactionMemory = 0;
     uint32_t               _suballocationBlockSize       = 0;
-    uint32_t               _currentCompactionMemorySize  = 0;
     uint32_t               _totalUncompactedMemory       = 0;
     uint32_t               _totalCompactedMemory         = 0;
     uint64_t               _totalTriangles               = 0;
-    std::queue<ASBuffers*> _asBufferCompactionQueue;
     std::queue<ASBuffers*> _asBufferCompleteQueue;
     std::queue<ASBuffers*> _asBufferReleaseQueue;
 
-    bool CopyCompaction(ID3D12Device5* const              device,
+    CompactionSizeRing*     _compactionSizeRing           = nullptr;
+    ID3D12Resource*         _compactionSizeGpuBuffer      = nullptr;
+    ID3D12Resource*         _compactionSizeReadbackBuffer = nullptr;
+    const uint64_t*         _compactionSizeReadback       = nullptr;
+    std::vector<ASBuffers*> _compactionSizeOwners;
+    uint64_t                _compactionSizeOverflows      = 0;
+
+    std::vector<ASBuffers*>          _compactedBuffers;
+    ASDefragmenter*                  _defragmenter            = nullptr;
+    std::vector<Relocation>          _pendingRelocations;
+    std::queue<RetiredSuballocation> _retiredCompactions;
+    uint64_t                         _totalDefragmentedMemory = 0;
+
+    BLASCache*                               _blasCache            = nullptr;
+    BLASSerializationBackend*                _serializationBackend = nullptr;
+    std::unordered_map<ASBuffers*, uint64_t> _pendingCacheStores;
+    SerializationBatch                       _serializationQueries = {};
+    std::vector<SerializationBatch>          _serializationBatches;
+    std::queue<CacheUpload>                  _cacheUploads;
+
+    ScratchArenaBackend*    _scratchArenaBackend         = nullptr;
+    ScratchArena*           _scratchArena                = nullptr;
+    ParallelRecorder*       _parallelRecorder            = nullptr;
+    BuildBatcher            _buildBatcher;
+    uint64_t                _buildBatchCount             = 0;
+    std::vector<ASBuffers*> _compactionPending;
+    CompactionBudgets       _compactionBudgets           = {};
+    CompactionScheduler     _compactionScheduler;
+    CompactionFrameStats    _compactionStats             = {};
+    uint64_t                _transientCompactionInFlight = 0;
+
+    MemoryTelemetry        _memoryTelemetry        = {};
+    MemoryTelemetry        _frameTelemetry         = {};
+    MemoryTelemetryWriter* _telemetryWriter        = nullptr;
+    uint64_t               _totalCompactionSavings = 0;
+
+    ID3D12Resource* CreateBuffer(ID3D12Device5* const  device,
+                                 uint64_t              sizeInBytes,
+                                 D3D12_HEAP_TYPE       heapType,
+                                 D3D12_RESOURCE_STATES resourceState)
+    {
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension           = D3D12_RESOURCE_DIMENSION_BUFFER;
+        desc.Width               = sizeInBytes;
+        desc.Height              = 1;
+        desc.DepthOrArraySize    = 1;
+        desc.MipLevels           = 1;
+        desc.Format              = DXGI_FORMAT_UNKNOWN;
+        desc.SampleDesc.Count    = 1;
+        desc.Layout              = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        desc.Flags               = heapType == D3D12_HEAP_TYPE_DEFAULT ? D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS :
+                                                                         D3D12_RESOURCE_FLAG_NONE;
+
+        D3D12_HEAP_PROPERTIES heapProperties = {};
+        heapProperties.Type                  = heapType;
+        heapProperties.CreationNodeMask      = 1;
+        heapProperties.VisibleNodeMask       = 1;
+
+        ID3D12Resource* buffer = nullptr;
+        device->CreateCommittedResource(&heapProperties,
+                                        D3D12_HEAP_FLAG_NONE,
+                                        &desc,
+                                        resourceState,
+                                        nullptr,
+                                        IID_PPV_ARGS(&buffer));
+        return buffer;
+    }
+
+    ScratchBuffer D3D12ScratchArenaBackend::CreateBuffer(uint64_t sizeInBytes)
+    {
+        ID3D12Resource* buffer = RTCompaction::CreateBuffer(m_device,
+                                                            sizeInBytes,
+                                                            D3D12_HEAP_TYPE_DEFAULT,
+                                                            D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        return ScratchBuffer{buffer, buffer->GetGPUVirtualAddress(), sizeInBytes};
+    }
+
+    // Moves a buffer written by the GPU over to its readback copy
+    void CopyToReadback(ID3D12GraphicsCommandList4* const commandList,
+                        ID3D12Resource*                   gpuBuffer,
+                        ID3D12Resource*                   readbackBuffer)
+    {
+        D3D12_RESOURCE_BARRIER rb = {};
+        rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        rb.Transition.pResource   = gpuBuffer;
+        rb.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        rb.Transition.StateAfter  = D3D12_RESOURCE_STATE_COPY_SOURCE;
+
+        commandList->ResourceBarrier(1, &rb);
+        commandList->CopyResource(readbackBuffer, gpuBuffer);
+    }
+
+    // Primitives of every geometry desc of a bottom level build, triangles of indexed and non
+    // indexed geometry alike and procedural boxes
+    uint32_t CountPrimitives(const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& inputs)
+    {
+        uint64_t primitives = 0;
+        for (uint32_t geometryIndex = 0; geometryIndex < inputs.NumDescs; geometryIndex++)
+        {
+            const D3D12_RAYTRACING_GEOMETRY_DESC& geometry = inputs.DescsLayout == D3D12_ELEMENTS_LAYOUT_ARRAY ?
+                                                                 inputs.pGeometryDescs[geometryIndex] :
+                                                                 *inputs.ppGeometryDescs[geometryIndex];
+            if (geometry.Type == D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES)
+            {
+                primitives += (geometry.Triangles.IndexFormat != DXGI_FORMAT_UNKNOWN ? geometry.Triangles.IndexCount :
+                                                                                      geometry.Triangles.VertexCount) / 3;
+            }
+            else
+            {
+                primitives += geometry.AABBs.AABBCount;
+            }
+        }
+        return static_cast<uint32_t>(std::min<uint64_t>(primitives, UINT32_MAX));
+    }
+
+    // Counts a copy recorded this frame in counter and the moved bytes histogram
+    void RecordCopy(uint64_t& counter, uint64_t sizeInBytes)
+    {
+        counter += sizeInBytes;
+        _frameTelemetry.bytesMovedHistogram[MemoryTelemetryHistogramBucket(sizeInBytes)]++;
+    }
+
+    void CopyCompaction(ID3D12Device5* const              device,
                         ID3D12GraphicsCommandList4* const commandList,
                         ASBuffers**                       buffers,
                         const uint32_t                    compactionCount)
@@ -76,30 +407,30 @@ namespace RTCompaction
             if (buffers[compactionIndex]->isCompacted         == false &&
                 buffers[compactionIndex]->requestedCompaction == true)
             {
-                unsigned char* data           = nullptr;
-                uint64_t       compactionSize = 0;
-                uint32_t       offset         = buffers[compactionIndex]->compactionSizeCpuMemory.parentResourceOffset;
-
-                // Map the readback gpu memory to system memory to fetch compaction size
-                D3D12_RANGE readbackBufferRange{offset, offset + SizeOfCompactionDescriptor};
-                buffers[compactionIndex]->compactionSizeCpuMemory.parentResource->Map(0, &readbackBufferRange, (void**)&data);
-                memcpy(&compactionSize, &data[offset], SizeOfCompactionDescriptor);
-
-                // If zero compactions have been performed but the transient memory budget isn't big enough
-                // still move forward with the compaction
-                if ((_currentCompactionMemorySize != 0) &&
-                    ((_currentCompactionMemorySize + compactionSize) > _maxTransientCompactionMemory))
-                {
-                    return false;
-                }
-                _currentCompactionMemorySize += compactionSize;
+                // Read back by ReadCompactionSizes once the build executed, the scheduler already
+                // checked it against the budgets
+                const uint64_t compactionSize = buffers[compactionIndex]->compactedSizeInBytes;
+                _transientCompactionInFlight += compactionSize;
 
                 // Suballocate the gpu memory needed for compaction copy
                 buffers[compactionIndex]->compactionGpuMemory = _compactionPool->CreateSubAllocation(device,
                                                                                                      compactionSize,
                                                                                                      D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
 
-                _totalCompactedMemory += buffers[compactionIndex]->compactionGpuMemory.alignedBufferSizeInBytes;
+                // Out of pool blocks, the structure stays in its uncompacted result
+                if (buffers[compactionIndex]->compactionGpuMemory.handle.IsNull())
+                {
+                    _transientCompactionInFlight                  -= compactionSize;
+                    buffers[compactionIndex]->requestedCompaction  = false;
+                    _pendingCacheStores.erase(buffers[compactionIndex]);
+                    continue;
+                }
+
+                const uint32_t compactedAllocationSize = _compactionPool->GetSize(buffers[compactionIndex]->compactionGpuMemory.handle);
+                _totalCompactedMemory                 += compactedAllocationSize;
+                _totalCompactionSavings               += buffers[compactionIndex]->resultSizeInBytes -
+                                                         std::min(compactedAllocationSize, buffers[compactionIndex]->resultSizeInBytes);
+                RecordCopy(_frameTelemetry.frameCompactionBytes, compactionSize);
 
                 // Copy the result buffer into the compacted buffer
                 commandList->CopyRaytracingAccelerationStructure(buffers[compactionIndex]->compactionGpuMemory.GetGPUVA(),
@@ -107,7 +438,18 @@ namespace RTCompaction
                                                                  D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
 
                 // Tag as compaction complete
-                buffers[compactionIndex]->isCompacted = true;
+                buffers[compactionIndex]->isCompacted    = true;
+                buffers[compactionIndex]->compactedIndex = static_cast<uint32_t>(_compactedBuffers.size());
+                _compactedBuffers.push_back(buffers[compactionIndex]);
+
+                // Builds that missed the disk cache get their serialized size queried this frame
+                auto cacheStore = _pendingCacheStores.find(buffers[compactionIndex]);
+                if (cacheStore != _pendingCacheStores.end())
+                {
+                    _serializationQueries.buffers.push_back(cacheStore->first);
+                    _serializationQueries.cacheKeys.push_back(cacheStore->second);
+                    _pendingCacheStores.erase(cacheStore);
+                }
 
                 //OutputDebugString((
                 //    "Triangle count: " + std::to_string(buffers[compactionIndex]->numTriangles) + "\n"
@@ -118,12 +460,11 @@ namespace RTCompaction
 
 //#if _DEBUG
 //                OutputDebugString((
-//                    "Uncompacted memory: " + std::to_string(buffers[compactionIndex]->resultGpuMemory.alignedBufferSizeInBytes) + "\n"
+//                    "Uncompacted memory: " + std::to_string(buffers[compactionIndex]->resultSizeInBytes)                          + "\n"
 //                    "Compacted memory: "   + std::to_string(compactionSize)                                                     + "\n").c_str());
 //#endif
             }
         }
-        return true;
     }
 
     void PostBuildRelease(ASBuffers**    buffers,
@@ -134,12 +475,10 @@ namespace RTCompaction
             // Only delete compaction size and result buffers if compaction was done
             if (buffers[buildIndex]->isCompacted == true)
             {
-                // Deallocate all the buffers used to create a compaction AS buffer
+                // Deallocate the uncompacted result
                 _resultPool->FreeSubAllocation(buffers[buildIndex]->resultGpuMemory);
-                _compactionSizeGpuPool->FreeSubAllocation(buffers[buildIndex]->compactionSizeGpuMemory);
-                _compactionSizeCpuPool->FreeSubAllocation(buffers[buildIndex]->compactionSizeCpuMemory);
+                _transientCompactionInFlight -= buffers[buildIndex]->compactedSizeInBytes;
             }
-            _scratchPool->FreeSubAllocation(buffers[buildIndex]->scratchGpuMemory);
         }
     }
 
@@ -148,21 +487,45 @@ namespace RTCompaction
         for (uint32_t buildIndex = 0; buildIndex < removeCount; buildIndex++)
         {
             // Deallocate all the buffers used for acceleration structures
-            if (buffers[buildIndex]->scratchGpuMemory.parentResource != nullptr)
+            if (buffers[buildIndex]->resultGpuMemory.handle.IsNull() == false)
             {
-                _scratchPool->FreeSubAllocation(buffers[buildIndex]->scratchGpuMemory);
+                _resultPool->FreeSubAllocation(buffers[buildIndex]->resultGpuMemory);
             }
-            if (buffers[buildIndex]->resultGpuMemory.parentResource != nullptr)
+            // A relocation still in flight never switched over, drop its destination
+            for (size_t relocationIndex = 0; relocationIndex < _pendingRelocations.size(); relocationIndex++)
             {
-                _resultPool->FreeSubAllocation(buffers[buildIndex]->resultGpuMemory);
+                if (_pendingRelocations[relocationIndex].buffers == buffers[buildIndex])
+                {
+                    _compactionPool->FreeSubAllocation(_pendingRelocations[relocationIndex].destination);
+                    _pendingRelocations.erase(_pendingRelocations.begin() + relocationIndex);
+                    break;
+                }
             }
-            if (buffers[buildIndex]->compactionGpuMemory.parentResource != nullptr)
+            if (buffers[buildIndex]->compactionGpuMemory.handle.IsNull() == false)
             {
+                // Cache hits never had an uncompacted result to save on
+                const uint32_t compactedAllocationSize = _compactionPool->GetSize(buffers[buildIndex]->compactionGpuMemory.handle);
+                _totalCompactedMemory                 -= compactedAllocationSize;
+                _totalCompactionSavings               -= buffers[buildIndex]->resultSizeInBytes -
+                                                         std::min(compactedAllocationSize, buffers[buildIndex]->resultSizeInBytes);
                 _compactionPool->FreeSubAllocation(buffers[buildIndex]->compactionGpuMemory);
             }
 
-            _totalUncompactedMemory -= buffers[buildIndex]->resultGpuMemory.alignedBufferSizeInBytes;
-            _totalCompactedMemory   -= buffers[buildIndex]->compactionGpuMemory.alignedBufferSizeInBytes;
+            _totalUncompactedMemory -= buffers[buildIndex]->resultSizeInBytes;
+
+            // A size still in flight has nobody to go to
+            if (buffers[buildIndex]->compactionSizeSlot != CompactionSizeRing::InvalidSlot &&
+                _compactionSizeOwners[buffers[buildIndex]->compactionSizeSlot] == buffers[buildIndex])
+            {
+                _compactionSizeOwners[buffers[buildIndex]->compactionSizeSlot] = nullptr;
+            }
+
+            // Serialization copies are no longer recorded for it
+            _pendingCacheStores.erase(buffers[buildIndex]);
+            for (SerializationBatch& batch : _serializationBatches)
+            {
+                std::replace(batch.buffers.begin(), batch.buffers.end(), buffers[buildIndex], static_cast<ASBuffers*>(nullptr));
+            }
 
             // This prevents compaction from being performed if an acceleration structure
             // gets allocated and then deallocated between round trips
@@ -170,28 +533,326 @@ namespace RTCompaction
         }
     }
 
-    void NextFrame(ID3D12Device5* const              device,
-                   ID3D12GraphicsCommandList4* const commandList)
+    void UnregisterCompactedBuffers(ASBuffers* buffers)
     {
-        //Clear out previous command lists compaction logging
-        _buildLogger.clear();
+        if (buffers->compactedIndex >= _compactedBuffers.size() ||
+            _compactedBuffers[buffers->compactedIndex] != buffers)
+        {
+            return;
+        }
 
-        float memoryReductionRatio = (static_cast<float>(_totalCompactedMemory) / (_totalUncompactedMemory + 1.0));
-        _buildLogger.append(
-            "Theoretical uncompacted  memory: "                  + std::to_string(_totalUncompactedMemory                      / 1000000.0f) + " MB\n"
-            "Compacted                memory: "                  + std::to_string(_totalCompactedMemory                        / 1000000.0f) + " MB\n"
-            "Compaction  memory    reduction: "                  + std::to_string(memoryReductionRatio                         * 100.0f)     + " %%\n"
-            "Uncompacted suballocator memory: "                  + std::to_string(_resultPool->GetSuballocatorSize()           / 1000000.0f) + " MB\n"
-            "Compacted   suballocator memory: "                  + std::to_string(_compactionPool->GetSuballocatorSize()       / 1000000.0f) + " MB\n"
-            "Scratch     suballocator memory: "                  + std::to_string(_scratchPool->GetSuballocatorSize()          / 1000000.0f) + " MB\n"
-            "Unused      uncompacted  memory: "                  + std::to_string(_resultPool->GetFreeSuballocationsSize()     / 1000000.0f) + " MB\n"
-            "Unused      compacted    memory: "                  + std::to_string(_compactionPool->GetFreeSuballocationsSize() / 1000000.0f) + " MB\n"
-            "Unused      scratch      memory: "                  + std::to_string(_scratchPool->GetFreeSuballocationsSize()    / 1000000.0f) + " MB\n"
-            "Suballocation alignment   saved: "                  + std::to_string(_compactionPool->GetAlignmentSavingSize()    / 1000000.0f) + " MB\n"
-            "Bytes per triangle       memory: "                  + std::to_string(_totalCompactedMemory / (_totalTriangles + 1))             + " Bytes\n"
-            "Total triangles in BLASes      : "                  + std::to_string(_totalTriangles)                                           + "\n"
-        );
+        ASBuffers* last                            = _compactedBuffers.back();
+        last->compactedIndex                       = buffers->compactedIndex;
+        _compactedBuffers[buffers->compactedIndex] = last;
+        _compactedBuffers.pop_back();
+
+        buffers->compactedIndex = UINT32_MAX;
+    }
+
+    void Defragment(ID3D12GraphicsCommandList4* const commandList)
+    {
+        // Relocations whose clone copy has executed switch over to the new range
+        for (size_t relocationIndex = 0; relocationIndex < _pendingRelocations.size();)
+        {
+            Relocation& relocation = _pendingRelocations[relocationIndex];
+            if (relocation.frameIndexRequest + (_commandListLatency - 1) < _commandListIndex)
+            {
+                _retiredCompactions.push(RetiredSuballocation{relocation.buffers->compactionGpuMemory, _commandListIndex});
+                relocation.buffers->compactionGpuMemory = relocation.destination;
+
+                relocation = _pendingRelocations.back();
+                _pendingRelocations.pop_back();
+            }
+            else
+            {
+                relocationIndex++;
+            }
+        }
+
+        // Emptied blocks are given back by the pool as their last range is freed
+        while (_retiredCompactions.empty() == false &&
+               _retiredCompactions.front().frameIndexRequest + (_commandListLatency - 1) < _commandListIndex)
+        {
+            _compactionPool->FreeSubAllocation(_retiredCompactions.front().suballocation);
+            _retiredCompactions.pop();
+        }
+
+        // Only plan once everything in flight has landed so the plan sees the pool as it is
+        if (_defragmenter == nullptr || _pendingRelocations.empty() == false || _retiredCompactions.empty() == false)
+        {
+            return;
+        }
+
+        std::vector<const TLSFAllocator*> blocks;
+        std::vector<DefragItem>           items(_compactedBuffers.size());
+        _compactionPool->GetBlockAllocators(blocks);
+        for (uint32_t compactedIndex = 0; compactedIndex < _compactedBuffers.size(); compactedIndex++)
+        {
+            const SuballocationHandle handle = _compactedBuffers[compactedIndex]->compactionGpuMemory.handle;
+            items[compactedIndex]            = DefragItem{compactedIndex, handle.GetBlockIndex(), handle.GetNode()};
+        }
+
+        // Replaying the moves in plan order lands every one where the planner put it
+        const DefragPlan    plan = _defragmenter->Plan(blocks, items);
+        D3D12ASCopyCommands copyCommands(commandList);
+
+        // A move can pick a structure compacted or deserialized earlier on this command list, its
+        // copy has to land before the clone reads it
+        if (plan.moves.empty() == false)
+        {
+            D3D12_RESOURCE_BARRIER rb = {};
+            rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            rb.UAV.pResource          = nullptr;
+            commandList->ResourceBarrier(1, &rb);
+        }
+
+        for (const DefragMove& move : plan.moves)
+        {
+            ASBuffers*    buffers     = _compactedBuffers[move.id];
+            Suballocation destination = _compactionPool->CreateSubAllocationInBlock(move.destinationBlock,
+                                                                                    move.sizeInBytes,
+                                                                                    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+            if (destination.handle.IsNull())
+            {
+                break;
+            }
+
+            copyCommands.CloneAccelerationStructure(destination.GetGPUVA(), buffers->compactionGpuMemory.GetGPUVA());
+            _pendingRelocations.push_back(Relocation{buffers, destination, _commandListIndex});
+            _totalDefragmentedMemory += move.sizeInBytes;
+            RecordCopy(_frameTelemetry.frameDefragmentationBytes, move.sizeInBytes);
+        }
+    }
+
+    void SerializeToCache(ID3D12Device5* const              device,
+                          ID3D12GraphicsCommandList4* const commandList)
+    {
+        // Deserialization sources are released once the copies out of them executed
+        while (_cacheUploads.empty() == false &&
+               _cacheUploads.front().frameIndexRequest + (_commandListLatency - 1) < _commandListIndex)
+        {
+            _cacheUploads.front().uploadBuffer->Release();
+            _cacheUploads.pop();
+        }
+
+        bool stored = false;
+        for (size_t batchIndex = 0; batchIndex < _serializationBatches.size();)
+        {
+            SerializationBatch& batch = _serializationBatches[batchIndex];
+            if (batch.frameIndexRequest + (_commandListLatency - 1) >= _commandListIndex)
+            {
+                batchIndex++;
+                continue;
+            }
+
+            unsigned char* data = nullptr;
+            batch.readbackBuffer->Map(0, nullptr, (void**)&data);
+
+            if (batch.serialized)
+            {
+                // Blobs are on the CPU, write them out and drop the batch
+                for (size_t item = 0; item < batch.cacheKeys.size(); item++)
+                {
+                    if (batch.sizesInBytes[item] > 0)
+                    {
+                        _blasCache->Store(batch.cacheKeys[item], &data[batch.offsets[item]], batch.sizesInBytes[item]);
+                        stored = true;
+                    }
+                }
+                batch.readbackBuffer->Unmap(0, nullptr);
+                batch.readbackBuffer->Release();
+                batch.gpuBuffer->Release();
+
+                _serializationBatches.erase(_serializationBatches.begin() + batchIndex);
+                continue;
+            }
+
+            // Sizes are on the CPU, lay the blobs out and serialize everything still alive
+            const uint32_t SizeOfSerializationDescriptor = sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_SERIALIZATION_DESC);
+            uint64_t       totalSizeInBytes              = 0;
+            batch.offsets.resize(batch.buffers.size());
+            batch.sizesInBytes.resize(batch.buffers.size());
+            for (size_t item = 0; item < batch.buffers.size(); item++)
+            {
+                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_SERIALIZATION_DESC desc = {};
+                memcpy(&desc, &data[item * SizeOfSerializationDescriptor], SizeOfSerializationDescriptor);
+
+                batch.offsets[item]      = totalSizeInBytes;
+                batch.sizesInBytes[item] = batch.buffers[item] != nullptr ? desc.SerializedSizeInBytes : 0;
+                totalSizeInBytes        += (batch.sizesInBytes[item] + (D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT - 1)) &
+                                           ~uint64_t(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT - 1);
+            }
+            batch.readbackBuffer->Unmap(0, nullptr);
+            batch.readbackBuffer->Release();
+            batch.gpuBuffer->Release();
+            batch.readbackBuffer = nullptr;
+            batch.gpuBuffer      = nullptr;
+
+            if (totalSizeInBytes == 0)
+            {
+                _serializationBatches.erase(_serializationBatches.begin() + batchIndex);
+                continue;
+            }
+
+            batch.gpuBuffer      = CreateBuffer(device, totalSizeInBytes, D3D12_HEAP_TYPE_DEFAULT,  D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+            batch.readbackBuffer = CreateBuffer(device, totalSizeInBytes, D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_STATE_COPY_DEST);
+            for (size_t item = 0; item < batch.buffers.size(); item++)
+            {
+                if (batch.sizesInBytes[item] > 0)
+                {
+                    commandList->CopyRaytracingAccelerationStructure(batch.gpuBuffer->GetGPUVirtualAddress() + batch.offsets[item],
+                                                                     batch.buffers[item]->compactionGpuMemory.GetGPUVA(),
+                                                                     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_SERIALIZE);
+                }
+            }
+            CopyToReadback(commandList, batch.gpuBuffer, batch.readbackBuffer);
+
+            batch.frameIndexRequest = _commandListIndex;
+            batch.serialized        = true;
+            batchIndex++;
+        }
+
+        if (stored)
+        {
+            _blasCache->Flush();
+        }
+
+        // Query the serialized sizes of this frame's compactions once the compaction copies land
+        if (_serializationQueries.buffers.empty() == false)
+        {
+            const uint32_t SizeOfSerializationDescriptor = sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_SERIALIZATION_DESC);
+            const uint64_t querySizeInBytes              = _serializationQueries.buffers.size() * SizeOfSerializationDescriptor;
+
+            SerializationBatch batch = std::move(_serializationQueries);
+            _serializationQueries    = {};
+            batch.gpuBuffer          = CreateBuffer(device, querySizeInBytes, D3D12_HEAP_TYPE_DEFAULT,  D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+            batch.readbackBuffer     = CreateBuffer(device, querySizeInBytes, D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_STATE_COPY_DEST);
+            batch.frameIndexRequest  = _commandListIndex;
+            batch.serialized         = false;
+
+            D3D12_RESOURCE_BARRIER rb = {};
+            rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            rb.UAV.pResource          = nullptr;
+            commandList->ResourceBarrier(1, &rb);
+
+            for (size_t item = 0; item < batch.buffers.size(); item++)
+            {
+                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postBuildInfo = {
+                    batch.gpuBuffer->GetGPUVirtualAddress() + item * SizeOfSerializationDescriptor,
+                    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_SERIALIZATION };
+
+                const D3D12_GPU_VIRTUAL_ADDRESS source = batch.buffers[item]->compactionGpuMemory.GetGPUVA();
+                commandList->EmitRaytracingAccelerationStructurePostbuildInfo(&postBuildInfo, 1, &source);
+            }
+            CopyToReadback(commandList, batch.gpuBuffer, batch.readbackBuffer);
+
+            _serializationBatches.push_back(std::move(batch));
+        }
+    }
+
+    void ReadCompactionSizes()
+    {
+        // Every run of slots written by a frame that has executed is read in one pass
+        if (_commandListIndex < _commandListLatency)
+        {
+            return;
+        }
+        _compactionSizeRing->Retire(_commandListIndex - _commandListLatency, [](uint32_t firstSlot, uint32_t count)
+        {
+            for (uint32_t slot = firstSlot; slot < firstSlot + count; slot++)
+            {
+                ASBuffers* buffers = _compactionSizeOwners[slot];
+                if (buffers != nullptr)
+                {
+                    buffers->compactedSizeInBytes = static_cast<uint32_t>(_compactionSizeReadback[slot]);
+                    buffers->compactionSizeSlot   = CompactionSizeRing::InvalidSlot;
+                    _compactionSizeOwners[slot]   = nullptr;
+                }
+            }
+        });
+    }
+
+    void ScheduleCompactions(ID3D12Device5* const              device,
+                             ID3D12GraphicsCommandList4* const commandList)
+    {
+        // Only builds whose original build execution is confirmed and whose size has been read are
+        // candidates, released ones are dropped
+        std::vector<CompactionCandidate> candidates;
+        for (size_t pendingIndex = 0; pendingIndex < _compactionPending.size();)
+        {
+            ASBuffers* buffers = _compactionPending[pendingIndex];
+            if (buffers->requestedCompaction == false)
+            {
+                _compactionPending[pendingIndex] = _compactionPending.back();
+                _compactionPending.pop_back();
+                continue;
+            }
+            if (buffers->compactionSizeSlot == CompactionSizeRing::InvalidSlot)
+            {
+                candidates.push_back(CompactionCandidate{static_cast<uint32_t>(pendingIndex),
+                                                         buffers->resultSizeInBytes,
+                                                         buffers->compactedSizeInBytes,
+                                                         0, // Scratch went back to the arena at the build's fence
+                                                         buffers->priorityDistance,
+                                                         buffers->frameIndexRequest});
+            }
+            pendingIndex++;
+        }
+
+        const CompactionSchedule schedule = _compactionScheduler.Schedule(candidates,
+                                                                          _compactionBudgets,
+                                                                          _transientCompactionInFlight,
+                                                                          _commandListIndex);
+        for (uint32_t id : schedule.ids)
+        {
+            CopyCompaction(device, commandList, &_compactionPending[id], 1);
+
+            // Tag initial frame index request for deletion
+            _compactionPending[id]->frameIndexRequest = _commandListIndex;
+            _asBufferCompleteQueue.push(_compactionPending[id]);
+            _compactionPending[id] = nullptr;
+        }
+        _compactionPending.erase(std::remove(_compactionPending.begin(), _compactionPending.end(), static_cast<ASBuffers*>(nullptr)),
+                                 _compactionPending.end());
+
+        _compactionStats = schedule.stats;
+    }
 
+    void CountFrameAllocations(PoolTelemetry& pool, const PoolTelemetry& previous)
+    {
+        pool.frameAllocations = static_cast<uint32_t>(pool.allocations - previous.allocations);
+        pool.frameFrees       = static_cast<uint32_t>(pool.frees - previous.frees);
+    }
+
+    void SampleTelemetry()
+    {
+        // _memoryTelemetry still holds the previous frame's sample to take the frame counts from
+        MemoryTelemetry& telemetry = _frameTelemetry;
+        telemetry.frameIndex       = _commandListIndex;
+        _resultPool->GetTelemetry(telemetry.result);
+        _compactionPool->GetTelemetry(telemetry.compaction);
+        CountFrameAllocations(telemetry.result, _memoryTelemetry.result);
+        CountFrameAllocations(telemetry.compaction, _memoryTelemetry.compaction);
+
+        telemetry.scratchResidentBytes  = _scratchArena->GetStats().residentBytes;
+        telemetry.scratchFramePeakBytes = _scratchArena->GetStats().framePeakBytes;
+        telemetry.uncompactedBytes      = _totalUncompactedMemory;
+        telemetry.compactedBytes        = _totalCompactedMemory;
+        telemetry.compactionSavedBytes  = _totalCompactionSavings;
+        telemetry.compactionsPending    = static_cast<uint32_t>(_compactionPending.size());
+        telemetry.transientBytes        = _transientCompactionInFlight;
+
+        _memoryTelemetry = telemetry;
+        _frameTelemetry  = {};
+        if (_telemetryWriter != nullptr)
+        {
+            _telemetryWriter->Write(_memoryTelemetry);
+        }
+    }
+
+    void NextFrame(ID3D12Device5* const              device,
+                   ID3D12GraphicsCommandList4* const commandList)
+    {
         // Release queue indicates acceleration structure is completely removed
         while (_asBufferReleaseQueue.empty() == false)
         {
@@ -220,51 +881,45 @@ namespace RTCompaction
             }
         }
 
-        // Compaction queue indicates compaction needs to be done
-        // Reset the current compaction memory overhead
-        _currentCompactionMemorySize = 0;
-        while (_asBufferCompactionQueue.empty() == false)
-        {
-            // Only do compaction on the confirmed completion of the original
-            // build execution.
-            if ((_asBufferCompactionQueue.front()->frameIndexRequest + (_commandListLatency - 1) < _commandListIndex) &&
-                (_asBufferCompactionQueue.front()->requestedCompaction == true))
-            {
-                const bool successfulCompaction = CopyCompaction(device,
-                                                                 commandList,
-                                                                 &_asBufferCompactionQueue.front(),
-                                                                 1);
-                if (successfulCompaction == false)
-                {
-                    break;
-                }
+        ReadCompactionSizes();
 
-                // Tag initial frame index request for deletion
-                _asBufferCompactionQueue.front()->frameIndexRequest = _commandListIndex;
-                _asBufferCompleteQueue.push(_asBufferCompactionQueue.front());
-                _asBufferCompactionQueue.pop();
-            }
-            else
-            {
-                break;
-            }
+        ScheduleCompactions(device, commandList);
+
+        if (_blasCache != nullptr)
+        {
+            SerializeToCache(device, commandList);
         }
 
+        Defragment(commandList);
+
+        SampleTelemetry();
+
         _commandListIndex++;
+        _scratchArena->BeginFrame(_commandListIndex);
     }
 
     void Initialize(ID3D12Device5* const device,
                     uint32_t             commandListLatency,
                     uint32_t             suballocatorBlockSize,
-                    uint32_t             maxTransientCompactionMemory)
+                    uint32_t             maxTransientCompactionMemory,
+                    uint32_t             maxDefragmentationBytesPerFrame,
+                    uint64_t             maxConcurrentScratchBytes)
     {
-        _maxTransientCompactionMemory = maxTransientCompactionMemory;
-        _commandListLatency           = commandListLatency;
+        if (maxDefragmentationBytesPerFrame > 0)
+        {
+            _defragmenter = new ASDefragmenter(maxDefragmentationBytesPerFrame,
+                                               0.5f,
+                                               D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+        }
 
-        _scratchPool = new BufferSuballocator(device,
-                                              suballocatorBlockSize,
-                                              D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                                              D3D12_HEAP_TYPE_DEFAULT);
+        _compactionBudgets.copyBytesPerFrame = maxTransientCompactionMemory;
+        _commandListLatency                  = commandListLatency;
+
+        _scratchArenaBackend = new D3D12ScratchArenaBackend(device);
+        _scratchArena        = new ScratchArena(_scratchArenaBackend,
+                                                commandListLatency,
+                                                maxConcurrentScratchBytes,
+                                                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
                 
         _resultPool  = new BufferSuballocator(device,
                                               suballocatorBlockSize,
@@ -276,115 +931,321 @@ namespace RTCompaction
                                                  D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE,
                                                  D3D12_HEAP_TYPE_DEFAULT);
 
-        _compactionSizeGpuPool = new BufferSuballocator(device,
-                                                        CompactionSizeSuballocationBlockSize,
-                                                        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-                                                        D3D12_HEAP_TYPE_DEFAULT);
+        // The readback side is mapped once, the ring decides when a slot is safe to read
+        _compactionSizeRing           = new CompactionSizeRing(CompactionSizeRingCapacity);
+        _compactionSizeGpuBuffer      = CreateBuffer(device,
+                                                     CompactionSizeRingCapacity * SizeOfCompactionDescriptor,
+                                                     D3D12_HEAP_TYPE_DEFAULT,
+                                                     D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        _compactionSizeReadbackBuffer = CreateBuffer(device,
+                                                     CompactionSizeRingCapacity * SizeOfCompactionDescriptor,
+                                                     D3D12_HEAP_TYPE_READBACK,
+                                                     D3D12_RESOURCE_STATE_COPY_DEST);
+        _compactionSizeReadbackBuffer->Map(0, nullptr, (void**)&_compactionSizeReadback);
+        _compactionSizeOwners.assign(CompactionSizeRingCapacity, nullptr);
+    }
+
+    void SetCompactionPolicy(const CompactionBudgets& budgets,
+                             const CompactionWeights& weights)
+    {
+        _compactionBudgets   = budgets;
+        _compactionScheduler = CompactionScheduler(weights);
+    }
+
+    void EnableBLASCache(ID3D12Device5* const device,
+                         const char*          directory,
+                         uint64_t             deviceKey)
+    {
+        _serializationBackend = new D3D12SerializationBackend(device);
+        _blasCache            = new BLASCache(directory, deviceKey, _serializationBackend);
+    }
+
+    // Loads every cached build up front and stages them in one upload buffer, returns the number
+    // of hits.  Payloads of misses are left empty.
+    uint32_t LoadCachedBuilds(ID3D12Device5* const               device,
+                              const uint64_t*                    cacheKeys,
+                              const uint32_t                     buildCount,
+                              std::vector<std::vector<uint8_t>>& payloads,
+                              std::vector<uint64_t>&             offsets,
+                              ID3D12Resource*&                   uploadBuffer)
+    {
+        uint32_t hits             = 0;
+        uint64_t totalSizeInBytes = 0;
+        payloads.resize(buildCount);
+        offsets.resize(buildCount);
+        for (uint32_t buildIndex = 0; buildIndex < buildCount; buildIndex++)
+        {
+            if (cacheKeys[buildIndex] != 0 && _blasCache->Load(cacheKeys[buildIndex], payloads[buildIndex]))
+            {
+                offsets[buildIndex] = totalSizeInBytes;
+                totalSizeInBytes   += (payloads[buildIndex].size() + (D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT - 1)) &
+                                      ~uint64_t(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT - 1);
+                hits++;
+            }
+            else
+            {
+                payloads[buildIndex].clear();
+            }
+        }
+        if (hits == 0)
+        {
+            return 0;
+        }
+
+        uploadBuffer = CreateBuffer(device, totalSizeInBytes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
 
-        _compactionSizeCpuPool = new BufferSuballocator(device,
-                                                        CompactionSizeSuballocationBlockSize,
-                                                        D3D12_RESOURCE_STATE_COPY_DEST,
-                                                        D3D12_HEAP_TYPE_READBACK);
+        unsigned char* data = nullptr;
+        uploadBuffer->Map(0, nullptr, (void**)&data);
+        for (uint32_t buildIndex = 0; buildIndex < buildCount; buildIndex++)
+        {
+            if (payloads[buildIndex].empty() == false)
+            {
+                memcpy(&data[offsets[buildIndex]], payloads[buildIndex].data(), payloads[buildIndex].size());
+            }
+        }
+        uploadBuffer->Unmap(0, nullptr);
+
+        _cacheUploads.push(CacheUpload{uploadBuffer, _commandListIndex});
+        return hits;
     }
 
     ASBuffers* BuildAccelerationStructures(ID3D12Device5* const                                        device,
                                            ID3D12GraphicsCommandList4* const                           commandList,
                                            const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS* bottomLevelInputs,
-                                           const uint32_t                                              buildCount)
+                                           const uint32_t                                              buildCount,
+                                           const uint64_t*                                             cacheKeys,
+                                           ID3D12GraphicsCommandList4* const*                          workerCommandLists,
+                                           const uint32_t                                              workerCommandListCount)
     {
         // Allocate a batch of acceleration structure buffers that the application can use for building TLAS, etc.
-        ASBuffers* buffers             = new ASBuffers[buildCount];
-        bool       compactionRequested = false;
+        ASBuffers* buffers = new ASBuffers[buildCount]();
+
+        // Builds found in the disk cache are deserialized straight into the compaction pool
+        std::vector<std::vector<uint8_t>> payloads;
+        std::vector<uint64_t>             payloadOffsets;
+        ID3D12Resource*                   uploadBuffer = nullptr;
+        if (_blasCache != nullptr && cacheKeys != nullptr)
+        {
+            LoadCachedBuilds(device, cacheKeys, buildCount, payloads, payloadOffsets, uploadBuffer);
+        }
 
+        // Every compacting build of the batch writes its size into one run of ring slots
+        uint32_t compactionCount = 0;
         for (uint32_t buildIndex = 0; buildIndex < buildCount; buildIndex++)
         {
-            // Request build size information and suballocate the scratch and result buffers
-            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO prebuildInfo = {};
-            device->GetRaytracingAccelerationStructurePrebuildInfo(&bottomLevelInputs[buildIndex],
-                                                                   &prebuildInfo);
+            if ((bottomLevelInputs[buildIndex].Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION) &&
+                (uploadBuffer == nullptr || payloads[buildIndex].empty()))
+            {
+                compactionCount++;
+            }
+        }
+        const uint32_t firstSizeSlot = compactionCount > 0 ? _compactionSizeRing->Allocate(compactionCount, _commandListIndex) :
+                                                             CompactionSizeRing::InvalidSlot;
+        if (compactionCount > 0 && firstSizeSlot == CompactionSizeRing::InvalidSlot)
+        {
+            // Too many sizes in flight, the batch is built uncompacted rather than stalling
+            _compactionSizeOverflows += compactionCount;
+        }
+        uint32_t nextSizeSlot = firstSizeSlot;
 
-            buffers[buildIndex].scratchGpuMemory = _scratchPool->CreateSubAllocation(device,
-                                                                                     prebuildInfo.ScratchDataSizeInBytes,
-                                                                                     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+        // Request build size information, cache hits need none
+        std::vector<D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO> prebuildInfos(buildCount);
+        std::vector<PendingBuild>                                          pendingBuilds(buildCount);
+        for (uint32_t buildIndex = 0; buildIndex < buildCount; buildIndex++)
+        {
+            if (uploadBuffer == nullptr || payloads[buildIndex].empty())
+            {
+                device->GetRaytracingAccelerationStructurePrebuildInfo(&bottomLevelInputs[buildIndex],
+                                                                       &prebuildInfos[buildIndex]);
+                pendingBuilds[buildIndex] = PendingBuild{prebuildInfos[buildIndex].ResultDataMaxSizeInBytes,
+                                                         prebuildInfos[buildIndex].ScratchDataSizeInBytes};
+            }
+        }
 
-            buffers[buildIndex].resultGpuMemory  = _resultPool->CreateSubAllocation(device,
-                                                                                    prebuildInfo.ResultDataMaxSizeInBytes,
-                                                                                    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+        // Builds are recorded grouped by size class with a barrier only between batches whose
+        // scratch doesn't fit together, everything below walks the batched order
+        std::vector<uint32_t>   buildOrder;
+        std::vector<BuildBatch> buildBatches;
+        _buildBatcher.Plan(pendingBuilds.data(), buildCount, _scratchArena->GetMaxConcurrentBytes(), buildOrder, buildBatches);
 
-            _totalUncompactedMemory += buffers[buildIndex].resultGpuMemory.alignedBufferSizeInBytes;
+        std::vector<uint64_t>         scratchSizes(buildCount);
+        std::vector<uint8_t>          runStarts(buildCount, 0);
+        std::vector<ScratchPlacement> scratchPlacements(buildCount);
+        for (uint32_t position = 0; position < buildCount; position++)
+        {
+            scratchSizes[position] = pendingBuilds[buildOrder[position]].scratchSizeInBytes;
+        }
+        for (const BuildBatch& batch : buildBatches)
+        {
+            runStarts[batch.first] = batch.barrierBefore ? 1 : 0;
+        }
+        _scratchArena->PlaceBatch(scratchSizes.data(), buildCount, scratchPlacements.data(), runStarts.data());
+        _buildBatchCount += buildBatches.size();
+
+        // Memory, size slots and queues are handed out here in recording order, the builds
+        // themselves are recorded afterwards, on the worker command lists when there are some
+        std::vector<PlannedBuild> plannedBuilds(buildCount);
+        std::vector<uint64_t>     recordingCosts(buildCount);
+        std::vector<uint8_t>      barrierBefore(buildCount);
+        for (uint32_t position = 0; position < buildCount; position++)
+        {
+            const uint32_t buildIndex   = buildOrder[position];
+            const uint32_t numTriangles = CountPrimitives(bottomLevelInputs[buildIndex]);
+
+            recordingCosts[position] = numTriangles;
+            barrierBefore[position]  = scratchPlacements[position].barrierBefore ? 1 : 0;
+
+            buffers[buildIndex].compactionSizeSlot = CompactionSizeRing::InvalidSlot;
+
+            if (uploadBuffer != nullptr && payloads[buildIndex].empty() == false)
+            {
+                const D3D12_SERIALIZED_RAYTRACING_ACCELERATION_STRUCTURE_HEADER* header =
+                    reinterpret_cast<const D3D12_SERIALIZED_RAYTRACING_ACCELERATION_STRUCTURE_HEADER*>(payloads[buildIndex].data());
+
+                buffers[buildIndex].compactionGpuMemory = _compactionPool->CreateSubAllocation(device,
+                                                                                               header->DeserializedSizeInBytes,
+                                                                                               D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+                commandList->CopyRaytracingAccelerationStructure(buffers[buildIndex].compactionGpuMemory.GetGPUVA(),
+                                                                 uploadBuffer->GetGPUVirtualAddress() + payloadOffsets[buildIndex],
+                                                                 D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_DESERIALIZE);
+
+                // Already compacted, nothing goes through the compaction or completion queues
+                buffers[buildIndex].isCompacted         = true;
+                buffers[buildIndex].requestedCompaction = false;
+                buffers[buildIndex].numTriangles        = numTriangles;
+                buffers[buildIndex].frameIndexRequest   = _commandListIndex;
+                buffers[buildIndex].compactedIndex      = static_cast<uint32_t>(_compactedBuffers.size());
+                _compactedBuffers.push_back(&buffers[buildIndex]);
 
-            _totalTriangles += bottomLevelInputs[buildIndex].pGeometryDescs[0].Triangles.IndexCount / 3;
-            buffers[buildIndex].numTriangles = bottomLevelInputs[buildIndex].pGeometryDescs[0].Triangles.IndexCount / 3;
+                _totalCompactedMemory += _compactionPool->GetSize(buffers[buildIndex].compactionGpuMemory.handle);
+                _totalTriangles       += numTriangles;
+                RecordCopy(_frameTelemetry.frameDeserializationBytes, header->DeserializedSizeInBytes);
+
+                plannedBuilds[position].deserialized = true;
+                continue;
+            }
+
+            // Suballocate the result buffer
+            buffers[buildIndex].resultGpuMemory = _resultPool->CreateSubAllocation(device,
+                                                                                   prebuildInfos[buildIndex].ResultDataMaxSizeInBytes,
+                                                                                   D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+
+            // The result may be freed after compaction but the statistics keep its size
+            buffers[buildIndex].resultSizeInBytes = _resultPool->GetSize(buffers[buildIndex].resultGpuMemory.handle);
+            _totalUncompactedMemory              += buffers[buildIndex].resultSizeInBytes;
+
+            _totalTriangles                 += numTriangles;
+            buffers[buildIndex].numTriangles = numTriangles;
+
+            buffers[buildIndex].compactedIndex = UINT32_MAX;
 
             // Keeps track of which frame index the build was requested
             buffers[buildIndex].frameIndexRequest = _commandListIndex;
 
             // Setup build desc
-            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC bottomLevelBuildDesc = {};
-            bottomLevelBuildDesc.Inputs                                             = bottomLevelInputs[buildIndex];
-            bottomLevelBuildDesc.ScratchAccelerationStructureData                   = buffers[buildIndex].scratchGpuMemory.GetGPUVA();
-            bottomLevelBuildDesc.DestAccelerationStructureData                      = buffers[buildIndex].resultGpuMemory.GetGPUVA();
+            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC& bottomLevelBuildDesc = plannedBuilds[position].desc;
+            bottomLevelBuildDesc.Inputs                                              = bottomLevelInputs[buildIndex];
+            bottomLevelBuildDesc.ScratchAccelerationStructureData                    = scratchPlacements[position].gpuVA;
+            bottomLevelBuildDesc.DestAccelerationStructureData                       = buffers[buildIndex].resultGpuMemory.GetGPUVA();
 
             // Only perform compaction of the build inputs that include compaction
-            if (bottomLevelInputs[buildIndex].Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION)
+            if ((bottomLevelInputs[buildIndex].Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION) &&
+                firstSizeSlot != CompactionSizeRing::InvalidSlot)
             {
                 // Tag as not yet compacted
                 buffers[buildIndex].isCompacted         = false;
                 buffers[buildIndex].requestedCompaction = true;
 
-                // Suballocate the gpu memory that the builder will use to write the compaction size post build
-                buffers[buildIndex].compactionSizeGpuMemory = _compactionSizeGpuPool->CreateSubAllocation(device,
-                                                                                                          SizeOfCompactionDescriptor,
-                                                                                                          SizeOfCompactionDescriptor);
+                // The builder writes the compaction size into the build's ring slot
+                buffers[buildIndex].compactionSizeSlot = nextSizeSlot;
+                _compactionSizeOwners[nextSizeSlot]    = &buffers[buildIndex];
+
                 // Request to get compaction size post build
-                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postBuildInfo [] = {
-                    buffers[buildIndex].compactionSizeGpuMemory.GetGPUVA(),
+                plannedBuilds[position].postBuildInfo = {
+                    _compactionSizeGpuBuffer->GetGPUVirtualAddress() + uint64_t(nextSizeSlot) * SizeOfCompactionDescriptor,
                       D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE };
+                plannedBuilds[position].postBuildInfoCount = 1;
+                nextSizeSlot++;
 
-                commandList->BuildRaytracingAccelerationStructure(&bottomLevelBuildDesc,
-                                                                  sizeof(postBuildInfo) / sizeof(postBuildInfo[0]),
-                                                                  postBuildInfo);
+                // Wait for the scheduler to pick it once its size is read
+                _compactionPending.push_back(&buffers[buildIndex]);
 
-                // Suballocate the readback memory
-                buffers[buildIndex].compactionSizeCpuMemory = _compactionSizeCpuPool->CreateSubAllocation(device,
-                                                                                                          SizeOfCompactionDescriptor,
-                                                                                                          SizeOfCompactionDescriptor);
-                // Place compaction item on the compaction queue
-                _asBufferCompactionQueue.push(&buffers[buildIndex]);
+                // Misses are serialized to the disk cache once compacted
+                if (_blasCache != nullptr && cacheKeys != nullptr && cacheKeys[buildIndex] != 0)
+                {
+                    _pendingCacheStores[&buffers[buildIndex]] = cacheKeys[buildIndex];
+                }
 
-                compactionRequested = true;
             }
             else
             {
                 // This build doesn't request compaction
                 buffers[buildIndex].isCompacted         = false;
                 buffers[buildIndex].requestedCompaction = false;
-                commandList->BuildRaytracingAccelerationStructure(&bottomLevelBuildDesc,
-                                                                  0,
-                                                                  nullptr);
+
                 // Place build item on the completion queue
                 _asBufferCompleteQueue.push(&buffers[buildIndex]);
             }
         }
 
-        if (compactionRequested)
+        if (workerCommandListCount > 1)
         {
-            // Transition the gpu compaction size suballocator block to copy over to mappable cpu memory
+            // One lane per worker command list, recorded by as many threads as the machine has
+            if (_parallelRecorder == nullptr)
+            {
+                _parallelRecorder = new ParallelRecorder(std::min(workerCommandListCount,
+                                                                  std::max(std::thread::hardware_concurrency(), 1u)) - 1);
+            }
+            std::vector<D3D12RecordingLane> lanes;
+            std::vector<RecordingLane*>     lanePointers;
+            lanes.reserve(workerCommandListCount);
+            for (uint32_t laneIndex = 0; laneIndex < workerCommandListCount; laneIndex++)
+            {
+                lanes.emplace_back(workerCommandLists[laneIndex], plannedBuilds.data());
+                lanePointers.push_back(&lanes.back());
+            }
+            _parallelRecorder->Record(lanePointers.data(),
+                                      workerCommandListCount,
+                                      recordingCosts.data(),
+                                      barrierBefore.data(),
+                                      buildCount);
+        }
+        else
+        {
+            // A single worker command list or none at all records the batch on this thread
+            D3D12RecordingLane lane(workerCommandListCount == 1 ? workerCommandLists[0] : commandList,
+                                    plannedBuilds.data());
+            for (uint32_t position = 0; position < buildCount; position++)
+            {
+                if (barrierBefore[position] != 0)
+                {
+                    lane.RecordBarrier();
+                }
+                lane.RecordBuild(position);
+            }
+        }
+
+        if (firstSizeSlot != CompactionSizeRing::InvalidSlot)
+        {
+            // Transition the gpu compaction sizes to copy the batch's run over to the mapped readback buffer
             D3D12_RESOURCE_BARRIER rb = {};
-            rb.Transition.pResource   = buffers[0].compactionSizeGpuMemory.parentResource;
+            rb.Transition.pResource   = _compactionSizeGpuBuffer;
             rb.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
             rb.Transition.StateAfter  = D3D12_RESOURCE_STATE_COPY_SOURCE;
             rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 
             commandList->ResourceBarrier(1, &rb);
 
-            // Copy the entire resource to avoid individually copying over each compaction size in strides of 8 bytes
-            commandList->CopyResource(buffers[0].compactionSizeCpuMemory.parentResource,
-                                      buffers[0].compactionSizeGpuMemory.parentResource);
+            // One copy for every size of the batch, the run is contiguous
+            commandList->CopyBufferRegion(_compactionSizeReadbackBuffer,
+                                          uint64_t(firstSizeSlot) * SizeOfCompactionDescriptor,
+                                          _compactionSizeGpuBuffer,
+                                          uint64_t(firstSizeSlot) * SizeOfCompactionDescriptor,
+                                          uint64_t(compactionCount) * SizeOfCompactionDescriptor);
 
-            // Transition the gpu written compaction size suballocator block back over to unordered for later use
+            // Transition the gpu compaction sizes back over to unordered for later builds
             rb                        = {};
-            rb.Transition.pResource   = buffers[0].compactionSizeGpuMemory.parentResource;
+            rb.Transition.pResource   = _compactionSizeGpuBuffer;
             rb.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
             rb.Transition.StateAfter  = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
             rb.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -400,14 +1261,90 @@ namespace RTCompaction
     {
         for (uint32_t removeIndex = 0; removeIndex < removeCount; removeIndex++)
         {
-            // Tag initial frame index request for deletion
+            // Tag initial frame index request for deletion and stop the defragmenter from
+            // starting any new moves of it
             buffers[removeIndex]->frameIndexRequest = _commandListIndex;
+            UnregisterCompactedBuffers(buffers[removeIndex]);
             _asBufferReleaseQueue.push(buffers[removeIndex]);
         }
     }
 
+    ID3D12Resource* GetResultResource(const ASBuffers& buffers)
+    {
+        // Structures loaded from the disk cache are written straight into the compaction pool
+        if (buffers.resultGpuMemory.handle.IsNull())
+        {
+            return _compactionPool->GetResource(buffers.compactionGpuMemory.handle);
+        }
+        return _resultPool->GetResource(buffers.resultGpuMemory.handle);
+    }
+
+    const CompactionFrameStats& GetCompactionStats()
+    {
+        return _compactionStats;
+    }
+
+    const MemoryTelemetry& GetMemoryTelemetry()
+    {
+        return _memoryTelemetry;
+    }
+
+    bool EnableMemoryTelemetryDump(const char*           path,
+                                   MemoryTelemetryFormat format)
+    {
+        if (path == nullptr)
+        {
+            delete _telemetryWriter;
+            _telemetryWriter = nullptr;
+            return true;
+        }
+        if (_telemetryWriter == nullptr)
+        {
+            _telemetryWriter = new MemoryTelemetryWriter();
+        }
+        return _telemetryWriter->Open(path, format);
+    }
+
     const char* GetLog()
     {
+        // Only rebuilt when asked for and at most once per frame
+        if (_buildLoggerFrameIndex == _commandListIndex)
+        {
+            return _buildLogger.c_str();
+        }
+        _buildLoggerFrameIndex = _commandListIndex;
+        _buildLogger.clear();
+
+        float memoryReductionRatio = (static_cast<float>(_totalCompactedMemory) / (_totalUncompactedMemory + 1.0));
+        _buildLogger.append(
+            "Theoretical uncompacted  memory: "                  + std::to_string(_totalUncompactedMemory                      / 1000000.0f) + " MB\n"
+            "Compacted                memory: "                  + std::to_string(_totalCompactedMemory                        / 1000000.0f) + " MB\n"
+            "Compaction  memory    reduction: "                  + std::to_string(memoryReductionRatio                         * 100.0f)     + " %%\n"
+            "Uncompacted suballocator memory: "                  + std::to_string(_resultPool->GetSuballocatorSize()           / 1000000.0f) + " MB\n"
+            "Compacted   suballocator memory: "                  + std::to_string(_compactionPool->GetSuballocatorSize()       / 1000000.0f) + " MB\n"
+            "Scratch     arena        memory: "                  + std::to_string(_scratchArena->GetStats().residentBytes      / 1000000.0f) + " MB\n"
+            "Unused      uncompacted  memory: "                  + std::to_string(_resultPool->GetFreeSuballocationsSize()     / 1000000.0f) + " MB\n"
+            "Unused      compacted    memory: "                  + std::to_string(_compactionPool->GetFreeSuballocationsSize() / 1000000.0f) + " MB\n"
+            "Scratch peak last frame /   max: "                  + std::to_string(_scratchArena->GetStats().lastFramePeakBytes / 1000000.0f) + " MB / " +
+                                                                   std::to_string(_scratchArena->GetStats().maxFramePeakBytes  / 1000000.0f) + " MB\n"
+            "Build batches    /  UAV barriers: "                  + std::to_string(_buildBatchCount)                                          + " / " +
+                                                                   std::to_string(_scratchArena->GetStats().barriers)                        + "\n"
+            "Suballocation alignment   saved: "                  + std::to_string(_compactionPool->GetAlignmentSavingSize()    / 1000000.0f) + " MB\n"
+            "Defragmented memory       moved: "                  + std::to_string(_totalDefragmentedMemory                     / 1000000.0f) + " MB\n"
+            "BLAS cache hits          /stores: "                  + std::to_string(_blasCache != nullptr ? _blasCache->GetStats().hits   : 0) + " / " +
+                                                                    std::to_string(_blasCache != nullptr ? _blasCache->GetStats().stores : 0) + "\n"
+            "Bytes per triangle       memory: "                  + std::to_string(_totalCompactedMemory / (_totalTriangles + 1))             + " Bytes\n"
+            "Total triangles in BLASes      : "                  + std::to_string(_totalTriangles)                                           + "\n"
+            "Compaction size slots in flight: "                  + std::to_string(_compactionSizeRing->GetUsedSlots())                       + " / " +
+                                                                   std::to_string(_compactionSizeOverflows)                                  + " overflowed\n"
+            "Compactions scheduled /deferred: "                  + std::to_string(_compactionStats.scheduledCount)                           + " / " +
+                                                                   std::to_string(_compactionStats.deferredCount)                            + " oldest " +
+                                                                   std::to_string(_compactionStats.oldestDeferredFrames)                     + " frames\n"
+            "Compaction copies    this frame: "                  + std::to_string(_compactionStats.copyBytes                   / 1000000.0f) + " MB / " +
+                                                                   std::to_string(_compactionStats.reclaimedBytes              / 1000000.0f) + " MB reclaimed\n"
+            "Compaction transient in  flight: "                  + std::to_string(_transientCompactionInFlight                 / 1000000.0f) + " MB\n"
+        );
+
         return _buildLogger.c_str();
     }
 }
\ No newline at end of file
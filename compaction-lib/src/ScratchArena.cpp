@@ -0,0 +1,143 @@
+#include "ScratchArena.h"
+#include <algorithm>
+
+ScratchArena::ScratchArena(ScratchArenaBackend* backend,
+                           uint32_t             frameCount,
+                           uint64_t             maxConcurrentBytes,
+                           uint32_t             alignmentInBytes,
+                           uint64_t             granularityInBytes)
+{
+    m_backend            = backend;
+    m_maxConcurrentBytes = maxConcurrentBytes;
+    m_alignment          = alignmentInBytes;
+    m_granularity        = std::max<uint64_t>(granularityInBytes, alignmentInBytes);
+    m_frameIndex         = 0;
+    m_slots.assign(std::max(frameCount, 1u), Slot{});
+    m_stats              = {};
+}
+
+ScratchArena::~ScratchArena()
+{
+    for (Slot& slot : m_slots)
+    {
+        if (slot.buffer.resource != nullptr)
+        {
+            m_backend->ReleaseBuffer(slot.buffer);
+        }
+    }
+    for (Retired& retired : m_retired)
+    {
+        m_backend->ReleaseBuffer(retired.buffer);
+    }
+}
+
+void ScratchArena::BeginFrame(uint64_t frameIndex)
+{
+    if (frameIndex != m_frameIndex)
+    {
+        m_stats.lastFramePeakBytes = m_stats.framePeakBytes;
+        m_stats.framePeakBytes     = 0;
+    }
+    m_frameIndex = frameIndex;
+
+    // Buffers outgrown frameCount frames ago aren't read anymore
+    while (m_retired.empty() == false && m_retired.front().frameIndex + m_slots.size() <= frameIndex)
+    {
+        m_stats.residentBytes -= m_retired.front().buffer.sizeInBytes;
+        m_backend->ReleaseBuffer(m_retired.front().buffer);
+        m_retired.pop_front();
+    }
+
+    // The frame that last used this slot has executed.  A slot no frame needed for a few rounds
+    // gives its buffer back so scratch doesn't stay resident once building stops, without
+    // recreating it every time a frame happens to build nothing.
+    Slot& slot      = m_slots[frameIndex % m_slots.size()];
+    slot.idleRounds = slot.used ? 0 : slot.idleRounds + 1;
+    if (slot.idleRounds >= IdleRoundsBeforeRelease && slot.buffer.resource != nullptr)
+    {
+        m_stats.residentBytes -= slot.buffer.sizeInBytes;
+        m_backend->ReleaseBuffer(slot.buffer);
+        slot.buffer = {};
+    }
+    slot.used = false;
+}
+
+void ScratchArena::PlaceBatch(const uint64_t*   scratchSizes,
+                              uint32_t          buildCount,
+                              ScratchPlacement* placements,
+                              const uint8_t*    runStarts)
+{
+    if (buildCount == 0)
+    {
+        return;
+    }
+    Slot& slot = m_slots[m_frameIndex % m_slots.size()];
+
+    // Offsets first, builds after a barrier start over at zero.  An earlier batch of the frame
+    // may still be writing its regions when this one starts.
+    std::vector<uint64_t> offsets(buildCount);
+    uint64_t              cursor = 0;
+    uint64_t              needed = 0;
+    for (uint32_t build = 0; build < buildCount; build++)
+    {
+        const uint64_t size = AlignSize(scratchSizes[build]);
+
+        placements[build].barrierBefore = build == 0 ? slot.used : false;
+        if (cursor > 0 && ((runStarts != nullptr && runStarts[build] != 0) ||
+                           (m_maxConcurrentBytes > 0 && cursor + size > m_maxConcurrentBytes)))
+        {
+            placements[build].barrierBefore = true;
+            cursor                          = 0;
+        }
+        if (placements[build].barrierBefore)
+        {
+            m_stats.barriers++;
+        }
+
+        offsets[build] = cursor;
+        cursor        += size;
+        needed         = std::max(needed, cursor);
+    }
+
+    if (slot.buffer.sizeInBytes < needed)
+    {
+        // Builds recorded earlier this frame keep reading the old buffer until it has executed,
+        // otherwise its last frame already has
+        if (slot.buffer.resource != nullptr && slot.used)
+        {
+            m_retired.push_back(Retired{slot.buffer, m_frameIndex});
+        }
+        else if (slot.buffer.resource != nullptr)
+        {
+            m_stats.residentBytes -= slot.buffer.sizeInBytes;
+            m_backend->ReleaseBuffer(slot.buffer);
+        }
+        slot.buffer = m_backend->CreateBuffer((needed + (m_granularity - 1)) / m_granularity * m_granularity);
+        m_stats.residentBytes += slot.buffer.sizeInBytes;
+        m_stats.buffersCreated++;
+    }
+
+    for (uint32_t build = 0; build < buildCount; build++)
+    {
+        placements[build].gpuVA = slot.buffer.gpuVA + offsets[build];
+    }
+
+    slot.used                 = true;
+    m_stats.framePeakBytes    = std::max(m_stats.framePeakBytes, needed);
+    m_stats.maxFramePeakBytes = std::max(m_stats.maxFramePeakBytes, needed);
+}
+
+uint64_t ScratchArena::GetMaxConcurrentBytes() const
+{
+    return m_maxConcurrentBytes;
+}
+
+const ScratchArenaStats& ScratchArena::GetStats() const
+{
+    return m_stats;
+}
+
+uint64_t ScratchArena::AlignSize(uint64_t sizeInBytes) const
+{
+    return (sizeInBytes + (m_alignment - 1)) & ~uint64_t(m_alignment - 1);
+}
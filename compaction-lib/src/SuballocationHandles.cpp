@@ -0,0 +1,69 @@
+#include "SuballocationHandles.h"
+
+SuballocationHandleTable::SuballocationHandleTable()
+{
+    m_generation = 0;
+}
+
+uint32_t SuballocationHandleTable::AddBlock()
+{
+    if (m_unusedBlockSlots.empty() == false)
+    {
+        const uint32_t blockIndex = m_unusedBlockSlots.back();
+        m_unusedBlockSlots.pop_back();
+        return blockIndex;
+    }
+    if (m_nodeGenerations.size() >= MaxBlockCount)
+    {
+        return InvalidBlock;
+    }
+    m_nodeGenerations.emplace_back();
+    return static_cast<uint32_t>(m_nodeGenerations.size() - 1);
+}
+
+void SuballocationHandleTable::RemoveBlock(uint32_t blockIndex)
+{
+    m_nodeGenerations[blockIndex].clear();
+    m_unusedBlockSlots.push_back(blockIndex);
+}
+
+SuballocationHandle SuballocationHandleTable::Issue(uint32_t blockIndex, uint32_t node)
+{
+    // Zero marks a free node so the counter skips it when it wraps
+    m_generation = (m_generation == UINT16_MAX) ? 1 : m_generation + 1;
+
+    std::vector<uint16_t>& nodeGenerations = m_nodeGenerations[blockIndex];
+    if (node >= nodeGenerations.size())
+    {
+        nodeGenerations.resize(node + 1, 0);
+    }
+    nodeGenerations[node] = m_generation;
+
+    return SuballocationHandle::Pack(blockIndex, node, m_generation);
+}
+
+bool SuballocationHandleTable::Retire(SuballocationHandle handle)
+{
+    if (IsLive(handle) == false)
+    {
+        return false;
+    }
+    m_nodeGenerations[handle.GetBlockIndex()][handle.GetNode()] = 0;
+    return true;
+}
+
+bool SuballocationHandleTable::IsLive(SuballocationHandle handle) const
+{
+    if (handle.IsNull() || handle.GetBlockIndex() >= m_nodeGenerations.size())
+    {
+        return false;
+    }
+    const std::vector<uint16_t>& nodeGenerations = m_nodeGenerations[handle.GetBlockIndex()];
+    return handle.GetNode() < nodeGenerations.size() &&
+           nodeGenerations[handle.GetNode()] == handle.GetGeneration();
+}
+
+uint32_t SuballocationHandleTable::GetBlockSlotCount() const
+{
+    return static_cast<uint32_t>(m_nodeGenerations.size());
+}
@@ -0,0 +1,120 @@
+#include "TLASUpdatePolicy.h"
+#include <cfloat>
+
+void InstanceBounds::Reset()
+{
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        min[axis] = FLT_MAX;
+        max[axis] = -FLT_MAX;
+    }
+}
+
+void InstanceBounds::Grow(float x, float y, float z)
+{
+    const float point[3] = {x, y, z};
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        min[axis] = point[axis] < min[axis] ? point[axis] : min[axis];
+        max[axis] = point[axis] > max[axis] ? point[axis] : max[axis];
+    }
+}
+
+bool InstanceBounds::IsEmpty() const
+{
+    return min[0] > max[0];
+}
+
+float InstanceBounds::SurfaceArea() const
+{
+    if (IsEmpty())
+    {
+        return 0.0f;
+    }
+    const float x = max[0] - min[0];
+    const float y = max[1] - min[1];
+    const float z = max[2] - min[2];
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+TLASUpdatePolicy::TLASUpdatePolicy(const TLASUpdateSettings& settings)
+{
+    m_settings = settings;
+    m_stats    = {};
+    Reset();
+}
+
+TLASBuildDecision TLASUpdatePolicy::Decide(const TLASFrameInputs& inputs)
+{
+    const float surfaceArea = inputs.bounds.SurfaceArea();
+
+    TLASRebuildReason reason = TLASRebuildReason::None;
+    if (m_hasBuild == false || inputs.sourceAvailable == false)
+    {
+        reason = TLASRebuildReason::NoSource;
+    }
+    else if (inputs.topologyChanged || inputs.instanceCount != m_lastInstanceCount)
+    {
+        reason = TLASRebuildReason::Topology;
+    }
+    else if (m_updatesSinceRebuild >= m_settings.maxUpdates)
+    {
+        reason = TLASRebuildReason::UpdateLimit;
+    }
+    else if (surfaceArea > m_rebuildSurfaceArea * m_settings.maxBoundsGrowth)
+    {
+        // Instances spreading out of a point or a plane count as growth too
+        reason = TLASRebuildReason::BoundsGrowth;
+    }
+
+    m_stats.rebuildOnlyCost += inputs.instanceCount;
+    m_lastInstanceCount      = inputs.instanceCount;
+    m_hasBuild               = true;
+
+    if (reason == TLASRebuildReason::None)
+    {
+        m_updatesSinceRebuild++;
+        m_stats.updates++;
+        m_stats.estimatedCost += inputs.instanceCount * static_cast<double>(m_settings.updateCost);
+        return TLASBuildDecision{TLASBuildMode::Update, reason};
+    }
+
+    m_updatesSinceRebuild       = 0;
+    m_rebuildSurfaceArea        = surfaceArea;
+    m_stats.rebuilds++;
+    m_stats.estimatedCost      += inputs.instanceCount;
+    m_stats.noSourceRebuilds    += reason == TLASRebuildReason::NoSource ? 1 : 0;
+    m_stats.topologyRebuilds    += reason == TLASRebuildReason::Topology ? 1 : 0;
+    m_stats.updateLimitRebuilds += reason == TLASRebuildReason::UpdateLimit ? 1 : 0;
+    m_stats.boundsRebuilds      += reason == TLASRebuildReason::BoundsGrowth ? 1 : 0;
+    return TLASBuildDecision{TLASBuildMode::Rebuild, reason};
+}
+
+void TLASUpdatePolicy::Reset()
+{
+    m_lastInstanceCount   = 0;
+    m_updatesSinceRebuild = 0;
+    m_rebuildSurfaceArea  = 0.0f;
+    m_hasBuild            = false;
+}
+
+uint32_t TLASUpdatePolicy::GetUpdatesSinceRebuild() const
+{
+    return m_updatesSinceRebuild;
+}
+
+const TLASUpdateStats& TLASUpdatePolicy::GetStats() const
+{
+    return m_stats;
+}
+
+double TLASUpdatePolicy::RebuildToUpdateRatio(const TLASUpdateStats& stats)
+{
+    const double rebuilds = static_cast<double>(stats.rebuilds);
+    return stats.updates > 0 ? rebuilds / stats.updates : rebuilds;
+}
+
+double TLASUpdatePolicy::SavedFraction(const TLASUpdateStats& stats)
+{
+    return stats.rebuildOnlyCost > 0.0 ? 1.0 - stats.estimatedCost / stats.rebuildOnlyCost : 0.0;
+}
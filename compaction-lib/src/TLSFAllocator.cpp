@@ -0,0 +1,600 @@
+#include "TLSFAllocator.h"
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    uint32_t LowestSetBit(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return index;
+#else
+        return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+    }
+
+    uint32_t HighestSetBit(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return index;
+#else
+        return 31u - static_cast<uint32_t>(__builtin_clz(value));
+#endif
+    }
+}
+
+TLSFAllocator::TLSFAllocator(uint32_t capacityInBytes, uint32_t granularityInBytes)
+{
+    m_granularityLog2 = HighestSetBit(granularityInBytes == 0 ? 1 : granularityInBytes);
+    m_capacity        = capacityInBytes >> m_granularityLog2;
+    Reset();
+}
+
+void TLSFAllocator::Reset()
+{
+    m_usedSize         = 0;
+    m_allocationCount  = 0;
+    m_freeRangeCount   = 0;
+    m_firstLevelBitmap = 0;
+    memset(m_secondLevelBitmaps, 0, sizeof(m_secondLevelBitmaps));
+    memset(m_freeHeads, 0xFF, sizeof(m_freeHeads));
+    m_nodes.clear();
+    m_unusedNodes.clear();
+
+    if (m_capacity > 0)
+    {
+        InsertFreeNode(CreateNode(0, m_capacity, InvalidNode, InvalidNode));
+    }
+}
+
+TLSFAllocator::Allocation TLSFAllocator::Allocate(uint32_t sizeInBytes, uint32_t alignmentInBytes)
+{
+    Allocation allocation = {0, 0, InvalidNode};
+
+    const uint32_t granularityMask = (1u << m_granularityLog2) - 1;
+    const uint64_t size            = (static_cast<uint64_t>(sizeInBytes) + granularityMask) >> m_granularityLog2;
+    const uint32_t alignment       = alignmentInBytes > granularityMask ? (alignmentInBytes >> m_granularityLog2) : 1;
+    if (size == 0 || size > m_capacity)
+    {
+        return allocation;
+    }
+
+    // Ask for enough extra that any range found can be aligned inside itself
+    const uint64_t searchSize = size + alignment - 1;
+    if (searchSize > m_capacity)
+    {
+        return allocation;
+    }
+    uint32_t node = FindFreeNode(static_cast<uint32_t>(searchSize));
+    if (node == InvalidNode)
+    {
+        return allocation;
+    }
+    RemoveFreeNode(node);
+
+    // Front padding becomes its own free range.  The range before a free one is always in use
+    // so there is nothing to merge it with.
+    const uint32_t padding = ((m_nodes[node].offset + alignment - 1) & ~(alignment - 1)) - m_nodes[node].offset;
+    if (padding > 0)
+    {
+        uint32_t front = CreateNode(m_nodes[node].offset, padding, m_nodes[node].prevPhysical, node);
+        if (m_nodes[front].prevPhysical != InvalidNode)
+        {
+            m_nodes[m_nodes[front].prevPhysical].nextPhysical = front;
+        }
+        m_nodes[node].prevPhysical  = front;
+        m_nodes[node].offset       += padding;
+        m_nodes[node].size         -= padding;
+        InsertFreeNode(front);
+    }
+
+    // The tail goes back on the free lists, again with an in use neighbour after it
+    if (m_nodes[node].size > size)
+    {
+        uint32_t tail = CreateNode(m_nodes[node].offset + static_cast<uint32_t>(size),
+                                   m_nodes[node].size - static_cast<uint32_t>(size),
+                                   node,
+                                   m_nodes[node].nextPhysical);
+        if (m_nodes[tail].nextPhysical != InvalidNode)
+        {
+            m_nodes[m_nodes[tail].nextPhysical].prevPhysical = tail;
+        }
+        m_nodes[node].nextPhysical = tail;
+        m_nodes[node].size         = static_cast<uint32_t>(size);
+        InsertFreeNode(tail);
+    }
+
+    m_usedSize += m_nodes[node].size;
+    m_allocationCount++;
+
+    allocation.offset = m_nodes[node].offset << m_granularityLog2;
+    allocation.size   = m_nodes[node].size << m_granularityLog2;
+    allocation.node   = node;
+    return allocation;
+}
+
+void TLSFAllocator::Free(uint32_t node)
+{
+    if (node >= m_nodes.size() || m_nodes[node].isFree || m_nodes[node].size == 0)
+    {
+        return;
+    }
+
+    m_usedSize -= m_nodes[node].size;
+    m_allocationCount--;
+
+    // Absorb free physical neighbours on both sides
+    uint32_t previous = m_nodes[node].prevPhysical;
+    if (previous != InvalidNode && m_nodes[previous].isFree)
+    {
+        RemoveFreeNode(previous);
+        m_nodes[previous].size         += m_nodes[node].size;
+        m_nodes[previous].nextPhysical  = m_nodes[node].nextPhysical;
+        if (m_nodes[node].nextPhysical != InvalidNode)
+        {
+            m_nodes[m_nodes[node].nextPhysical].prevPhysical = previous;
+        }
+        ReleaseNode(node);
+        node = previous;
+    }
+
+    uint32_t next = m_nodes[node].nextPhysical;
+    if (next != InvalidNode && m_nodes[next].isFree)
+    {
+        RemoveFreeNode(next);
+        m_nodes[node].size         += m_nodes[next].size;
+        m_nodes[node].nextPhysical  = m_nodes[next].nextPhysical;
+        if (m_nodes[next].nextPhysical != InvalidNode)
+        {
+            m_nodes[m_nodes[next].nextPhysical].prevPhysical = node;
+        }
+        ReleaseNode(next);
+    }
+
+    InsertFreeNode(node);
+}
+
+uint32_t TLSFAllocator::GetCapacity() const
+{
+    return m_capacity << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetGranularity() const
+{
+    return 1u << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetUsedSize() const
+{
+    return m_usedSize << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetFreeSize() const
+{
+    return (m_capacity - m_usedSize) << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetAllocationCount() const
+{
+    return m_allocationCount;
+}
+
+uint32_t TLSFAllocator::GetFreeRangeCount() const
+{
+    return m_freeRangeCount;
+}
+
+uint32_t TLSFAllocator::GetLargestFreeRange() const
+{
+    if (m_firstLevelBitmap == 0)
+    {
+        return 0;
+    }
+
+    // Only the highest non empty bin can hold the largest range, walk just that one list
+    uint32_t firstLevel  = HighestSetBit(m_firstLevelBitmap);
+    uint32_t secondLevel = HighestSetBit(m_secondLevelBitmaps[firstLevel]);
+    uint32_t largest     = 0;
+    for (uint32_t node = m_freeHeads[firstLevel][secondLevel]; node != InvalidNode; node = m_nodes[node].nextFree)
+    {
+        largest = m_nodes[node].size > largest ? m_nodes[node].size : largest;
+    }
+    return largest << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetLargestFreeBin() const
+{
+    if (m_firstLevelBitmap == 0)
+    {
+        return InvalidBin;
+    }
+    uint32_t firstLevel = HighestSetBit(m_firstLevelBitmap);
+    return firstLevel * SecondLevelCount + HighestSetBit(m_secondLevelBitmaps[firstLevel]);
+}
+
+uint32_t TLSFAllocator::GetNodeOffset(uint32_t node) const
+{
+    return m_nodes[node].offset << m_granularityLog2;
+}
+
+uint32_t TLSFAllocator::GetNodeSize(uint32_t node) const
+{
+    return m_nodes[node].size << m_granularityLog2;
+}
+
+bool TLSFAllocator::Validate() const
+{
+    if (m_capacity == 0)
+    {
+        return m_nodes.empty();
+    }
+
+    // The first range starts at zero, find it through any live node
+    uint32_t first = InvalidNode;
+    for (uint32_t node = 0; node < m_nodes.size(); node++)
+    {
+        if (m_nodes[node].size > 0 && m_nodes[node].prevPhysical == InvalidNode)
+        {
+            first = node;
+            break;
+        }
+    }
+    if (first == InvalidNode || m_nodes[first].offset != 0)
+    {
+        return false;
+    }
+
+    uint32_t offset     = 0;
+    uint32_t used       = 0;
+    uint32_t allocated  = 0;
+    uint32_t freeRanges = 0;
+    bool     wasFree    = false;
+    for (uint32_t node = first; node != InvalidNode; node = m_nodes[node].nextPhysical)
+    {
+        const Node& current = m_nodes[node];
+        if (current.offset != offset || current.size == 0)
+        {
+            return false;
+        }
+        if (current.nextPhysical != InvalidNode && m_nodes[current.nextPhysical].prevPhysical != node)
+        {
+            return false;
+        }
+        if (current.isFree)
+        {
+            // Coalescing leaves no two free ranges side by side
+            if (wasFree)
+            {
+                return false;
+            }
+            uint32_t firstLevel, secondLevel;
+            MappingInsert(current.size, firstLevel, secondLevel);
+            if ((m_secondLevelBitmaps[firstLevel] & (1u << secondLevel)) == 0)
+            {
+                return false;
+            }
+            freeRanges++;
+        }
+        else
+        {
+            used += current.size;
+            allocated++;
+        }
+        wasFree = current.isFree;
+        offset += current.size;
+    }
+
+    uint32_t listed = 0;
+    for (uint32_t firstLevel = 0; firstLevel < FirstLevelCount; firstLevel++)
+    {
+        for (uint32_t secondLevel = 0; secondLevel < SecondLevelCount; secondLevel++)
+        {
+            bool hasHead = m_freeHeads[firstLevel][secondLevel] != InvalidNode;
+            if (hasHead != ((m_secondLevelBitmaps[firstLevel] >> secondLevel) & 1u))
+            {
+                return false;
+            }
+            for (uint32_t node = m_freeHeads[firstLevel][secondLevel]; node != InvalidNode; node = m_nodes[node].nextFree)
+            {
+                if (m_nodes[node].isFree == false)
+                {
+                    return false;
+                }
+                listed++;
+            }
+        }
+        if (((m_firstLevelBitmap >> firstLevel) & 1u) != (m_secondLevelBitmaps[firstLevel] != 0))
+        {
+            return false;
+        }
+    }
+
+    return offset == m_capacity && used == m_usedSize && allocated == m_allocationCount &&
+           freeRanges == m_freeRangeCount && listed == freeRanges;
+}
+
+void TLSFAllocator::GetRequestBins(uint32_t  sizeInBytes,
+                                   uint32_t  alignmentInBytes,
+                                   uint32_t  granularityInBytes,
+                                   uint32_t& fitBin,
+                                   uint32_t& exactBin)
+{
+    fitBin   = InvalidBin;
+    exactBin = InvalidBin;
+
+    const uint32_t granularityLog2 = HighestSetBit(granularityInBytes == 0 ? 1 : granularityInBytes);
+    const uint32_t granularityMask = (1u << granularityLog2) - 1;
+    const uint64_t size            = (static_cast<uint64_t>(sizeInBytes) + granularityMask) >> granularityLog2;
+    const uint32_t alignment       = alignmentInBytes > granularityMask ? (alignmentInBytes >> granularityLog2) : 1;
+    const uint64_t searchSize      = size + alignment - 1;
+    if (size == 0 || searchSize > UINT32_MAX)
+    {
+        return;
+    }
+
+    uint32_t firstLevel, secondLevel;
+    MappingInsert(static_cast<uint32_t>(searchSize), firstLevel, secondLevel);
+    exactBin = firstLevel * SecondLevelCount + secondLevel;
+    if (MappingSearch(static_cast<uint32_t>(searchSize), firstLevel, secondLevel) && firstLevel < FirstLevelCount)
+    {
+        fitBin = firstLevel * SecondLevelCount + secondLevel;
+    }
+}
+
+void TLSFAllocator::MappingInsert(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    if (size < SecondLevelCount)
+    {
+        firstLevel  = 0;
+        secondLevel = size;
+    }
+    else
+    {
+        uint32_t log2 = HighestSetBit(size);
+        firstLevel    = log2 - SecondLevelLog2 + 1;
+        secondLevel   = (size >> (log2 - SecondLevelLog2)) - SecondLevelCount;
+    }
+}
+
+bool TLSFAllocator::MappingSearch(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    // Round up to the next bin boundary so every range in the chosen bin is big enough
+    uint64_t rounded = size;
+    if (size >= SecondLevelCount)
+    {
+        rounded += (1ull << (HighestSetBit(size) - SecondLevelLog2)) - 1;
+        if (rounded > UINT32_MAX)
+        {
+            return false;
+        }
+    }
+    MappingInsert(static_cast<uint32_t>(rounded), firstLevel, secondLevel);
+    return true;
+}
+
+uint32_t TLSFAllocator::FindFreeNode(uint32_t size) const
+{
+    uint32_t firstLevel, secondLevel;
+    if (MappingSearch(size, firstLevel, secondLevel) && firstLevel < FirstLevelCount)
+    {
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+        if (secondLevelMap == 0)
+        {
+            uint32_t firstLevelMap = firstLevel + 1 < 32 ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+            if (firstLevelMap != 0)
+            {
+                firstLevel     = LowestSetBit(firstLevelMap);
+                secondLevelMap = m_secondLevelBitmaps[firstLevel];
+            }
+        }
+        if (secondLevelMap != 0)
+        {
+            secondLevel = LowestSetBit(secondLevelMap);
+            return m_freeHeads[firstLevel][secondLevel];
+        }
+    }
+
+    // Rounding up skips the request's own bin, which can still hold a range that fits exactly,
+    // e.g. a dedicated block asked for its whole capacity.  Only reached when nothing larger is
+    // free, so walking that one list keeps the common path constant time.
+    MappingInsert(size, firstLevel, secondLevel);
+    for (uint32_t node = m_freeHeads[firstLevel][secondLevel]; node != InvalidNode; node = m_nodes[node].nextFree)
+    {
+        if (m_nodes[node].size >= size)
+        {
+            return node;
+        }
+    }
+    return InvalidNode;
+}
+
+void TLSFAllocator::InsertFreeNode(uint32_t node)
+{
+    uint32_t firstLevel, secondLevel;
+    MappingInsert(m_nodes[node].size, firstLevel, secondLevel);
+
+    uint32_t head           = m_freeHeads[firstLevel][secondLevel];
+    m_nodes[node].isFree    = true;
+    m_nodes[node].prevFree  = InvalidNode;
+    m_nodes[node].nextFree  = head;
+    if (head != InvalidNode)
+    {
+        m_nodes[head].prevFree = node;
+    }
+    m_freeHeads[firstLevel][secondLevel]  = node;
+    m_secondLevelBitmaps[firstLevel]     |= 1u << secondLevel;
+    m_firstLevelBitmap                   |= 1u << firstLevel;
+    m_freeRangeCount++;
+}
+
+void TLSFAllocator::RemoveFreeNode(uint32_t node)
+{
+    uint32_t firstLevel, secondLevel;
+    MappingInsert(m_nodes[node].size, firstLevel, secondLevel);
+
+    uint32_t previous = m_nodes[node].prevFree;
+    uint32_t next     = m_nodes[node].nextFree;
+    if (previous != InvalidNode)
+    {
+        m_nodes[previous].nextFree = next;
+    }
+    else
+    {
+        m_freeHeads[firstLevel][secondLevel] = next;
+        if (next == InvalidNode)
+        {
+            m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+            {
+                m_firstLevelBitmap &= ~(1u << firstLevel);
+            }
+        }
+    }
+    if (next != InvalidNode)
+    {
+        m_nodes[next].prevFree = previous;
+    }
+    m_nodes[node].isFree = false;
+    m_freeRangeCount--;
+}
+
+uint32_t TLSFAllocator::CreateNode(uint32_t offset, uint32_t size, uint32_t prevPhysical, uint32_t nextPhysical)
+{
+    Node created = {offset, size, prevPhysical, nextPhysical, InvalidNode, InvalidNode, false};
+    if (m_unusedNodes.empty() == false)
+    {
+        uint32_t node = m_unusedNodes.back();
+        m_unusedNodes.pop_back();
+        m_nodes[node] = created;
+        return node;
+    }
+    m_nodes.push_back(created);
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void TLSFAllocator::ReleaseNode(uint32_t node)
+{
+    m_nodes[node].size   = 0;
+    m_nodes[node].isFree = false;
+    m_unusedNodes.push_back(node);
+}
+
+TLSFBlockIndex::TLSFBlockIndex()
+{
+    m_firstLevelBitmap = 0;
+    memset(m_secondLevelBitmaps, 0, sizeof(m_secondLevelBitmaps));
+    memset(m_binHeads, 0xFF, sizeof(m_binHeads));
+}
+
+void TLSFBlockIndex::Update(uint32_t block, const TLSFAllocator& allocator)
+{
+    if (block >= m_entries.size())
+    {
+        m_entries.resize(block + 1, Entry{TLSFAllocator::InvalidBin, InvalidBlock, InvalidBlock});
+    }
+
+    uint32_t bin = allocator.GetLargestFreeBin();
+    if (m_entries[block].bin == bin)
+    {
+        return;
+    }
+    Unlink(block);
+    if (bin != TLSFAllocator::InvalidBin)
+    {
+        Link(block, bin);
+    }
+}
+
+void TLSFBlockIndex::Remove(uint32_t block)
+{
+    if (block < m_entries.size())
+    {
+        Unlink(block);
+    }
+}
+
+uint32_t TLSFBlockIndex::FindBlock(uint32_t bin) const
+{
+    if (bin >= TLSFAllocator::BinCount)
+    {
+        return InvalidBlock;
+    }
+
+    uint32_t firstLevel     = bin / TLSFAllocator::SecondLevelCount;
+    uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << (bin % TLSFAllocator::SecondLevelCount));
+    if (secondLevelMap == 0)
+    {
+        uint32_t firstLevelMap = firstLevel + 1 < 32 ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+        if (firstLevelMap == 0)
+        {
+            return InvalidBlock;
+        }
+        firstLevel     = LowestSetBit(firstLevelMap);
+        secondLevelMap = m_secondLevelBitmaps[firstLevel];
+    }
+    return m_binHeads[firstLevel * TLSFAllocator::SecondLevelCount + LowestSetBit(secondLevelMap)];
+}
+
+uint32_t TLSFBlockIndex::GetFirstInBin(uint32_t bin) const
+{
+    return bin < TLSFAllocator::BinCount ? m_binHeads[bin] : InvalidBlock;
+}
+
+uint32_t TLSFBlockIndex::GetNextInBin(uint32_t block) const
+{
+    return m_entries[block].nextInBin;
+}
+
+void TLSFBlockIndex::Link(uint32_t block, uint32_t bin)
+{
+    uint32_t head    = m_binHeads[bin];
+    m_entries[block] = Entry{bin, InvalidBlock, head};
+    if (head != InvalidBlock)
+    {
+        m_entries[head].prevInBin = block;
+    }
+    m_binHeads[bin] = block;
+
+    uint32_t firstLevel               = bin / TLSFAllocator::SecondLevelCount;
+    m_secondLevelBitmaps[firstLevel] |= 1u << (bin % TLSFAllocator::SecondLevelCount);
+    m_firstLevelBitmap               |= 1u << firstLevel;
+}
+
+void TLSFBlockIndex::Unlink(uint32_t block)
+{
+    Entry& entry = m_entries[block];
+    if (entry.bin == TLSFAllocator::InvalidBin)
+    {
+        return;
+    }
+
+    if (entry.prevInBin != InvalidBlock)
+    {
+        m_entries[entry.prevInBin].nextInBin = entry.nextInBin;
+    }
+    else
+    {
+        m_binHeads[entry.bin] = entry.nextInBin;
+        if (entry.nextInBin == InvalidBlock)
+        {
+            uint32_t firstLevel                = entry.bin / TLSFAllocator::SecondLevelCount;
+            m_secondLevelBitmaps[firstLevel]  &= ~(1u << (entry.bin % TLSFAllocator::SecondLevelCount));
+            if (m_secondLevelBitmaps[firstLevel] == 0)
+            {
+                m_firstLevelBitmap &= ~(1u << firstLevel);
+            }
+        }
+    }
+    if (entry.nextInBin != InvalidBlock)
+    {
+        m_entries[entry.nextInBin].prevInBin = entry.prevInBin;
+    }
+    entry = Entry{TLSFAllocator::InvalidBin, InvalidBlock, InvalidBlock};
+}
@@ -41,12 +41,12 @@ struct D3DBuffer
     DXGI_FORMAT                 indexBufferFormat;
 };
 
+// Position stays full float since the acceleration structure builds read it in place
 struct CompressedAttribute
 {
     float    vertex[3];
-    uint16_t normal[3];
-    uint16_t uv[2];
-    uint16_t padding;
+    uint32_t normal; // Octahedral, snorm16 x in the low half and y in the high half
+    uint32_t uv;     // Half float u in the low half and v in the high half
 };
 
 using namespace Microsoft::WRL;
@@ -2,7 +2,7 @@
 #include "DXLayer.h"
 #include "EngineManager.h"
 #include "Model.h"
-#include "FloatConverter.h"
+#include "Packing.h"
 
 #include "AnimatedModel.h"
 
@@ -103,22 +103,20 @@ void VAO::createVAO(RenderBuffers* renderBuffers, ModelClass classId, AnimatedMo
 
     for (int i = 0; i < vertices->size(); i++)
     {
-        float* flatVert   = (*vertices)[i].getFlatBuffer();
-        float* flatNormal = (*normals)[i].getFlatBuffer();
-        float* flatUV     = (*textures)[i].getFlatBuffer();
+        float* flatVert = (*vertices)[i].getFlatBuffer();
 
         compressedAttributes[i].vertex[0] = flatVert[0];
         compressedAttributes[i].vertex[1] = flatVert[1];
         compressedAttributes[i].vertex[2] = flatVert[2];
+    }
 
-        compressedAttributes[i].normal[0] = floatToHalfFloat(flatNormal[0]);
-        compressedAttributes[i].normal[1] = floatToHalfFloat(flatNormal[1]);
-        compressedAttributes[i].normal[2] = floatToHalfFloat(flatNormal[2]);
-
-        compressedAttributes[i].uv[0] = floatToHalfFloat(flatUV[0]);
-        compressedAttributes[i].uv[1] = floatToHalfFloat(flatUV[1]);
-
-        compressedAttributes[i].padding = floatToHalfFloat(0.0);
+    // Normals and uvs are converted a whole stream at a time straight into the interleaved layout
+    if (triBuffSize > 0)
+    {
+        Packing::encodeOctahedral(normals->data(), triBuffSize, &compressedAttributes[0].normal,
+                                  sizeof(CompressedAttribute));
+        Packing::packHalf2((*textures)[0].getFlatBuffer(), triBuffSize,
+                           &compressedAttributes[0].uv, sizeof(CompressedAttribute));
     }
 
     UINT compressedAttributeByteSize = triBuffSize * sizeof(CompressedAttribute);
@@ -4,5 +4,6 @@
 #define MAX_SRVS 128
 #define NUM_SWAP_CHAIN_BUFFERS 3
 #define CMD_LIST_NUM NUM_SWAP_CHAIN_BUFFERS
+#define BUILD_WORKER_CMD_LIST_NUM 4
 #define TIME_QUERIES_PER_CMD_LIST 8
 #define TIME_QUERY_COUNT CMD_LIST_NUM* TIME_QUERIES_PER_CMD_LIST
\ No newline at end of file
@@ -43,6 +43,9 @@ class DXLayer
     ComPtr<ID3D12GraphicsCommandList4> getTextureCopyCmdList();
     ComPtr<ID3D12GraphicsCommandList4> getComputeCmdList();
     ComPtr<ID3D12GraphicsCommandList4> getCmdList();
+    // Lists bottom level builds are recorded on by worker threads, submitted right ahead of the
+    // frame's build command list once handed out, returns how many were written to cmdLists
+    UINT                               getBuildWorkerCmdLists(ID3D12GraphicsCommandList4** cmdLists);
     ComPtr<ID3D12Device>               getDevice();
     ComPtr<IDXGIAdapter>               getAdapter();
     static DXLayer*                    instance();
@@ -58,6 +61,8 @@ class DXLayer
     DXLayer(HINSTANCE hInstance, int cmdShow);
     ~DXLayer();
 
+    UINT                               closeBuildWorkerCmdLists(int cmdListIndex, ID3D12CommandList** cmdLists);
+
     const DXGI_FORMAT                  _rtvFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
 
     ComPtr<ID3D12Device>               _device;
@@ -85,6 +90,10 @@ class DXLayer
     ComPtr<ID3D12GraphicsCommandList4> _attributeBufferCopyCmdLists[CMD_LIST_NUM];
     ComPtr<ID3D12GraphicsCommandList4> _textureCopyCmdLists[CMD_LIST_NUM];
 
+    ComPtr<ID3D12CommandAllocator>     _buildWorkerCmdAllocators[CMD_LIST_NUM][BUILD_WORKER_CMD_LIST_NUM];
+    ComPtr<ID3D12GraphicsCommandList4> _buildWorkerCmdLists[CMD_LIST_NUM][BUILD_WORKER_CMD_LIST_NUM];
+    bool                               _buildWorkerCmdListsUsed[CMD_LIST_NUM];
+
 
     bool                               _rayTracingEnabled;
     PresentTarget*                     _presentTarget;
@@ -105,6 +114,9 @@ class DXLayer
     std::string                        _perfData;
     bool                               _useAsyncCompute = false;
     bool                               _useAsyncCopyInFrame = false;
+    // Off until the worker lists have run under the debug layer, the builds rely on the list
+    // boundaries to order scratch reuse across lanes
+    bool                               _useBuildWorkerCmdLists = false;
     std::queue<uint32_t>               _finishedCmdLists;
     clock_t                            _previousFrameTime;
     clock_t                            _previousCpuTime;
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <vector>
-#include <random>
 #include <numeric>
 #include "DXLayer.h"
+#include "Random.h"
 
 namespace Samplers {
 
@@ -19,10 +19,12 @@ namespace Samplers {
     class Sampler
     {
         static const UINT s_seed = 1729;
-        std::function<UINT()> GetRandomJump;        // Generates a random uniform index within [0, m_numSamples - 1]
-        std::function<UINT()> GetRandomSetJump;     // Generates a random uniform index within [0, m_numSampleSets - 1]
-        std::function<float()> GetRandomFloat01;    // Generates a random uniform float within [0,1)
-        std::function<float()> GetRandomFloat01inclusive; // Generates a random uniform float within [0,1]
+        // Generates a random uniform index within [0, m_numSamples - 1]
+        UINT GetRandomJump() { return m_generatorURNG.nextUInt(m_numSamples); }
+        // Generates a random uniform index within [0, m_numSampleSets - 1]
+        UINT GetRandomSetJump() { return m_generatorURNG.nextUInt(m_numSampleSets); }
+        // Generates a random uniform float within [0,1)
+        float GetRandomFloat01() { return m_generatorURNG.nextFloat(); }
     public:
         // Constructor, desctructor
         Sampler();
@@ -47,7 +49,7 @@ namespace Samplers {
         UINT GetRandomNumber(UINT min, UINT max);
 
         
-        std::mt19937 m_generatorURNG;  // Uniform random number generator
+        ::Random::PCG32 m_generatorURNG;  // Uniform random number generator
         UINT m_numSamples;      // number of samples in a set (pattern).
         UINT m_numSampleSets;   // number of sample sets.
         std::vector<UnitSquareSample2D> m_samples; // samples on a unit square.
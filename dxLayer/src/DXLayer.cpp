@@ -155,6 +155,20 @@ DXLayer::DXLayer(HINSTANCE hInstance, int cmdShow) : _cmdShow(cmdShow), _cmdList
         _device->CreateFence(0, D3D12_FENCE_FLAG_NONE,
                              IID_PPV_ARGS(_copyCmdListFence[i].GetAddressOf()));
 
+        // Build worker stuff, the same type as the list the rest of the builds go on
+        D3D12_COMMAND_LIST_TYPE buildCmdListType = _useAsyncCompute ? D3D12_COMMAND_LIST_TYPE_COMPUTE
+                                                                    : D3D12_COMMAND_LIST_TYPE_DIRECT;
+        for (int worker = 0; _useBuildWorkerCmdLists && worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+        {
+            _device->CreateCommandAllocator(buildCmdListType,
+                                            IID_PPV_ARGS(_buildWorkerCmdAllocators[i][worker].GetAddressOf()));
+
+            _device->CreateCommandList(0, buildCmdListType, _buildWorkerCmdAllocators[i][worker].Get(), nullptr,
+                                       IID_PPV_ARGS(_buildWorkerCmdLists[i][worker].GetAddressOf()));
+            _buildWorkerCmdLists[i][worker]->Close();
+        }
+        _buildWorkerCmdListsUsed[i] = false;
+
         _finishedCmdLists.push(i);
     }
 
@@ -169,6 +183,12 @@ DXLayer::DXLayer(HINSTANCE hInstance, int cmdShow) : _cmdShow(cmdShow), _cmdList
     _copyTextureCmdAllocator[0]->Reset();
     _textureCopyCmdLists[0]->Reset(_copyTextureCmdAllocator[0].Get(), nullptr);
 
+    for (int worker = 0; _useBuildWorkerCmdLists && worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+    {
+        _buildWorkerCmdAllocators[0][worker]->Reset();
+        _buildWorkerCmdLists[0][worker]->Reset(_buildWorkerCmdAllocators[0][worker].Get(), nullptr);
+    }
+
     // Describe and create a heap for timestamp queries
     D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
     queryHeapDesc.Count                 = TIME_QUERY_COUNT;
@@ -282,6 +302,12 @@ void DXLayer::initCmdLists()
         _computeCmdLists[_cmdListIndex]->Reset(_computeCmdAllocator[_cmdListIndex].Get(), nullptr);
     }
 
+    for (int worker = 0; _useBuildWorkerCmdLists && worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+    {
+        _buildWorkerCmdAllocators[_cmdListIndex][worker]->Reset();
+        _buildWorkerCmdLists[_cmdListIndex][worker]->Reset(_buildWorkerCmdAllocators[_cmdListIndex][worker].Get(), nullptr);
+    }
+
     if (_useAsyncCopyInFrame)
     {
         _copyAttributeBufferCmdAllocator[_cmdListIndex]->Reset();
@@ -444,9 +470,14 @@ void DXLayer::flushCommandList(RenderTexture* renderFrame)
 
     if (_useAsyncCompute)
     {
-        // Submit the async compute command list for acceleration structure build
+        // Submit the async compute command list for acceleration structure build, the builds
+        // recorded on worker lists go first
+        ID3D12CommandList* cmdLists[BUILD_WORKER_CMD_LIST_NUM + 1];
+        UINT               cmdListCount = closeBuildWorkerCmdLists(prevCmdListIndex, cmdLists);
+
         _computeCmdLists[prevCmdListIndex]->Close();
-        _computeCmdQueue->ExecuteCommandLists(1, CommandListCast(_computeCmdLists[prevCmdListIndex].GetAddressOf()));
+        cmdLists[cmdListCount++] = _computeCmdLists[prevCmdListIndex].Get();
+        _computeCmdQueue->ExecuteCommandLists(cmdListCount, cmdLists);
 
         int fenceValue = _computeNextFenceValue[prevCmdListIndex]++;
         _computeCmdQueue->Signal(_computeCmdListFence[prevCmdListIndex].Get(), fenceValue);
@@ -499,10 +530,14 @@ void DXLayer::flushCommandList(RenderTexture* renderFrame)
 
     getTimestamp(prevCmdListIndex);
 
-    // Submit the current command list
+    // Submit the current command list, behind the build worker lists when the builds are on it
+    ID3D12CommandList* cmdLists[BUILD_WORKER_CMD_LIST_NUM + 1];
+    UINT               cmdListCount = _useAsyncCompute ? 0 : closeBuildWorkerCmdLists(prevCmdListIndex, cmdLists);
+
     _gfxCmdLists[prevCmdListIndex]->Close();
+    cmdLists[cmdListCount++] = _gfxCmdLists[prevCmdListIndex].Get();
 
-    _gfxCmdQueue->ExecuteCommandLists(1, CommandListCast(_gfxCmdLists[prevCmdListIndex].GetAddressOf()));
+    _gfxCmdQueue->ExecuteCommandLists(cmdListCount, cmdLists);
 
     HRESULT result = _presentTarget->present();
 #ifdef _DEBUG
@@ -657,8 +692,12 @@ void DXLayer::fenceCommandList()
 
     {
     // Submit the graphics command list
+    ID3D12CommandList* cmdLists[BUILD_WORKER_CMD_LIST_NUM + 1];
+    UINT               cmdListCount = _useAsyncCompute ? 0 : closeBuildWorkerCmdLists(_cmdListIndex, cmdLists);
+
     _gfxCmdLists[_cmdListIndex]->Close();
-    _gfxCmdQueue->ExecuteCommandLists(1, CommandListCast(_gfxCmdLists[_cmdListIndex].GetAddressOf()));
+    cmdLists[cmdListCount++] = _gfxCmdLists[_cmdListIndex].Get();
+    _gfxCmdQueue->ExecuteCommandLists(cmdListCount, cmdLists);
 
     int fenceValue = _gfxNextFenceValue[_cmdListIndex]++;
     _gfxCmdQueue->Signal(_gfxCmdListFence[_cmdListIndex].Get(), fenceValue);
@@ -671,8 +710,12 @@ void DXLayer::fenceCommandList()
 
     {
     // Submit the compute command list
+    ID3D12CommandList* cmdLists[BUILD_WORKER_CMD_LIST_NUM + 1];
+    UINT               cmdListCount = _useAsyncCompute ? closeBuildWorkerCmdLists(_cmdListIndex, cmdLists) : 0;
+
     _computeCmdLists[_cmdListIndex]->Close();
-    _computeCmdQueue->ExecuteCommandLists(1, CommandListCast(_computeCmdLists[_cmdListIndex].GetAddressOf()));
+    cmdLists[cmdListCount++] = _computeCmdLists[_cmdListIndex].Get();
+    _computeCmdQueue->ExecuteCommandLists(cmdListCount, cmdLists);
 
     int fenceValue = _computeNextFenceValue[_cmdListIndex]++;
     _computeCmdQueue->Signal(_computeCmdListFence[_cmdListIndex].Get(), fenceValue);
@@ -685,6 +728,47 @@ void DXLayer::fenceCommandList()
 
 }
 
+UINT DXLayer::getBuildWorkerCmdLists(ID3D12GraphicsCommandList4** cmdLists)
+{
+    // No worker lists means the builds get recorded on the frame's own list
+    if (_useBuildWorkerCmdLists == false)
+    {
+        return 0;
+    }
+
+    _buildWorkerCmdListsUsed[_cmdListIndex] = true;
+    for (int worker = 0; worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+    {
+        cmdLists[worker] = _buildWorkerCmdLists[_cmdListIndex][worker].Get();
+    }
+    return BUILD_WORKER_CMD_LIST_NUM;
+}
+
+UINT DXLayer::closeBuildWorkerCmdLists(int cmdListIndex, ID3D12CommandList** cmdLists)
+{
+    if (_useBuildWorkerCmdLists == false)
+    {
+        return 0;
+    }
+
+    // Every worker list was opened with the frame, only the ones handed out get submitted
+    for (int worker = 0; worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+    {
+        _buildWorkerCmdLists[cmdListIndex][worker]->Close();
+    }
+    if (_buildWorkerCmdListsUsed[cmdListIndex] == false)
+    {
+        return 0;
+    }
+
+    _buildWorkerCmdListsUsed[cmdListIndex] = false;
+    for (int worker = 0; worker < BUILD_WORKER_CMD_LIST_NUM; worker++)
+    {
+        cmdLists[worker] = _buildWorkerCmdLists[cmdListIndex][worker].Get();
+    }
+    return BUILD_WORKER_CMD_LIST_NUM;
+}
+
 ComPtr<ID3D12Device>               DXLayer::getDevice()          { return _device; }
 ComPtr<ID3D12GraphicsCommandList4> DXLayer::getCmdList()         { return _gfxCmdLists[_cmdListIndex]; }
 ComPtr<ID3D12GraphicsCommandList4> DXLayer::getComputeCmdList()  { return _computeCmdLists[_cmdListIndex];}
@@ -52,25 +52,9 @@ void Sampler::Reset(UINT numSamples, UINT numSampleSets, HemisphereDistribution:
     m_shuffledIndices.resize(m_numSamples * m_numSampleSets);
     m_hemisphereSamples.resize(m_numSamples * m_numSampleSets, HemisphereSample3D(FLT_MAX, FLT_MAX, FLT_MAX));
     
-    // Reset generator and initialize distributions.
-    {
-        // Initialize to the same seed for determinism.
-        m_generatorURNG.seed(s_seed);
-
-        uniform_int_distribution<UINT> jumpDistribution(0, m_numSamples - 1);
-        uniform_int_distribution<UINT> jumpSetDistribution(0, m_numSampleSets - 1);
-
-        uniform_real_distribution<float> unitSquareDistribution(0.f, 1.f);
-
-        // Specify the next representable value for the end range, since
-        // uniform_real_distribution constructs excluding the end value [being, end).
-        uniform_real_distribution<float> unitSquareDistributionInclusive(0.f, nextafter(1.f, FLT_MAX));
-
-        GetRandomJump = bind(jumpDistribution, ref(m_generatorURNG));
-        GetRandomSetJump = bind(jumpSetDistribution, ref(m_generatorURNG));
-        GetRandomFloat01 = bind(unitSquareDistribution, ref(m_generatorURNG));
-        GetRandomFloat01inclusive = bind(unitSquareDistributionInclusive, ref(m_generatorURNG));
-    }
+    // Reset generator.
+    // Initialize to the same seed for determinism.
+    m_generatorURNG = ::Random::PCG32(s_seed);
 
     // Generate random samples.
     {
@@ -88,7 +72,12 @@ void Sampler::Reset(UINT numSamples, UINT numSampleSets, HemisphereDistribution:
             auto last = first + m_numSamples;
 
             iota(first, last, 0u); // Fill with 0, 1, ..., m_numSamples - 1 
-            shuffle(first, last, m_generatorURNG);
+
+            // Fisher-Yates, spelled out so the order does not depend on the standard library
+            for (UINT j = m_numSamples - 1; j > 0; j--)
+            {
+                swap(first[j], first[m_generatorURNG.nextUInt(j + 1)]);
+            }
         }
     }
 };
@@ -100,8 +89,7 @@ UnitSquareSample2D Sampler::RandomFloat01_2D()
 
 UINT Sampler::GetRandomNumber(UINT min, UINT max)
 {
-    uniform_int_distribution<UINT> distribution(min, max);
-    return distribution(m_generatorURNG);
+    return min + m_generatorURNG.nextUInt(max - min + 1);
 }
 UnitSquareSample2D Sampler::GetSample2D()
 {
@@ -198,7 +186,7 @@ void MultiJittered::GenerateSamples2D()
 }
 
 // Generate random sample patterns on unit square.
-void Random::GenerateSamples2D()
+void Samplers::Random::GenerateSamples2D()
 {
     for (auto& sample : m_samples)
     {
@@ -44,8 +44,6 @@ class SSAO
     AssetTexture*        _noise;
     SSCompute*           _blur;
 
-    float lerp(float a, float b, float f);
-
   public:
     SSAO();
     ~SSAO();
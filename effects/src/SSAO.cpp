@@ -2,10 +2,11 @@
 #include "DXLayer.h"
 #include "EngineManager.h"
 #include "HLSLShader.h"
+#include "KernelTables.h"
 #include "MRTFrameBuffer.h"
 #include "ShaderBroker.h"
 #include "ViewEventDistributor.h"
-#include <random>
+#include <iterator>
 
 SSAO::SSAO()
     : _renderTexture(IOEventDistributor::screenPixelWidth, IOEventDistributor::screenPixelHeight,
@@ -27,39 +28,13 @@ SSAO::SSAO()
 
 SSAO::~SSAO() {}
 
-// helper lerp, move to math function utility someday
-float SSAO::lerp(float a, float b, float f) { return a + f * (b - a); }
-
 void SSAO::_generateKernelNoise()
 {
-    // random floats between 0.0 - 1.0
-    std::uniform_real_distribution<float> randomFloats(0.0, 1.0);
-    std::default_random_engine            generator;
-
-    for (unsigned int i = 0; i < 64; ++i)
-    {
-        Vector4 sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f,
-                       randomFloats(generator), 1.0f);
-        sample.normalize();
-
-        sample      = sample * randomFloats(generator);
-        float scale = static_cast<float>(i) / 64.0f;
-
-        scale  = lerp(0.1f, 1.0f, scale * scale);
-        sample = sample * scale;
-
-        _ssaoKernel.push_back(sample);
-    }
-
-    for (unsigned int i = 0; i < 16; i++)
-    {
-
-        Vector4 noise(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f,
-                      0.0f, 1.0f);
-
-        _ssaoNoise.push_back(noise);
-    }
-
+    // Kernel and noise are generated at compile time
+    _ssaoKernel.assign(std::begin(KernelTables::SSAOTable.kernel),
+                       std::end(KernelTables::SSAOTable.kernel));
+    _ssaoNoise.assign(std::begin(KernelTables::SSAOTable.noise),
+                      std::end(KernelTables::SSAOTable.noise));
 
     _noise = new AssetTexture(&_ssaoNoise[0], 4, 4, DXLayer::instance()->getAttributeBufferCopyCmdList(),
                                 DXLayer::instance()->getDevice());
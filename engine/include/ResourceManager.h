@@ -12,8 +12,13 @@
 #include <wrl.h>
 #include "HLSLShader.h"
 #include "RTCompaction.h"
+#include "InstanceSlotAllocator.h"
+#include "InstanceUploadTracker.h"
+#include "ParallelInstanceWriter.h"
+#include "TLASUpdatePolicy.h"
 #include "DXDefines.h"
 #include "Model.h"
+#include "Random.h"
 
 using namespace Microsoft::WRL;
 
@@ -38,11 +43,25 @@ struct GpuToCpuBuffers
 // 4000 BLAS count using 4 textures each
 #define MaxBLASSRVsForRayTracing   16000 * 4
 #define TlasAllocationMultiplier   10
+// Every 60 frames move up to 256 instances into the holes of the instance slot range
+#define InstanceSlotCompactionInterval 60
+#define InstanceSlotCompactionMoves    256
+// Changed instance slots are written in chunks of 256 on up to 8 threads
+#define InstanceWriterChunkSlots       256
+#define InstanceWriterMaxThreads       8
 
 #define RandomInsertAndRemoveEntities 0
 
+// Frames the upload buffers of one instance stream and the GPU buffers they feed were last brought
+// up to date in, zero for a buffer that holds nothing yet.  Streams copied into a single GPU
+// buffer use gpuFrames[0].
+struct InstanceStreamSync
+{
+    uint64_t uploadFrames[CMD_LIST_NUM] = {};
+    uint64_t gpuFrames[CMD_LIST_NUM]    = {};
+};
 
-class ResourceManager
+class ResourceManager : private InstanceChunkWriter
 {
     using TextureDescriptorHeapMap = std::pair<std::vector<AssetTexture*>, int>;
     using TextureMapping = std::map<Model*, TextureDescriptorHeapMap>;
@@ -71,6 +90,20 @@ class ResourceManager
     std::vector<float>                                                _instanceWorldToObjectMatrixTransforms;
     std::vector<float>                                                _instanceTransforms;
     std::vector<float>                                                _prevInstanceTransforms;
+    std::vector<Matrix>                                               _instanceWorldTransforms;
+    std::vector<D3D12_RAYTRACING_INSTANCE_DESC>                       _instanceDescs;
+    // Instance slots only get rewritten and uploaded when the entity or the transform they hold changed
+    InstanceUploadTracker                                             _instanceUploadTracker;
+    std::vector<SlotRange>                                            _instanceUploadRanges;
+    InstanceStreamSync                                                _instanceDescSync;
+    InstanceStreamSync                                                _normalMatrixSync;
+    InstanceStreamSync                                                _modelMatrixSync;
+    InstanceStreamSync                                                _prevInstanceSync;
+    InstanceStreamSync                                                _worldToObjectSync;
+    ParallelInstanceWriter*                                           _instanceWriter = nullptr;
+    // Persistent generators for particle trajectories and random entity placement
+    Random::PCG32                                                     _transformRandom = Random::generator(1);
+    Random::PCG32                                                     _geometryRandom  = Random::generator(2);
 
     AttributeMapping                                                  _vertexBufferMap;
     IndexBufferMapping                                                _indexBufferMap;
@@ -78,8 +111,32 @@ class ResourceManager
     UniformMaterialMapping                                            _uniformMaterialMap;
     BlasMapping                                                       _blasMap;
 
+    // Models get a dense id when their geometry is registered, what the per frame path reads about
+    // a model lives in flat tables indexed by it instead of the maps above
+    InstanceSlotAllocator                                             _modelIds;
+    std::vector<Model*>                                               _idModels;
+    std::vector<UINT>                                                 _modelMaterialIndices;
+    std::vector<UINT>                                                 _modelAttributeIndices;
+    std::vector<RTCompaction::ASBuffers*>                             _modelBlas;
+    std::vector<int>                                                  _modelEntityCounts;
+    std::vector<uint64_t>                                             _modelCountFrames;
+    std::vector<uint32_t>                                             _countedModelIds;
+    uint64_t                                                          _modelCountFrame = 0;
+
+    // Indexed by instance slot, entries only change when a slot gets another entity or model
     std::vector<UINT>                                                 _attributeMapping;
     std::vector<UINT>                                                 _materialMapping;
+    bool                                                              _attributeMappingDirty = true;
+    bool                                                              _materialMappingDirty  = true;
+
+    // Persistent instance numbering, entities keep their slot until they leave the entity list
+    InstanceSlotAllocator                                             _instanceSlots;
+    std::vector<Entity*>                                              _slotEntities;
+    std::vector<Model*>                                               _slotModels;
+    std::vector<uint64_t>                                             _slotSeenFrames;
+    std::vector<InstanceSlotMove>                                     _instanceSlotMoves;
+    std::vector<Entity*>                                              _unslottedEntities;
+    uint64_t                                                          _instanceSlotFrame = 0;
 
     std::queue<UINT>                                                  _reusableMaterialSRVIndices;
     std::queue<UINT>                                                  _reusableAttributeSRVIndices;
@@ -111,8 +168,14 @@ class ResourceManager
 
     std::vector<D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS> _bottomLevelBuildDescs;
     std::vector<Model*>                                               _bottomLevelBuildModels;
+    std::vector<uint64_t>                                             _bottomLevelBuildKeys;
+    std::vector<float>                                                _bottomLevelBuildDistances;
     ComPtr<ID3D12Resource>                                            _tlasResultBuffer[CMD_LIST_NUM];
     ComPtr<ID3D12Resource>                                            _tlasScratchBuffer[CMD_LIST_NUM];
+    // Refits the top level built last frame while the instance topology holds, _tlasSourceIndex is
+    // the cmd list index of that build and UINT_MAX before the first one
+    TLASUpdatePolicy                                                  _tlasUpdatePolicy;
+    UINT                                                              _tlasSourceIndex = UINT_MAX;
     ComPtr<ID3D12Resource>                                            _instanceDescriptionCPUBuffer[CMD_LIST_NUM];
     ComPtr<ID3D12Resource>                                            _instanceDescriptionGPUBuffer[CMD_LIST_NUM];
 
@@ -140,7 +203,21 @@ class ResourceManager
 
     UINT _allocateDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE* cpuDescriptor,
                              UINT descriptorIndexToUse = UINT_MAX);
+    uint32_t _registerModel(Model* model);
+    void     _unregisterModel(Model* model);
+    bool     _isModelRegistered(Model* model);
+    uint32_t _getModelId(Model* model);
+    void _updateInstanceSlots();
     void _updateTransformData();
+    void WriteChunk(uint32_t firstSlot, uint32_t slotCount) override;
+    bool _uploadInstanceStream(const void*                stream,
+                               UINT                       slotSizeInBytes,
+                               uint32_t                   trailingFrames,
+                               ID3D12Resource*            upload,
+                               uint64_t&                  uploadFrame,
+                               ID3D12Resource*            gpu,
+                               uint64_t&                  gpuFrame,
+                               ID3D12GraphicsCommandList* commandList);
     void _updateResourceMappingBuffers();
     void _updateGeometryData();
 
@@ -157,6 +234,7 @@ class ResourceManager
     float*                                        getWorldToObjectTransforms();
     float*                                        getPrevInstanceTransforms();
     int                                           getBLASCount();
+    const TLASUpdateStats&                        getTLASUpdateStats();
     void                                          updateAndBindMaterialBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute);
     void                                          updateAndBindAttributeBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute);
     void                                          updateAndBindUniformMaterialBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute);
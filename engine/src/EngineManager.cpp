@@ -9,7 +9,7 @@
 #include "IOEvents.h"
 #include "MasterClock.h"
 #include "ModelBroker.h"
-#include "Randomization.h"
+#include "Random.h"
 #include "SSCompute.h"
 #include "SceneBuilder.h"
 #include "ShaderBroker.h"
@@ -28,8 +28,8 @@ EngineManager*            EngineManager::_engineManager = nullptr;
 
 EngineManager::EngineManager(int* argc, char** argv, HINSTANCE hInstance, int nCmdShow)
 {
-    // seed the random number generator
-    Randomization::seed();
+    // seed the random number generator, a fixed seed from the command line wins
+    Random::seedFromTime();
 
     // initialize engine manager pointer so it can be used a singleton
     _engineManager = this;
@@ -109,9 +109,8 @@ EngineManager::EngineManager(int* argc, char** argv, HINSTANCE hInstance, int nC
 
     const int numParticlesPerOrigin = 750;
     // random floats between -1.0 - 1.0
-    std::random_device               rd;
-    std::mt19937                     generator(rd());
-    std::uniform_real_distribution<> randomFloats(-1.0, 1.0);
+    Random::PCG32 generator    = Random::generator(3);
+    auto          randomFloats = [&generator]() { return generator.nextFloat(-1.0f, 1.0f); };
 
 
     std::vector<Vector4> particleOrigins = {
@@ -135,7 +134,7 @@ EngineManager::EngineManager(int* argc, char** argv, HINSTANCE hInstance, int nC
     for (int i = 0; i < numParticlesPerOrigin * particleOrigins.size(); i++)
     {
         // Random colorful particles
-        float modelChoice = randomFloats(generator);
+        float modelChoice = randomFloats();
         //if (modelChoice <= -0.5)
         //{
         //    sceneEntity.modelname =
@@ -164,7 +163,7 @@ EngineManager::EngineManager(int* argc, char** argv, HINSTANCE hInstance, int nC
         sceneEntity.name      = /*sceneEntity.modelname*/ "particle_lod1" + std::to_string(particleGroupId);
         sceneEntity.position  = particleOrigins[particleOriginIndex];
         sceneEntity.rotation  = Vector4(0.0, 0.0, 0.0);
-        auto scale            = (randomFloats(generator) + 1.0) / 2.0;
+        auto scale            = (randomFloats() + 1.0) / 2.0;
         sceneEntity.scale     = Vector4(scale * 0.001, scale * 0.001,  scale * 0.001);
         auto transform = Matrix::translation(sceneEntity.position.getx(), sceneEntity.position.gety(), sceneEntity.position.getz()) *
                          Matrix::rotationAroundY(sceneEntity.rotation.gety()) *
@@ -261,20 +260,18 @@ void EngineManager::processLights(std::vector<Light*>&  lights,
     auto milliSeconds = MasterClock::instance()->getGameTime();
     if (((milliSeconds - previousTime) > lightGenInternalMs) && addLights)
     {
-        // random floats between -1.0 - 1.0
-        // Will be used to obtain a seed for the random number engine
-        std::random_device rd;
-        // Standard mersenne_twister_engine seeded with rd()
-        std::mt19937                     generator(rd());
-        std::uniform_real_distribution<> randomFloats(-1.0, 1.0);
+        // random floats between -1.0 - 1.0, one generator for the whole run instead of
+        // reseeding from the OS every time a light is spawned
+        static Random::PCG32 generator    = Random::generator(4);
+        auto                 randomFloats = []() { return generator.nextFloat(-1.0f, 1.0f); };
 
         float lightIntensityRange = 10.0f;
         //float randomLightIntensity = lightIntensityRange;
-        float randomLightIntensity = (((randomFloats(generator) + 1.0) / 2.0) * lightIntensityRange) + 300000.0;
+        float randomLightIntensity = (((randomFloats() + 1.0) / 2.0) * lightIntensityRange) + 300000.0;
 
-        Vector4 randomColor(static_cast<int>(((randomFloats(generator) + 1.0) / 2.0) * 2.0),
-                            static_cast<int>(((randomFloats(generator) + 1.0) / 2.0) * 2.0),
-                            static_cast<int>(((randomFloats(generator) + 1.0) / 2.0) * 2.0));
+        Vector4 randomColor(static_cast<int>(((randomFloats() + 1.0) / 2.0) * 2.0),
+                            static_cast<int>(((randomFloats() + 1.0) / 2.0) * 2.0),
+                            static_cast<int>(((randomFloats() + 1.0) / 2.0) * 2.0));
 
         //Vector4 randomColor(1.0, 1.0, 1.0);
         //Vector4 randomColor(64.0 / 255.0, 156.0 / 255.0, 255.0 / 255.0);
@@ -355,6 +352,8 @@ void EngineManager::_preDraw()
         DXLayer::instance()->initCmdLists();
     }
 
+    // Every entity's draw tests against the same frustum, build it once instead of per entity
+    _viewManager->updateFrustum();
 }
 void EngineManager::_postDraw()
 {
@@ -5,8 +5,8 @@
 #include "ShaderTable.h"
 #include "DXLayer.h"
 #include "AnimatedModel.h"
-#include <random>
-#include <set>
+#include "TransformBatch.h"
+#include "BLASCache.h"
 
 ResourceManager::ResourceManager()
 {
@@ -33,6 +33,7 @@ void ResourceManager::init(ComPtr<ID3D12Device> device)
 {
     _materialMapping.reserve(InitInstancesForRayTracing);
     _attributeMapping.reserve(InitInstancesForRayTracing);
+    _instanceWorldTransforms.reserve(InitInstancesForRayTracing);
 
     constexpr auto transformOffset              = 12; // 3x4
     UINT           instanceTransformSizeInBytes = InitInstancesForRayTracing * transformOffset;
@@ -65,7 +66,17 @@ void ResourceManager::init(ComPtr<ID3D12Device> device)
 
         // Initialize command list round trip execution to CMD_LIST_NUM
         // Initialize suballocator blocks to 64 KB and limit compaction transient allocation to 16 MB
-        RTCompaction::Initialize(_dxrDevice.Get(), CMD_LIST_NUM, 65536, (uint32_t)(-1));
+        RTCompaction::Initialize(_dxrDevice.Get(), CMD_LIST_NUM, 65536, (uint32_t)(-1), 4 * 1024 * 1024);
+
+        // Serialized BLASes are only valid on the adapter and driver that wrote them
+        DXGI_ADAPTER_DESC adapterDesc   = {};
+        LARGE_INTEGER     driverVersion = {};
+        dxLayer->getAdapter()->GetDesc(&adapterDesc);
+        dxLayer->getAdapter()->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+        uint64_t deviceIdentity[] = {adapterDesc.VendorId, adapterDesc.DeviceId, adapterDesc.SubSysId,
+                                     adapterDesc.Revision, static_cast<uint64_t>(driverVersion.QuadPart)};
+        RTCompaction::EnableBLASCache(_dxrDevice.Get(), "blas-cache",
+                                      BLASCache::HashBytes(deviceIdentity, sizeof(deviceIdentity)));
 
         // Create descriptor heap
         ZeroMemory(&_rtASSrvHeapDesc, sizeof(_rtASSrvHeapDesc));
@@ -115,6 +126,53 @@ void ResourceManager::allocateUploadBuffer(ID3D12Device* pDevice, void* pData,
     }
 }
 
+// Writes the slots of an instance stream changed since the upload buffer was last written into it
+// and copies the slots changed since the GPU buffer was last written into that, returns whether
+// any copy was recorded.  Streams read straight from the upload buffer pass no GPU buffer.
+bool ResourceManager::_uploadInstanceStream(const void*                stream,
+                                            UINT                       slotSizeInBytes,
+                                            uint32_t                   trailingFrames,
+                                            ID3D12Resource*            upload,
+                                            uint64_t&                  uploadFrame,
+                                            ID3D12Resource*            gpu,
+                                            uint64_t&                  gpuFrame,
+                                            ID3D12GraphicsCommandList* commandList)
+{
+    const uint64_t frame = _instanceUploadTracker.GetFrame();
+
+    _instanceUploadTracker.CollectRanges(uploadFrame, trailingFrames, _instanceUploadRanges);
+    if (_instanceUploadRanges.empty() == false)
+    {
+        BYTE*         mappedData = nullptr;
+        CD3DX12_RANGE readRange(0, 0);
+        upload->Map(0, &readRange, reinterpret_cast<void**>(&mappedData));
+
+        for (const SlotRange& range : _instanceUploadRanges)
+        {
+            const UINT64 offset = static_cast<UINT64>(range.first) * slotSizeInBytes;
+            memcpy(&mappedData[offset], static_cast<const BYTE*>(stream) + offset,
+                   static_cast<size_t>(range.count) * slotSizeInBytes);
+        }
+    }
+    uploadFrame = frame;
+
+    if (gpu == nullptr)
+    {
+        return false;
+    }
+
+    _instanceUploadTracker.CollectRanges(gpuFrame, trailingFrames, _instanceUploadRanges);
+    for (const SlotRange& range : _instanceUploadRanges)
+    {
+        const UINT64 offset = static_cast<UINT64>(range.first) * slotSizeInBytes;
+        commandList->CopyBufferRegion(gpu, offset, upload, offset,
+                                      static_cast<UINT64>(range.count) * slotSizeInBytes);
+    }
+    gpuFrame = frame;
+
+    return _instanceUploadRanges.empty() == false;
+}
+
 ComPtr<ID3D12DescriptorHeap> ResourceManager::getRTASDescHeap()
 {
     return _rtASDescriptorHeap;
@@ -145,9 +203,14 @@ ResourceManager::TextureMapping& ResourceManager::getSceneTextures()
 
 void ResourceManager::updateAndBindMaterialBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute)
 {
-    BYTE* mappedData                           = nullptr;
-    _instanceIndexToMaterialMappingGPUBuffer->resource->Map(0, nullptr, reinterpret_cast<void**>(&mappedData));
-    memcpy(&mappedData[0], _materialMapping.data(), sizeof(UINT) * _materialMapping.size());
+    // The mapping only changes on entity lifecycle events
+    if (_materialMappingDirty)
+    {
+        BYTE* mappedData = nullptr;
+        _instanceIndexToMaterialMappingGPUBuffer->resource->Map(0, nullptr, reinterpret_cast<void**>(&mappedData));
+        memcpy(&mappedData[0], _materialMapping.data(), sizeof(UINT) * _materialMapping.size());
+        _materialMappingDirty = false;
+    }
 
     auto                  cmdList           = DXLayer::instance()->getCmdList();
     auto                  resourceBindings  = resourceIndexes;
@@ -169,10 +232,15 @@ void ResourceManager::updateAndBindMaterialBuffer(std::map<std::string, UINT> re
 
 void ResourceManager::updateAndBindAttributeBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute)
 {
-    BYTE* mappedData                           = nullptr;
-    _instanceIndexToAttributeMappingGPUBuffer->resource->Map(0, nullptr,
-                                                             reinterpret_cast<void**>(&mappedData));
-    memcpy(&mappedData[0], _attributeMapping.data(), sizeof(UINT) * _attributeMapping.size());
+    // The mapping only changes on entity lifecycle events
+    if (_attributeMappingDirty)
+    {
+        BYTE* mappedData = nullptr;
+        _instanceIndexToAttributeMappingGPUBuffer->resource->Map(0, nullptr,
+                                                                 reinterpret_cast<void**>(&mappedData));
+        memcpy(&mappedData[0], _attributeMapping.data(), sizeof(UINT) * _attributeMapping.size());
+        _attributeMappingDirty = false;
+    }
 
     auto                  cmdList           = DXLayer::instance()->getCmdList();
     auto                  resourceBindings  = resourceIndexes;
@@ -236,17 +304,14 @@ void ResourceManager::updateAndBindUniformMaterialBuffer(std::map<std::string, U
 void ResourceManager::updateAndBindModelMatrixBuffer(std::map<std::string, UINT> resourceIndexes,
                                                       bool                       isCompute)
 {
-    auto  cmdListIndex    = DXLayer::instance()->getCmdListIndex();
-    BYTE* mappedData = nullptr;
-    _instanceModelMatrixTransformsUpload[cmdListIndex]->Map(0, nullptr, reinterpret_cast<void**>(&mappedData));
-
-    memcpy(&mappedData[0], _instanceModelMatrixTransforms.data(),
-           sizeof(float) * _instanceModelMatrixTransforms.size());
-
-    auto cmdList = DXLayer::instance()->getCmdList();
+    auto cmdListIndex = DXLayer::instance()->getCmdListIndex();
+    auto cmdList      = DXLayer::instance()->getCmdList();
 
-    cmdList->CopyResource(_instanceModelMatrixTransformsGPUBuffer->resource.Get(),
-                          _instanceModelMatrixTransformsUpload[cmdListIndex].Get());
+    _uploadInstanceStream(_instanceModelMatrixTransforms.data(), sizeof(float) * TransformBatch::ModelFloats, 0,
+                          _instanceModelMatrixTransformsUpload[cmdListIndex].Get(),
+                          _modelMatrixSync.uploadFrames[cmdListIndex],
+                          _instanceModelMatrixTransformsGPUBuffer->resource.Get(),
+                          _modelMatrixSync.gpuFrames[0], cmdList.Get());
 
     auto                  resourceBindings  = resourceIndexes;
     ID3D12DescriptorHeap* descriptorHeaps[] = {_descriptorHeap.Get()};
@@ -267,10 +332,10 @@ void ResourceManager::updateAndBindModelMatrixBuffer(std::map<std::string, UINT>
 
 void ResourceManager::updateAndBindNormalMatrixBuffer(std::map<std::string, UINT> resourceIndexes, bool isCompute)
 {
-    BYTE* mappedData                           = nullptr;
-    _instanceNormalMatrixTransformsGPUBuffer->resource->Map(0, nullptr,
-                                                             reinterpret_cast<void**>(&mappedData));
-    memcpy(&mappedData[0], _instanceNormalMatrixTransforms.data(), sizeof(float) * _instanceNormalMatrixTransforms.size());
+    // Shaders read the normal matrices straight from the upload buffer
+    _uploadInstanceStream(_instanceNormalMatrixTransforms.data(), sizeof(float) * TransformBatch::NormalFloats, 0,
+                          _instanceNormalMatrixTransformsGPUBuffer->resource.Get(),
+                          _normalMatrixSync.uploadFrames[0], nullptr, _normalMatrixSync.gpuFrames[0], nullptr);
 
     auto                  cmdList           = DXLayer::instance()->getCmdList();
     auto                  resourceBindings  = resourceIndexes;
@@ -294,17 +359,14 @@ void ResourceManager::updateAndBindPrevInstanceMatrixBuffer(std::map<std::string
                                                             bool                        isCompute)
 {
     auto cmdListIndex = DXLayer::instance()->getCmdListIndex();
+    auto cmdList      = DXLayer::instance()->getCmdList();
 
-    BYTE* mappedData = nullptr;
-    _prevInstanceTransformsUpload[cmdListIndex]->Map(0, nullptr, reinterpret_cast<void**>(&mappedData));
-
-    memcpy(&mappedData[0], _prevInstanceTransforms.data(),
-           sizeof(float) * _prevInstanceTransforms.size());
-
-    auto cmdList = DXLayer::instance()->getCmdList();
-
-    cmdList->CopyResource(_prevInstanceTransformsGPUBuffer->resource.Get(),
-                          _prevInstanceTransformsUpload[cmdListIndex].Get());
+    // A slot's previous transform changes the frame after its transform did
+    _uploadInstanceStream(_prevInstanceTransforms.data(), sizeof(float) * TransformBatch::ObjectToWorldFloats, 1,
+                          _prevInstanceTransformsUpload[cmdListIndex].Get(),
+                          _prevInstanceSync.uploadFrames[cmdListIndex],
+                          _prevInstanceTransformsGPUBuffer->resource.Get(),
+                          _prevInstanceSync.gpuFrames[0], cmdList.Get());
 
     auto                  resourceBindings  = resourceIndexes;
     ID3D12DescriptorHeap* descriptorHeaps[] = {_descriptorHeap.Get()};
@@ -326,17 +388,14 @@ void ResourceManager::updateAndBindPrevInstanceMatrixBuffer(std::map<std::string
 void ResourceManager::updateAndBindWorldToObjectMatrixBuffer(std::map<std::string, UINT> resourceIndexes,
                                                             bool                        isCompute)
 {
-    auto  cmdListIndex = DXLayer::instance()->getCmdListIndex();
-    BYTE* mappedData = nullptr;
-    _worldToObjectInstanceTransformsUpload[cmdListIndex]->Map(0, nullptr, reinterpret_cast<void**>(&mappedData));
-
-    memcpy(&mappedData[0], _instanceWorldToObjectMatrixTransforms.data(),
-           sizeof(float) * _instanceWorldToObjectMatrixTransforms.size());
-
-    auto                  cmdList           = DXLayer::instance()->getCmdList();
+    auto cmdListIndex = DXLayer::instance()->getCmdListIndex();
+    auto cmdList      = DXLayer::instance()->getCmdList();
 
-    cmdList->CopyResource(_worldToObjectInstanceTransformsGPUBuffer->resource.Get(),
-                          _worldToObjectInstanceTransformsUpload[cmdListIndex].Get());
+    _uploadInstanceStream(_instanceWorldToObjectMatrixTransforms.data(), sizeof(float) * TransformBatch::WorldToObjectFloats, 0,
+                          _worldToObjectInstanceTransformsUpload[cmdListIndex].Get(),
+                          _worldToObjectSync.uploadFrames[cmdListIndex],
+                          _worldToObjectInstanceTransformsGPUBuffer->resource.Get(),
+                          _worldToObjectSync.gpuFrames[0], cmdList.Get());
 
     auto                  resourceBindings  = resourceIndexes;
     ID3D12DescriptorHeap* descriptorHeaps[] = {_descriptorHeap.Get()};
@@ -372,7 +431,8 @@ void ResourceManager::updateBLAS()
     bool updatesPerformed = false;
     for (auto entity : entityList)
     {
-        bool isValidBlas = _blasMap.find(entity->getModel()) != _blasMap.end();
+        bool isValidBlas = _isModelRegistered(entity->getModel()) &&
+                           (_modelBlas[_getModelId(entity->getModel())] != nullptr);
 
         if (entity->isAnimated() && isValidBlas)
         {
@@ -565,7 +625,7 @@ void ResourceManager::updateBLAS()
             bottomLevelInputs.pGeometryDescs = geomDesc->data();
 
             bottomLevelBuildDesc.DestAccelerationStructureData =
-                _blasMap[entityList[instanceIndex]->getModel()]->GetASBuffer();
+                _modelBlas[_getModelId(entityList[instanceIndex]->getModel())]->GetASBuffer();
 
             bottomLevelBuildDesc.SourceAccelerationStructureData =
                 bottomLevelBuildDesc.DestAccelerationStructureData;
@@ -633,6 +693,8 @@ void ResourceManager::buildGeometry(Entity* entity)
     auto vertexAndBufferStrides = (*entity->getModel()->getVAO())[0]->getVertexAndIndexBufferStrides();
 
     std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>* staticGeometryDesc = new std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>();
+    std::vector<BLASGeometry>                    cacheGeometry;
+    auto                                         renderBuffers      = entity->getModel()->getRenderBuffers();
 
     int geometryIndex = 0;
 
@@ -823,6 +885,20 @@ void ResourceManager::buildGeometry(Entity* entity)
             (*staticGeometryDesc)[staticGeomIndex].Triangles.VertexCount  = static_cast<UINT>(vertexCount);
             (*staticGeometryDesc)[staticGeomIndex].Triangles.VertexBuffer.StartAddress = vertexGPUAddress;
             (*staticGeometryDesc)[staticGeomIndex].Triangles.VertexBuffer.StrideInBytes = sizeof(CompressedAttribute);
+
+            // The vertex and index buffers are built from the render buffers' CPU copies
+            BLASGeometry geometry = {};
+            geometry.vertices     = renderBuffers->getVertices()->data() + vertexCountOffset;
+            geometry.vertexCount  = static_cast<uint32_t>(vertexCount);
+            geometry.vertexStride = sizeof(Vector4);
+            geometry.positionSize = 3 * sizeof(float);
+            geometry.vertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+            geometry.indices      = renderBuffers->getIndices()->data() + indexCountOffset;
+            geometry.indexCount   = static_cast<uint32_t>(indexCount);
+            geometry.indexSize    = sizeof(uint32_t);
+            geometry.indexFormat  = indexFormat;
+            geometry.flags        = (*staticGeometryDesc)[staticGeomIndex].Flags;
+            cacheGeometry.push_back(geometry);
         }
 
         indexCountOffset += indexCount;
@@ -837,29 +913,225 @@ void ResourceManager::buildGeometry(Entity* entity)
 
         _bottomLevelBuildDescs.push_back(bottomLevelInputs);
         _bottomLevelBuildModels.push_back(entity->getModel());
+
+        // Only compacted static builds go through the disk cache
+        uint64_t cacheKey = 0;
+        if (entity->isAnimated() == false && _useCompaction)
+        {
+            cacheKey = BLASCache::HashGeometry(cacheGeometry.data(),
+                                               static_cast<uint32_t>(cacheGeometry.size()),
+                                               bottomLevelInputs.Flags);
+        }
+        _bottomLevelBuildKeys.push_back(cacheKey);
+
+        // Builds near the camera are compacted first
+        Vector4 cameraPos      = EngineManager::instance()->getViewManager()->getCameraPos();
+        Vector4 entityPosition = entity->getWorldSpaceTransform() * Vector4(0, 0, 0, 1);
+        _bottomLevelBuildDistances.push_back((entityPosition - cameraPos).getMagnitude());
+    }
+
+    // The descriptor indices the instance mappings need are looked up once here instead of per
+    // instance and frame
+    Model* model = entity->getModel();
+    if (_vertexBufferMap.find(model) != _vertexBufferMap.end())
+    {
+        uint32_t modelId                = _registerModel(model);
+        _modelMaterialIndices[modelId]  = _texturesMap[model].second;
+        _modelAttributeIndices[modelId] = _vertexBufferMap[model].second;
     }
 }
 
-void ResourceManager::_updateTransformData()
+uint32_t ResourceManager::_registerModel(Model* model)
+{
+    if (_isModelRegistered(model))
+    {
+        return _getModelId(model);
+    }
+
+    InstanceSlotHandle handle  = _modelIds.Allocate();
+    uint32_t           modelId = handle.GetSlot();
+    model->setResourceId(handle.value);
+
+    if (modelId >= _idModels.size())
+    {
+        _idModels.resize(modelId + 1, nullptr);
+        _modelMaterialIndices.resize(modelId + 1, 0);
+        _modelAttributeIndices.resize(modelId + 1, 0);
+        _modelBlas.resize(modelId + 1, nullptr);
+        _modelEntityCounts.resize(modelId + 1, 0);
+        _modelCountFrames.resize(modelId + 1, 0);
+    }
+    _idModels[modelId]              = model;
+    _modelMaterialIndices[modelId]  = 0;
+    _modelAttributeIndices[modelId] = 0;
+    _modelBlas[modelId]             = nullptr;
+    return modelId;
+}
+
+void ResourceManager::_unregisterModel(Model* model)
+{
+    if (_isModelRegistered(model) == false)
+    {
+        return;
+    }
+
+    uint32_t modelId    = _getModelId(model);
+    _idModels[modelId]  = nullptr;
+    _modelBlas[modelId] = nullptr;
+    _modelIds.Release(InstanceSlotHandle{model->getResourceId()});
+    model->setResourceId(0);
+}
+
+bool ResourceManager::_isModelRegistered(Model* model)
+{
+    InstanceSlotHandle handle = {model->getResourceId()};
+    return _modelIds.IsLive(handle) && _idModels[handle.GetSlot()] == model;
+}
+
+uint32_t ResourceManager::_getModelId(Model* model)
+{
+    return InstanceSlotHandle{model->getResourceId()}.GetSlot();
+}
+
+void ResourceManager::_updateInstanceSlots()
 {
     auto entityList = EngineManager::instance()->getEntityList();
 
-    constexpr int transformOffset       = sizeof(float) * 12;
-    constexpr int normalTransformOffset = sizeof(float) * 9;
-    constexpr int modelTransformOffset = sizeof(float) * 16;
+    // Entities keep the slot they were numbered with for as long as they stay in the entity list
+    _instanceSlotFrame++;
+    _unslottedEntities.clear();
+    for (auto entity : *entityList)
+    {
+        InstanceSlotHandle handle = {entity->getInstanceSlot()};
+        if (_instanceSlots.IsLive(handle) && _slotEntities[handle.GetSlot()] == entity)
+        {
+            _slotSeenFrames[handle.GetSlot()] = _instanceSlotFrame;
+        }
+        else
+        {
+            _unslottedEntities.push_back(entity);
+        }
+    }
 
-    // Copy over all the previous instance transforms for motion vectors
-    memcpy(_prevInstanceTransforms.data(), _instanceTransforms.data(), sizeof(float) * 12 * entityList->size());
+    // Slots of entities that left the list are freed before new entities fill the lowest holes
+    for (uint32_t slot = 0; slot < _instanceSlots.GetSlotCount(); slot++)
+    {
+        if (_slotEntities[slot] != nullptr && _slotSeenFrames[slot] != _instanceSlotFrame)
+        {
+            _instanceSlots.Release(_instanceSlots.GetHandle(slot));
+            _slotEntities[slot] = nullptr;
+            _slotModels[slot]   = nullptr;
+        }
+    }
 
-    // Create an instance desc for the dynamic and static bottom levels
-    std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDescriptionCPUBuffer(entityList->size());
-    std::random_device                          rd;
-    std::mt19937                                generator(rd());
-    std::uniform_real_distribution<>            randomFloats(-1.0, 1.0);
+    for (auto entity : _unslottedEntities)
+    {
+        InstanceSlotHandle handle = _instanceSlots.Allocate();
+        entity->setInstanceSlot(handle.value);
 
-    std::uniform_real_distribution<> zeroToOneRandomFloats(0.0, 1.0);
+        if (handle.GetSlot() >= _slotEntities.size())
+        {
+            _slotEntities.resize(handle.GetSlot() + 1, nullptr);
+            _slotModels.resize(handle.GetSlot() + 1, nullptr);
+            _slotSeenFrames.resize(handle.GetSlot() + 1, 0);
+        }
+        _slotEntities[handle.GetSlot()]   = entity;
+        _slotSeenFrames[handle.GetSlot()] = _instanceSlotFrame;
+    }
+
+    // Pull the last instances into the holes now and then so the top level doesn't carry a long
+    // tail of empty instances.  The range only grew this frame if there were no holes, so every
+    // moved slot was numbered in an earlier frame and its transform can come along for the
+    // previous transform of its new slot.
+    if (_instanceSlotFrame % InstanceSlotCompactionInterval == 0)
+    {
+        _instanceSlots.Compact(InstanceSlotCompactionMoves, _instanceSlotMoves);
+        for (const InstanceSlotMove& move : _instanceSlotMoves)
+        {
+            Entity* entity = _slotEntities[move.from];
+            entity->setInstanceSlot(move.handle.value);
+
+            _slotEntities[move.to]   = entity;
+            _slotEntities[move.from] = nullptr;
+            _slotModels[move.from]   = nullptr;
+            memcpy(&_instanceTransforms[move.to * TransformBatch::ObjectToWorldFloats],
+                   &_instanceTransforms[move.from * TransformBatch::ObjectToWorldFloats],
+                   sizeof(float) * TransformBatch::ObjectToWorldFloats);
+        }
+    }
+
+    // The material and attribute mappings only change when a slot gets another entity or its
+    // entity another model
+    const uint32_t slotCount = _instanceSlots.GetSlotCount();
+    _materialMapping.resize(slotCount, 0);
+    _attributeMapping.resize(slotCount, 0);
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+    {
+        Model* model = (_slotEntities[slot] != nullptr) ? _slotEntities[slot]->getModel() : nullptr;
+        if (model == _slotModels[slot])
+        {
+            continue;
+        }
+
+        _slotModels[slot]       = model;
+        _materialMapping[slot]  = (model != nullptr) ? _modelMaterialIndices[_getModelId(model)] : 0;
+        _attributeMapping[slot] = (model != nullptr) ? _modelAttributeIndices[_getModelId(model)] : 0;
+        _materialMappingDirty   = true;
+        _attributeMappingDirty  = true;
+    }
+}
+
+void ResourceManager::WriteChunk(uint32_t firstSlot, uint32_t slotCount)
+{
+    // Gather the world transforms contiguously and write all of their instance streams in one pass
+    for (uint32_t slot = firstSlot; slot < firstSlot + slotCount; slot++)
+    {
+        Entity* entity                 = _slotEntities[slot];
+        _instanceWorldTransforms[slot] = (entity != nullptr) ? entity->getWorldSpaceTransform() : Matrix();
+    }
+
+    TransformBatch::Streams streams;
+    streams.objectToWorld = &_instanceTransforms[firstSlot * TransformBatch::ObjectToWorldFloats];
+    streams.worldToObject = &_instanceWorldToObjectMatrixTransforms[firstSlot * TransformBatch::WorldToObjectFloats];
+    streams.normal        = &_instanceNormalMatrixTransforms[firstSlot * TransformBatch::NormalFloats];
+    streams.model         = &_instanceModelMatrixTransforms[firstSlot * TransformBatch::ModelFloats];
+    TransformBatch::write(&_instanceWorldTransforms[firstSlot], slotCount, streams);
 
-    std::uniform_real_distribution<>fireConeRandomFloats(-0.05, 0.05);
+    if (EngineManager::getGraphicsLayer() != GraphicsLayer::DX12)
+    {
+        for (uint32_t slot = firstSlot; slot < firstSlot + slotCount; slot++)
+        {
+            D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc = _instanceDescs[slot];
+            Entity*                         entity       = _slotEntities[slot];
+            if (entity == nullptr)
+            {
+                // Free slots hold an instance without a bottom level that no ray can hit
+                instanceDesc = D3D12_RAYTRACING_INSTANCE_DESC();
+                continue;
+            }
+
+            memcpy(&instanceDesc.Transform, &_instanceTransforms[slot * TransformBatch::ObjectToWorldFloats],
+                   sizeof(float) * TransformBatch::ObjectToWorldFloats);
+
+            // do not overwrite geometry flags for bottom levels, this caused the non opaque and
+            // opaqueness of bottom levels to be random
+            instanceDesc.Flags                               = D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
+            instanceDesc.InstanceMask                        = 1;
+            instanceDesc.InstanceID                          = 0;
+            instanceDesc.InstanceContributionToHitGroupIndex = 0;
+
+            instanceDesc.AccelerationStructure = _modelBlas[_getModelId(entity->getModel())]->GetASBuffer();
+        }
+    }
+}
+
+void ResourceManager::_updateTransformData()
+{
+    auto entityList = EngineManager::instance()->getEntityList();
+
+    auto randomFloats          = [this]() { return _transformRandom.nextFloat(-1.0f, 1.0f); };
+    auto zeroToOneRandomFloats = [this]() { return _transformRandom.nextFloat(); };
+    auto fireConeRandomFloats  = [this]() { return _transformRandom.nextFloat(-0.05f, 0.05f); };
 
     struct ParticleData
     {
@@ -932,8 +1204,8 @@ void ResourceManager::_updateTransformData()
             {
                 if (particleEvents[entityName].state == FIREFLIES)
                 {
-                    direction = Vector4(randomFloats(generator), zeroToOneRandomFloats(generator),
-                                        randomFloats(generator));
+                    direction = Vector4(randomFloats(), zeroToOneRandomFloats(),
+                                        randomFloats());
                     direction.normalize();
                     direction            = direction * Vector4(0.0001, 0.0001, 0.0001);
                     particleLifeCycleMax = 100000;
@@ -941,21 +1213,21 @@ void ResourceManager::_updateTransformData()
                 else if (particleEvents[entityName].state == FIRE)
                 {
                     direction =
-                        Vector4(fireConeRandomFloats(generator), zeroToOneRandomFloats(generator),
-                                fireConeRandomFloats(generator));
+                        Vector4(fireConeRandomFloats(), zeroToOneRandomFloats(),
+                                fireConeRandomFloats());
                     direction            = direction * (Vector4(0.001, 0.001, 0.001));
                     particleLifeCycleMax = 300;
                 }
                 else if (particleEvents[entityName].state == FIREWORKS)
                 {
-                    direction = Vector4(randomFloats(generator), zeroToOneRandomFloats(generator),
-                                        randomFloats(generator));
+                    direction = Vector4(randomFloats(), zeroToOneRandomFloats(),
+                                        randomFloats());
 
                     direction.normalize();
 
                     Vector4 direction2 =
-                        Vector4(fireConeRandomFloats(generator), zeroToOneRandomFloats(generator),
-                                fireConeRandomFloats(generator));
+                        Vector4(fireConeRandomFloats(), zeroToOneRandomFloats(),
+                                fireConeRandomFloats());
 
                     direction2.normalize();
 
@@ -965,7 +1237,7 @@ void ResourceManager::_updateTransformData()
                 }
 
                 int particleLifeCycle =
-                    static_cast<float>(particleLifeCycleMax) * zeroToOneRandomFloats(generator);
+                    static_cast<float>(particleLifeCycleMax) * zeroToOneRandomFloats();
 
                 particleMetaData.push_back(
                     ParticleData{direction, particleLifeTick, particleLifeCycle, pos});
@@ -1008,31 +1280,31 @@ void ResourceManager::_updateTransformData()
                     if (particleEvents[entityName].state == FIREFLIES)
                     {
                         direction =
-                            Vector4(randomFloats(generator), zeroToOneRandomFloats(generator),
-                                    randomFloats(generator));
+                            Vector4(randomFloats(), zeroToOneRandomFloats(),
+                                    randomFloats());
                         direction.normalize();
                         direction            = direction * Vector4(0.0001, 0.0001, 0.0001);
                         particleLifeCycleMax = 100000;
                     }
                     else if (particleEvents[entityName].state == FIRE)
                     {
-                        direction            = Vector4(fireConeRandomFloats(generator),
-                                            zeroToOneRandomFloats(generator),
-                                            fireConeRandomFloats(generator));
+                        direction            = Vector4(fireConeRandomFloats(),
+                                            zeroToOneRandomFloats(),
+                                            fireConeRandomFloats());
                         direction            = direction * (Vector4(0.001, 0.001, 0.001));
                         particleLifeCycleMax = 300;
                     }
                     else if (particleEvents[entityName].state == FIREWORKS)
                     {
                         direction =
-                            Vector4(randomFloats(generator), zeroToOneRandomFloats(generator),
-                                    randomFloats(generator));
+                            Vector4(randomFloats(), zeroToOneRandomFloats(),
+                                    randomFloats());
 
                         direction.normalize();
 
-                        Vector4 direction2 = Vector4(fireConeRandomFloats(generator),
-                                            zeroToOneRandomFloats(generator),
-                                            fireConeRandomFloats(generator));
+                        Vector4 direction2 = Vector4(fireConeRandomFloats(),
+                                            zeroToOneRandomFloats(),
+                                            fireConeRandomFloats());
 
                         direction2.normalize();
 
@@ -1042,7 +1314,7 @@ void ResourceManager::_updateTransformData()
                     }
 
                     int particleLifeCycle =
-                        static_cast<float>(particleLifeCycleMax) * zeroToOneRandomFloats(generator);
+                        static_cast<float>(particleLifeCycleMax) * zeroToOneRandomFloats();
 
                     particleMetaData[particleIndex] =
                         ParticleData{direction, particleLifeTick, particleLifeCycle, pos};
@@ -1052,12 +1324,12 @@ void ResourceManager::_updateTransformData()
                     direction = particleMetaData[particleIndex].initialTrajectory * (static_cast<float>(diffTime) / static_cast<float>(particleUpdateTime));
 
                     // random movement
-                    direction += Vector4(randomFloats(generator), randomFloats(generator),
-                                            randomFloats(generator)) *
+                    direction += Vector4(randomFloats(), randomFloats(),
+                                            randomFloats()) *
                         Vector4(0.001, 0.001, 0.001) *
                         (static_cast<float>(diffTime) / static_cast<float>(particleUpdateTime));
 
-                    float singleScaleValue = zeroToOneRandomFloats(generator);
+                    float singleScaleValue = zeroToOneRandomFloats();
 
                     float particleTime =
                         particleMetaData[particleIndex].lifeTotal -
@@ -1074,60 +1346,69 @@ void ResourceManager::_updateTransformData()
 
                 particleIndex++;
 
-                entity->setState(pos + direction, Vector4(0.0, 0.0, 0.0), scale);
+                entity->setState(TRS(pos + direction, Quaternion(), scale));
             }
         }
         particleLifeTick++;
     }
 
-    int instanceDescIndex = 0;
-    for (auto entity : *entityList)
-    {
-        auto worldSpaceTransform = entity->getWorldSpaceTransform();
-        memcpy(&_instanceTransforms[instanceDescIndex * (transformOffset / sizeof(float))],
-                worldSpaceTransform.getFlatBuffer(), sizeof(float) * 12);
+    // A slot changes when it holds another entity, the entity's transform was written or its bottom
+    // level moved.  Unchanged slots keep what earlier frames wrote into every stream.
+    const uint32_t slotCount = _instanceSlots.GetSlotCount();
+    _instanceUploadTracker.BeginFrame(slotCount);
+    _instanceWorldTransforms.resize(slotCount);
+    _instanceDescs.resize(slotCount);
 
-        auto worldToObjectMatrix = entity->getWorldSpaceTransform().inverse();
-            memcpy(&_instanceWorldToObjectMatrixTransforms[instanceDescIndex * (transformOffset / sizeof(float))],
-                worldToObjectMatrix.getFlatBuffer(), sizeof(float) * 12);
+    // A refit can't follow an instance onto another bottom level or in and out of a free slot
+    bool instanceTopologyChanged = false;
 
-        // Update normal transforms which is for all geometry in both
-        auto normalMatrix = worldToObjectMatrix.transpose();
-        auto offset       = instanceDescIndex * (normalTransformOffset / sizeof(float));
-
-        // Pointer math works in offset of the type
-        memcpy(&_instanceNormalMatrixTransforms[offset + 0], normalMatrix.getFlatBuffer() + 0, normalTransformOffset / 3);
-        memcpy(&_instanceNormalMatrixTransforms[offset + 3], normalMatrix.getFlatBuffer() + 4, normalTransformOffset / 3);
-        memcpy(&_instanceNormalMatrixTransforms[offset + 6], normalMatrix.getFlatBuffer() + 8, normalTransformOffset / 3);
+    uint32_t slot = 0;
+    for (slot = 0; slot < slotCount; slot++)
+    {
+        Entity* entity = _slotEntities[slot];
+        if (entity == nullptr)
+        {
+            _instanceUploadTracker.Track(slot, nullptr, 0);
+            instanceTopologyChanged |= _instanceDescs[slot].AccelerationStructure != 0;
+            continue;
+        }
 
-        memcpy(&_instanceModelMatrixTransforms[instanceDescIndex * (modelTransformOffset / sizeof(float))],
-               worldSpaceTransform.getFlatBuffer(), sizeof(float) * 16);
+        _instanceUploadTracker.Track(slot, entity, entity->getTransformGeneration());
 
-        if (EngineManager::getGraphicsLayer() != GraphicsLayer::DX12)
+        if (EngineManager::getGraphicsLayer() != GraphicsLayer::DX12 &&
+            _instanceDescs[slot].AccelerationStructure !=
+                _modelBlas[_getModelId(entity->getModel())]->GetASBuffer())
         {
-            instanceDescriptionCPUBuffer.push_back(D3D12_RAYTRACING_INSTANCE_DESC());
-            memcpy(&instanceDescriptionCPUBuffer[instanceDescIndex].Transform,
-                    &_instanceTransforms[instanceDescIndex * (transformOffset / sizeof(float))],
-                    sizeof(float) * 12);
-
-            // do not overwrite geometry flags for bottom levels, this caused the non opaque and
-            // opaqueness of bottom levels to be random
-            instanceDescriptionCPUBuffer[instanceDescIndex].Flags                               = D3D12_RAYTRACING_INSTANCE_FLAG_NONE;
-            instanceDescriptionCPUBuffer[instanceDescIndex].InstanceMask                        = 1;
-            instanceDescriptionCPUBuffer[instanceDescIndex].InstanceID                          = 0;
-            instanceDescriptionCPUBuffer[instanceDescIndex].InstanceContributionToHitGroupIndex = 0;
-            instanceDescriptionCPUBuffer[instanceDescIndex].AccelerationStructure               = _blasMap[entity->getModel()]->GetASBuffer();
+            _instanceUploadTracker.Invalidate(slot);
+            instanceTopologyChanged = true;
         }
+    }
 
-        instanceDescIndex++;
+    // Previous transforms for motion vectors catch up on the slots changed last frame or this one
+    // before the changed slots are rewritten
+    const uint64_t frame = _instanceUploadTracker.GetFrame();
+    _instanceUploadTracker.CollectRanges(frame - 1, 1, _instanceUploadRanges);
+    for (const SlotRange& range : _instanceUploadRanges)
+    {
+        memcpy(&_prevInstanceTransforms[range.first * TransformBatch::ObjectToWorldFloats],
+               &_instanceTransforms[range.first * TransformBatch::ObjectToWorldFloats],
+               sizeof(float) * TransformBatch::ObjectToWorldFloats * range.count);
+    }
 
-        _materialMapping.push_back(_texturesMap[entity->getModel()].second);
-        _attributeMapping.push_back(_vertexBufferMap[entity->getModel()].second);
+    // Chunks of the changed ranges are written on worker threads, each straight into its own slots
+    // of every stream, so the streams come out the same as written on one thread
+    if (_instanceWriter == nullptr)
+    {
+        _instanceWriter = new ParallelInstanceWriter(std::min(static_cast<uint32_t>(InstanceWriterMaxThreads),
+                                                              std::max(std::thread::hardware_concurrency(), 1u)) - 1,
+                                                     InstanceWriterChunkSlots);
     }
+    _instanceUploadTracker.CollectRanges(frame - 1, 0, _instanceUploadRanges);
+    _instanceWriter->Write(_instanceUploadRanges, this);
 
     if (EngineManager::getGraphicsLayer() != GraphicsLayer::DX12)
     {
-        if (entityList->size() == 0)
+        if (slotCount == 0)
         {
             return;
         }
@@ -1140,8 +1421,9 @@ void ResourceManager::_updateTransformData()
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC    topLevelBuildDesc = {};
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& topLevelInputs = topLevelBuildDesc.Inputs;
         topLevelInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-        topLevelInputs.Flags    = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
-        topLevelInputs.NumDescs       = static_cast<UINT>(entityList->size());
+        topLevelInputs.Flags    = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+                                  D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+        topLevelInputs.NumDescs       = slotCount;
         topLevelInputs.pGeometryDescs = nullptr;
         topLevelInputs.Type           = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 
@@ -1160,8 +1442,9 @@ void ResourceManager::_updateTransformData()
             newTopLevelAllocation = true;
         }
         else if ((topLevelPrebuildInfo.ScratchDataSizeInBytes >_tlasScratchBuffer[cmdListIndex]->GetDesc().Width) ||
+                 (topLevelPrebuildInfo.UpdateScratchDataSizeInBytes > _tlasScratchBuffer[cmdListIndex]->GetDesc().Width) ||
                  (topLevelPrebuildInfo.ResultDataMaxSizeInBytes > _tlasResultBuffer[cmdListIndex]->GetDesc().Width)||
-                 (_instanceDescriptionCPUBuffer[cmdListIndex]->GetDesc().Width < (sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * entityList->size())))
+                 (_instanceDescriptionCPUBuffer[cmdListIndex]->GetDesc().Width < (sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * slotCount)))
         {
             newTopLevelAllocation = true;
         }
@@ -1191,35 +1474,67 @@ void ResourceManager::_updateTransformData()
             _dxrDevice->CreateShaderResourceView(nullptr, &_rtASSrvDesc, hDescriptor);
 
             allocateUploadBuffer(_dxrDevice.Get(), nullptr,
-                                    sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * entityList->size() *
+                                    sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * slotCount *
                                         TlasAllocationMultiplier,
                                     &_instanceDescriptionCPUBuffer[cmdListIndex], L"instanceDescriptionCPUBuffer");
 
-            auto gpuBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * entityList->size() * TlasAllocationMultiplier,
+            auto gpuBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * slotCount * TlasAllocationMultiplier,
                                                                 D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 
             _dxrDevice->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE,
                                                 &gpuBufferDesc, D3D12_RESOURCE_STATE_COPY_DEST,
                                                 nullptr, IID_PPV_ARGS(&_instanceDescriptionGPUBuffer[cmdListIndex]));
-        }
 
-        BYTE*         mappedData = nullptr;
-        CD3DX12_RANGE readRange(0, 0);
-        _instanceDescriptionCPUBuffer[cmdListIndex]->Map(0, &readRange, reinterpret_cast<void**>(&mappedData));
+            // The new buffers hold no instances yet
+            _instanceDescSync.uploadFrames[cmdListIndex] = 0;
+            _instanceDescSync.gpuFrames[cmdListIndex]    = 0;
+        }
 
-        memcpy(&mappedData[0], instanceDescriptionCPUBuffer.data(), sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * entityList->size());
+        // Without a copy the buffer is still in the common state it decayed to and is promoted
+        // by the build reading it
+        if (_uploadInstanceStream(_instanceDescs.data(), sizeof(D3D12_RAYTRACING_INSTANCE_DESC), 0,
+                                  _instanceDescriptionCPUBuffer[cmdListIndex].Get(),
+                                  _instanceDescSync.uploadFrames[cmdListIndex],
+                                  _instanceDescriptionGPUBuffer[cmdListIndex].Get(),
+                                  _instanceDescSync.gpuFrames[cmdListIndex], commandList.Get()))
+        {
+            D3D12_RESOURCE_BARRIER barrierDesc = {};
 
-        commandList->CopyResource(_instanceDescriptionGPUBuffer[cmdListIndex].Get(), _instanceDescriptionCPUBuffer[cmdListIndex].Get());
+            barrierDesc.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrierDesc.Transition.pResource   = _instanceDescriptionGPUBuffer[cmdListIndex].Get();
+            barrierDesc.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barrierDesc.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barrierDesc.Transition.StateAfter  = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
 
-        D3D12_RESOURCE_BARRIER barrierDesc = {};
+            commandList->ResourceBarrier(1, &barrierDesc);
+        }
 
-        barrierDesc.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barrierDesc.Transition.pResource   = _instanceDescriptionGPUBuffer[cmdListIndex].Get();
-        barrierDesc.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrierDesc.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-        barrierDesc.Transition.StateAfter  = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        // Refit last frame's top level into this frame's buffer while the instances still point at
+        // the same bottom levels, the origins of the live instances stand in for how far the
+        // refit boxes have loosened since the last rebuild
+        TLASFrameInputs tlasInputs = {};
+        tlasInputs.instanceCount   = slotCount;
+        tlasInputs.topologyChanged = instanceTopologyChanged;
+        tlasInputs.sourceAvailable = (_tlasSourceIndex != UINT_MAX) &&
+                                     ((newTopLevelAllocation == false) || (_tlasSourceIndex != cmdListIndex));
+        tlasInputs.bounds.Reset();
+        for (slot = 0; slot < slotCount; slot++)
+        {
+            if (_slotEntities[slot] != nullptr)
+            {
+                const float* transform = &_instanceTransforms[slot * TransformBatch::ObjectToWorldFloats];
+                tlasInputs.bounds.Grow(transform[3], transform[7], transform[11]);
+            }
+        }
 
-        commandList->ResourceBarrier(1, &barrierDesc);
+        TLASBuildDecision tlasDecision = _tlasUpdatePolicy.Decide(tlasInputs);
+        if (tlasDecision.mode == TLASBuildMode::Update)
+        {
+            topLevelInputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+            topLevelBuildDesc.SourceAccelerationStructureData =
+                _tlasResultBuffer[_tlasSourceIndex]->GetGPUVirtualAddress();
+        }
+        _tlasSourceIndex = cmdListIndex;
 
         // Top Level Acceleration Structure desc
         topLevelBuildDesc.DestAccelerationStructureData =
@@ -1258,7 +1573,7 @@ void ResourceManager::_updateResourceMappingBuffers()
 
         newInstanceMappingAllocation = true;
     }
-    else if (_instanceIndexToMaterialMappingGPUBuffer->count < entityList->size())
+    else if (_instanceIndexToMaterialMappingGPUBuffer->count < _instanceSlots.GetSlotCount())
     {
         _instanceMappingIndex++;
         _instanceMappingIndex %= CMD_LIST_NUM;
@@ -1268,8 +1583,16 @@ void ResourceManager::_updateResourceMappingBuffers()
 
     if (newInstanceMappingAllocation)
     {
+        // Every stream buffer below is new and holds no instances yet
+        _normalMatrixSync  = InstanceStreamSync();
+        _modelMatrixSync   = InstanceStreamSync();
+        _prevInstanceSync  = InstanceStreamSync();
+        _worldToObjectSync = InstanceStreamSync();
+        _materialMappingDirty  = true;
+        _attributeMappingDirty = true;
+
        auto newInstanceSize = (_instanceIndexToMaterialMappingGPUBuffer->count == 0)
-                                    ? entityList->size()
+                                    ? _instanceSlots.GetSlotCount()
                                     : _instanceIndexToMaterialMappingGPUBuffer->count * TlasAllocationMultiplier;
 
         constexpr auto transformOffset                    = 12; // 3x4
@@ -1405,9 +1728,7 @@ void ResourceManager::_updateGeometryData()
                                                                 : DXLayer::instance()->getCmdList();
 
     // random floats between -1.0 - 1.0
-    std::random_device               rd;
-    std::mt19937                     generator(rd());
-    std::uniform_real_distribution<> randomFloats(-1.0, 1.0);
+    auto randomFloats = [this]() { return _geometryRandom.nextFloat(-1.0f, 1.0f); };
 
     if (RandomInsertAndRemoveEntities)
     {
@@ -1421,7 +1742,7 @@ void ResourceManager::_updateGeometryData()
             const float addEntityRange  = 10.0;
 
             SceneEntity sceneEntity;
-            int         entitiesToAdd = (((randomFloats(generator) + 1.0) / 2.0) * addEntityRange);
+            int         entitiesToAdd = (((randomFloats() + 1.0) / 2.0) * addEntityRange);
             if (entityList->size() == 0 && entitiesToAdd == 0)
             {
                 entitiesToAdd++;
@@ -1429,7 +1750,7 @@ void ResourceManager::_updateGeometryData()
 
             for (int i = 0; i < entitiesToAdd; i++)
             {
-                int randomCollection  = ((randomFloats(generator) + 1.0) / 2.0) * modelCount;
+                int randomCollection  = ((randomFloats() + 1.0) / 2.0) * modelCount;
                 sceneEntity.modelname = modelNames[randomCollection];
                 sceneEntity.name      = "";
 
@@ -1447,16 +1768,16 @@ void ResourceManager::_updateGeometryData()
                     modelScaleRange = 500.0;
                 }
 
-                Vector4 randomLocation(randomFloats(generator) * radiusRange * 10.0,
-                                       randomFloats(generator) * radiusRange * 10.0,
-                                       randomFloats(generator) * radiusRange * 10.0);
+                Vector4 randomLocation(randomFloats() * radiusRange * 10.0,
+                                       randomFloats() * radiusRange * 10.0,
+                                       randomFloats() * radiusRange * 10.0);
 
                 randomLocation = randomLocation - cameraPos;
 
-                Vector4 randomRotation(randomFloats(generator) * 360.0, randomFloats(generator) * 360.0,
-                                       randomFloats(generator) * 360.0);
+                Vector4 randomRotation(randomFloats() * 360.0, randomFloats() * 360.0,
+                                       randomFloats() * 360.0);
 
-                float   scaleForAll = ((randomFloats(generator) + 1.0) / 2.0) * modelScaleRange;
+                float   scaleForAll = ((randomFloats() + 1.0) / 2.0) * modelScaleRange;
                 Vector4 randomScale(scaleForAll, scaleForAll, scaleForAll);
 
                 sceneEntity.position = randomLocation;
@@ -1482,7 +1803,9 @@ void ResourceManager::_updateGeometryData()
     float cometTailRadius = 20000;
     bool  newGeometryBuilds   = false;
 
-    std::map<Model*, int> modelCountsInEntities;
+    // Entity counts of the models met this frame, kept in the flat per model tables
+    _modelCountFrame++;
+    _countedModelIds.clear();
     for (auto entity = entityList->begin(); entity != entityList->end();)
     {
         Vector4 entityPosition = ((*entity)->getWorldSpaceTransform() * Vector4(0, 0, 0, 1));
@@ -1490,8 +1813,8 @@ void ResourceManager::_updateGeometryData()
         {
             if ((*entity)->getHasEntered() == false)
             {
-                Vector4 rotation(randomFloats(generator) * 360.0, randomFloats(generator) * 360.0,
-                                 randomFloats(generator) * 360.0);
+                Vector4 rotation(randomFloats() * 360.0, randomFloats() * 360.0,
+                                 randomFloats() * 360.0);
 
                 (*entity)->entranceWaypoint(Vector4(entityPosition.getx(),
                                                     entityPosition.gety() - 500.0,
@@ -1501,7 +1824,7 @@ void ResourceManager::_updateGeometryData()
         }
 
         // Does a vertex buffer exist for this blas
-        bool isNewGeometry = _vertexBufferMap.find((*entity)->getModel()) == _vertexBufferMap.end();
+        bool isNewGeometry = _isModelRegistered((*entity)->getModel()) == false;
 
         if (isNewGeometry)
         {
@@ -1511,12 +1834,19 @@ void ResourceManager::_updateGeometryData()
 
         if (RandomInsertAndRemoveEntities)
         {
-            modelCountsInEntities[(*entity)->getModel()]++;
+            uint32_t modelId = _getModelId((*entity)->getModel());
+            if (_modelCountFrames[modelId] != _modelCountFrame)
+            {
+                _modelCountFrames[modelId]  = _modelCountFrame;
+                _modelEntityCounts[modelId] = 0;
+                _countedModelIds.push_back(modelId);
+            }
+            _modelEntityCounts[modelId]++;
 
             auto distance = (cameraPos + entityPosition).getMagnitude();
             if (distance > cometTailRadius)
             {
-                modelCountsInEntities[(*entity)->getModel()]--;
+                _modelEntityCounts[modelId]--;
                 auto tempEntity = *entity;
                 entity = entityList->erase(entity);
                 delete tempEntity;
@@ -1532,36 +1862,29 @@ void ResourceManager::_updateGeometryData()
         }
     }
 
-    std::map<Model*, int> modelsToRemove;
-    for (auto model : modelCountsInEntities)
-    {
-        if (model.second == 0)
-        {
-            modelsToRemove[model.first] = 1;
-        }
-    }
-
     bool blasRemoved = false;
-    for (auto model : modelCountsInEntities)
+    for (uint32_t modelId : _countedModelIds)
     {
-        if (model.second == 0 && _blasMap.find(model.first) != _blasMap.end())
+        Model* model = _idModels[modelId];
+        if (_modelEntityCounts[modelId] == 0 && _modelBlas[modelId] != nullptr)
         {
 
-            removeSRVToUnboundedTextureDescriptorTable(_texturesMap[model.first].second);
-            removeSRVToUnboundedAttributeBufferDescriptorTable(_vertexBufferMap[model.first].second);
-            removeSRVToUnboundedIndexBufferDescriptorTable(_indexBufferMap[model.first].second);
+            removeSRVToUnboundedTextureDescriptorTable(_texturesMap[model].second);
+            removeSRVToUnboundedAttributeBufferDescriptorTable(_vertexBufferMap[model].second);
+            removeSRVToUnboundedIndexBufferDescriptorTable(_indexBufferMap[model].second);
 
             // Clear out material slot and use later
-            auto attributeSlot = _vertexBufferMap.find(model.first)->second.second;
+            auto attributeSlot = _vertexBufferMap.find(model)->second.second;
             _uniformMaterialMap[attributeSlot].clear();
 
-            _vertexBufferMap.erase(_vertexBufferMap.find(model.first));
-            _indexBufferMap.erase(_indexBufferMap.find(model.first));
-            _texturesMap.erase(_texturesMap.find(model.first));
+            _vertexBufferMap.erase(_vertexBufferMap.find(model));
+            _indexBufferMap.erase(_indexBufferMap.find(model));
+            _texturesMap.erase(_texturesMap.find(model));
             // Deallocate the memory first
-            RTCompaction::RemoveAccelerationStructures(&_blasMap[model.first], 1);
+            RTCompaction::RemoveAccelerationStructures(&_blasMap[model], 1);
             // Remove the blas entry from the list
-            _blasMap.erase(model.first);
+            _blasMap.erase(model);
+            _unregisterModel(model);
 
             blasRemoved = true;
         }
@@ -1571,28 +1894,27 @@ void ResourceManager::_updateGeometryData()
     {
         if (newGeometryBuilds)
         {
+            // Worker threads record the batch on their own lists, DXLayer submits them ahead of
+            // commandList which keeps the cache loads and compaction size copies
+            ID3D12GraphicsCommandList4* workerCommandLists[BUILD_WORKER_CMD_LIST_NUM];
+            UINT workerCommandListCount = dxLayer->getBuildWorkerCmdLists(workerCommandLists);
+
             RTCompaction::ASBuffers* buffers = RTCompaction::BuildAccelerationStructures(
                 _dxrDevice.Get(), commandList.Get(), _bottomLevelBuildDescs.data(),
-                _bottomLevelBuildDescs.size());
+                _bottomLevelBuildDescs.size(), _bottomLevelBuildKeys.data(), workerCommandLists,
+                workerCommandListCount);
 
-            std::set<ID3D12Resource*> resourcesToBarrier;
             for (int asBufferIndex = 0; asBufferIndex < _bottomLevelBuildModels.size(); asBufferIndex++)
             {
                 _blasMap[_bottomLevelBuildModels[asBufferIndex]] = &buffers[asBufferIndex];
-
-                resourcesToBarrier.insert(buffers[asBufferIndex].resultGpuMemory.parentResource);
+                buffers[asBufferIndex].priorityDistance           = _bottomLevelBuildDistances[asBufferIndex];
+                _modelBlas[_getModelId(_bottomLevelBuildModels[asBufferIndex])] =
+                    &buffers[asBufferIndex];
             }
 
-            D3D12_RESOURCE_BARRIER* barrierDesc = new D3D12_RESOURCE_BARRIER[resourcesToBarrier.size()];
-            ZeroMemory(barrierDesc, sizeof(D3D12_RESOURCE_BARRIER) * resourcesToBarrier.size());
-
-            int i = 0;
-            for (auto resourceToBarrier : resourcesToBarrier)
-            {
-                barrierDesc[i] = CD3DX12_RESOURCE_BARRIER::UAV(resourceToBarrier);
-                i++;
-            }
-            commandList->ResourceBarrier(resourcesToBarrier.size(), barrierDesc);
+            // One barrier for the whole batch instead of one per suballocator block it built into
+            auto barrierDesc = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+            commandList->ResourceBarrier(1, &barrierDesc);
         }
     }
 
@@ -1607,9 +1929,6 @@ void ResourceManager::updateResources()
     auto commandList = dxLayer->usingAsyncCompute() ? DXLayer::instance()->getComputeCmdList()
                                                              : DXLayer::instance()->getCmdList();
 
-    _attributeMapping.clear();
-    _materialMapping.clear();
-
     if (EngineManager::getGraphicsLayer() != GraphicsLayer::DX12)
     {
         // Increment next frame and let the library internally manage compaction and releasing memory
@@ -1617,10 +1936,14 @@ void ResourceManager::updateResources()
 
         _bottomLevelBuildDescs.clear();
         _bottomLevelBuildModels.clear();
+        _bottomLevelBuildKeys.clear();
+        _bottomLevelBuildDistances.clear();
     }
 
     _updateGeometryData();
 
+    _updateInstanceSlots();
+
     _updateResourceMappingBuffers();
 
     _updateTransformData();
@@ -1635,6 +1958,7 @@ float* ResourceManager::getInstanceNormalTransforms()                   { return
 float* ResourceManager::getWorldToObjectTransforms()                    { return _instanceWorldToObjectMatrixTransforms.data(); }
 float* ResourceManager::getPrevInstanceTransforms()                     { return _prevInstanceTransforms.data();                }
 int    ResourceManager::getBLASCount()                                  { return _blasMap.size();                               }
+const TLASUpdateStats& ResourceManager::getTLASUpdateStats()            { return _tlasUpdatePolicy.GetStats();                  }
 
 void ResourceManager::createUnboundedTextureSrvDescriptorTable(UINT descriptorTableEntries)
 {
@@ -2,6 +2,7 @@
 #include "IOEventDistributor.h"
 #include "Logger.h"
 #include "Matrix.h"
+#include "Random.h"
 #include "Vector4.h"
 #include <Windows.h>
 #include <algorithm>
@@ -26,6 +27,14 @@ int main_entry(int argc, char** argv, HINSTANCE hInstance, int nCmdShow)
                 Logger::setLogLevel(log_level);
             }
         }
+        else if (arg == RANDOMSEEDCLI)
+        {
+            if (argc > (i + 1))
+            {
+                Random::setSeed(std::stoull(argv[i + 1]));
+                Random::setFixedSeed(true);
+            }
+        }
     }
 
     // Send the width and height in pixel units and the near and far plane to describe the view
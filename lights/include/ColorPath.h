@@ -1,4 +1,5 @@
 #pragma once
+#include "Curve.h"
 #include "Matrix.h"
 #include <string>
 #include <vector>
@@ -24,9 +25,10 @@ class ColorPath
 
   private:
     void                     _loadVectorsFromFile(const std::string& file);
+    void                     _buildCurve(const Vector4& initialColor);
     int                      _elapsedTime;
     int                      _currentVector;
-    Vector4                  _diffColor;
-    float                    _diffAlpha;
+    Curve                    _curve; // Starts from the color seen on the first update
+    Curve::Cursor            _cursor;
     std::vector<ColorVector> _vectors;
 };
\ No newline at end of file
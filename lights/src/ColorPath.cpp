@@ -24,37 +24,29 @@ ColorPath::ColorPath(const std::vector<ColorVector>& vectors) : _vectors(vectors
 
 void ColorPath::updateColor(int milliseconds, Vector4& color)
 {
-    if (_currentVector != -1)
+    if (_currentVector == -1 || _vectors.empty())
     {
-        if (_elapsedTime >= _vectors[_currentVector].time)
-        {
-            _elapsedTime = 0;
-            _currentVector++;
-
-            if (_currentVector >= _vectors.size())
-            {
-                _currentVector = -1;
-                return;
-            }
-        }
-        if (_elapsedTime == 0)
-        {
-            _diffColor = (_vectors[_currentVector].color - color) / _vectors[_currentVector].time;
-            _diffAlpha = (_vectors[_currentVector].color.getw() - color.getw()) /
-                         _vectors[_currentVector].time;
-        }
+        return;
+    }
 
-        // Save off the alpha value to indicate if a light is on or off
-        float preservedAlpha = color.getw() + (_diffAlpha * static_cast<float>(milliseconds));
+    // Each vector blends from wherever the color was when the path started, so the first
+    // update supplies the starting key
+    if (_curve.getKeyCount() == 0)
+    {
+        _buildCurve(color);
+    }
 
-        // This trashes alpha
-        color = color + (_diffColor * milliseconds);
+    _elapsedTime += milliseconds;
 
-        // Push back the preserved alpha value
-        color.getFlatBuffer()[3] = preservedAlpha;
+    // Alpha interpolates with the color and still marks a light as on or off
+    color = _curve.evaluate(static_cast<float>(_elapsedTime), _cursor);
 
-        _elapsedTime += milliseconds;
+    if (_elapsedTime >= _curve.getEndTime())
+    {
+        _currentVector = -1;
+        return;
     }
+    _currentVector = static_cast<int>(_cursor.segment);
 }
 
 void ColorPath::resetVectorsFromFile(const std::string& pathFile)
@@ -62,6 +54,7 @@ void ColorPath::resetVectorsFromFile(const std::string& pathFile)
     _loadVectorsFromFile(pathFile);
     _elapsedTime   = 0;
     _currentVector = 0;
+    _curve.clear();
 }
 
 void ColorPath::resetVectors(const std::vector<ColorVector>& vectors)
@@ -69,6 +62,22 @@ void ColorPath::resetVectors(const std::vector<ColorVector>& vectors)
     _vectors       = vectors;
     _elapsedTime   = 0;
     _currentVector = 0;
+    _curve.clear();
+}
+
+void ColorPath::_buildCurve(const Vector4& initialColor)
+{
+    // Vector times are durations, the keys sit at their running sum
+    float time = 0.0f;
+    _curve     = Curve(CurveInterpolation::Linear);
+    _curve.reserve(_vectors.size() + 1);
+    _curve.addKey(time, initialColor);
+    for (auto& vector : _vectors)
+    {
+        time += vector.time;
+        _curve.addKey(time, vector.color);
+    }
+    _cursor = Curve::Cursor();
 }
 
 void ColorPath::_loadVectorsFromFile(const std::string& file)
@@ -137,8 +137,7 @@ bool Light::isShadowCaster()
 
 float Light::getRange()
 {
-    float* projMatrix = _lightMVP.getProjectionBuffer();
-    float  farVal     = projMatrix[17];
+    float farVal = _lightMVP.getProjectionMatrix().getProjectionInfo().farPlane;
     return farVal;
 }
 
@@ -0,0 +1,921 @@
+/**
+ *  Math microbenchmark suite.  Times the matrix, vector, half float, quaternion, TRS and curve
+ *  hot paths on streams of pseudo random inputs and writes one row per benchmark as text, CSV
+ *  or JSON so runs before and after a change to the math internals can be diffed.  Before timing
+ *  anything it checks the rigid, uniform scale and affine inverses against the general 4x4 one
+ *  and every inverse times its matrix against the identity, and fails if any element is off by
+ *  more than 1e-4 relative, 1e-3 for the projective products.  The random generators are checked
+ *  against the published Philox and PCG32 known answers, Sobol against its net property, R2
+ *  against the sequence in double and blue noise against a brute force best candidate search.
+ *  The filter kernels KernelTables::emitHLSL writes have to match the checked in
+ *  filterKernels.hlsl, and the batch frustum culls have to agree with the single volume tests.
+ *
+ *  math_bench [--format text|csv|json] [--output file] [--filter substring] [--samples n]
+ */
+
+#include "Bounds.h"
+#include "Curve.h"
+#include "KernelTables.h"
+#include "Matrix.h"
+#include "Packing.h"
+#include "Quaternion.h"
+#include "Random.h"
+#include "TRS.h"
+#include "Vector4.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr size_t ElementCount   = 4096;
+constexpr double TargetSampleMs = 20.0;
+
+struct Result
+{
+    std::string name;
+    size_t      elements;
+    size_t      repetitions; // Passes over the elements per sample
+    double      medianNs;    // Per element
+    double      minimumNs;
+};
+
+struct Options
+{
+    std::string format  = "text";
+    std::string output;
+    std::string filter;
+    int         samples = 9;
+};
+
+// Results feed this so the compiler cannot drop the work being timed
+volatile float sink = 0.0f;
+
+void consume(const float* values, size_t count)
+{
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i += 97)
+    {
+        sum += values[i];
+    }
+    sink = sink + sum;
+}
+
+double passMs(const std::function<void()>& pass, size_t repetitions)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        pass();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Calibrates the repetition count to roughly TargetSampleMs per sample, then reports the median
+// and fastest sample so a noisy machine still gives a usable lower bound
+Result measure(const std::string& name, size_t elements, const Options& options,
+               const std::function<void()>& pass)
+{
+    size_t repetitions = 1;
+    passMs(pass, 1);
+    while (true)
+    {
+        double ms = passMs(pass, repetitions);
+        if (ms >= TargetSampleMs * 0.5 || repetitions >= (1u << 24))
+        {
+            repetitions = std::max<size_t>(
+                1, static_cast<size_t>(repetitions * TargetSampleMs / std::max(ms, 0.001)));
+            break;
+        }
+        repetitions *= 4;
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < options.samples; i++)
+    {
+        double ms = passMs(pass, repetitions);
+        samples.push_back(ms * 1.0e6 / (static_cast<double>(repetitions) * elements));
+    }
+    std::sort(samples.begin(), samples.end());
+    return Result{name, elements, repetitions, samples[samples.size() / 2], samples.front()};
+}
+
+struct Inputs
+{
+    std::vector<Matrix>     affine;
+    std::vector<Matrix>     projective;
+    std::vector<Vector4>    vectors;
+    std::vector<Vector4>    normals;
+    std::vector<float>      floats;
+    std::vector<uint16_t>   halves;
+    std::vector<Quaternion> quaternions;
+    std::vector<TRS>        transforms;
+    std::vector<float>      times;
+};
+
+Inputs buildInputs()
+{
+    Random::PCG32 generator(Random::DefaultSeed, 10);
+    Inputs        inputs;
+    Matrix        projection = Matrix::projection(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    for (size_t i = 0; i < ElementCount; i++)
+    {
+        Vector4 angles(generator.nextFloat(-180.0f, 180.0f), generator.nextFloat(-180.0f, 180.0f),
+                       generator.nextFloat(-180.0f, 180.0f));
+        Vector4 translation(generator.nextFloat(-100.0f, 100.0f),
+                            generator.nextFloat(-100.0f, 100.0f),
+                            generator.nextFloat(-100.0f, 100.0f));
+        Vector4 scale(generator.nextFloat(0.5f, 2.0f), generator.nextFloat(0.5f, 2.0f),
+                      generator.nextFloat(0.5f, 2.0f));
+        Quaternion rotation = Quaternion::fromEulerDegrees(angles);
+        TRS        trs(translation, rotation, scale);
+
+        inputs.affine.push_back(trs.toMatrix());
+        inputs.projective.push_back(projection * trs.toMatrix());
+        inputs.vectors.push_back(translation);
+        inputs.normals.push_back(Random::pointInSphere(generator));
+        inputs.normals.back().normalize();
+        inputs.floats.push_back(generator.nextFloat(-70000.0f, 70000.0f) *
+                                (i % 3 == 0 ? 1.0e-6f : 1.0f));
+        inputs.floats.push_back(generator.nextFloat(-2.0f, 2.0f));
+        inputs.quaternions.push_back(rotation);
+        inputs.transforms.push_back(trs);
+        inputs.times.push_back(generator.nextFloat(0.0f, 1000.0f));
+    }
+    inputs.halves.resize(inputs.floats.size());
+    Packing::floatToHalf(inputs.floats.data(), inputs.halves.data(), inputs.floats.size());
+    std::sort(inputs.times.begin(), inputs.times.end());
+    return inputs;
+}
+
+// Every specialized inverse is checked against the general 4x4 path, and every inverse times its
+// matrix against the identity, before anything is timed.  The projection's 0.1 to 1000 depth
+// range leaves the projective products further from the identity.
+constexpr float InverseTolerance            = 1.0e-4f;
+constexpr float ProjectiveResidualTolerance = 1.0e-3f;
+
+bool withinTolerance(const float* value, const float* reference, float tolerance)
+{
+    for (int i = 0; i < MATRIX_SIZE; i++)
+    {
+        if (fabsf(value[i] - reference[i]) > tolerance * (1.0f + fabsf(reference[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool validateInverses()
+{
+    Random::PCG32 generator(Random::DefaultSeed, 11);
+    Matrix        projection = Matrix::projection(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    const char*   names[]    = {"rigid", "uniform scale", "affine", "projective"};
+    const Matrix  identity;
+    bool          success = true;
+    for (int transformClass = 0; transformClass < 4; transformClass++)
+    {
+        int failures = 0;
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            Vector4 angles(generator.nextFloat(-180.0f, 180.0f),
+                           generator.nextFloat(-180.0f, 180.0f),
+                           generator.nextFloat(-180.0f, 180.0f));
+            Vector4 translation(generator.nextFloat(-100.0f, 100.0f),
+                                generator.nextFloat(-100.0f, 100.0f),
+                                generator.nextFloat(-100.0f, 100.0f));
+            float   uniform = generator.nextFloat(0.5f, 2.0f);
+            Vector4 scale(1.0f, 1.0f, 1.0f);
+            if (transformClass == 1)
+            {
+                scale = Vector4(uniform, uniform, uniform);
+            }
+            else if (transformClass >= 2)
+            {
+                scale = Vector4(uniform, generator.nextFloat(0.5f, 2.0f),
+                                generator.nextFloat(0.5f, 2.0f));
+            }
+
+            // Off unit length like a rotation after many compositions, still a rigid rotation
+            Quaternion rotation = Quaternion::fromEulerDegrees(angles);
+            float      drift    = generator.nextFloat(0.9f, 1.1f);
+            rotation = Quaternion(rotation.getx() * drift, rotation.gety() * drift,
+                                  rotation.getz() * drift, rotation.getw() * drift);
+
+            Matrix matrix = TRS(translation, rotation, scale).toMatrix();
+            if (transformClass == 3)
+            {
+                matrix = projection * matrix;
+            }
+
+            Matrix inverse   = matrix.inverse();
+            Matrix reference = matrix.generalInverse();
+            Matrix product   = matrix * inverse;
+            float  residual  = transformClass == 3 ? ProjectiveResidualTolerance : InverseTolerance;
+            if (static_cast<int>(matrix.getTransformClass()) != transformClass ||
+                withinTolerance(inverse.getFlatBuffer(), reference.getFlatBuffer(),
+                                InverseTolerance) == false ||
+                withinTolerance(product.getFlatBuffer(), identity.getFlatBuffer(),
+                                residual) == false)
+            {
+                failures++;
+            }
+        }
+        if (failures > 0)
+        {
+            fprintf(stderr, "inverse %s: %d of %zu off the general inverse or the identity\n",
+                    names[transformClass], failures, ElementCount);
+            success = false;
+        }
+    }
+    return success;
+}
+
+// Published known answers: the Random123 Philox4x32-10 vectors and the first outputs of the
+// pcg32 reference demo, seed 42 on stream 54
+struct PhiloxKnownAnswer
+{
+    uint32_t counter[4];
+    uint64_t key;
+    uint32_t expected[4];
+};
+
+constexpr PhiloxKnownAnswer PhiloxKnownAnswers[] = {
+    {{0, 0, 0, 0}, 0, {0x6627E8D5u, 0xE169C58Du, 0xBC57AC4Cu, 0x9B00DBD8u}},
+    {{0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu},
+     0xFFFFFFFFFFFFFFFFull,
+     {0x408F276Du, 0x41C83B0Eu, 0xA20BC7C6u, 0x6D5451FDu}},
+    {{0x243F6A88u, 0x85A308D3u, 0x13198A2Eu, 0x03707344u},
+     0x299F31D0A4093822ull,
+     {0xD16CFE09u, 0x94FDCCEBu, 0x5001E420u, 0x24126EA1u}},
+};
+
+constexpr uint32_t PCG32KnownAnswers[] = {0xA15C02B7u, 0x7B47F409u, 0xBA1D3330u,
+                                          0x83D2F293u, 0xBFA4784Bu, 0xCBED606Eu};
+
+// Every elementary interval of area 1 / count holds exactly one point, the (0, m, 2)-net
+// property of the first two Sobol dimensions, and each dimension alone is stratified
+bool isSobolNet(uint32_t count, uint32_t scramble)
+{
+    uint32_t log2Count = 0;
+    while ((1u << log2Count) < count)
+    {
+        log2Count++;
+    }
+
+    std::vector<Random::Sample2D> points(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        points[i] = Random::sobol2D(i, scramble);
+    }
+    for (uint32_t xBits = 0; xBits <= log2Count; xBits++)
+    {
+        uint32_t          columns = 1u << xBits;
+        uint32_t          rows    = count / columns;
+        std::vector<bool> filled(count, false);
+        for (const Random::Sample2D& point : points)
+        {
+            uint32_t cell = static_cast<uint32_t>(point.y * rows) * columns +
+                            static_cast<uint32_t>(point.x * columns);
+            if (filled[cell])
+            {
+                return false;
+            }
+            filled[cell] = true;
+        }
+    }
+
+    for (uint32_t dimension = 0; dimension < Random::SobolDimensions; dimension++)
+    {
+        std::vector<bool> filled(count, false);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t cell = static_cast<uint32_t>(Random::sobol(i, dimension, scramble) * count);
+            if (filled[cell])
+            {
+                return false;
+            }
+            filled[cell] = true;
+        }
+    }
+    return true;
+}
+
+// Best candidate with a brute force nearest neighbour search, the grid in Random::blueNoise
+// has to find the same nearest point for every candidate and so pick the same points
+std::vector<Random::Sample2D> bruteForceBlueNoise(size_t count, uint64_t seed, int candidates)
+{
+    std::vector<Random::Sample2D> points;
+    Random::PCG32                 random(seed);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t           tries    = i == 0 ? 1 : static_cast<size_t>(candidates) * i;
+        Random::Sample2D best     = {};
+        float            bestDist = -1.0f;
+        for (size_t t = 0; t < tries; t++)
+        {
+            Random::Sample2D candidate = {random.nextFloat(), random.nextFloat()};
+            float            nearest   = 2.0f;
+            for (const Random::Sample2D& point : points)
+            {
+                float dx = fabsf(candidate.x - point.x);
+                float dy = fabsf(candidate.y - point.y);
+                dx       = dx > 0.5f ? 1.0f - dx : dx;
+                dy       = dy > 0.5f ? 1.0f - dy : dy;
+                nearest  = std::min(nearest, dx * dx + dy * dy);
+            }
+            if (nearest > bestDist)
+            {
+                best     = candidate;
+                bestDist = nearest;
+            }
+        }
+        points.push_back(best);
+    }
+    return points;
+}
+
+bool validateRandom()
+{
+    bool success = true;
+    for (const PhiloxKnownAnswer& answer : PhiloxKnownAnswers)
+    {
+        Random::Philox4 words = Random::philox(answer.counter[0], answer.counter[1],
+                                               answer.counter[2], answer.counter[3], answer.key);
+        if (memcmp(words.value, answer.expected, sizeof(answer.expected)) != 0)
+        {
+            fprintf(stderr, "philox: counter %08x off the known answer\n", answer.counter[0]);
+            success = false;
+        }
+    }
+
+    Random::PCG32 pcg(42, 54);
+    for (uint32_t expected : PCG32KnownAnswers)
+    {
+        if (pcg.nextUInt() != expected)
+        {
+            fprintf(stderr, "pcg32: seed 42 stream 54 off the known answer\n");
+            success = false;
+            break;
+        }
+    }
+
+    // Jumping ahead has to land where stepping does
+    Random::PCG32 stepped(Random::DefaultSeed, 3);
+    Random::PCG32 jumped(Random::DefaultSeed, 3);
+    for (int i = 0; i < 1000; i++)
+    {
+        stepped.nextUInt();
+    }
+    jumped.advance(1000);
+    if (stepped.nextUInt() != jumped.nextUInt())
+    {
+        fprintf(stderr, "pcg32: advance off stepping\n");
+        success = false;
+    }
+
+    if (isSobolNet(256, 0) == false || isSobolNet(256, 0x9E3779B9u) == false)
+    {
+        fprintf(stderr, "sobol: first 256 points are not stratified\n");
+        success = false;
+    }
+
+    // R2 against fractional multiples of the inverse plastic number and its square in double
+    const double plastic  = 1.32471795724474602596;
+    int          r2Errors = 0;
+    for (uint32_t i = 0; i < ElementCount; i++)
+    {
+        Random::Sample2D point     = Random::r2(i);
+        double           x         = 0.5 + i / plastic;
+        double           y         = 0.5 + i / (plastic * plastic);
+        double           xDistance = fabs(point.x - (x - floor(x)));
+        double           yDistance = fabs(point.y - (y - floor(y)));
+        if (std::min(xDistance, 1.0 - xDistance) > 1.0e-5 ||
+            std::min(yDistance, 1.0 - yDistance) > 1.0e-5)
+        {
+            r2Errors++;
+        }
+    }
+    if (r2Errors > 0)
+    {
+        fprintf(stderr, "r2: %d of %zu off the double sequence\n", r2Errors, ElementCount);
+        success = false;
+    }
+
+    std::vector<Random::Sample2D> blueNoise = Random::blueNoise(256, Random::DefaultSeed, 8);
+    std::vector<Random::Sample2D> reference = bruteForceBlueNoise(256, Random::DefaultSeed, 8);
+    if (memcmp(blueNoise.data(), reference.data(), reference.size() * sizeof(Random::Sample2D)) !=
+        0)
+    {
+        fprintf(stderr, "blue noise: grid search picked other points than the brute force one\n");
+        success = false;
+    }
+    return success;
+}
+
+// Line endings are ignored so a checkout with CRLF still matches
+bool validateFilterKernels()
+{
+    std::ifstream file(FILTER_KERNELS_HLSL);
+    if (file.is_open() == false)
+    {
+        fprintf(stderr, "filter kernels: could not open %s\n", FILTER_KERNELS_HLSL);
+        return false;
+    }
+
+    std::ostringstream generated;
+    KernelTables::emitHLSL(generated);
+    std::istringstream expected(generated.str());
+    std::string        fileLine;
+    std::string        expectedLine;
+    int                lineNumber = 1;
+    while (true)
+    {
+        bool fileMore     = static_cast<bool>(std::getline(file, fileLine));
+        bool expectedMore = static_cast<bool>(std::getline(expected, expectedLine));
+        if (fileMore == false && expectedMore == false)
+        {
+            return true;
+        }
+        if (fileLine.empty() == false && fileLine.back() == '\r')
+        {
+            fileLine.pop_back();
+        }
+        if (fileMore != expectedMore || fileLine != expectedLine)
+        {
+            fprintf(stderr, "filter kernels: %s differs from KernelTables::emitHLSL at line %d\n",
+                    FILTER_KERNELS_HLSL, lineNumber);
+            return false;
+        }
+        lineNumber++;
+    }
+}
+
+// Boxes and spheres around a randomly placed camera, most of them straddle a plane. The count
+// is not a multiple of 8 so the scalar tail after the SIMD batches runs too.
+bool validateCulling()
+{
+    Random::PCG32 generator(Random::DefaultSeed, 13);
+    Matrix        projection = Matrix::projection(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    bool          success    = true;
+    for (int camera = 0; camera < 16; camera++)
+    {
+        Vector4 angles(generator.nextFloat(-180.0f, 180.0f), generator.nextFloat(-180.0f, 180.0f),
+                       generator.nextFloat(-180.0f, 180.0f));
+        Vector4 position(generator.nextFloat(-50.0f, 50.0f), generator.nextFloat(-50.0f, 50.0f),
+                         generator.nextFloat(-50.0f, 50.0f));
+        Matrix  view =
+            TRS(position, Quaternion::fromEulerDegrees(angles), Vector4(1.0f, 1.0f, 1.0f))
+                .toMatrix()
+                .inverse();
+        Frustum frustum(view, projection);
+
+        const size_t                count = ElementCount + 5;
+        std::vector<AABB>           boxes;
+        std::vector<BoundingSphere> spheres;
+        for (size_t i = 0; i < count; i++)
+        {
+            Vector4 center(generator.nextFloat(-200.0f, 200.0f),
+                           generator.nextFloat(-200.0f, 200.0f),
+                           generator.nextFloat(-200.0f, 200.0f));
+            Vector4 extents(generator.nextFloat(0.1f, 20.0f), generator.nextFloat(0.1f, 20.0f),
+                            generator.nextFloat(0.1f, 20.0f));
+            boxes.emplace_back(center - extents, center + extents);
+            spheres.emplace_back(center, extents.getx());
+        }
+
+        std::vector<uint8_t> visible(count);
+        size_t               boxCount    = frustum.cullAABBs(boxes.data(), count, visible.data());
+        size_t               expected    = 0;
+        int                  boxFailures = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            bool isVisible = frustum.isVisible(boxes[i]);
+            expected += isVisible ? 1 : 0;
+            boxFailures += visible[i] != (isVisible ? 1 : 0) ? 1 : 0;
+        }
+        if (boxFailures > 0 || boxCount != expected)
+        {
+            fprintf(stderr, "cull boxes: %d of %zu off the single box test\n", boxFailures, count);
+            success = false;
+        }
+
+        size_t sphereCount    = frustum.cullSpheres(spheres.data(), count, visible.data());
+        int    sphereFailures = 0;
+        expected              = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            bool isVisible = frustum.isVisible(spheres[i]);
+            expected += isVisible ? 1 : 0;
+            sphereFailures += visible[i] != (isVisible ? 1 : 0) ? 1 : 0;
+        }
+        if (sphereFailures > 0 || sphereCount != expected)
+        {
+            fprintf(stderr, "cull spheres: %d of %zu off the single sphere test\n",
+                    sphereFailures, count);
+            success = false;
+        }
+    }
+    return success;
+}
+
+std::vector<Result> runBenchmarks(const Options& options)
+{
+    Inputs              in = buildInputs();
+    std::vector<Result> results;
+    size_t              n  = ElementCount;
+
+    std::vector<Matrix>   matrices(n);
+    std::vector<Vector4>  vectors(n);
+    std::vector<float>    floats(in.floats.size());
+    std::vector<uint16_t> halves(in.floats.size());
+    std::vector<uint32_t> words(n);
+
+    auto run = [&](const std::string& name, size_t elements, const std::function<void()>& pass)
+    {
+        if (options.filter.empty() == false && name.find(options.filter) == std::string::npos)
+        {
+            return;
+        }
+        results.push_back(measure(name, elements, options, pass));
+        fprintf(stderr, "%s\n", name.c_str());
+    };
+    auto consumeMatrices = [&]() { consume(matrices[0].getFlatBuffer(), n * 16); };
+    auto consumeVectors  = [&]() { consume(vectors[0].getFlatBuffer(), n * 4); };
+
+    run("matrix_multiply", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.projective[i] * in.affine[(i + 1) % n];
+            }
+            consumeMatrices();
+        });
+    run("matrix_vector_multiply", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.projective[i] * in.vectors[i];
+            }
+            consumeVectors();
+        });
+    run("matrix_transpose", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.projective[i].transpose();
+            }
+            consumeMatrices();
+        });
+    run("matrix_inverse_affine", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.affine[i].inverse();
+            }
+            consumeMatrices();
+        });
+    run("matrix_inverse_projective", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.projective[i].inverse();
+            }
+            consumeMatrices();
+        });
+
+    run("vector4_add", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.vectors[i] + in.normals[i];
+            }
+            consumeVectors();
+        });
+    run("vector4_scale", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.vectors[i] * 0.5f;
+            }
+            consumeVectors();
+        });
+    run("vector4_dot", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                floats[i] = in.vectors[i].dotProduct(in.normals[i]);
+            }
+            consume(floats.data(), n);
+        });
+    run("vector4_cross", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.vectors[i].crossProduct(in.normals[i]);
+            }
+            consumeVectors();
+        });
+    run("vector4_normalize", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.vectors[i];
+                vectors[i].normalize();
+            }
+            consumeVectors();
+        });
+
+    size_t halfCount = in.floats.size();
+    run("half_from_float", halfCount,
+        [&]()
+        {
+            for (size_t i = 0; i < halfCount; i++)
+            {
+                halves[i] = Packing::floatToHalf(in.floats[i]);
+            }
+            sink = sink + halves[halfCount / 2];
+        });
+    run("half_from_float_batch", halfCount,
+        [&]()
+        {
+            Packing::floatToHalf(in.floats.data(), halves.data(), halfCount);
+            sink = sink + halves[halfCount / 2];
+        });
+    run("half_to_float", halfCount,
+        [&]()
+        {
+            for (size_t i = 0; i < halfCount; i++)
+            {
+                floats[i] = Packing::halfToFloat(in.halves[i]);
+            }
+            consume(floats.data(), halfCount);
+        });
+    run("half_to_float_batch", halfCount,
+        [&]()
+        {
+            Packing::halfToFloat(in.halves.data(), floats.data(), halfCount);
+            consume(floats.data(), halfCount);
+        });
+    run("octahedral_encode_batch", n,
+        [&]()
+        {
+            Packing::encodeOctahedral(in.normals.data(), n, words.data(), sizeof(uint32_t));
+            sink = sink + static_cast<float>(words[n / 2]);
+        });
+
+    std::vector<Quaternion> quaternions(n);
+    auto consumeQuaternions = [&]() { consume(quaternions[0].getFlatBuffer(), n * 4); };
+    run("quaternion_multiply", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                quaternions[i] = in.quaternions[i] * in.quaternions[(i + 1) % n];
+            }
+            consumeQuaternions();
+        });
+    run("quaternion_slerp", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                quaternions[i] =
+                    Quaternion::slerp(in.quaternions[i], in.quaternions[(i + 1) % n], 0.37f);
+            }
+            consumeQuaternions();
+        });
+    run("quaternion_rotate", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = in.quaternions[i].rotate(in.vectors[i]);
+            }
+            consumeVectors();
+        });
+    run("quaternion_to_matrix", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.quaternions[i].toMatrix();
+            }
+            consumeMatrices();
+        });
+
+    std::vector<TRS> transforms(n);
+    auto consumeTransforms = [&]() { consume(transforms[0].translation, n * 10); };
+    run("trs_to_matrix", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                matrices[i] = in.transforms[i].toMatrix();
+            }
+            consumeMatrices();
+        });
+    run("trs_from_matrix", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                transforms[i] = TRS::fromMatrix(in.affine[i]);
+            }
+            consumeTransforms();
+        });
+    run("trs_compose", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                transforms[i] = TRS::compose(in.transforms[i], in.transforms[(i + 1) % n]);
+            }
+            consumeTransforms();
+        });
+    run("trs_interpolate", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                transforms[i] =
+                    TRS::interpolate(in.transforms[i], in.transforms[(i + 1) % n], 0.37f);
+            }
+            consumeTransforms();
+        });
+
+    // One curve keyed on every input vector, sampled at sorted times like a playing animation
+    Curve linear(CurveInterpolation::Linear);
+    Curve catmullRom(CurveInterpolation::CatmullRom);
+    for (size_t i = 0; i < n; i++)
+    {
+        linear.addKey(static_cast<float>(i) * (1000.0f / n), in.vectors[i]);
+        catmullRom.addKey(static_cast<float>(i) * (1000.0f / n), in.vectors[i]);
+    }
+    run("curve_linear_search", n,
+        [&]()
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = linear.evaluate(in.times[i]);
+            }
+            consumeVectors();
+        });
+    run("curve_linear_cursor", n,
+        [&]()
+        {
+            Curve::Cursor cursor;
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = linear.evaluate(in.times[i], cursor);
+            }
+            consumeVectors();
+        });
+    run("curve_catmull_rom_cursor", n,
+        [&]()
+        {
+            Curve::Cursor cursor;
+            for (size_t i = 0; i < n; i++)
+            {
+                vectors[i] = catmullRom.evaluate(in.times[i], cursor);
+            }
+            consumeVectors();
+        });
+
+    return results;
+}
+
+std::string simdName()
+{
+#if defined(MATH_SIMD_AVX)
+    return "avx";
+#elif defined(MATH_SIMD_SSE)
+    return "sse";
+#elif defined(MATH_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void writeResults(FILE* file, const Options& options, const std::vector<Result>& results)
+{
+    if (options.format == "csv")
+    {
+        fprintf(file, "name,simd,elements,repetitions,median_ns,min_ns,mops_per_s\n");
+        for (auto& result : results)
+        {
+            fprintf(file, "%s,%s,%zu,%zu,%.4f,%.4f,%.2f\n", result.name.c_str(),
+                    simdName().c_str(), result.elements, result.repetitions, result.medianNs,
+                    result.minimumNs, 1.0e3 / result.medianNs);
+        }
+    }
+    else if (options.format == "json")
+    {
+        fprintf(file, "{\n  \"simd\": \"%s\",\n  \"samples\": %d,\n  \"benchmarks\": [\n",
+                simdName().c_str(), options.samples);
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            auto& result = results[i];
+            fprintf(file,
+                    "    {\"name\": \"%s\", \"elements\": %zu, \"repetitions\": %zu, "
+                    "\"median_ns\": %.4f, \"min_ns\": %.4f, \"mops_per_s\": %.2f}%s\n",
+                    result.name.c_str(), result.elements, result.repetitions, result.medianNs,
+                    result.minimumNs, 1.0e3 / result.medianNs,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+    }
+    else
+    {
+        fprintf(file, "simd %s, %d samples, ns per element\n", simdName().c_str(),
+                options.samples);
+        for (auto& result : results)
+        {
+            fprintf(file, "%-28s median %9.3f  min %9.3f  %9.2f Mops/s\n", result.name.c_str(),
+                    result.medianNs, result.minimumNs, 1.0e3 / result.medianNs);
+        }
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool        hasValue = i + 1 < argc;
+        if (argument == "--format" && hasValue)
+        {
+            options.format = argv[++i];
+        }
+        else if (argument == "--output" && hasValue)
+        {
+            options.output = argv[++i];
+        }
+        else if (argument == "--filter" && hasValue)
+        {
+            options.filter = argv[++i];
+        }
+        else if (argument == "--samples" && hasValue)
+        {
+            options.samples = std::max(1, atoi(argv[++i]));
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.format == "text" || options.format == "csv" || options.format == "json";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (parseOptions(argc, argv, options) == false)
+    {
+        fprintf(stderr, "usage: math_bench [--format text|csv|json] [--output file] "
+                        "[--filter substring] [--samples n]\n");
+        return 1;
+    }
+
+    if (validateInverses() == false || validateRandom() == false ||
+        validateFilterKernels() == false || validateCulling() == false)
+    {
+        fprintf(stderr, "FAILED\n");
+        return 1;
+    }
+
+    std::vector<Result> results = runBenchmarks(options);
+
+    FILE* file = options.output.empty() ? stdout : fopen(options.output.c_str(), "w");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "could not open %s\n", options.output.c_str());
+        return 1;
+    }
+    writeResults(file, options, results);
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    return 0;
+}
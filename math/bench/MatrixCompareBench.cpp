@@ -0,0 +1,375 @@
+/**
+ *  Checks the Matrix multiply, matrix times vector, transpose and inverse against a copy of the
+ *  scalar code they replaced and times both, in ns per matrix.  Built twice, once on the SIMD
+ *  path SIMD.h picks for the build machine and once with MATH_SIMD_SCALAR, and both builds are
+ *  held to the same limits.  Multiply, matrix times vector and transpose keep the old operation
+ *  order and have to match the old code bit for bit, 0 ULP.  The inverses use other formulas, so
+ *  they are measured against the old cofactor expansion evaluated in double and every element has
+ *  to be within 1e-4 relative, |current - exact| <= 1e-4 * (1 + |exact|).  The old float
+ *  inverse's own error against the same reference is printed next to it.
+ *
+ *  matrix_compare_bench, matrix_compare_bench_scalar
+ */
+
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "Random.h"
+#include "TRS.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace
+{
+constexpr size_t ElementCount     = 4096;
+constexpr int    Iterations       = 200;
+constexpr float  InverseTolerance = 1.0e-4f;
+
+// The scalar Matrix code before the SIMD rewrite, on bare row major 4x4s
+void legacyMultiply(const float* a, const float* b, float* result)
+{
+    for (int row = 0; row < 4; row++)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            result[row * 4 + column] = a[row * 4] * b[column] + a[row * 4 + 1] * b[4 + column] +
+                                       a[row * 4 + 2] * b[8 + column] +
+                                       a[row * 4 + 3] * b[12 + column];
+        }
+    }
+}
+
+void legacyMultiplyVector(const float* m, const float* vector, float* result)
+{
+    for (int row = 0; row < 4; row++)
+    {
+        result[row] = m[row * 4] * vector[0] + m[row * 4 + 1] * vector[1] +
+                      m[row * 4 + 2] * vector[2] + m[row * 4 + 3] * vector[3];
+    }
+}
+
+void legacyTranspose(const float* m, float* result)
+{
+    result[0] = m[0], result[1] = m[4], result[2] = m[8], result[3] = m[12];
+    result[4] = m[1], result[5] = m[5], result[6] = m[9], result[7] = m[13];
+    result[8] = m[2], result[9] = m[6], result[10] = m[10], result[11] = m[14];
+    result[12] = m[3], result[13] = m[7], result[14] = m[11], result[15] = m[15];
+}
+
+// Also run in double as the exact inverse the float results are measured against
+template <typename T> void legacyInverse(const float* m, T* result)
+{
+    T a11 = m[0], a12 = m[1], a13 = m[2], a14 = m[3];
+    T a21 = m[4], a22 = m[5], a23 = m[6], a24 = m[7];
+    T a31 = m[8], a32 = m[9], a33 = m[10], a34 = m[11];
+    T a41 = m[12], a42 = m[13], a43 = m[14], a44 = m[15];
+
+    std::copy(m, m + 16, result);
+
+    T det = (a11 * a22 * a33 * a44) + (a11 * a23 * a34 * a42) + (a11 * a24 * a32 * a43) +
+                (a12 * a21 * a34 * a43) + (a12 * a23 * a31 * a44) + (a12 * a24 * a33 * a41) +
+                (a13 * a21 * a32 * a44) + (a13 * a22 * a34 * a41) + (a13 * a24 * a31 * a42) +
+                (a14 * a21 * a33 * a42) + (a14 * a22 * a31 * a43) + (a14 * a23 * a32 * a41) -
+                (a11 * a22 * a34 * a43) - (a11 * a23 * a32 * a44) - (a11 * a24 * a33 * a42) -
+                (a12 * a21 * a33 * a44) - (a12 * a23 * a34 * a41) - (a12 * a24 * a31 * a43) -
+                (a13 * a21 * a34 * a42) - (a13 * a22 * a31 * a44) - (a13 * a24 * a32 * a41) -
+                (a14 * a21 * a32 * a43) - (a14 * a22 * a33 * a41) - (a14 * a23 * a31 * a42);
+
+    // Determinant cannot equal zero
+    if (det == 0)
+    {
+        return;
+    }
+
+    result[0] = ((a22 * a33 * a44) + (a23 * a34 * a42) + (a24 * a32 * a43) - (a22 * a34 * a43) -
+                 (a23 * a32 * a44) - (a24 * a33 * a42)) / det;
+    result[1] = ((a12 * a34 * a43) + (a13 * a32 * a44) + (a14 * a33 * a42) - (a12 * a33 * a44) -
+                 (a13 * a34 * a42) - (a14 * a32 * a43)) / det;
+    result[2] = ((a12 * a23 * a44) + (a13 * a24 * a42) + (a14 * a22 * a43) - (a12 * a24 * a43) -
+                 (a13 * a22 * a44) - (a14 * a23 * a42)) / det;
+    result[3] = ((a12 * a24 * a33) + (a13 * a22 * a34) + (a14 * a23 * a32) - (a12 * a23 * a34) -
+                 (a13 * a24 * a32) - (a14 * a22 * a33)) / det;
+    result[4] = ((a21 * a34 * a43) + (a23 * a31 * a44) + (a24 * a33 * a41) - (a21 * a33 * a44) -
+                 (a23 * a34 * a41) - (a24 * a31 * a43)) / det;
+    result[5] = ((a11 * a33 * a44) + (a13 * a34 * a41) + (a14 * a31 * a43) - (a11 * a34 * a43) -
+                 (a13 * a31 * a44) - (a14 * a33 * a41)) / det;
+    result[6] = ((a11 * a24 * a43) + (a13 * a21 * a44) + (a14 * a23 * a41) - (a11 * a23 * a44) -
+                 (a13 * a24 * a41) - (a14 * a21 * a43)) / det;
+    result[7] = ((a11 * a23 * a34) + (a13 * a24 * a31) + (a14 * a21 * a33) - (a11 * a24 * a33) -
+                 (a13 * a21 * a34) - (a14 * a23 * a31)) / det;
+    result[8] = ((a21 * a32 * a44) + (a22 * a34 * a41) + (a24 * a31 * a42) - (a21 * a34 * a42) -
+                 (a22 * a31 * a44) - (a24 * a32 * a41)) / det;
+    result[9] = ((a11 * a34 * a42) + (a12 * a31 * a44) + (a14 * a32 * a41) - (a11 * a32 * a44) -
+                 (a12 * a34 * a41) - (a14 * a31 * a42)) / det;
+    result[10] = ((a11 * a22 * a44) + (a12 * a24 * a41) + (a14 * a21 * a42) - (a11 * a24 * a42) -
+                  (a12 * a21 * a44) - (a14 * a22 * a41)) / det;
+    result[11] = ((a11 * a24 * a32) + (a12 * a21 * a34) + (a14 * a22 * a31) - (a11 * a22 * a34) -
+                  (a12 * a24 * a31) - (a14 * a21 * a32)) / det;
+    result[12] = ((a21 * a33 * a42) + (a22 * a31 * a43) + (a23 * a32 * a41) - (a21 * a32 * a43) -
+                  (a22 * a33 * a41) - (a23 * a31 * a42)) / det;
+    result[13] = ((a11 * a32 * a43) + (a12 * a33 * a41) + (a13 * a31 * a42) - (a11 * a33 * a42) -
+                  (a12 * a31 * a43) - (a13 * a32 * a41)) / det;
+    result[14] = ((a11 * a23 * a42) + (a12 * a21 * a43) + (a13 * a22 * a41) - (a11 * a22 * a43) -
+                  (a12 * a23 * a41) - (a13 * a21 * a42)) / det;
+    result[15] = ((a11 * a22 * a33) + (a12 * a23 * a31) + (a13 * a21 * a32) - (a11 * a23 * a32) -
+                  (a12 * a21 * a33) - (a13 * a22 * a31)) / det;
+}
+
+// Distance in representable floats, so 0 is bit for bit
+uint32_t ulpDistance(float a, float b)
+{
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    ia = ia < 0 ? INT32_MIN - ia : ia;
+    ib = ib < 0 ? INT32_MIN - ib : ib;
+    return ia > ib ? uint32_t(int64_t(ia) - ib) : uint32_t(int64_t(ib) - ia);
+}
+
+struct Check
+{
+    const char* name;
+    uint32_t    maxUlp            = 0;
+    double      maxRelative       = 0.0;
+    double      legacyMaxRelative = 0.0;
+    double      legacyNs          = 0.0;
+    double      currentNs         = 0.0;
+};
+
+uint32_t maxUlp(const float* value, const float* reference, size_t count)
+{
+    uint32_t distance = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        distance = std::max(distance, ulpDistance(value[i], reference[i]));
+    }
+    return distance;
+}
+
+template <typename T> double maxRelative(const float* value, const T* reference, size_t count)
+{
+    double error = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        error = std::max(error, fabs(value[i] - double(reference[i])) /
+                                    (1.0 + fabs(double(reference[i]))));
+    }
+    return error;
+}
+
+void compare(Check& check, const float* value, const float* reference, size_t count)
+{
+    check.maxUlp      = std::max(check.maxUlp, maxUlp(value, reference, count));
+    check.maxRelative = std::max(check.maxRelative, maxRelative(value, reference, count));
+}
+
+// Fastest of a few runs, in ns per element
+double timeNs(const std::function<void()>& pass)
+{
+    double best = 1.0e30;
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Iterations; i++)
+        {
+            pass();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                             start).count();
+        best      = std::min(best, ns / (double(Iterations) * ElementCount));
+    }
+    return best;
+}
+
+const char* simdName()
+{
+#if defined(MATH_SIMD_AVX)
+    return "avx";
+#elif defined(MATH_SIMD_SSE)
+    return "sse";
+#elif defined(MATH_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+} // namespace
+
+int main()
+{
+    Random::PCG32        generator(Random::DefaultSeed, 12);
+    Matrix               projection = Matrix::projection(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+    std::vector<Matrix>  affine;
+    std::vector<Matrix>  projective;
+    std::vector<Vector4> vectors;
+    for (size_t i = 0; i < ElementCount; i++)
+    {
+        Vector4 angles(generator.nextFloat(-180.0f, 180.0f), generator.nextFloat(-180.0f, 180.0f),
+                       generator.nextFloat(-180.0f, 180.0f));
+        Vector4 translation(generator.nextFloat(-100.0f, 100.0f),
+                            generator.nextFloat(-100.0f, 100.0f),
+                            generator.nextFloat(-100.0f, 100.0f));
+        Vector4 scale(generator.nextFloat(0.5f, 2.0f), generator.nextFloat(0.5f, 2.0f),
+                      generator.nextFloat(0.5f, 2.0f));
+        affine.push_back(TRS(translation, Quaternion::fromEulerDegrees(angles), scale).toMatrix());
+        projective.push_back(projection * affine.back());
+        vectors.push_back(Vector4(translation.getx(), translation.gety(), translation.getz(),
+                                  1.0f));
+    }
+
+    std::vector<Matrix>  matrices(ElementCount);
+    std::vector<Vector4> results(ElementCount);
+    std::vector<float>   legacy(ElementCount * 16);
+    volatile float       sink = 0.0f;
+
+    Check multiply{"multiply"};
+    auto  legacyMultiplyPass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            legacyMultiply(projective[i].getFlatBuffer(),
+                           affine[(i + 1) % ElementCount].getFlatBuffer(), &legacy[i * 16]);
+        }
+        sink = sink + legacy[ElementCount * 8];
+    };
+    auto currentMultiplyPass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            matrices[i] = projective[i] * affine[(i + 1) % ElementCount];
+        }
+        sink = sink + matrices[ElementCount / 2].getFlatBuffer()[0];
+    };
+    legacyMultiplyPass();
+    currentMultiplyPass();
+    for (size_t i = 0; i < ElementCount; i++)
+    {
+        compare(multiply, matrices[i].getFlatBuffer(), &legacy[i * 16], 16);
+    }
+    multiply.legacyNs  = timeNs(legacyMultiplyPass);
+    multiply.currentNs = timeNs(currentMultiplyPass);
+
+    Check vectorMultiply{"matrix_vector"};
+    auto  legacyVectorPass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            legacyMultiplyVector(projective[i].getFlatBuffer(), vectors[i].getFlatBuffer(),
+                                 &legacy[i * 4]);
+        }
+        sink = sink + legacy[ElementCount * 2];
+    };
+    auto currentVectorPass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            results[i] = projective[i] * vectors[i];
+        }
+        sink = sink + results[ElementCount / 2].getFlatBuffer()[0];
+    };
+    legacyVectorPass();
+    currentVectorPass();
+    for (size_t i = 0; i < ElementCount; i++)
+    {
+        compare(vectorMultiply, results[i].getFlatBuffer(), &legacy[i * 4], 4);
+    }
+    vectorMultiply.legacyNs  = timeNs(legacyVectorPass);
+    vectorMultiply.currentNs = timeNs(currentVectorPass);
+
+    Check transpose{"transpose"};
+    auto  legacyTransposePass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            legacyTranspose(projective[i].getFlatBuffer(), &legacy[i * 16]);
+        }
+        sink = sink + legacy[ElementCount * 8];
+    };
+    auto currentTransposePass = [&]()
+    {
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            matrices[i] = projective[i].transpose();
+        }
+        sink = sink + matrices[ElementCount / 2].getFlatBuffer()[0];
+    };
+    legacyTransposePass();
+    currentTransposePass();
+    for (size_t i = 0; i < ElementCount; i++)
+    {
+        compare(transpose, matrices[i].getFlatBuffer(), &legacy[i * 16], 16);
+    }
+    transpose.legacyNs  = timeNs(legacyTransposePass);
+    transpose.currentNs = timeNs(currentTransposePass);
+
+    Check inverseAffine{"inverse_affine"};
+    Check inverseProjective{"inverse_projective"};
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<Matrix>& inputs = pass == 0 ? affine : projective;
+        Check&               check  = pass == 0 ? inverseAffine : inverseProjective;
+        auto                 legacyInversePass = [&]()
+        {
+            for (size_t i = 0; i < ElementCount; i++)
+            {
+                legacyInverse(inputs[i].getFlatBuffer(), &legacy[i * 16]);
+            }
+            sink = sink + legacy[ElementCount * 8];
+        };
+        auto currentInversePass = [&]()
+        {
+            for (size_t i = 0; i < ElementCount; i++)
+            {
+                matrices[i] = inputs[i].inverse();
+            }
+            sink = sink + matrices[ElementCount / 2].getFlatBuffer()[0];
+        };
+        legacyInversePass();
+        currentInversePass();
+        for (size_t i = 0; i < ElementCount; i++)
+        {
+            const float* current = matrices[i].getFlatBuffer();
+            double       exact[16];
+            legacyInverse(inputs[i].getFlatBuffer(), exact);
+            check.maxRelative       = std::max(check.maxRelative, maxRelative(current, exact, 16));
+            check.legacyMaxRelative = std::max(check.legacyMaxRelative,
+                                               maxRelative(&legacy[i * 16], exact, 16));
+        }
+        check.legacyNs  = timeNs(legacyInversePass);
+        check.currentNs = timeNs(currentInversePass);
+    }
+
+    printf("simd %s, %zu matrices, ns per element\n", simdName(), ElementCount);
+    printf("%-20s %10s %10s %9s %8s %13s %13s %6s\n", "operation", "legacy", "current",
+           "speedup", "max ulp", "max relative", "legacy error", "pass");
+
+    Check* checks[] = {&multiply, &vectorMultiply, &transpose, &inverseAffine, &inverseProjective};
+    bool   success  = true;
+    for (Check* check : checks)
+    {
+        // Only the inverses changed formulas, everything else has to be bit for bit
+        bool inverse = check == &inverseAffine || check == &inverseProjective;
+        bool passed  = inverse ? check->maxRelative <= InverseTolerance : check->maxUlp == 0;
+        success      = success && passed;
+        char ulp[16]         = "-";
+        char legacyError[16] = "-";
+        if (inverse)
+        {
+            snprintf(legacyError, sizeof(legacyError), "%.3g", check->legacyMaxRelative);
+        }
+        else
+        {
+            snprintf(ulp, sizeof(ulp), "%u", check->maxUlp);
+        }
+        printf("%-20s %10.3f %10.3f %8.2fx %8s %13.3g %13s %6s\n", check->name, check->legacyNs,
+               check->currentNs, check->legacyNs / check->currentNs, ulp, check->maxRelative,
+               legacyError, passed ? "yes" : "no");
+    }
+
+    printf("%s\n", success ? "matches the legacy matrix code" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+/**
+ *  Throughput and round trip accuracy of the Packing batch converters on multi million vertex
+ *  streams, compared with the per vertex float to half loop VAO::createVAO used to run.
+ */
+
+#include "Packing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+constexpr int VertexCounts[] = {1000000, 4000000};
+constexpr int Iterations     = 10;
+
+// Old layout and converter, truncating and flushing small values to zero
+struct LegacyAttribute
+{
+    float    vertex[3];
+    uint16_t normal[3];
+    uint16_t uv[2];
+    uint16_t padding;
+};
+
+struct PackedAttribute
+{
+    float    vertex[3];
+    uint32_t normal;
+    uint32_t uv;
+};
+
+uint16_t legacyFloatToHalf(float floatValue)
+{
+    if (std::isnan(floatValue))
+    {
+        return 0xFFFF;
+    }
+    else if (std::isinf(floatValue))
+    {
+        return 0x7C00;
+    }
+    uint32_t value;
+    memcpy(&value, &floatValue, sizeof(value));
+    if (floatValue <= 0.001f && floatValue >= -0.001f)
+    {
+        return 0;
+    }
+    uint16_t output   = uint16_t((value & 0x007FFFFF) >> 13);
+    uint32_t exponent = ((value & 0x7F800000) >> 23);
+    if (exponent != 0)
+    {
+        if (exponent > 142)
+        {
+            return uint16_t((value & 0x80000000) >> 16) | uint16_t(0x7C00);
+        }
+        output |= (((exponent - 112) << 10) & 0x7C00);
+    }
+    output |= uint16_t((value & 0x80000000) >> 16);
+    return output;
+}
+
+// Deterministic unit normals spread over the sphere and uvs that tile past [0, 1]
+void buildStreams(int count, std::vector<Vector4>& normals, std::vector<float>& uvs)
+{
+    normals.resize(count);
+    uvs.resize(count * 2);
+    for (int i = 0; i < count; i++)
+    {
+        float   z   = 1.0f - 2.0f * (i + 0.5f) / count;
+        float   r   = sqrtf(std::max(0.0f, 1.0f - z * z));
+        float   phi = i * 2.39996323f;
+        normals[i]  = Vector4(r * cosf(phi), r * sinf(phi), z, 0.0f);
+        uvs[i * 2]     = fmodf(i * 0.000731f, 8.0f) - 2.0f;
+        uvs[i * 2 + 1] = fmodf(i * 0.000377f, 4.0f);
+    }
+}
+
+template <typename Func>
+double timeMs(Func func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < Iterations; i++)
+    {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / Iterations;
+}
+} // namespace
+
+int main()
+{
+    for (int count : VertexCounts)
+    {
+        std::vector<Vector4>         normals;
+        std::vector<float>           uvs;
+        std::vector<LegacyAttribute> legacy(count);
+        std::vector<PackedAttribute> packed(count);
+        buildStreams(count, normals, uvs);
+
+        double legacyMs = timeMs(
+            [&]()
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    const float* normal = normals[i].getFlatBuffer();
+                    legacy[i].normal[0] = legacyFloatToHalf(normal[0]);
+                    legacy[i].normal[1] = legacyFloatToHalf(normal[1]);
+                    legacy[i].normal[2] = legacyFloatToHalf(normal[2]);
+                    legacy[i].uv[0]     = legacyFloatToHalf(uvs[i * 2]);
+                    legacy[i].uv[1]     = legacyFloatToHalf(uvs[i * 2 + 1]);
+                    legacy[i].padding   = 0;
+                }
+            });
+        double batchMs = timeMs(
+            [&]()
+            {
+                Packing::encodeOctahedral(normals.data(), count, &packed[0].normal,
+                                          sizeof(PackedAttribute));
+                Packing::packHalf2(uvs.data(), count, &packed[0].uv, sizeof(PackedAttribute));
+            });
+
+        // Round trip error of the new encoding
+        double maxAngle = 0.0;
+        double maxUV    = 0.0;
+        for (int i = 0; i < count; i++)
+        {
+            // atan2 of the cross and dot products stays accurate for tiny angles where acos does not
+            Vector4 decoded = Packing::decodeOctahedral(packed[i].normal);
+            double  sine    = decoded.crossProduct(normals[i]).getMagnitude();
+            double  cosine  = decoded.dotProduct(normals[i]);
+            maxAngle        = std::max(maxAngle, atan2(sine, cosine) * 180.0 / 3.14159265358979);
+
+            float u = Packing::halfToFloat(static_cast<uint16_t>(packed[i].uv & 0xFFFF));
+            float v = Packing::halfToFloat(static_cast<uint16_t>(packed[i].uv >> 16));
+            maxUV   = std::max(maxUV, static_cast<double>(fabsf(u - uvs[i * 2])));
+            maxUV   = std::max(maxUV, static_cast<double>(fabsf(v - uvs[i * 2 + 1])));
+        }
+
+        printf("vertices %8d  per vertex %8.3f ms  batch %8.3f ms  speedup %5.2fx  "
+               "%6.1f Mverts/s  max normal error %.5f deg  max uv error %.6f  "
+               "bytes per vertex %zu -> %zu\n",
+               count, legacyMs, batchMs, legacyMs / batchMs, count / batchMs / 1000.0, maxAngle,
+               maxUV, sizeof(LegacyAttribute), sizeof(PackedAttribute));
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ *  Microbenchmark for TransformBatch::write against the per entity
+ *  getWorldSpaceTransform/inverse/transpose/memcpy loop it replaced.
+ */
+
+#include "TransformBatch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+constexpr int InstanceCounts[] = {1000, 10000, 50000};
+constexpr int Iterations       = 50;
+
+std::vector<Matrix> buildTransforms(int count)
+{
+    std::vector<Matrix> transforms;
+    transforms.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        float f = static_cast<float>(i);
+        transforms.push_back(Matrix::translation(f, f * 0.5f, -f) *
+                             Matrix::rotationAroundY(f * 0.1f) *
+                             Matrix::scale(1.0f + (i % 7) * 0.25f));
+    }
+    return transforms;
+}
+
+void scalarPath(const std::vector<Matrix>& transforms, TransformBatch::Streams& streams)
+{
+    for (size_t i = 0; i < transforms.size(); i++)
+    {
+        Matrix worldSpaceTransform = transforms[i];
+        memcpy(&streams.objectToWorld[i * 12], worldSpaceTransform.getFlatBuffer(), sizeof(float) * 12);
+
+        Matrix worldToObjectMatrix = worldSpaceTransform.inverse();
+        memcpy(&streams.worldToObject[i * 12], worldToObjectMatrix.getFlatBuffer(), sizeof(float) * 12);
+
+        Matrix normalMatrix = worldToObjectMatrix.transpose();
+        memcpy(&streams.normal[i * 9 + 0], normalMatrix.getFlatBuffer() + 0, sizeof(float) * 3);
+        memcpy(&streams.normal[i * 9 + 3], normalMatrix.getFlatBuffer() + 4, sizeof(float) * 3);
+        memcpy(&streams.normal[i * 9 + 6], normalMatrix.getFlatBuffer() + 8, sizeof(float) * 3);
+
+        memcpy(&streams.model[i * 16], worldSpaceTransform.getFlatBuffer(), sizeof(float) * 16);
+    }
+}
+
+template <typename Func>
+double timeMs(Func func)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < Iterations; i++)
+    {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / Iterations;
+}
+} // namespace
+
+int main()
+{
+    for (int count : InstanceCounts)
+    {
+        std::vector<Matrix> transforms = buildTransforms(count);
+        std::vector<float>  objectToWorld(count * TransformBatch::ObjectToWorldFloats);
+        std::vector<float>  worldToObject(count * TransformBatch::WorldToObjectFloats);
+        std::vector<float>  normal(count * TransformBatch::NormalFloats);
+        std::vector<float>  model(count * TransformBatch::ModelFloats);
+
+        TransformBatch::Streams streams;
+        streams.objectToWorld = objectToWorld.data();
+        streams.worldToObject = worldToObject.data();
+        streams.normal        = normal.data();
+        streams.model         = model.data();
+
+        double scalarMs = timeMs([&]() { scalarPath(transforms, streams); });
+        double batchMs  = timeMs(
+            [&]() { TransformBatch::write(transforms.data(), transforms.size(), streams); });
+
+        printf("instances %6d  per entity %8.3f ms  batch %8.3f ms  speedup %5.2fx\n", count,
+               scalarMs, batchMs, scalarMs / batchMs);
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ *  SIMD kernels for inverting the upper 3x4 of an affine matrix.
+ *  Shared by Matrix::inverse and TransformBatch so both pick the same
+ *  specialized path for rigid, uniform scale and general affine transforms.
+ */
+
+#pragma once
+#include "Matrix.h"
+#include "SIMD.h"
+
+namespace AffineInverse
+{
+
+// Rows of the inverse transpose of the upper 3x3 (the normal matrix) of a row major 4x4.
+// The w lane of each row is undefined.  Returns false if the 3x3 is singular.
+SIMD_INLINE bool normalRows(const float* m, TransformClass transformClass, SIMD::Float4& n0,
+                            SIMD::Float4& n1, SIMD::Float4& n2)
+{
+    SIMD::Float4 r0 = SIMD::load(&m[0]);
+    SIMD::Float4 r1 = SIMD::load(&m[4]);
+    SIMD::Float4 r2 = SIMD::load(&m[8]);
+
+    if (transformClass == TransformClass::Rigid)
+    {
+        // Orthonormal so the inverse transpose is the rotation itself
+        n0 = r0, n1 = r1, n2 = r2;
+        return true;
+    }
+    else if (transformClass == TransformClass::UniformScale)
+    {
+        // s * R inverts to R^T / s, the transpose of that is the matrix over s squared
+        float scaleSquared = (m[0] * m[0]) + (m[1] * m[1]) + (m[2] * m[2]);
+        if (scaleSquared == 0.0f)
+        {
+            return false;
+        }
+        SIMD::Float4 rScale = SIMD::splat(1.0f / scaleSquared);
+        n0                  = SIMD::mul(r0, rScale);
+        n1                  = SIMD::mul(r1, rScale);
+        n2                  = SIMD::mul(r2, rScale);
+        return true;
+    }
+
+    // Columns of the inverse scaled by the determinant are the cross products of the rows,
+    // which makes them the rows of the inverse transpose
+    SIMD::Float4 c0 = SIMD::cross3(r1, r2);
+    SIMD::Float4 c1 = SIMD::cross3(r2, r0);
+    SIMD::Float4 c2 = SIMD::cross3(r0, r1);
+
+    // The rows carry the translation in w, so c0's w lane is only zero without FMA contraction.
+    // Leave the translation out of the dot product.
+    SIMD::Float4 det = SIMD::horizontalSum(SIMD::mul(SIMD::set(m[0], m[1], m[2], 0.0f), c0));
+
+    // Determinant cannot equal zero
+    if (SIMD::getX(det) == 0.0f)
+    {
+        return false;
+    }
+
+    SIMD::Float4 rDet = SIMD::div(SIMD::splat(1.0f), det);
+    n0                = SIMD::mul(c0, rDet);
+    n1                = SIMD::mul(c1, rDet);
+    n2                = SIMD::mul(c2, rDet);
+    return true;
+}
+
+// Turns the normal rows of m into the first three rows of the inverse, translation in w.
+// Works in place on n0, n1 and n2.
+SIMD_INLINE void inverseRows(const float* m, SIMD::Float4& n0, SIMD::Float4& n1, SIMD::Float4& n2)
+{
+    // -(R^-1 * t) expressed as a combination of the normal rows
+    SIMD::Float4 inverseTranslation = SIMD::mul(SIMD::splat(m[3]), n0);
+    inverseTranslation              = SIMD::madd(SIMD::splat(m[7]), n1, inverseTranslation);
+    inverseTranslation              = SIMD::madd(SIMD::splat(m[11]), n2, inverseTranslation);
+    inverseTranslation              = SIMD::negate(inverseTranslation);
+
+    // Row 3 of the transpose is thrown away so the undefined w lanes never reach the output
+    SIMD::transpose(n0, n1, n2, inverseTranslation);
+}
+
+// Bottom row is exactly 0 0 0 1
+SIMD_INLINE bool hasAffineBottomRow(const float* m)
+{
+    return m[12] == 0.0f && m[13] == 0.0f && m[14] == 0.0f && m[15] == 1.0f;
+}
+
+} // namespace AffineInverse
@@ -0,0 +1,97 @@
+/**
+ *  Bounding volumes and view frustum tests.  Axis aligned boxes, oriented boxes and spheres,
+ *  a frustum whose six planes are pulled straight out of a view projection matrix and batch
+ *  visibility tests that check 4 (SSE/NEON) or 8 (AVX) volumes against every plane at once.
+ *  Matrices follow the engine convention, column vectors with clip = projection * view * p
+ *  and a DirectX 0 to 1 clip depth.
+ */
+
+#pragma once
+#include "Matrix.h"
+#include "Vector4.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct AABB
+{
+    Vector4 minPoint;
+    Vector4 maxPoint;
+
+    // Empty box, inverted so the first expand or merge snaps it onto the point
+    AABB();
+    AABB(const Vector4& minPoint, const Vector4& maxPoint);
+
+    static AABB fromPoints(const Vector4* points, size_t count);
+
+    bool    isEmpty() const;
+    Vector4 getCenter() const;
+    Vector4 getExtents() const; // Half size along each axis
+    void    expand(const Vector4& point);
+    void    merge(const AABB& other);
+
+    // Box around the transformed box, affine transforms only
+    AABB transform(const Matrix& transform) const;
+};
+
+struct BoundingSphere
+{
+    Vector4 center;
+    float   radius = 0.0f;
+
+    BoundingSphere() {}
+    BoundingSphere(const Vector4& center, float radius);
+    // Encloses the box, center to corner radius
+    explicit BoundingSphere(const AABB& box);
+
+    // Centered on the points' bounding box with the radius of the farthest point
+    static BoundingSphere fromPoints(const Vector4* points, size_t count);
+
+    // Radius grows by the largest axis scale so non uniform scale stays conservative
+    BoundingSphere transform(const Matrix& transform) const;
+};
+
+struct OBB
+{
+    Vector4 center;
+    Vector4 axes[3]; // Unit length
+    Vector4 extents; // Half size along each of the axes
+
+    OBB() {}
+    // Box carried through an affine transform, tighter than AABB::transform under rotation
+    OBB(const AABB& box, const Matrix& transform);
+
+    AABB getAABB() const;
+};
+
+struct Frustum
+{
+    enum Plane
+    {
+        Left = 0,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+        PlaneCount
+    };
+
+    // Plane i holds a unit normal pointing inside in xyz and the distance in w, a point is
+    // inside when dot(normal, p) + w >= 0 for all six
+    alignas(16) float planes[PlaneCount][4];
+
+    // Zero planes, every volume is visible
+    Frustum();
+    explicit Frustum(const Matrix& viewProjection);
+    Frustum(const Matrix& view, const Matrix& projection);
+
+    // Conservative, a volume that straddles a corner outside two planes can still pass
+    bool isVisible(const AABB& box) const;
+    bool isVisible(const BoundingSphere& sphere) const;
+    bool isVisible(const OBB& box) const;
+
+    // visible[i] is set to 1 or 0 per volume, returns the number of visible volumes.
+    // Same results as the single volume tests.
+    size_t cullAABBs(const AABB* boxes, size_t count, uint8_t* visible) const;
+    size_t cullSpheres(const BoundingSphere* spheres, size_t count, uint8_t* visible) const;
+};
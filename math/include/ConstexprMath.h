@@ -0,0 +1,120 @@
+/**
+ *  Compile time replacements for the <math.h> functions the math classes need.
+ *  Only used while the compiler is folding a constant expression, runtime code keeps
+ *  calling the library functions so results at runtime do not change.
+ *  Everything is evaluated in double and converges to well under a float ulp for the
+ *  ranges used by the builders and kernel tables (angles, sigma sized exponents).
+ */
+
+#pragma once
+
+namespace ConstexprMath
+{
+
+constexpr double Pi = 3.14159265358979323846;
+
+constexpr double abs(double x) { return x < 0.0 ? -x : x; }
+
+// Newton iteration from a first guess of x, stops once the estimate no longer changes
+constexpr double sqrt(double x)
+{
+    if (x <= 0.0)
+    {
+        return 0.0;
+    }
+    double guess = x < 1.0 ? 1.0 : x;
+    double prev  = 0.0;
+    while (guess != prev)
+    {
+        prev  = guess;
+        guess = 0.5 * (guess + x / guess);
+        // Newton can bounce between two neighbouring doubles forever
+        if (abs(guess - prev) <= 1e-15 * guess)
+        {
+            break;
+        }
+    }
+    return guess;
+}
+
+// Reduces x to [-pi, pi] then sums the Taylor series
+constexpr double sin(double x)
+{
+    double twoPi = 2.0 * Pi;
+    x            = x - twoPi * static_cast<double>(static_cast<long long>(x / twoPi));
+    if (x > Pi)
+    {
+        x -= twoPi;
+    }
+    else if (x < -Pi)
+    {
+        x += twoPi;
+    }
+
+    double term = x;
+    double sum  = x;
+    for (int n = 1; n < 20; n++)
+    {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) { return sin(x + 0.5 * Pi); }
+
+constexpr double tan(double x) { return sin(x) / cos(x); }
+
+// exp(x) = exp(x / 2^k)^(2^k) keeps the series argument below one
+constexpr double exp(double x)
+{
+    int halvings = 0;
+    while (abs(x) > 0.5)
+    {
+        x *= 0.5;
+        halvings++;
+    }
+
+    double term = 1.0;
+    double sum  = 1.0;
+    for (int n = 1; n < 20; n++)
+    {
+        term *= x / n;
+        sum += term;
+    }
+    for (int i = 0; i < halvings; i++)
+    {
+        sum *= sum;
+    }
+    return sum;
+}
+
+// Taylor series near zero and the erfc continued fraction in the tails where the
+// series would lose everything to cancellation
+constexpr double erf(double x)
+{
+    double sign = x < 0.0 ? -1.0 : 1.0;
+    x           = abs(x);
+
+    if (x < 2.5)
+    {
+        double term = x;
+        double sum  = x;
+        for (int n = 1; n < 80; n++)
+        {
+            term *= -x * x / n;
+            sum += term / (2.0 * n + 1.0);
+        }
+        return sign * 2.0 / sqrt(Pi) * sum;
+    }
+
+    double fraction = 0.0;
+    for (int n = 60; n > 0; n--)
+    {
+        fraction = (n * 0.5) / (x + fraction);
+    }
+    double erfc = exp(-x * x) / sqrt(Pi) / (x + fraction);
+    return sign * (1.0 - erfc);
+}
+
+} // namespace ConstexprMath
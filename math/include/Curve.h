@@ -0,0 +1,94 @@
+/**
+ *  Time keyed curves.  Step, linear, Catmull-Rom and cubic Hermite interpolation of up to four
+ *  components per key, with O(log n) segment lookup by binary search and a cursor that turns
+ *  forward playback into O(1).  Paths evaluate their curves at any time directly instead of
+ *  stepping state every kinematics tick.
+ */
+
+#pragma once
+#include "Vector4.h"
+#include <stddef.h>
+#include <vector>
+
+enum class CurveInterpolation
+{
+    Step,       // Holds each key until the next one
+    Linear,
+    CatmullRom, // Hermite with finite difference tangents, passes through every key
+    Hermite     // Tangents given per key, keys added without one fall back to Catmull-Rom
+};
+
+enum class CurveWrap
+{
+    Clamp, // Holds the first and last key outside the keyed range
+    Loop   // Repeats the keyed range
+};
+
+class Curve
+{
+  public:
+    // Last segment found, forward playback finds its next segment without a search
+    struct Cursor
+    {
+        size_t segment = 0;
+    };
+
+    // Segment starting at key index and the normalized position u in [0, 1] inside it
+    struct Segment
+    {
+        size_t index;
+        float  u;
+    };
+
+    Curve(CurveInterpolation interpolation = CurveInterpolation::Linear,
+          CurveWrap          wrap          = CurveWrap::Clamp);
+
+    // Keys are expected in increasing time order
+    void addKey(float time, const Vector4& value);
+    // Tangent in value units per unit of time, only used by Hermite curves
+    void addKey(float time, const Vector4& value, const Vector4& tangent);
+    void reserve(size_t keyCount);
+    void clear();
+
+    size_t             getKeyCount() const;
+    float              getKeyTime(size_t index) const;
+    const Vector4&     getKeyValue(size_t index) const;
+    float              getStartTime() const;
+    float              getEndTime() const;
+    CurveInterpolation getInterpolation() const;
+    CurveWrap          getWrap() const;
+
+    // Wrapped or clamped time inside the keyed range
+    float   wrapTime(float time) const;
+    Segment locate(float time) const;
+    Segment locate(float time, Cursor& cursor) const;
+
+    // All four components are interpolated, w included.  An empty curve returns a zero vector.
+    Vector4 evaluate(float time) const;
+    Vector4 evaluate(float time, Cursor& cursor) const;
+    // Value inside a segment from locate, lets curves keyed at the same times share one lookup.
+    // Needs at least two keys.
+    Vector4 evaluate(const Segment& segment) const;
+
+    // Many curves at one time, cursors can be null or hold one cursor per curve
+    static void evaluate(const Curve* curves, size_t count, float time, Vector4* output,
+                         Cursor* cursors = nullptr);
+    static void evaluate(const Curve* const* curves, size_t count, float time, Vector4* output,
+                         Cursor* cursors = nullptr);
+
+  private:
+    struct Key
+    {
+        Vector4 value;
+        Vector4 tangent;
+    };
+
+    Segment _search(float wrappedTime) const;
+    void    _updateTangent(size_t index);
+
+    CurveInterpolation _interpolation;
+    CurveWrap          _wrap;
+    std::vector<float> _times; // Kept apart from the keys so the search walks a dense array
+    std::vector<Key>   _keys;
+    std::vector<bool>  _autoTangent;
+};
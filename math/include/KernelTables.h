@@ -0,0 +1,142 @@
+/**
+ *  Filter weights and sample kernels generated at compile time.
+ *  The C++ reference code reads these tables directly and emitHLSL writes the filter kernels
+ *  out as shading/shaders/hlsl/include/filterKernels.hlsl so both sides use the same numbers.
+ */
+
+#pragma once
+#include "ConstexprMath.h"
+#include "Random.h"
+#include "Vector4.h"
+#include <ostream>
+#include <stdint.h>
+
+namespace KernelTables
+{
+
+template <int Radius>
+struct FilterKernel
+{
+    static constexpr int Width = 1 + 2 * Radius;
+
+    float kernel1D[Width];
+    float kernel[Width][Width];
+};
+
+// Separable 2D weights are the outer product of the 1D weights
+template <int Radius>
+constexpr void fillOuterProduct(FilterKernel<Radius>& filter)
+{
+    for (int row = 0; row < FilterKernel<Radius>::Width; row++)
+    {
+        for (int col = 0; col < FilterKernel<Radius>::Width; col++)
+        {
+            filter.kernel[row][col] = filter.kernel1D[row] * filter.kernel1D[col];
+        }
+    }
+}
+
+template <int Radius>
+constexpr FilterKernel<Radius> box()
+{
+    FilterKernel<Radius> filter = {};
+    for (int i = 0; i < FilterKernel<Radius>::Width; i++)
+    {
+        filter.kernel1D[i] = static_cast<float>(1.0 / FilterKernel<Radius>::Width);
+    }
+    fillOuterProduct(filter);
+    return filter;
+}
+
+// Row 2 * Radius of Pascal's triangle over 4^Radius, 1 4 6 4 1 / 16 for a radius of 2
+template <int Radius>
+constexpr FilterKernel<Radius> binomial()
+{
+    FilterKernel<Radius> filter = {};
+    double               weight = 1.0;
+    double               total  = 1.0;
+    for (int i = 0; i < 2 * Radius; i++)
+    {
+        total *= 2.0;
+    }
+    for (int i = 0; i < FilterKernel<Radius>::Width; i++)
+    {
+        filter.kernel1D[i] = static_cast<float>(weight / total);
+        weight             = weight * (2 * Radius - i) / (i + 1);
+    }
+    fillOuterProduct(filter);
+    return filter;
+}
+
+// Gaussian integrated over each texel footprint and renormalized over the kernel support
+template <int Radius>
+constexpr FilterKernel<Radius> gaussian(double sigma)
+{
+    FilterKernel<Radius> filter  = {};
+    double               rSigma  = 1.0 / (sigma * ConstexprMath::sqrt(2.0));
+    double               support = ConstexprMath::erf((Radius + 0.5) * rSigma);
+    for (int i = 0; i < FilterKernel<Radius>::Width; i++)
+    {
+        double x           = static_cast<double>(i - Radius);
+        double area        = ConstexprMath::erf((x + 0.5) * rSigma) -
+                      ConstexprMath::erf((x - 0.5) * rSigma);
+        filter.kernel1D[i] = static_cast<float>(area / (2.0 * support));
+    }
+    fillOuterProduct(filter);
+    return filter;
+}
+
+constexpr FilterKernel<1> Box3x3      = box<1>();
+constexpr FilterKernel<2> Box5x5      = box<2>();
+constexpr FilterKernel<3> Box7x7      = box<3>();
+constexpr FilterKernel<1> Gaussian3x3 = gaussian<1>(1.0);
+constexpr FilterKernel<2> Gaussian5x5 = binomial<2>();
+constexpr FilterKernel<3> Gaussian7x7 = gaussian<3>(1.0);
+constexpr FilterKernel<4> Gaussian9x9 = gaussian<4>(1.0);
+
+constexpr int SSAOKernelSize = 64;
+constexpr int SSAONoiseSize  = 16;
+
+struct SSAOSamples
+{
+    Vector4 kernel[SSAOKernelSize];
+    Vector4 noise[SSAONoiseSize];
+};
+
+// Hemisphere samples along +z, pushed towards the origin so close occluders count the most.
+// Drawn from the stateless hash so the table folds at compile time.
+constexpr SSAOSamples ssaoSamples()
+{
+    SSAOSamples samples = {};
+    uint32_t    stream  = 0;
+    for (int i = 0; i < SSAOKernelSize; i++)
+    {
+        Vector4 sample(Random::hashToUnitFloat(stream) * 2.0f - 1.0f,
+                       Random::hashToUnitFloat(stream + 1) * 2.0f - 1.0f,
+                       Random::hashToUnitFloat(stream + 2), 1.0f);
+        sample.normalize();
+        sample = sample * Random::hashToUnitFloat(stream + 3);
+        stream += 4;
+
+        float scale = static_cast<float>(i) / SSAOKernelSize;
+        scale       = 0.1f + (scale * scale) * (1.0f - 0.1f);
+
+        samples.kernel[i] = sample * scale;
+    }
+
+    // Random rotations around z used to tile the kernel across the screen
+    for (int i = 0; i < SSAONoiseSize; i++)
+    {
+        samples.noise[i] = Vector4(Random::hashToUnitFloat(stream) * 2.0f - 1.0f,
+                                   Random::hashToUnitFloat(stream + 1) * 2.0f - 1.0f, 0.0f, 1.0f);
+        stream += 2;
+    }
+    return samples;
+}
+
+constexpr SSAOSamples SSAOTable = ssaoSamples();
+
+// Writes the filter kernels as HLSL, used to regenerate filterKernels.hlsl
+void emitHLSL(std::ostream& output);
+
+} // namespace KernelTables
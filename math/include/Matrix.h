@@ -21,12 +21,46 @@
  */
 
 #pragma once
+#include "ConstexprMath.h"
+#include "SIMD.h"
 #include "Vector4.h"
 #include <math.h>
+#include <stdint.h>
 
-const float PI          = 3.14159265f;
-const float PI_OVER_180 = PI / 180.0f;
-#define MATRIX_SIZE 25
+constexpr float PI          = 3.14159265f;
+constexpr float PI_OVER_180 = PI / 180.0f;
+#define MATRIX_SIZE 16
+
+// Near, far, left, right, top, bottom, angle, aspect ratio and if inverted.
+// Only projection and ortho matrices fill these in, every other matrix leaves them zeroed.
+struct ProjectionInfo
+{
+    float nearPlane   = 0.0f;
+    float farPlane    = 0.0f;
+    float left        = 0.0f;
+    float right       = 0.0f;
+    float top         = 0.0f;
+    float bottom      = 0.0f;
+    float angleOfView = 0.0f;
+    float aspectRatio = 0.0f;
+    bool  inverted    = false;
+
+    constexpr bool isEmpty() const
+    {
+        return nearPlane == 0.0f && farPlane == 0.0f && left == 0.0f && right == 0.0f &&
+               top == 0.0f && bottom == 0.0f && angleOfView == 0.0f && aspectRatio == 0.0f;
+    }
+};
+
+// What kind of transform a matrix holds, ordered from most to least specialized.
+// Multiplying two matrices gives the less specialized class of the two.
+enum class TransformClass : uint8_t
+{
+    Rigid,        // Rotation and translation only
+    UniformScale, // Rigid with one scale factor on all three axes
+    Affine,       // Any 3x3 plus translation, bottom row is 0 0 0 1
+    Projective    // Anything else, also used when the contents are unknown
+};
 
 class Matrix
 {
@@ -76,34 +110,457 @@ class Matrix
     //| 0 0 0 1 |
 
     friend class Uniforms;
+    friend class Quaternion;
+    friend struct TRS;
 
-    // Extend to 25 to house the 4x4 matrix and also
-    // the near, far, left, right, top, bottom, angle, aspect ratio and if inverted
-    float _matrix[MATRIX_SIZE];
+    // 4x4 rows are 16 byte aligned for the SIMD paths and the whole 4x4 sits in one cache line.
+    // Projection metadata lives in a side struct after it so the hot kernels never touch it.
+    alignas(64) float _matrix[MATRIX_SIZE];
+    ProjectionInfo    _projectionInfo;
+    // Tracked by the builders and operators so inverse can skip the general 4x4 path
+    TransformClass    _transformClass;
 
     static Matrix convertToRightHanded(Matrix leftHandedMatrix, bool isViewMatrix);
-    Matrix(float* mat);
+    constexpr Matrix(const float* mat, TransformClass transformClass = TransformClass::Projective);
+    constexpr Matrix(const float* mat, const ProjectionInfo& projectionInfo);
+    Matrix _generalInverse() const;
+
+    // Runtime SIMD bodies of the operators.  The constexpr public versions only fall back to
+    // scalar code while the compiler is folding a constant so runtime results do not change.
+    Matrix  _simdTranspose() const;
+    Matrix  _simdInverse() const;
+    Matrix  _simdMultiply(const Matrix& mat) const;
+    Vector4 _simdMultiply(const Vector4& vec) const;
+    Matrix  _simdAdd(const Matrix& mat) const;
+    Matrix  _simdSubtract(const Matrix& mat) const;
+    Matrix  _simdScale(float scale) const;
+
+    constexpr Matrix        _affineInverse(TransformClass transformClass) const;
+    static constexpr float  _sin(float radians);
+    static constexpr float  _cos(float radians);
+    static constexpr double _tan(double radians);
 
   public:
-    Matrix();
-    float*  getFlatBuffer();
-    Matrix  transpose();
-    Matrix  inverse();
-    void    display();
-    Matrix  operator*(Matrix mat);
-    Vector4 operator*(Vector4 vec);
-    Matrix  operator*(double scale);
-    Matrix  operator*(float scale);
-    Matrix  operator+(Matrix mat);
-    Matrix  operator-(Matrix mat);
-
-    static Matrix rotationAroundX(float degrees);
-    static Matrix rotationAroundY(float degrees);
-    static Matrix rotationAroundZ(float degrees);
-    static Matrix translation(float x, float y, float z);
-    static Matrix projection(float angleOfView, float aspectRatio, float near, float far);
-    static Matrix scale(float scalar);
-    static Matrix scale(float x, float y, float z);
-    static Matrix ortho(float orthoWidth, float orthoHeight, float n, float f);
-    static Matrix ortho(float l, float r, float t, float b, float n, float f);
-};
\ No newline at end of file
+    constexpr Matrix();
+    // Writable access drops the tracked transform class since the contents can change
+    constexpr float*                getFlatBuffer();
+    constexpr const float*          getFlatBuffer() const;
+    constexpr const ProjectionInfo& getProjectionInfo() const;
+    constexpr TransformClass        getTransformClass() const;
+    // Affine inverses fold at compile time, a general projective inverse only runs at runtime
+    constexpr Matrix                transpose() const;
+    constexpr Matrix                inverse() const;
+    // Always the general 4x4 path, the reference the specialized inverses are checked against
+    Matrix                          generalInverse() const;
+    void                            display() const;
+    constexpr Matrix                operator*(const Matrix& mat) const;
+    constexpr Vector4               operator*(const Vector4& vec) const;
+    constexpr Matrix                operator*(double scale) const;
+    constexpr Matrix                operator*(float scale) const;
+    constexpr Matrix                operator+(const Matrix& mat) const;
+    constexpr Matrix                operator-(const Matrix& mat) const;
+
+    static constexpr Matrix rotationAroundX(float degrees);
+    static constexpr Matrix rotationAroundY(float degrees);
+    static constexpr Matrix rotationAroundZ(float degrees);
+    static constexpr Matrix translation(float x, float y, float z);
+    static constexpr Matrix projection(float angleOfView, float aspectRatio, float near, float far);
+    static constexpr Matrix scale(float scalar);
+    static constexpr Matrix scale(float x, float y, float z);
+    static constexpr Matrix ortho(float orthoWidth, float orthoHeight, float n, float f);
+    static constexpr Matrix ortho(float l, float r, float t, float b, float n, float f);
+};
+
+constexpr Matrix::Matrix()
+    : // Identity 4x4 homogenous matrix
+      _matrix{1.0f, 0.0f, 0.0f, 0.0f,
+              0.0f, 1.0f, 0.0f, 0.0f,
+              0.0f, 0.0f, 1.0f, 0.0f,
+              0.0f, 0.0f, 0.0f, 1.0f},
+      _projectionInfo(), _transformClass(TransformClass::Rigid)
+{
+}
+
+constexpr Matrix::Matrix(const float* mat, TransformClass transformClass)
+    : _matrix{mat[0], mat[1], mat[2],  mat[3],  mat[4],  mat[5],  mat[6],  mat[7],
+              mat[8], mat[9], mat[10], mat[11], mat[12], mat[13], mat[14], mat[15]},
+      _projectionInfo(), _transformClass(transformClass)
+{
+}
+
+constexpr Matrix::Matrix(const float* mat, const ProjectionInfo& projectionInfo) : Matrix(mat)
+{
+    _projectionInfo = projectionInfo;
+}
+
+constexpr float* Matrix::getFlatBuffer()
+{
+    _transformClass = TransformClass::Projective;
+    return _matrix;
+}
+
+constexpr const float* Matrix::getFlatBuffer() const { return _matrix; }
+
+constexpr const ProjectionInfo& Matrix::getProjectionInfo() const { return _projectionInfo; }
+
+constexpr TransformClass Matrix::getTransformClass() const { return _transformClass; }
+
+// The library trig functions are not constexpr so the builders swap them out while folding
+constexpr float Matrix::_sin(float radians)
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return static_cast<float>(ConstexprMath::sin(radians));
+    }
+    return sinf(radians);
+}
+
+constexpr float Matrix::_cos(float radians)
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return static_cast<float>(ConstexprMath::cos(radians));
+    }
+    return cosf(radians);
+}
+
+constexpr double Matrix::_tan(double radians)
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return ConstexprMath::tan(radians);
+    }
+    return tan(radians);
+}
+
+constexpr Matrix Matrix::transpose() const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdTranspose();
+    }
+
+    Matrix matrix;
+    matrix._projectionInfo = _projectionInfo;
+
+    // Without a translation the transpose of a 3x3 transform is the same kind of transform
+    bool hasTranslation    = _matrix[3] != 0.0f || _matrix[7] != 0.0f || _matrix[11] != 0.0f;
+    matrix._transformClass = hasTranslation ? TransformClass::Projective : _transformClass;
+
+    for (int row = 0; row < 4; row++)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            matrix._matrix[column * 4 + row] = _matrix[row * 4 + column];
+        }
+    }
+    return matrix;
+}
+
+constexpr Matrix Matrix::inverse() const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdInverse();
+    }
+
+    bool affineBottomRow = _matrix[12] == 0.0f && _matrix[13] == 0.0f && _matrix[14] == 0.0f &&
+                           _matrix[15] == 1.0f;
+    if (_transformClass == TransformClass::Projective && affineBottomRow == false)
+    {
+        // Not constexpr, a true projective inverse in a constant expression fails to compile
+        return _generalInverse();
+    }
+    return _affineInverse(_transformClass == TransformClass::Projective ? TransformClass::Affine
+                                                                        : _transformClass);
+}
+
+// Scalar version of the AffineInverse kernels, the 3x3 inverse is the cross products of the
+// rows over the determinant and the translation is rotated and negated
+constexpr Matrix Matrix::_affineInverse(TransformClass transformClass) const
+{
+    const float* m = _matrix;
+    Matrix       matrix(_matrix, transformClass);
+    matrix._projectionInfo          = _projectionInfo;
+    matrix._projectionInfo.inverted = true;
+
+    float c0[3] = {(m[5] * m[10]) - (m[6] * m[9]), (m[6] * m[8]) - (m[4] * m[10]),
+                   (m[4] * m[9]) - (m[5] * m[8])};
+    float c1[3] = {(m[9] * m[2]) - (m[10] * m[1]), (m[10] * m[0]) - (m[8] * m[2]),
+                   (m[8] * m[1]) - (m[9] * m[0])};
+    float c2[3] = {(m[1] * m[6]) - (m[2] * m[5]), (m[2] * m[4]) - (m[0] * m[6]),
+                   (m[0] * m[5]) - (m[1] * m[4])};
+    float det   = (m[0] * c0[0]) + (m[1] * c0[1]) + (m[2] * c0[2]);
+
+    // Determinant cannot equal zero
+    if (det == 0.0f)
+    {
+        return matrix;
+    }
+
+    for (int row = 0; row < 3; row++)
+    {
+        float* inverseRow = &matrix._matrix[row * 4];
+        inverseRow[0]     = c0[row] / det;
+        inverseRow[1]     = c1[row] / det;
+        inverseRow[2]     = c2[row] / det;
+        inverseRow[3]     = -((inverseRow[0] * m[3]) + (inverseRow[1] * m[7]) +
+                          (inverseRow[2] * m[11]));
+    }
+    return matrix;
+}
+
+constexpr Vector4 Matrix::operator*(const Vector4& vec) const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdMultiply(vec);
+    }
+
+    const float* v         = vec.getFlatBuffer();
+    float        result[4] = {};
+    for (int row = 0; row < 4; row++)
+    {
+        const float* m = &_matrix[row * 4];
+        result[row]    = (m[0] * v[0]) + (m[1] * v[1]) + (m[2] * v[2]) + (m[3] * v[3]);
+    }
+    return Vector4(result[0], result[1], result[2], result[3]);
+}
+
+constexpr Matrix Matrix::operator*(const Matrix& mat) const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdMultiply(mat);
+    }
+
+    Matrix result;
+    result._projectionInfo = _projectionInfo;
+    result._transformClass =
+        _transformClass > mat._transformClass ? _transformClass : mat._transformClass;
+
+    for (int row = 0; row < 4; row++)
+    {
+        const float* a = &_matrix[row * 4];
+        for (int column = 0; column < 4; column++)
+        {
+            const float* b                  = &mat._matrix[column];
+            result._matrix[row * 4 + column] =
+                (a[0] * b[0]) + (a[1] * b[4]) + (a[2] * b[8]) + (a[3] * b[12]);
+        }
+    }
+    return result;
+}
+
+constexpr Matrix Matrix::operator+(const Matrix& mat) const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdAdd(mat);
+    }
+
+    Matrix result;
+    result._projectionInfo = _projectionInfo;
+    result._transformClass = TransformClass::Projective;
+    for (int i = 0; i < MATRIX_SIZE; i++)
+    {
+        result._matrix[i] = _matrix[i] + mat._matrix[i];
+    }
+    return result;
+}
+
+constexpr Matrix Matrix::operator-(const Matrix& mat) const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdSubtract(mat);
+    }
+
+    Matrix result;
+    result._projectionInfo = _projectionInfo;
+    result._transformClass = TransformClass::Projective;
+    for (int i = 0; i < MATRIX_SIZE; i++)
+    {
+        result._matrix[i] = _matrix[i] - mat._matrix[i];
+    }
+    return result;
+}
+
+constexpr Matrix Matrix::operator*(double scale) const { return *this * static_cast<float>(scale); }
+
+constexpr Matrix Matrix::operator*(float scale) const
+{
+    if (!SIMD::isConstantEvaluated())
+    {
+        return _simdScale(scale);
+    }
+
+    Matrix result;
+    result._projectionInfo = _projectionInfo;
+    result._transformClass = TransformClass::Projective;
+    for (int i = 0; i < MATRIX_SIZE; i++)
+    {
+        result._matrix[i] = _matrix[i] * scale;
+    }
+    return result;
+}
+
+// Rotation Matrix of a theta change around X axis
+//| 1  0    0   0 |
+//| 0 cos -sin  0 |
+//| 0 sin  cos  0 |
+//| 0  0    0   1 |
+constexpr Matrix Matrix::rotationAroundX(float degrees)
+{
+    float theta = degrees * PI_OVER_180;
+    float c     = _cos(theta);
+    float s     = _sin(theta);
+
+    const float result[MATRIX_SIZE] = {1.0f, 0.0f, 0.0f, 0.0f,
+                                       0.0f, c,    s,    0.0f,
+                                       0.0f, -s,   c,    0.0f,
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    return Matrix(result, TransformClass::Rigid);
+}
+
+// Rotation Matrix of a theta change around Y axis
+//| cos 0  sin  0 |
+//|  0  1   0   0 |
+//|-sin 0  cos  0 |
+//|  0  0   0   1 |
+constexpr Matrix Matrix::rotationAroundY(float degrees)
+{
+    float theta = degrees * PI_OVER_180;
+    float c     = _cos(theta);
+    float s     = _sin(theta);
+
+    const float result[MATRIX_SIZE] = {c,    0.0f, -s,   0.0f,
+                                       0.0f, 1.0f, 0.0f, 0.0f,
+                                       s,    0.0f, c,    0.0f,
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    return Matrix(result, TransformClass::Rigid);
+}
+
+// Rotation Matrix of a theta change around Z axis
+//| cos -sin 0  0 |
+//| sin  cos 0  0 |
+//|  0    0  1  0 |
+//|  0    0  0  1 |
+constexpr Matrix Matrix::rotationAroundZ(float degrees)
+{
+    float theta = degrees * PI_OVER_180;
+    float c     = _cos(theta);
+    float s     = _sin(theta);
+
+    const float result[MATRIX_SIZE] = {c,    s,    0.0f, 0.0f,
+                                       -s,   c,    0.0f, 0.0f,
+                                       0.0f, 0.0f, 1.0f, 0.0f,
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    return Matrix(result, TransformClass::Rigid);
+}
+
+// Translation Matrix of a +5 change in X position
+//| 1 0 0 5 |
+//| 0 1 0 0 |
+//| 0 0 1 0 |
+//| 0 0 0 1 |
+constexpr Matrix Matrix::translation(float x, float y, float z)
+{
+    const float result[MATRIX_SIZE] = {1.0f, 0.0f, 0.0f, x,
+                                       0.0f, 1.0f, 0.0f, y,
+                                       0.0f, 0.0f, 1.0f, z,
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    return Matrix(result, TransformClass::Rigid);
+}
+
+// Scale Matrix of 2
+//| 2 0 0 0 |
+//| 0 2 0 0 |
+//| 0 0 2 0 |
+//| 0 0 0 1 |
+constexpr Matrix Matrix::scale(float scalar)
+{
+    const float result[MATRIX_SIZE] = {scalar, 0.0f,   0.0f,   0.0f,
+                                       0.0f,   scalar, 0.0f,   0.0f,
+                                       0.0f,   0.0f,   scalar, 0.0f,
+                                       0.0f,   0.0f,   0.0f,   1.0f};
+
+    return Matrix(result, TransformClass::UniformScale);
+}
+
+// Scale Matrix of 2, 4 and 5
+//| 2 0 0 0 |
+//| 0 4 0 0 |
+//| 0 0 5 0 |
+//| 0 0 0 1 |
+constexpr Matrix Matrix::scale(float x, float y, float z)
+{
+    const float result[MATRIX_SIZE] = {x,    0.0f, 0.0f, 0.0f,
+                                       0.0f, y,    0.0f, 0.0f,
+                                       0.0f, 0.0f, z,    0.0f,
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    bool uniform = (x == y) && (y == z);
+    return Matrix(result, uniform ? TransformClass::UniformScale : TransformClass::Affine);
+}
+
+constexpr Matrix Matrix::projection(float angleOfView, float imageAspectRatio, float n, float f)
+{
+    float scale = static_cast<float>(_tan(angleOfView * 0.5 * PI_OVER_180)) * n;
+    float r     = imageAspectRatio * scale;
+    float l     = -r;
+    float t     = scale;
+    float b     = -t;
+
+    // Perspective Matrix
+    const float result[MATRIX_SIZE] = {2 * n / (r - l), 0, -(r + l) / (r - l), 0,
+                                       0, 2 * n / (t - b), -(t + b) / (t - b), 0,
+                                       0, 0, (f) / (f - n), -f * n / (f - n),
+                                       0, 0, 1, 0};
+
+    ProjectionInfo info;
+    info.nearPlane = n, info.farPlane = f, info.left = l, info.right = r;
+    info.top = t, info.bottom = b, info.angleOfView = angleOfView;
+    info.aspectRatio = imageAspectRatio;
+
+    return Matrix(result, info);
+}
+
+constexpr Matrix Matrix::ortho(float orthoWidth, float orthoHeight, float n, float f)
+{
+    // Setup components of projection
+    float r = orthoWidth / 2.0f;  // Right
+    float l = -r;                 // Left
+    float t = orthoHeight / 2.0f; // Top
+    float b = -t;                 // Bottom
+
+    // Clip space in z is 0 to 1 in directx so invert near and far plane
+    // Ortho Matrix
+    const float result[MATRIX_SIZE] = {2.0f / (r - l), 0.0f, 0.0f, -((r + l) / (r - l)),
+                                       0.0f, 2.0f / (t - b), 0.0f, -((t + b) / (t - b)),
+                                       0.0f, 0.0f, 1.0f / (f - n), -((n) / (f - n)),
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    ProjectionInfo info;
+    info.nearPlane = n, info.farPlane = f, info.left = l, info.right = r;
+    info.top = t, info.bottom = b;
+    return Matrix(result, info);
+}
+
+constexpr Matrix Matrix::ortho(float l, float r, float t, float b, float n, float f)
+{
+    // Ortho Matrix
+    const float result[MATRIX_SIZE] = {2.0f / (r - l), 0.0f, 0.0f, -((r + l) / (r - l)),
+                                       0.0f, 2.0f / (t - b), 0.0f, -((t + b) / (t - b)),
+                                       0.0f, 0.0f, -2.0f / (f - n), -((f + n) / (f - n)),
+                                       0.0f, 0.0f, 0.0f, 1.0f};
+
+    ProjectionInfo info;
+    info.nearPlane = n, info.farPlane = f, info.left = l, info.right = r;
+    info.top = t, info.bottom = b;
+    return Matrix(result, info);
+}
@@ -0,0 +1,43 @@
+/**
+ *  Vertex attribute packing.  Correctly rounded float to half conversion (F16C when the
+ *  target has it), snorm16/unorm16 quantization and octahedral normal encoding, plus batch
+ *  versions that convert a whole attribute stream straight into an interleaved vertex layout.
+ *  The HLSL decoders live in shading/shaders/hlsl/include/math.hlsl.
+ */
+
+#pragma once
+#include "Vector4.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Packing
+{
+
+// Round to nearest even, overflow goes to infinity, subnormals are kept and NaN stays NaN
+uint16_t floatToHalf(float value);
+float    halfToFloat(uint16_t half);
+
+// Clamped to [-1, 1] and [0, 1] then rounded to the nearest step
+uint16_t floatToSnorm16(float value);
+float    snorm16ToFloat(uint16_t value);
+uint16_t floatToUnorm16(float value);
+float    unorm16ToFloat(uint16_t value);
+
+// Two values in one 32 bit word, x in the low 16 bits
+uint32_t packHalf2(float x, float y);
+uint32_t packSnorm16x2(float x, float y);
+uint32_t packUnorm16x2(float x, float y);
+
+// Unit vector folded onto the octahedron and stored as snorm16 x and y, a zero vector
+// decodes to +z.  Worst case angular error is about 0.005 degrees.
+uint32_t encodeOctahedral(const Vector4& normal);
+Vector4  decodeOctahedral(uint32_t packed);
+
+// Batch converters.  The strided versions write one 32 bit word every strideBytes so they can
+// fill a field of an interleaved vertex struct in place.
+void floatToHalf(const float* input, uint16_t* output, size_t count);
+void halfToFloat(const uint16_t* input, float* output, size_t count);
+void packHalf2(const float* pairs, size_t count, void* output, size_t strideBytes);
+void encodeOctahedral(const Vector4* normals, size_t count, void* output, size_t strideBytes);
+
+} // namespace Packing
@@ -0,0 +1,46 @@
+/**
+ *  Quaternion class.  Unit quaternions for rotations stored as x, y, z, w.
+ *  Matches the glTF layout and the right handed rotation matrices the
+ *  engine's negated Euler angles produce.
+ */
+
+#pragma once
+#include "Matrix.h"
+#include "Vector4.h"
+
+class Quaternion
+{
+    // Unaligned so it packs tightly inside TRS, SIMD paths use unaligned loads
+    float _q[4];
+
+  public:
+    Quaternion();
+    Quaternion(float x, float y, float z, float w);
+    explicit Quaternion(const Vector4& xyzw);
+
+    static Quaternion fromAxisAngle(const Vector4& axis, float degrees);
+    // Same convention as Matrix::rotationAroundY(y) * rotationAroundZ(z) * rotationAroundX(x)
+    static Quaternion fromEulerDegrees(const Vector4& rotation);
+    // Rotation part of a matrix whose upper 3x3 is orthonormal, inverse of toMatrix
+    static Quaternion fromMatrix(const Matrix& rotation);
+
+    // Hamilton product, rotating by other first and then by this
+    Quaternion operator*(const Quaternion& other) const;
+    Quaternion conjugate() const;
+    Quaternion normalized() const;
+    float      dotProduct(const Quaternion& other) const;
+    Vector4    rotate(const Vector4& vec) const;
+
+    // Roll, pitch and yaw in degrees, inverse of fromEulerDegrees with every angle negated
+    Vector4 toEulerDegrees() const;
+    Matrix  toMatrix() const;
+
+    static Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t);
+    static Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+
+    const float* getFlatBuffer() const;
+    float        getx() const;
+    float        gety() const;
+    float        getz() const;
+    float        getw() const;
+};
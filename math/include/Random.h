@@ -0,0 +1,208 @@
+/**
+ *  Deterministic random numbers.  PCG32 for sequential streams that can be split per thread or
+ *  per entity, Philox4x32-10 for counter based draws that need no state at all, and Sobol, R2
+ *  and blue noise point sets for low discrepancy sampling.  Every generator starts from one
+ *  global seed that stays at DefaultSeed unless seedFromTime is called, fixed seed mode pins
+ *  it so benchmarks and captured frames replay exactly.
+ */
+
+#pragma once
+#include "Vector4.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Command line switch that sets the seed and turns on fixed seed mode, -s <seed>
+#define RANDOMSEEDCLI "-s"
+
+namespace Random
+{
+
+constexpr uint64_t DefaultSeed = 0x853C49E6748FEA9Bull;
+
+void     setSeed(uint64_t seed);
+uint64_t getSeed();
+// Time based seed for runs that should differ, does nothing in fixed seed mode
+void seedFromTime();
+void setFixedSeed(bool fixedSeed);
+bool isFixedSeed();
+
+// SplitMix64 finalizer, turns sequential ids into well spread seeds
+constexpr uint64_t mix64(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Stateless integer hash (PCG output permutation)
+constexpr uint32_t hash(uint32_t value)
+{
+    uint32_t state = value * 747796405u + 2891336453u;
+    uint32_t word  = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Top 24 bits to [0, 1), every value is exactly representable
+constexpr float toUnitFloat(uint32_t bits)
+{
+    return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f);
+}
+
+constexpr float hashToUnitFloat(uint32_t value) { return toUnitFloat(hash(value)); }
+
+// PCG XSH RR 64/32.  Satisfies UniformRandomBitGenerator so it also drops into <random>.
+class PCG32
+{
+  public:
+    using result_type = uint32_t;
+    static constexpr uint32_t min() { return 0; }
+    static constexpr uint32_t max() { return 0xFFFFFFFFu; }
+
+    constexpr PCG32(uint64_t seed = DefaultSeed, uint64_t stream = 0);
+
+    constexpr uint32_t operator()() { return nextUInt(); }
+    constexpr uint32_t nextUInt();
+    // [0, bound) without modulo bias
+    constexpr uint32_t nextUInt(uint32_t bound);
+    // [0, 1) and [low, high)
+    constexpr float nextFloat();
+    constexpr float nextFloat(float low, float high);
+
+    // Independent generator on its own stream, the parent is left untouched
+    constexpr PCG32 split(uint64_t stream) const;
+    // Skips delta outputs in O(log delta) steps
+    constexpr void advance(uint64_t delta);
+
+  private:
+    static constexpr uint64_t Multiplier = 6364136223846793005ull;
+
+    uint64_t _state;
+    uint64_t _increment;
+};
+
+// Generator on the given stream of the current global seed
+PCG32 generator(uint64_t stream);
+// Per thread generator, split from the global seed the first time a thread asks for it
+PCG32& threadGenerator();
+
+// Uniform point inside the unit sphere, w is 0
+Vector4 pointInSphere(PCG32& generator);
+
+// Philox4x32-10 (Salmon et al. 2011).  The same key and counter always produce the same four
+// words, so any thread can draw sample n of stream s directly without sharing state.
+struct Philox4
+{
+    uint32_t value[4];
+};
+
+constexpr Philox4 philox(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint64_t key)
+{
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+    for (int round = 0; round < 10; round++)
+    {
+        uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+        uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+
+        uint32_t n0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+        c1          = static_cast<uint32_t>(product1);
+        c3          = static_cast<uint32_t>(product0);
+        c0          = n0;
+        c2          = n2;
+
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return Philox4{{c0, c1, c2, c3}};
+}
+
+// Sample index of a stream keyed by the global seed, as raw words or four [0, 1) floats
+Philox4 philox(uint64_t index, uint64_t stream);
+void    philoxUnitFloats(uint64_t index, uint64_t stream, float output[4]);
+
+struct Sample2D
+{
+    float x;
+    float y;
+};
+
+// Sobol points with Joe and Kuo direction numbers.  scramble is xor'ed in as a random digit
+// shift which keeps the stratification, dimensions past SobolDimensions wrap around.
+constexpr int SobolDimensions = 8;
+float         sobol(uint32_t index, uint32_t dimension, uint32_t scramble = 0);
+Sample2D      sobol2D(uint32_t index, uint32_t scramble = 0);
+
+// Roberts' R2 sequence, the 2D golden ratio generalization, evaluated in 32 bit fixed point
+Sample2D r2(uint32_t index);
+
+// Mitchell's best candidate on the unit torus, tileable blue noise points.  Quadratic in count,
+// meant for sample tables built once at startup.
+std::vector<Sample2D> blueNoise(size_t count, uint64_t seed = DefaultSeed, int candidates = 8);
+
+constexpr PCG32::PCG32(uint64_t seed, uint64_t stream)
+    : _state(0), _increment((stream << 1u) | 1u)
+{
+    nextUInt();
+    _state += seed;
+    nextUInt();
+}
+
+constexpr uint32_t PCG32::nextUInt()
+{
+    uint64_t oldState   = _state;
+    _state              = oldState * Multiplier + _increment;
+    uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+    uint32_t rotation   = static_cast<uint32_t>(oldState >> 59u);
+    return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31u));
+}
+
+// Lemire's multiply and reject
+constexpr uint32_t PCG32::nextUInt(uint32_t bound)
+{
+    uint64_t product = static_cast<uint64_t>(nextUInt()) * bound;
+    uint32_t low     = static_cast<uint32_t>(product);
+    if (low < bound)
+    {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold)
+        {
+            product = static_cast<uint64_t>(nextUInt()) * bound;
+            low     = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+constexpr float PCG32::nextFloat() { return toUnitFloat(nextUInt()); }
+
+constexpr float PCG32::nextFloat(float low, float high) { return low + (high - low) * nextFloat(); }
+
+constexpr PCG32 PCG32::split(uint64_t stream) const
+{
+    return PCG32(mix64(_state ^ mix64(stream)), mix64(_increment + stream));
+}
+
+// Brown's jump ahead, composes the LCG step with itself for each bit of delta
+constexpr void PCG32::advance(uint64_t delta)
+{
+    uint64_t multiplier    = Multiplier;
+    uint64_t increment     = _increment;
+    uint64_t accMultiplier = 1;
+    uint64_t accIncrement  = 0;
+    while (delta > 0)
+    {
+        if (delta & 1)
+        {
+            accMultiplier *= multiplier;
+            accIncrement = accIncrement * multiplier + increment;
+        }
+        increment  = (multiplier + 1) * increment;
+        multiplier = multiplier * multiplier;
+        delta >>= 1;
+    }
+    _state = accMultiplier * _state + accIncrement;
+}
+
+} // namespace Random
@@ -1,8 +0,0 @@
-#pragma once
-#include <Vector4.h>
-
-namespace Randomization
-{
-void    seed(); // Call once
-Vector4 pointInSphere();
-} // namespace Randomization
@@ -0,0 +1,335 @@
+/**
+ *  Thin 4-wide float abstraction used by the math classes.
+ *  Picks SSE (optionally AVX) on x86/x64, NEON on arm and a plain scalar
+ *  struct everywhere else.  Define MATH_SIMD_SCALAR to force the scalar path.
+ *  Only mul and add are used (no fused multiply add) so results match the
+ *  original scalar code bit for bit when the operation order is the same.
+ *  None of these are constexpr, callers that also run at compile time branch on
+ *  isConstantEvaluated first.
+ */
+
+#pragma once
+#include <type_traits>
+
+#if !defined(MATH_SIMD_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SIMD_SSE 1
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define MATH_SIMD_AVX 1
+#include <immintrin.h>
+#endif
+// MSVC has no F16C define but every AVX2 part supports it
+#if defined(__F16C__) || defined(__AVX2__)
+#define MATH_SIMD_F16C 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MATH_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define SIMD_INLINE __forceinline
+#else
+#define SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace SIMD
+{
+
+// True while the compiler folds a constant expression, constexpr math uses it to take a scalar
+// path there since intrinsics cannot be evaluated at compile time
+constexpr bool isConstantEvaluated()
+{
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+    return __builtin_is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+#if defined(MATH_SIMD_SSE)
+using Float4 = __m128;
+#elif defined(MATH_SIMD_NEON)
+using Float4 = float32x4_t;
+#else
+struct Float4
+{
+    float v[4];
+};
+#endif
+
+// Loads expect 16 byte aligned memory, the u variants do not
+SIMD_INLINE Float4 load(const float* p)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_load_ps(p);
+#elif defined(MATH_SIMD_NEON)
+    return vld1q_f32(p);
+#else
+    return Float4{{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 loadu(const float* p)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_loadu_ps(p);
+#else
+    return load(p);
+#endif
+}
+
+SIMD_INLINE void store(float* p, Float4 a)
+{
+#if defined(MATH_SIMD_SSE)
+    _mm_store_ps(p, a);
+#elif defined(MATH_SIMD_NEON)
+    vst1q_f32(p, a);
+#else
+    p[0] = a.v[0], p[1] = a.v[1], p[2] = a.v[2], p[3] = a.v[3];
+#endif
+}
+
+SIMD_INLINE void storeu(float* p, Float4 a)
+{
+#if defined(MATH_SIMD_SSE)
+    _mm_storeu_ps(p, a);
+#else
+    store(p, a);
+#endif
+}
+
+SIMD_INLINE Float4 set(float x, float y, float z, float w)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_setr_ps(x, y, z, w);
+#elif defined(MATH_SIMD_NEON)
+    alignas(16) const float p[4] = {x, y, z, w};
+    return vld1q_f32(p);
+#else
+    return Float4{{x, y, z, w}};
+#endif
+}
+
+SIMD_INLINE Float4 splat(float s)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_set1_ps(s);
+#elif defined(MATH_SIMD_NEON)
+    return vdupq_n_f32(s);
+#else
+    return Float4{{s, s, s, s}};
+#endif
+}
+
+SIMD_INLINE Float4 add(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_add_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vaddq_f32(a, b);
+#else
+    return Float4{{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 sub(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_sub_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vsubq_f32(a, b);
+#else
+    return Float4{{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 mul(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_mul_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vmulq_f32(a, b);
+#else
+    return Float4{{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 div(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_div_ps(a, b);
+#elif defined(MATH_SIMD_NEON) && defined(__aarch64__)
+    return vdivq_f32(a, b);
+#elif defined(MATH_SIMD_NEON)
+    alignas(16) float pa[4], pb[4];
+    vst1q_f32(pa, a);
+    vst1q_f32(pb, b);
+    return set(pa[0] / pb[0], pa[1] / pb[1], pa[2] / pb[2], pa[3] / pb[3]);
+#else
+    return Float4{{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+#endif
+}
+
+// Named minimum/maximum so the windows.h min and max macros cannot collide with them
+SIMD_INLINE Float4 minimum(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_min_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vminq_f32(a, b);
+#else
+    return Float4{{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 maximum(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_max_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vmaxq_f32(a, b);
+#else
+    return Float4{{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]}};
+#endif
+}
+
+SIMD_INLINE Float4 absolute(Float4 a)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+#elif defined(MATH_SIMD_NEON)
+    return vabsq_f32(a);
+#else
+    return Float4{{a.v[0] < 0.0f ? -a.v[0] : a.v[0], a.v[1] < 0.0f ? -a.v[1] : a.v[1],
+                   a.v[2] < 0.0f ? -a.v[2] : a.v[2], a.v[3] < 0.0f ? -a.v[3] : a.v[3]}};
+#endif
+}
+
+// Bit i is set when a[i] < b[i], lane 0 in the lowest bit like _mm_movemask_ps
+SIMD_INLINE int lessThanMask(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_movemask_ps(_mm_cmplt_ps(a, b));
+#elif defined(MATH_SIMD_NEON)
+    uint32x4_t less = vcltq_f32(a, b);
+    return static_cast<int>((vgetq_lane_u32(less, 0) & 1) | (vgetq_lane_u32(less, 1) & 2) |
+                            (vgetq_lane_u32(less, 2) & 4) | (vgetq_lane_u32(less, 3) & 8));
+#else
+    return (a.v[0] < b.v[0] ? 1 : 0) | (a.v[1] < b.v[1] ? 2 : 0) | (a.v[2] < b.v[2] ? 4 : 0) |
+           (a.v[3] < b.v[3] ? 8 : 0);
+#endif
+}
+
+// Multiply then add as two separate roundings, a * b + c
+SIMD_INLINE Float4 madd(Float4 a, Float4 b, Float4 c) { return add(mul(a, b), c); }
+
+SIMD_INLINE Float4 negate(Float4 a) { return sub(splat(0.0f), a); }
+
+SIMD_INLINE float getLane(Float4 a, int lane)
+{
+#if defined(MATH_SIMD_SSE) || defined(MATH_SIMD_NEON)
+    alignas(16) float p[4];
+    store(p, a);
+    return p[lane];
+#else
+    return a.v[lane];
+#endif
+}
+
+SIMD_INLINE float getX(Float4 a)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_cvtss_f32(a);
+#elif defined(MATH_SIMD_NEON)
+    return vgetq_lane_f32(a, 0);
+#else
+    return a.v[0];
+#endif
+}
+
+// Result is (a[x], a[y], b[z], b[w]), same contract as _mm_shuffle_ps
+template <int x, int y, int z, int w>
+SIMD_INLINE Float4 shuffle(Float4 a, Float4 b)
+{
+#if defined(MATH_SIMD_SSE)
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+#elif defined(MATH_SIMD_NEON)
+    return set(vgetq_lane_f32(a, x), vgetq_lane_f32(a, y), vgetq_lane_f32(b, z),
+               vgetq_lane_f32(b, w));
+#else
+    return Float4{{a.v[x], a.v[y], b.v[z], b.v[w]}};
+#endif
+}
+
+template <int x, int y, int z, int w>
+SIMD_INLINE Float4 swizzle(Float4 a)
+{
+    return shuffle<x, y, z, w>(a, a);
+}
+
+template <int lane>
+SIMD_INLINE Float4 splatLane(Float4 a)
+{
+#if defined(MATH_SIMD_NEON) && defined(__aarch64__)
+    return vdupq_laneq_f32(a, lane);
+#else
+    return shuffle<lane, lane, lane, lane>(a, a);
+#endif
+}
+
+// In place 4x4 transpose of four rows
+SIMD_INLINE void transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3)
+{
+#if defined(MATH_SIMD_SSE)
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+#elif defined(MATH_SIMD_NEON)
+    float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+    Float4 t0 = r0, t1 = r1, t2 = r2, t3 = r3;
+    r0        = Float4{{t0.v[0], t1.v[0], t2.v[0], t3.v[0]}};
+    r1        = Float4{{t0.v[1], t1.v[1], t2.v[1], t3.v[1]}};
+    r2        = Float4{{t0.v[2], t1.v[2], t2.v[2], t3.v[2]}};
+    r3        = Float4{{t0.v[3], t1.v[3], t2.v[3], t3.v[3]}};
+#endif
+}
+
+// Row vector times a row major 4x4 given as four rows, ((v.x*r0 + v.y*r1) + v.z*r2) + v.w*r3
+SIMD_INLINE Float4 linearCombine(Float4 v, Float4 r0, Float4 r1, Float4 r2, Float4 r3)
+{
+    Float4 result = mul(splatLane<0>(v), r0);
+    result        = madd(splatLane<1>(v), r1, result);
+    result        = madd(splatLane<2>(v), r2, result);
+    result        = madd(splatLane<3>(v), r3, result);
+    return result;
+}
+
+// Sum of all four lanes splatted across the register
+SIMD_INLINE Float4 horizontalSum(Float4 a)
+{
+    a = add(a, swizzle<2, 3, 0, 1>(a));
+    return add(a, swizzle<1, 0, 3, 2>(a));
+}
+
+// xyz cross product, (a.yzx * b.zxy) - (a.zxy * b.yzx).  w of the result is a.w * b.w minus
+// itself, exactly 0 only if the compiler keeps the multiply and subtract apart or a w is 0
+SIMD_INLINE Float4 cross3(Float4 a, Float4 b)
+{
+    return sub(mul(swizzle<1, 2, 0, 3>(a), swizzle<2, 0, 1, 3>(b)),
+               mul(swizzle<2, 0, 1, 3>(a), swizzle<1, 2, 0, 3>(b)));
+}
+
+} // namespace SIMD
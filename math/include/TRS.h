@@ -0,0 +1,35 @@
+/**
+ *  Compact translation, rotation and scale.  40 bytes instead of a 128 byte
+ *  Matrix so entities, waypoints and animation keys can be stored and
+ *  interpolated directly and only turned into a matrix once per frame.
+ */
+
+#pragma once
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "Vector4.h"
+
+struct TRS
+{
+    float      translation[3] = {0.0f, 0.0f, 0.0f};
+    Quaternion rotation;
+    float      scale[3]       = {1.0f, 1.0f, 1.0f};
+
+    TRS() {}
+    TRS(const Vector4& t, const Quaternion& r, const Vector4& s);
+    // Splits an affine matrix back into its parts, shear is dropped
+    static TRS fromMatrix(const Matrix& transform);
+
+    Vector4 getTranslation() const;
+    Vector4 getScale() const;
+
+    // T * R * S, tagged rigid, uniform scale or affine depending on the scale
+    Matrix toMatrix() const;
+
+    // Parent then child, exact as long as the parent scale is uniform
+    static TRS compose(const TRS& parent, const TRS& child);
+    // Linear translation and scale with a slerp or nlerp between rotations
+    static TRS interpolate(const TRS& a, const TRS& b, float t, bool useSlerp = true);
+};
+
+static_assert(sizeof(TRS) == 40, "TRS is expected to pack into 40 bytes");
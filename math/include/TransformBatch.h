@@ -0,0 +1,35 @@
+/**
+ *  Batched instance transform streams.  Takes a contiguous array of affine
+ *  object to world matrices and writes every per instance stream the ray tracing
+ *  passes consume in a single pass, straight into caller owned (possibly upload
+ *  mapped) memory.
+ */
+
+#pragma once
+#include "Matrix.h"
+#include <cstddef>
+
+namespace TransformBatch
+{
+
+// Floats written per instance for each stream
+constexpr size_t ObjectToWorldFloats = 12; // 3x4 row major, matches D3D12_RAYTRACING_INSTANCE_DESC
+constexpr size_t WorldToObjectFloats = 12; // 3x4 row major inverse
+constexpr size_t NormalFloats        = 9;  // 3x3 row major inverse transpose
+constexpr size_t ModelFloats         = 16; // 4x4 row major
+
+// Destination streams, any of them can be null to skip it.
+// Instance i is written at stream + i * <Stream>Floats.
+struct Streams
+{
+    float* objectToWorld = nullptr;
+    float* worldToObject = nullptr;
+    float* normal        = nullptr;
+    float* model         = nullptr;
+};
+
+// Transforms are expected to be affine, the bottom row is ignored and treated as 0 0 0 1.
+// Singular transforms write themselves as their own inverse, same as Matrix::inverse.
+void write(const Matrix* transforms, size_t count, const Streams& streams);
+
+} // namespace TransformBatch
@@ -20,39 +20,180 @@
  */
 
 #pragma once
+#include "ConstexprMath.h"
+#include "SIMD.h"
 #include <iostream>
+#include <math.h>
 
 class Vector4
 {
-    float _vec[4];
+    // 16 byte aligned so the four components load as one SIMD register
+    alignas(16) float _vec[4];
+
+    // Runtime bodies of the arithmetic operators, the constexpr versions below only do the
+    // scalar math themselves while the compiler is folding a constant
+    Vector4 _simdMultiply(const Vector4& other) const;
+    Vector4 _simdAdd(const Vector4& other) const;
+    Vector4 _simdSubtract(const Vector4& other) const;
+    Vector4 _simdScale(float scale) const;
+    Vector4 _simdDivide(float scale) const;
+    Vector4 _simdNegate() const;
+    void    _simdDivideAll(float scale);
 
   public:
-    Vector4();
-    Vector4(float x, float y, float z, float w = 1.0f);
-    Vector4(const Vector4& other);
-
-    bool     operator==(Vector4 other);
-    bool     operator!=(Vector4 other);
-    Vector4  operator*(Vector4 other);
-    Vector4  operator+(Vector4 other);
-    Vector4& operator+=(Vector4 other);
-    Vector4  operator-(Vector4 other);
-    Vector4  crossProduct(Vector4 other);
-    float    dotProduct(Vector4 other);
-    Vector4  operator/(float scale);
-    Vector4  operator*(float scale);
-    Vector4  operator-();
+    constexpr Vector4();
+    constexpr Vector4(float x, float y, float z, float w = 1.0f);
+    constexpr Vector4(const Vector4& other)            = default;
+    constexpr Vector4& operator=(const Vector4& other) = default;
+
+    constexpr bool     operator==(const Vector4& other) const;
+    constexpr bool     operator!=(const Vector4& other) const;
+    constexpr Vector4  operator*(const Vector4& other) const;
+    constexpr Vector4  operator+(const Vector4& other) const;
+    constexpr Vector4& operator+=(const Vector4& other);
+    constexpr Vector4  operator-(const Vector4& other) const;
+    constexpr Vector4  crossProduct(const Vector4& other) const;
+    constexpr float    dotProduct(const Vector4& other) const;
+    constexpr Vector4  operator/(float scale) const;
+    constexpr Vector4  operator*(float scale) const;
+    constexpr Vector4  operator-() const;
 
     friend std::ostream& operator<<(std::ostream& output, Vector4& other);
-    float*               getFlatBuffer();
-    float                getMagnitude();
-    void                 normalize();
-    void                 display();
-    float                getx() const;
-    float                gety() const;
-    float                getz() const;
-    float                getw() const;
+    constexpr float*       getFlatBuffer();
+    constexpr const float* getFlatBuffer() const;
+    constexpr float        getMagnitude() const;
+    constexpr void         normalize();
+    void                   display() const;
+    constexpr float        getx() const;
+    constexpr float        gety() const;
+    constexpr float        getz() const;
+    constexpr float        getw() const;
 };
 
 using Vector4x3 = Vector4 (&)[3];
 using Vector4x4 = Vector4 (&)[4];
+
+constexpr Vector4::Vector4() : _vec{0.0f, 0.0f, 0.0f, 1.0f} {}
+
+constexpr Vector4::Vector4(float x, float y, float z, float w) : _vec{x, y, z, w} {}
+
+constexpr float* Vector4::getFlatBuffer() { return _vec; }
+
+constexpr const float* Vector4::getFlatBuffer() const { return _vec; }
+
+constexpr float Vector4::getx() const { return _vec[0]; }
+
+constexpr float Vector4::gety() const { return _vec[1]; }
+
+constexpr float Vector4::getz() const { return _vec[2]; }
+
+constexpr float Vector4::getw() const { return _vec[3]; }
+
+constexpr float Vector4::getMagnitude() const
+{
+    float squared = (_vec[0] * _vec[0]) + (_vec[1] * _vec[1]) + (_vec[2] * _vec[2]);
+    if (SIMD::isConstantEvaluated())
+    {
+        return static_cast<float>(ConstexprMath::sqrt(squared));
+    }
+    return sqrtf(squared);
+}
+
+// Arithmetic only applies to x, y and z, w of the result stays at the default of 1
+constexpr Vector4 Vector4::operator/(float scale) const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(_vec[0] / scale, _vec[1] / scale, _vec[2] / scale);
+    }
+    return _simdDivide(scale);
+}
+
+constexpr Vector4 Vector4::operator*(float scale) const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(_vec[0] * scale, _vec[1] * scale, _vec[2] * scale);
+    }
+    return _simdScale(scale);
+}
+
+constexpr Vector4 Vector4::operator*(const Vector4& other) const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(_vec[0] * other._vec[0], _vec[1] * other._vec[1], _vec[2] * other._vec[2]);
+    }
+    return _simdMultiply(other);
+}
+
+constexpr Vector4 Vector4::operator+(const Vector4& other) const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(_vec[0] + other._vec[0], _vec[1] + other._vec[1], _vec[2] + other._vec[2]);
+    }
+    return _simdAdd(other);
+}
+
+constexpr Vector4& Vector4::operator+=(const Vector4& other)
+{
+    float w = _vec[3];
+    *this   = *this + other;
+    _vec[3] = w;
+    return *this;
+}
+
+constexpr Vector4 Vector4::operator-(const Vector4& other) const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(_vec[0] - other._vec[0], _vec[1] - other._vec[1], _vec[2] - other._vec[2]);
+    }
+    return _simdSubtract(other);
+}
+
+constexpr Vector4 Vector4::operator-() const
+{
+    if (SIMD::isConstantEvaluated())
+    {
+        return Vector4(-_vec[0], -_vec[1], -_vec[2]);
+    }
+    return _simdNegate();
+}
+
+constexpr Vector4 Vector4::crossProduct(const Vector4& other) const
+{
+    return Vector4((_vec[1] * other._vec[2]) - (_vec[2] * other._vec[1]),
+                   -(_vec[0] * other._vec[2]) + (_vec[2] * other._vec[0]),
+                   (_vec[0] * other._vec[1]) - (_vec[1] * other._vec[0]), 0.0f);
+}
+
+constexpr float Vector4::dotProduct(const Vector4& other) const
+{
+    return (_vec[0] * other._vec[0]) + (_vec[1] * other._vec[1]) + (_vec[2] * other._vec[2]);
+}
+
+// Divides all four components, w included
+constexpr void Vector4::normalize()
+{
+    float mag = getMagnitude();
+    if (SIMD::isConstantEvaluated())
+    {
+        _vec[0] /= mag, _vec[1] /= mag, _vec[2] /= mag, _vec[3] /= mag;
+        return;
+    }
+    _simdDivideAll(mag);
+}
+
+constexpr bool Vector4::operator==(const Vector4& other) const
+{
+    return _vec[0] == other._vec[0] && _vec[1] == other._vec[1] && _vec[2] == other._vec[2] &&
+           _vec[3] == other._vec[3];
+}
+
+constexpr bool Vector4::operator!=(const Vector4& other) const
+{
+    return _vec[0] != other._vec[0] || _vec[1] != other._vec[1] || _vec[2] != other._vec[2] ||
+           _vec[3] != other._vec[3];
+}
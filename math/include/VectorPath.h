@@ -1,4 +1,5 @@
 #pragma once
+#include "Curve.h"
 #include "Matrix.h"
 #include "StateVector.h"
 #include <string>
@@ -29,8 +30,13 @@ class VectorPath
 
   private:
     void                    _loadVectorsFromFile(const std::string& file);
+    void                    _buildCurves();
     int                     _elapsedTime;
     int                     _currentVector;
     Matrix                  _inversion;
     std::vector<PathVector> _vectors;
+    Curve                   _forceCurve; // Step curves keyed where each vector starts
+    Curve                   _torqueCurve;
+    Curve::Cursor           _forceCursor;
+    Curve::Cursor           _torqueCursor;
 };
\ No newline at end of file
@@ -1,13 +1,15 @@
 #pragma once
+#include "Curve.h"
 #include "MVP.h"
 #include "Matrix.h"
 #include "StateVector.h"
+#include "TRS.h"
 #include <string>
 #include <vector>
 
 struct PathWaypoint
 {
-    Matrix  transform;
+    Matrix  transform; // Parent transform times local, built once at load
     Vector4 position;
     Vector4 rotation;
     Vector4 scale;
@@ -16,6 +18,7 @@ struct PathWaypoint
 
     PathWaypoint() {}
     PathWaypoint(const Vector4& p, const Vector4& r, const Vector4& s, float t, Matrix trans) : position(p), rotation(r), scale(s), time(t), transform(trans) {}
+    PathWaypoint(const TRS& trs, const Vector4& r, float t, Matrix trans) : transform(trans), position(trs.getTranslation()), rotation(r), scale(trs.getScale()), time(t) {}
 };
 
 class WaypointPath
@@ -33,6 +36,8 @@ class WaypointPath
     void resetWaypointsFromFile(const std::string& pathFile);
     void resetWaypoints(const std::vector<PathWaypoint>& vectors);
     void updateState(int milliseconds, StateVector* state);
+    // Transform at a waypoint time in milliseconds, interpolated between the surrounding keys
+    Matrix evaluate(float milliseconds) const;
     void setInversion(const Matrix& inversion) { _inversion = inversion; }
 
     void resetState(StateVector* state);
@@ -44,11 +49,8 @@ class WaypointPath
     void        _loadWaypointsFromFile(const std::string& file);
     void        _drawPath();
     void        _calculateVelocities(StateVector* state);
-    float       ConvertToDegrees(float radian);
-    float       GetRoll(Vector4 q);
-    float       GetPitch(Vector4 q);
-    float       GetYaw(Vector4 q);
-
+    void        _buildCurves();
+    Matrix      _evaluate(const Curve::Segment& segment) const;
 
     std::string _name;
 
@@ -63,6 +65,10 @@ class WaypointPath
     Vector4                   _currentRotation;
     Vector4                   _initialPosition;
     std::vector<PathWaypoint> _waypoints;
+    Curve                     _translationCurve;
+    Curve                     _scaleCurve;
+    std::vector<Quaternion>   _rotationKeys; // Slerped over the translation curve's segments
+    Curve::Cursor             _cursor;
     Matrix                    _view;
     Matrix                    _projection;
 };
\ No newline at end of file
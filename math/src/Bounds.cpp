@@ -0,0 +1,472 @@
+#include "Bounds.h"
+#include "SIMD.h"
+#include <float.h>
+#include <math.h>
+
+namespace
+{
+// xyz of a row major matrix column
+Vector4 column(const float* m, int index) { return Vector4(m[index], m[4 + index], m[8 + index], 0.0f); }
+
+float length3(const Vector4& v) { return sqrtf(v.getx() * v.getx() + v.gety() * v.gety() + v.getz() * v.getz()); }
+
+// Four volumes in structure of arrays form, one lane per volume
+struct Lanes4
+{
+    SIMD::Float4 x, y, z;
+    SIMD::Float4 radius; // Unused for boxes
+    SIMD::Float4 ex, ey, ez;
+};
+
+SIMD_INLINE void loadBoxes(const AABB* boxes, Lanes4& lanes)
+{
+    SIMD::Float4 half = SIMD::splat(0.5f);
+
+    SIMD::Float4 min0 = SIMD::load(boxes[0].minPoint.getFlatBuffer());
+    SIMD::Float4 min1 = SIMD::load(boxes[1].minPoint.getFlatBuffer());
+    SIMD::Float4 min2 = SIMD::load(boxes[2].minPoint.getFlatBuffer());
+    SIMD::Float4 min3 = SIMD::load(boxes[3].minPoint.getFlatBuffer());
+    SIMD::Float4 max0 = SIMD::load(boxes[0].maxPoint.getFlatBuffer());
+    SIMD::Float4 max1 = SIMD::load(boxes[1].maxPoint.getFlatBuffer());
+    SIMD::Float4 max2 = SIMD::load(boxes[2].maxPoint.getFlatBuffer());
+    SIMD::Float4 max3 = SIMD::load(boxes[3].maxPoint.getFlatBuffer());
+
+    SIMD::Float4 c0 = SIMD::mul(SIMD::add(min0, max0), half);
+    SIMD::Float4 c1 = SIMD::mul(SIMD::add(min1, max1), half);
+    SIMD::Float4 c2 = SIMD::mul(SIMD::add(min2, max2), half);
+    SIMD::Float4 c3 = SIMD::mul(SIMD::add(min3, max3), half);
+    SIMD::transpose(c0, c1, c2, c3);
+    lanes.x = c0, lanes.y = c1, lanes.z = c2;
+
+    SIMD::Float4 e0 = SIMD::mul(SIMD::sub(max0, min0), half);
+    SIMD::Float4 e1 = SIMD::mul(SIMD::sub(max1, min1), half);
+    SIMD::Float4 e2 = SIMD::mul(SIMD::sub(max2, min2), half);
+    SIMD::Float4 e3 = SIMD::mul(SIMD::sub(max3, min3), half);
+    SIMD::transpose(e0, e1, e2, e3);
+    lanes.ex = e0, lanes.ey = e1, lanes.ez = e2;
+}
+
+SIMD_INLINE void loadSpheres(const BoundingSphere* spheres, Lanes4& lanes)
+{
+    SIMD::Float4 c0 = SIMD::load(spheres[0].center.getFlatBuffer());
+    SIMD::Float4 c1 = SIMD::load(spheres[1].center.getFlatBuffer());
+    SIMD::Float4 c2 = SIMD::load(spheres[2].center.getFlatBuffer());
+    SIMD::Float4 c3 = SIMD::load(spheres[3].center.getFlatBuffer());
+    SIMD::transpose(c0, c1, c2, c3);
+    lanes.x      = c0, lanes.y = c1, lanes.z = c2;
+    lanes.radius = SIMD::set(spheres[0].radius, spheres[1].radius, spheres[2].radius,
+                             spheres[3].radius);
+}
+
+// Signed distance of each lane's center to the plane
+SIMD_INLINE SIMD::Float4 planeDistance(const float* plane, const Lanes4& lanes)
+{
+    SIMD::Float4 distance = SIMD::mul(SIMD::splat(plane[0]), lanes.x);
+    distance              = SIMD::madd(SIMD::splat(plane[1]), lanes.y, distance);
+    distance              = SIMD::madd(SIMD::splat(plane[2]), lanes.z, distance);
+    return SIMD::add(distance, SIMD::splat(plane[3]));
+}
+
+// Box extents projected onto the plane normal
+SIMD_INLINE SIMD::Float4 projectedRadius(const float* plane, const Lanes4& lanes)
+{
+    SIMD::Float4 radius = SIMD::mul(SIMD::splat(fabsf(plane[0])), lanes.ex);
+    radius              = SIMD::madd(SIMD::splat(fabsf(plane[1])), lanes.ey, radius);
+    return SIMD::madd(SIMD::splat(fabsf(plane[2])), lanes.ez, radius);
+}
+
+float planeDistance(const float* plane, const Vector4& point)
+{
+    return plane[0] * point.getx() + plane[1] * point.gety() + plane[2] * point.getz() + plane[3];
+}
+
+size_t storeVisible(int outsideMask, int lanes, uint8_t* visible)
+{
+    size_t visibleCount = 0;
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        visible[lane] = ((outsideMask >> lane) & 1) ? 0 : 1;
+        visibleCount += visible[lane];
+    }
+    return visibleCount;
+}
+
+#if defined(MATH_SIMD_AVX)
+SIMD_INLINE __m256 combine(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+SIMD_INLINE __m256 madd8(__m256 a, __m256 b, __m256 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+
+// Eight volumes at once from two four lane loads, returns the lanes outside any plane
+int outsideMask8(const float (*planes)[4], const Lanes4& low, const Lanes4& high, bool isBox)
+{
+    __m256 x    = combine(low.x, high.x);
+    __m256 y    = combine(low.y, high.y);
+    __m256 z    = combine(low.z, high.z);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 ex, ey, ez, radius;
+    if (isBox)
+    {
+        ex = combine(low.ex, high.ex);
+        ey = combine(low.ey, high.ey);
+        ez = combine(low.ez, high.ez);
+    }
+    else
+    {
+        radius = combine(low.radius, high.radius);
+    }
+
+    int outside = 0;
+    for (int i = 0; i < Frustum::PlaneCount; i++)
+    {
+        const float* plane    = planes[i];
+        __m256       distance = _mm256_mul_ps(_mm256_set1_ps(plane[0]), x);
+        distance              = madd8(_mm256_set1_ps(plane[1]), y, distance);
+        distance              = madd8(_mm256_set1_ps(plane[2]), z, distance);
+        distance              = _mm256_add_ps(distance, _mm256_set1_ps(plane[3]));
+        if (isBox)
+        {
+            __m256 extent = _mm256_mul_ps(_mm256_set1_ps(fabsf(plane[0])), ex);
+            extent        = madd8(_mm256_set1_ps(fabsf(plane[1])), ey, extent);
+            extent        = madd8(_mm256_set1_ps(fabsf(plane[2])), ez, extent);
+            distance      = _mm256_add_ps(distance, extent);
+        }
+        else
+        {
+            distance = _mm256_add_ps(distance, radius);
+        }
+        outside |= _mm256_movemask_ps(_mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+    }
+    return outside;
+}
+#endif
+
+int outsideMask4(const float (*planes)[4], const Lanes4& lanes, bool isBox)
+{
+    SIMD::Float4 zero    = SIMD::splat(0.0f);
+    int          outside = 0;
+    for (int i = 0; i < Frustum::PlaneCount; i++)
+    {
+        SIMD::Float4 distance = planeDistance(planes[i], lanes);
+        distance = SIMD::add(distance, isBox ? projectedRadius(planes[i], lanes) : lanes.radius);
+        outside |= SIMD::lessThanMask(distance, zero);
+    }
+    return outside;
+}
+} // namespace
+
+AABB::AABB()
+    : minPoint(FLT_MAX, FLT_MAX, FLT_MAX), maxPoint(-FLT_MAX, -FLT_MAX, -FLT_MAX)
+{
+}
+
+AABB::AABB(const Vector4& minPoint, const Vector4& maxPoint)
+    : minPoint(minPoint), maxPoint(maxPoint)
+{
+}
+
+AABB AABB::fromPoints(const Vector4* points, size_t count)
+{
+    AABB box;
+    if (count == 0)
+    {
+        return box;
+    }
+
+    SIMD::Float4 minimum = SIMD::load(points[0].getFlatBuffer());
+    SIMD::Float4 maximum = minimum;
+    for (size_t i = 1; i < count; i++)
+    {
+        SIMD::Float4 point = SIMD::load(points[i].getFlatBuffer());
+        minimum            = SIMD::minimum(minimum, point);
+        maximum            = SIMD::maximum(maximum, point);
+    }
+    SIMD::store(box.minPoint.getFlatBuffer(), minimum);
+    SIMD::store(box.maxPoint.getFlatBuffer(), maximum);
+    box.minPoint.getFlatBuffer()[3] = 1.0f;
+    box.maxPoint.getFlatBuffer()[3] = 1.0f;
+    return box;
+}
+
+bool AABB::isEmpty() const
+{
+    return minPoint.getx() > maxPoint.getx() || minPoint.gety() > maxPoint.gety() ||
+           minPoint.getz() > maxPoint.getz();
+}
+
+Vector4 AABB::getCenter() const { return (minPoint + maxPoint) * 0.5f; }
+
+Vector4 AABB::getExtents() const { return (maxPoint - minPoint) * 0.5f; }
+
+void AABB::expand(const Vector4& point)
+{
+    SIMD::Float4 p = SIMD::load(point.getFlatBuffer());
+    SIMD::store(minPoint.getFlatBuffer(), SIMD::minimum(SIMD::load(minPoint.getFlatBuffer()), p));
+    SIMD::store(maxPoint.getFlatBuffer(), SIMD::maximum(SIMD::load(maxPoint.getFlatBuffer()), p));
+    minPoint.getFlatBuffer()[3] = 1.0f;
+    maxPoint.getFlatBuffer()[3] = 1.0f;
+}
+
+void AABB::merge(const AABB& other)
+{
+    if (other.isEmpty())
+    {
+        return;
+    }
+    expand(other.minPoint);
+    expand(other.maxPoint);
+}
+
+// Arvo's method, the new extents are the old extents through the absolute 3x3
+AABB AABB::transform(const Matrix& transform) const
+{
+    if (isEmpty())
+    {
+        return *this;
+    }
+
+    const float* m  = transform.getFlatBuffer();
+    SIMD::Float4 c0 = SIMD::load(&m[0]);
+    SIMD::Float4 c1 = SIMD::load(&m[4]);
+    SIMD::Float4 c2 = SIMD::load(&m[8]);
+    SIMD::Float4 c3 = SIMD::load(&m[12]);
+    SIMD::transpose(c0, c1, c2, c3);
+
+    Vector4      localCenter  = getCenter();
+    Vector4      localExtents = getExtents();
+    SIMD::Float4 center       = SIMD::madd(c0, SIMD::splat(localCenter.getx()), c3);
+    center                    = SIMD::madd(c1, SIMD::splat(localCenter.gety()), center);
+    center                    = SIMD::madd(c2, SIMD::splat(localCenter.getz()), center);
+
+    SIMD::Float4 extents = SIMD::mul(SIMD::absolute(c0), SIMD::splat(localExtents.getx()));
+    extents = SIMD::madd(SIMD::absolute(c1), SIMD::splat(localExtents.gety()), extents);
+    extents = SIMD::madd(SIMD::absolute(c2), SIMD::splat(localExtents.getz()), extents);
+
+    AABB box;
+    SIMD::store(box.minPoint.getFlatBuffer(), SIMD::sub(center, extents));
+    SIMD::store(box.maxPoint.getFlatBuffer(), SIMD::add(center, extents));
+    box.minPoint.getFlatBuffer()[3] = 1.0f;
+    box.maxPoint.getFlatBuffer()[3] = 1.0f;
+    return box;
+}
+
+BoundingSphere::BoundingSphere(const Vector4& center, float radius) : center(center), radius(radius)
+{
+}
+
+BoundingSphere::BoundingSphere(const AABB& box)
+    : center(box.getCenter()), radius(length3(box.getExtents()))
+{
+}
+
+BoundingSphere BoundingSphere::fromPoints(const Vector4* points, size_t count)
+{
+    if (count == 0)
+    {
+        return BoundingSphere();
+    }
+
+    Vector4      center = AABB::fromPoints(points, count).getCenter();
+    SIMD::Float4 c      = SIMD::load(center.getFlatBuffer());
+    SIMD::Float4 xyz    = SIMD::set(1.0f, 1.0f, 1.0f, 0.0f);
+
+    SIMD::Float4 maxDistance = SIMD::splat(0.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        SIMD::Float4 offset = SIMD::mul(SIMD::sub(SIMD::load(points[i].getFlatBuffer()), c), xyz);
+        maxDistance = SIMD::maximum(maxDistance, SIMD::horizontalSum(SIMD::mul(offset, offset)));
+    }
+    return BoundingSphere(center, sqrtf(SIMD::getX(maxDistance)));
+}
+
+BoundingSphere BoundingSphere::transform(const Matrix& transform) const
+{
+    const float* m     = transform.getFlatBuffer();
+    float        scale = fmaxf(fmaxf(length3(column(m, 0)), length3(column(m, 1))),
+                               length3(column(m, 2)));
+
+    Vector4 worldCenter = transform * Vector4(center.getx(), center.gety(), center.getz(), 1.0f);
+    return BoundingSphere(worldCenter, radius * scale);
+}
+
+OBB::OBB(const AABB& box, const Matrix& transform)
+{
+    const float* m = transform.getFlatBuffer();
+    Vector4      e = box.getExtents();
+    Vector4      c = box.getCenter();
+    center         = transform * Vector4(c.getx(), c.gety(), c.getz(), 1.0f);
+
+    float scaledExtents[3];
+    for (int i = 0; i < 3; i++)
+    {
+        Vector4 axis   = column(m, i);
+        float   length = length3(axis);
+        axes[i]        = length > 0.0f ? axis / length : Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+        axes[i].getFlatBuffer()[3] = 0.0f;
+        scaledExtents[i]           = e.getFlatBuffer()[i] * length;
+    }
+    extents = Vector4(scaledExtents[0], scaledExtents[1], scaledExtents[2], 0.0f);
+}
+
+AABB OBB::getAABB() const
+{
+    float half[3];
+    for (int i = 0; i < 3; i++)
+    {
+        half[i] = fabsf(axes[0].getFlatBuffer()[i]) * extents.getx() +
+                  fabsf(axes[1].getFlatBuffer()[i]) * extents.gety() +
+                  fabsf(axes[2].getFlatBuffer()[i]) * extents.getz();
+    }
+    Vector4 halfSize(half[0], half[1], half[2]);
+    return AABB(center - halfSize, center + halfSize);
+}
+
+Frustum::Frustum()
+{
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        planes[i][0] = planes[i][1] = planes[i][2] = planes[i][3] = 0.0f;
+    }
+}
+
+Frustum::Frustum(const Matrix& view, const Matrix& projection) : Frustum(projection * view) {}
+
+// Gribb and Hartmann, each clip space inequality -w <= x <= w, -w <= y <= w and 0 <= z <= w
+// is a sum or difference of matrix rows
+Frustum::Frustum(const Matrix& viewProjection)
+{
+    const float* m = viewProjection.getFlatBuffer();
+    for (int i = 0; i < 4; i++)
+    {
+        float x = m[i];
+        float y = m[4 + i];
+        float z = m[8 + i];
+        float w = m[12 + i];
+
+        planes[Left][i]   = w + x;
+        planes[Right][i]  = w - x;
+        planes[Bottom][i] = w + y;
+        planes[Top][i]    = w - y;
+        planes[Near][i]   = z;
+        planes[Far][i]    = w - z;
+    }
+
+    // Unit normals so the sphere test can compare distances against the radius
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        float length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] +
+                             planes[i][2] * planes[i][2]);
+        if (length > 0.0f)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                planes[i][j] /= length;
+            }
+        }
+    }
+}
+
+bool Frustum::isVisible(const AABB& box) const
+{
+    Vector4 center  = box.getCenter();
+    Vector4 extents = box.getExtents();
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        const float* plane  = planes[i];
+        float        radius = fabsf(plane[0]) * extents.getx() + fabsf(plane[1]) * extents.gety() +
+                       fabsf(plane[2]) * extents.getz();
+        if (planeDistance(plane, center) + radius < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::isVisible(const BoundingSphere& sphere) const
+{
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        if (planeDistance(planes[i], sphere.center) + sphere.radius < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::isVisible(const OBB& box) const
+{
+    for (int i = 0; i < PlaneCount; i++)
+    {
+        const float* plane  = planes[i];
+        float        radius = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const Vector4& a = box.axes[axis];
+            radius += fabsf(plane[0] * a.getx() + plane[1] * a.gety() + plane[2] * a.getz()) *
+                      box.extents.getFlatBuffer()[axis];
+        }
+        if (planeDistance(plane, box.center) + radius < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t Frustum::cullAABBs(const AABB* boxes, size_t count, uint8_t* visible) const
+{
+    size_t visibleCount = 0;
+    size_t i            = 0;
+#if defined(MATH_SIMD_AVX)
+    for (; i + 8 <= count; i += 8)
+    {
+        Lanes4 low, high;
+        loadBoxes(&boxes[i], low);
+        loadBoxes(&boxes[i + 4], high);
+        visibleCount += storeVisible(outsideMask8(planes, low, high, true), 8, &visible[i]);
+    }
+#endif
+    for (; i + 4 <= count; i += 4)
+    {
+        Lanes4 lanes;
+        loadBoxes(&boxes[i], lanes);
+        visibleCount += storeVisible(outsideMask4(planes, lanes, true), 4, &visible[i]);
+    }
+    for (; i < count; i++)
+    {
+        visible[i] = isVisible(boxes[i]) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+size_t Frustum::cullSpheres(const BoundingSphere* spheres, size_t count, uint8_t* visible) const
+{
+    size_t visibleCount = 0;
+    size_t i            = 0;
+#if defined(MATH_SIMD_AVX)
+    for (; i + 8 <= count; i += 8)
+    {
+        Lanes4 low, high;
+        loadSpheres(&spheres[i], low);
+        loadSpheres(&spheres[i + 4], high);
+        visibleCount += storeVisible(outsideMask8(planes, low, high, false), 8, &visible[i]);
+    }
+#endif
+    for (; i + 4 <= count; i += 4)
+    {
+        Lanes4 lanes;
+        loadSpheres(&spheres[i], lanes);
+        visibleCount += storeVisible(outsideMask4(planes, lanes, false), 4, &visible[i]);
+    }
+    for (; i < count; i++)
+    {
+        visible[i] = isVisible(spheres[i]) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
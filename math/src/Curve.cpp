@@ -0,0 +1,245 @@
+#include "Curve.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <math.h>
+
+Curve::Curve(CurveInterpolation interpolation, CurveWrap wrap)
+    : _interpolation(interpolation), _wrap(wrap)
+{
+}
+
+void Curve::addKey(float time, const Vector4& value)
+{
+    _times.push_back(time);
+    _keys.push_back(Key{value, Vector4(0.0f, 0.0f, 0.0f, 0.0f)});
+    _autoTangent.push_back(true);
+
+    // The new key changes the finite difference of its neighbour as well as its own
+    size_t last = _keys.size() - 1;
+    if (last > 0)
+    {
+        _updateTangent(last - 1);
+    }
+    _updateTangent(last);
+}
+
+void Curve::addKey(float time, const Vector4& value, const Vector4& tangent)
+{
+    _times.push_back(time);
+    _keys.push_back(Key{value, tangent});
+    _autoTangent.push_back(false);
+
+    size_t last = _keys.size() - 1;
+    if (last > 0)
+    {
+        _updateTangent(last - 1);
+    }
+}
+
+void Curve::reserve(size_t keyCount)
+{
+    _times.reserve(keyCount);
+    _keys.reserve(keyCount);
+    _autoTangent.reserve(keyCount);
+}
+
+void Curve::clear()
+{
+    _times.clear();
+    _keys.clear();
+    _autoTangent.clear();
+}
+
+size_t Curve::getKeyCount() const { return _keys.size(); }
+
+float Curve::getKeyTime(size_t index) const { return _times[index]; }
+
+const Vector4& Curve::getKeyValue(size_t index) const { return _keys[index].value; }
+
+float Curve::getStartTime() const { return _times.empty() ? 0.0f : _times.front(); }
+
+float Curve::getEndTime() const { return _times.empty() ? 0.0f : _times.back(); }
+
+CurveInterpolation Curve::getInterpolation() const { return _interpolation; }
+
+CurveWrap Curve::getWrap() const { return _wrap; }
+
+float Curve::wrapTime(float time) const
+{
+    if (_times.empty())
+    {
+        return time;
+    }
+
+    float start = _times.front();
+    float end   = _times.back();
+    if (_wrap == CurveWrap::Loop)
+    {
+        float duration = end - start;
+        if (duration <= 0.0f)
+        {
+            return start;
+        }
+        float offset = fmodf(time - start, duration);
+        if (offset < 0.0f)
+        {
+            offset += duration;
+        }
+        return start + offset;
+    }
+    return std::min(std::max(time, start), end);
+}
+
+Curve::Segment Curve::locate(float time) const
+{
+    if (_keys.size() < 2)
+    {
+        return Segment{0, 0.0f};
+    }
+    return _search(wrapTime(time));
+}
+
+Curve::Segment Curve::locate(float time, Cursor& cursor) const
+{
+    if (_keys.size() < 2)
+    {
+        return Segment{0, 0.0f};
+    }
+
+    float  wrapped     = wrapTime(time);
+    size_t lastSegment = _keys.size() - 2;
+
+    // Playback mostly stays in the same segment or moves to the next one, try both before
+    // falling back to the binary search
+    for (size_t segment = cursor.segment; segment <= std::min(cursor.segment + 1, lastSegment);
+         segment++)
+    {
+        float start = _times[segment];
+        float end   = _times[segment + 1];
+        if (wrapped >= start && (wrapped < end || (segment == lastSegment && wrapped <= end)))
+        {
+            float duration = end - start;
+            float u        = duration > 0.0f ? (wrapped - start) / duration : 0.0f;
+            cursor.segment = segment;
+            return Segment{segment, u};
+        }
+    }
+
+    Segment result = _search(wrapped);
+    cursor.segment = result.index;
+    return result;
+}
+
+Vector4 Curve::evaluate(float time) const
+{
+    if (_keys.size() < 2)
+    {
+        return _keys.empty() ? Vector4(0.0f, 0.0f, 0.0f, 0.0f) : _keys[0].value;
+    }
+    return evaluate(locate(time));
+}
+
+Vector4 Curve::evaluate(float time, Cursor& cursor) const
+{
+    if (_keys.size() < 2)
+    {
+        return _keys.empty() ? Vector4(0.0f, 0.0f, 0.0f, 0.0f) : _keys[0].value;
+    }
+    return evaluate(locate(time, cursor));
+}
+
+void Curve::evaluate(const Curve* curves, size_t count, float time, Vector4* output,
+                     Cursor* cursors)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = cursors != nullptr ? curves[i].evaluate(time, cursors[i])
+                                       : curves[i].evaluate(time);
+    }
+}
+
+void Curve::evaluate(const Curve* const* curves, size_t count, float time, Vector4* output,
+                     Cursor* cursors)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        output[i] = cursors != nullptr ? curves[i]->evaluate(time, cursors[i])
+                                       : curves[i]->evaluate(time);
+    }
+}
+
+Curve::Segment Curve::_search(float wrappedTime) const
+{
+    // First key strictly after the time, the segment starts one before it
+    auto   upper = std::upper_bound(_times.begin(), _times.end(), wrappedTime);
+    size_t index = static_cast<size_t>(upper - _times.begin());
+    index        = std::min(index > 0 ? index - 1 : 0, _keys.size() - 2);
+
+    float start    = _times[index];
+    float duration = _times[index + 1] - start;
+    float u        = duration > 0.0f ? (wrappedTime - start) / duration : 0.0f;
+    return Segment{index, std::min(std::max(u, 0.0f), 1.0f)};
+}
+
+Vector4 Curve::evaluate(const Segment& segment) const
+{
+    const Key& from = _keys[segment.index];
+    const Key& to   = _keys[segment.index + 1];
+    float      u    = segment.u;
+
+    if (_interpolation == CurveInterpolation::Step)
+    {
+        return u >= 1.0f ? to.value : from.value;
+    }
+
+    Vector4      result;
+    SIMD::Float4 p0 = SIMD::load(from.value.getFlatBuffer());
+    SIMD::Float4 p1 = SIMD::load(to.value.getFlatBuffer());
+    if (_interpolation == CurveInterpolation::Linear)
+    {
+        SIMD::store(result.getFlatBuffer(), SIMD::madd(SIMD::sub(p1, p0), SIMD::splat(u), p0));
+        return result;
+    }
+
+    // Cubic Hermite basis, tangents are per unit time so they scale by the segment length
+    float u2       = u * u;
+    float u3       = u2 * u;
+    float duration = _times[segment.index + 1] - _times[segment.index];
+    float h00      = 2.0f * u3 - 3.0f * u2 + 1.0f;
+    float h10      = (u3 - 2.0f * u2 + u) * duration;
+    float h01      = -2.0f * u3 + 3.0f * u2;
+    float h11      = (u3 - u2) * duration;
+
+    SIMD::Float4 m0  = SIMD::load(from.tangent.getFlatBuffer());
+    SIMD::Float4 m1  = SIMD::load(to.tangent.getFlatBuffer());
+    SIMD::Float4 sum = SIMD::mul(p0, SIMD::splat(h00));
+    sum              = SIMD::madd(m0, SIMD::splat(h10), sum);
+    sum              = SIMD::madd(p1, SIMD::splat(h01), sum);
+    sum              = SIMD::madd(m1, SIMD::splat(h11), sum);
+    SIMD::store(result.getFlatBuffer(), sum);
+    return result;
+}
+
+void Curve::_updateTangent(size_t index)
+{
+    if (_autoTangent[index] == false)
+    {
+        return;
+    }
+
+    // Catmull-Rom on non uniform keys, central difference inside and one sided at the ends
+    size_t last     = _keys.size() - 1;
+    size_t previous = index > 0 ? index - 1 : index;
+    size_t next     = index < last ? index + 1 : index;
+    float  duration = _times[next] - _times[previous];
+    if (next == previous || duration <= 0.0f)
+    {
+        _keys[index].tangent = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    SIMD::Float4 difference = SIMD::sub(SIMD::load(_keys[next].value.getFlatBuffer()),
+                                        SIMD::load(_keys[previous].value.getFlatBuffer()));
+    SIMD::store(_keys[index].tangent.getFlatBuffer(),
+                SIMD::mul(difference, SIMD::splat(1.0f / duration)));
+}
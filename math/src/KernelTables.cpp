@@ -0,0 +1,52 @@
+#include "KernelTables.h"
+#include <iomanip>
+
+namespace
+{
+template <int Radius>
+void emitKernel(std::ostream& output, const char* define, const KernelTables::FilterKernel<Radius>& filter)
+{
+    constexpr int Width = KernelTables::FilterKernel<Radius>::Width;
+
+    output << "#if defined(" << define << ")\n";
+    output << "static const unsigned int Radius          = " << Radius << ";\n";
+    output << "static const unsigned int Width           = 1 + 2 * Radius;\n";
+    output << "static const float        Kernel1D[Width] = {";
+    for (int i = 0; i < Width; i++)
+    {
+        output << (i == 0 ? "" : ", ") << filter.kernel1D[i];
+    }
+    output << "};\n";
+    output << "static const float        Kernel[Width][Width] = {\n";
+    for (int row = 0; row < Width; row++)
+    {
+        output << "    {";
+        for (int col = 0; col < Width; col++)
+        {
+            output << (col == 0 ? "" : ", ") << filter.kernel[row][col];
+        }
+        output << "},\n";
+    }
+    output << "};\n";
+    output << "#endif\n\n";
+}
+} // namespace
+
+void KernelTables::emitHLSL(std::ostream& output)
+{
+    // 9 significant digits round trips every float
+    output << std::setprecision(9);
+    output << "// Generated by KernelTables::emitHLSL from math/include/KernelTables.h, do not edit.\n"
+           << "// Define one of the kernel names before including this file.\n\n"
+           << "namespace FilterKernel\n{\n";
+
+    emitKernel(output, "BOX_KERNEL_3X3", Box3x3);
+    emitKernel(output, "BOX_KERNEL_5X5", Box5x5);
+    emitKernel(output, "BOX_KERNEL_7X7", Box7x7);
+    emitKernel(output, "GAUSSIAN_KERNEL_3X3", Gaussian3x3);
+    emitKernel(output, "GAUSSIAN_KERNEL_5X5", Gaussian5x5);
+    emitKernel(output, "GAUSSIAN_KERNEL_7X7", Gaussian7x7);
+    emitKernel(output, "GAUSSIAN_KERNEL_9X9", Gaussian9x9);
+
+    output << "} // namespace FilterKernel\n";
+}
@@ -0,0 +1,276 @@
+#include "Packing.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void storeStrided(void* output, size_t index, size_t strideBytes, uint32_t value)
+{
+    memcpy(static_cast<uint8_t*>(output) + index * strideBytes, &value, sizeof(value));
+}
+
+// Sign of value that treats zero as positive
+float signNotZero(float value) { return value < 0.0f ? -1.0f : 1.0f; }
+} // namespace
+
+// Rounding works by letting the float adder do it: the mantissa bits below the half
+// precision are either added into a magic denormal or rounded with a half ulp bias
+uint16_t Packing::floatToHalf(float value)
+{
+    uint32_t bits = floatBits(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half;
+    if (bits >= 0x47800000u)
+    {
+        // Too big for half, infinity stays infinity and NaN gets a quiet NaN
+        half = bits > 0x7F800000u ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < 0x38800000u)
+    {
+        // Subnormal half or zero, adding 0.5 shifts the mantissa into place with correct rounding
+        const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+        half = static_cast<uint16_t>(floatBits(bitsToFloat(bits) + bitsToFloat(denormMagic)) -
+                                     denormMagic);
+    }
+    else
+    {
+        // Rebias the exponent and round to nearest even on the 13 dropped mantissa bits
+        uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits -= (127u - 15u) << 23;
+        bits += 0xFFFu;
+        bits += mantissaOdd;
+        half = static_cast<uint16_t>(bits >> 13);
+    }
+    return half | static_cast<uint16_t>(sign >> 16);
+}
+
+float Packing::halfToFloat(uint16_t half)
+{
+    const uint32_t shiftedExponent = 0x7C00u << 13;
+
+    uint32_t bits     = (half & 0x7FFFu) << 13;
+    uint32_t exponent = bits & shiftedExponent;
+    bits += (127 - 15) << 23;
+
+    if (exponent == shiftedExponent)
+    {
+        // Infinity or NaN
+        bits += (128 - 16) << 23;
+    }
+    else if (exponent == 0)
+    {
+        // Zero or subnormal, renormalize through the float unit
+        bits += 1 << 23;
+        bits = floatBits(bitsToFloat(bits) - bitsToFloat(113 << 23));
+    }
+
+    bits |= (half & 0x8000u) << 16;
+    return bitsToFloat(bits);
+}
+
+uint16_t Packing::floatToSnorm16(float value)
+{
+    value = std::min(std::max(value, -1.0f), 1.0f);
+    return static_cast<uint16_t>(static_cast<int16_t>(lrintf(value * 32767.0f)));
+}
+
+float Packing::snorm16ToFloat(uint16_t value)
+{
+    return std::max(static_cast<float>(static_cast<int16_t>(value)) / 32767.0f, -1.0f);
+}
+
+uint16_t Packing::floatToUnorm16(float value)
+{
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    return static_cast<uint16_t>(lrintf(value * 65535.0f));
+}
+
+float Packing::unorm16ToFloat(uint16_t value) { return static_cast<float>(value) / 65535.0f; }
+
+uint32_t Packing::packHalf2(float x, float y)
+{
+    return static_cast<uint32_t>(floatToHalf(x)) | (static_cast<uint32_t>(floatToHalf(y)) << 16);
+}
+
+uint32_t Packing::packSnorm16x2(float x, float y)
+{
+    return static_cast<uint32_t>(floatToSnorm16(x)) |
+           (static_cast<uint32_t>(floatToSnorm16(y)) << 16);
+}
+
+uint32_t Packing::packUnorm16x2(float x, float y)
+{
+    return static_cast<uint32_t>(floatToUnorm16(x)) |
+           (static_cast<uint32_t>(floatToUnorm16(y)) << 16);
+}
+
+// Project onto the |x| + |y| + |z| = 1 octahedron and fold the lower half over the diagonals
+uint32_t Packing::encodeOctahedral(const Vector4& normal)
+{
+    float x  = normal.getx();
+    float y  = normal.gety();
+    float z  = normal.getz();
+    float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+    if (l1 == 0.0f)
+    {
+        return packSnorm16x2(0.0f, 0.0f);
+    }
+
+    float rl1 = 1.0f / l1;
+    float u   = x * rl1;
+    float v   = y * rl1;
+    if (z < 0.0f)
+    {
+        float foldedU = (1.0f - fabsf(v)) * signNotZero(u);
+        float foldedV = (1.0f - fabsf(u)) * signNotZero(v);
+        u             = foldedU;
+        v             = foldedV;
+    }
+    return packSnorm16x2(u, v);
+}
+
+Vector4 Packing::decodeOctahedral(uint32_t packed)
+{
+    float x = snorm16ToFloat(static_cast<uint16_t>(packed & 0xFFFF));
+    float y = snorm16ToFloat(static_cast<uint16_t>(packed >> 16));
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    Vector4 normal(x, y, z, 0.0f);
+    float   length = normal.getMagnitude();
+    return Vector4(x / length, y / length, z / length, 0.0f);
+}
+
+void Packing::floatToHalf(const float* input, uint16_t* output, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i halves =
+            _mm256_cvtps_ph(_mm256_loadu_ps(&input[i]), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), halves);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        output[i] = floatToHalf(input[i]);
+    }
+}
+
+void Packing::halfToFloat(const uint16_t* input, float* output, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+        _mm256_storeu_ps(&output[i], _mm256_cvtph_ps(halves));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        output[i] = halfToFloat(input[i]);
+    }
+}
+
+void Packing::packHalf2(const float* pairs, size_t count, void* output, size_t strideBytes)
+{
+    size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+    // Four pairs per conversion, each 32 bit lane of the result is one packed pair
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i halves =
+            _mm256_cvtps_ph(_mm256_loadu_ps(&pairs[i * 2]), _MM_FROUND_TO_NEAREST_INT);
+        alignas(16) uint32_t packed[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(packed), halves);
+
+        storeStrided(output, i, strideBytes, packed[0]);
+        storeStrided(output, i + 1, strideBytes, packed[1]);
+        storeStrided(output, i + 2, strideBytes, packed[2]);
+        storeStrided(output, i + 3, strideBytes, packed[3]);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        storeStrided(output, i, strideBytes, packHalf2(pairs[i * 2], pairs[i * 2 + 1]));
+    }
+}
+
+void Packing::encodeOctahedral(const Vector4* normals, size_t count, void* output,
+                               size_t strideBytes)
+{
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    // Four normals per iteration transposed into x, y and z registers, same math as the scalar
+    // encoder including the round to nearest even quantization
+    const __m128 absMask  = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128 one      = _mm_set1_ps(1.0f);
+    const __m128 zero     = _mm_setzero_ps();
+    const __m128 scale    = _mm_set1_ps(32767.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_load_ps(normals[i].getFlatBuffer());
+        __m128 y = _mm_load_ps(normals[i + 1].getFlatBuffer());
+        __m128 z = _mm_load_ps(normals[i + 2].getFlatBuffer());
+        __m128 w = _mm_load_ps(normals[i + 3].getFlatBuffer());
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, absMask), _mm_and_ps(y, absMask)),
+                               _mm_and_ps(z, absMask));
+        // Zero length normals produce 0, 0 like the scalar path
+        __m128 valid = _mm_cmpneq_ps(l1, zero);
+        __m128 rl1   = _mm_div_ps(one, l1);
+        __m128 u     = _mm_and_ps(_mm_mul_ps(x, rl1), valid);
+        __m128 v     = _mm_and_ps(_mm_mul_ps(y, rl1), valid);
+
+        __m128 signU   = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(u, zero), signMask), one);
+        __m128 signV   = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(v, zero), signMask), one);
+        __m128 foldedU = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(v, absMask)), signU);
+        __m128 foldedV = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(u, absMask)), signV);
+        __m128 lower   = _mm_and_ps(_mm_cmplt_ps(z, zero), valid);
+        u              = _mm_or_ps(_mm_and_ps(lower, foldedU), _mm_andnot_ps(lower, u));
+        v              = _mm_or_ps(_mm_and_ps(lower, foldedV), _mm_andnot_ps(lower, v));
+
+        u = _mm_min_ps(_mm_max_ps(u, _mm_set1_ps(-1.0f)), one);
+        v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), one);
+        __m128i qu = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(u, scale)), _mm_set1_epi32(0xFFFF));
+        __m128i qv = _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(v, scale)), 16);
+
+        alignas(16) uint32_t packed[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(packed), _mm_or_si128(qu, qv));
+
+        storeStrided(output, i, strideBytes, packed[0]);
+        storeStrided(output, i + 1, strideBytes, packed[1]);
+        storeStrided(output, i + 2, strideBytes, packed[2]);
+        storeStrided(output, i + 3, strideBytes, packed[3]);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        storeStrided(output, i, strideBytes, encodeOctahedral(normals[i]));
+    }
+}
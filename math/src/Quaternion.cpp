@@ -0,0 +1,231 @@
+#include "Quaternion.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+SIMD_INLINE SIMD::Float4 load(const Quaternion& q) { return SIMD::loadu(q.getFlatBuffer()); }
+
+SIMD_INLINE Quaternion toQuaternion(SIMD::Float4 v)
+{
+    alignas(16) float q[4];
+    SIMD::store(q, v);
+    return Quaternion(q[0], q[1], q[2], q[3]);
+}
+
+SIMD_INLINE SIMD::Float4 normalize4(SIMD::Float4 v)
+{
+    SIMD::Float4 lengthSquared = SIMD::horizontalSum(SIMD::mul(v, v));
+    return SIMD::div(v, SIMD::splat(sqrtf(SIMD::getX(lengthSquared))));
+}
+
+float toDegrees(float radians) { return (180.0f / PI) * radians; }
+} // namespace
+
+Quaternion::Quaternion()
+{
+    _q[0] = 0.0f;
+    _q[1] = 0.0f;
+    _q[2] = 0.0f;
+    _q[3] = 1.0f;
+}
+
+Quaternion::Quaternion(float x, float y, float z, float w)
+{
+    _q[0] = x;
+    _q[1] = y;
+    _q[2] = z;
+    _q[3] = w;
+}
+
+Quaternion::Quaternion(const Vector4& xyzw)
+    : Quaternion(xyzw.getx(), xyzw.gety(), xyzw.getz(), xyzw.getw())
+{
+}
+
+Quaternion Quaternion::fromAxisAngle(const Vector4& axis, float degrees)
+{
+    Vector4 unitAxis = axis;
+    unitAxis.normalize();
+    float halfAngle = degrees * PI_OVER_180 * 0.5f;
+    float s         = sinf(halfAngle);
+    return Quaternion(unitAxis.getx() * s, unitAxis.gety() * s, unitAxis.getz() * s,
+                      cosf(halfAngle));
+}
+
+Quaternion Quaternion::fromEulerDegrees(const Vector4& rotation)
+{
+    // The engine's rotation matrices turn by the negative angle so flip the sign here
+    Quaternion x = fromAxisAngle(Vector4(1.0f, 0.0f, 0.0f), -rotation.getx());
+    Quaternion y = fromAxisAngle(Vector4(0.0f, 1.0f, 0.0f), -rotation.gety());
+    Quaternion z = fromAxisAngle(Vector4(0.0f, 0.0f, 1.0f), -rotation.getz());
+    return y * z * x;
+}
+
+Quaternion Quaternion::fromMatrix(const Matrix& rotation)
+{
+    const float* m     = rotation.getFlatBuffer();
+    float        trace = m[0] + m[5] + m[10];
+
+    // Shepperd's method, divide by the largest of w, x, y or z to stay well conditioned
+    if (trace > 0.0f)
+    {
+        float s = sqrtf(trace + 1.0f) * 2.0f;
+        return Quaternion((m[9] - m[6]) / s, (m[2] - m[8]) / s, (m[4] - m[1]) / s, 0.25f * s);
+    }
+    else if (m[0] > m[5] && m[0] > m[10])
+    {
+        float s = sqrtf(1.0f + m[0] - m[5] - m[10]) * 2.0f;
+        return Quaternion(0.25f * s, (m[1] + m[4]) / s, (m[2] + m[8]) / s, (m[9] - m[6]) / s);
+    }
+    else if (m[5] > m[10])
+    {
+        float s = sqrtf(1.0f + m[5] - m[0] - m[10]) * 2.0f;
+        return Quaternion((m[1] + m[4]) / s, 0.25f * s, (m[6] + m[9]) / s, (m[2] - m[8]) / s);
+    }
+    float s = sqrtf(1.0f + m[10] - m[0] - m[5]) * 2.0f;
+    return Quaternion((m[2] + m[8]) / s, (m[6] + m[9]) / s, 0.25f * s, (m[4] - m[1]) / s);
+}
+
+Quaternion Quaternion::operator*(const Quaternion& other) const
+{
+    SIMD::Float4 a = load(*this);
+    SIMD::Float4 b = load(other);
+
+    SIMD::Float4 t0 = SIMD::mul(SIMD::splatLane<3>(a), b);
+    SIMD::Float4 t1 = SIMD::mul(SIMD::swizzle<0, 1, 2, 0>(a), SIMD::swizzle<3, 3, 3, 0>(b));
+    SIMD::Float4 t2 = SIMD::mul(SIMD::swizzle<1, 2, 0, 1>(a), SIMD::swizzle<2, 0, 1, 1>(b));
+    SIMD::Float4 t3 = SIMD::mul(SIMD::swizzle<2, 0, 1, 2>(a), SIMD::swizzle<1, 2, 0, 2>(b));
+
+    // x, y and z add the middle terms while w subtracts them
+    SIMD::Float4 middle = SIMD::mul(SIMD::add(t1, t2), SIMD::set(1.0f, 1.0f, 1.0f, -1.0f));
+    return toQuaternion(SIMD::sub(SIMD::add(t0, middle), t3));
+}
+
+Quaternion Quaternion::conjugate() const { return Quaternion(-_q[0], -_q[1], -_q[2], _q[3]); }
+
+Quaternion Quaternion::normalized() const { return toQuaternion(normalize4(load(*this))); }
+
+float Quaternion::dotProduct(const Quaternion& other) const
+{
+    return SIMD::getX(SIMD::horizontalSum(SIMD::mul(load(*this), load(other))));
+}
+
+Vector4 Quaternion::rotate(const Vector4& vec) const
+{
+    // v + 2w(q x v) + 2(q x (q x v))
+    SIMD::Float4 q = SIMD::set(_q[0], _q[1], _q[2], 0.0f);
+    SIMD::Float4 v = SIMD::set(vec.getx(), vec.gety(), vec.getz(), 0.0f);
+    SIMD::Float4 t = SIMD::cross3(q, v);
+    t              = SIMD::add(t, t);
+
+    SIMD::Float4 result = SIMD::madd(SIMD::splat(_q[3]), t, v);
+    result              = SIMD::add(result, SIMD::cross3(q, t));
+
+    alignas(16) float out[4];
+    SIMD::store(out, result);
+    return Vector4(out[0], out[1], out[2], vec.getw());
+}
+
+Vector4 Quaternion::toEulerDegrees() const
+{
+    float x = _q[0], y = _q[1], z = _q[2], w = _q[3];
+
+    float roll  = toDegrees(atan2f(2 * x * w - 2 * y * z, 1 - 2 * x * x - 2 * z * z));
+    float pitch = toDegrees(atan2f(2 * y * w - 2 * x * z, 1 - 2 * y * y - 2 * z * z));
+    float yaw   = toDegrees(asinf(std::clamp(2 * x * y + 2 * z * w, -1.0f, 1.0f)));
+
+    // Gimbal lock at the poles, put all of the rotation into roll
+    float pole = x * y + z * w;
+    if (pole == 0.5f)
+    {
+        roll  = toDegrees(2 * atan2f(x, w));
+        pitch = 0.0f;
+    }
+    else if (pole == -0.5f)
+    {
+        roll  = toDegrees(-2 * atan2f(x, w));
+        pitch = 0.0f;
+    }
+    return Vector4(roll, pitch, yaw);
+}
+
+// Scaling by 2 / |q|^2 instead of 2 gives the rotation of the normalized quaternion, so the
+// result is orthonormal and the rigid tag holds even after quaternions drift off unit length
+Matrix Quaternion::toMatrix() const
+{
+    float x = _q[0], y = _q[1], z = _q[2], w = _q[3];
+
+    float lengthSquared = x * x + y * y + z * z + w * w;
+    if (lengthSquared == 0.0f)
+    {
+        return Matrix();
+    }
+    float s = 2.0f / lengthSquared;
+
+    float result[MATRIX_SIZE];
+    result[0] = 1 - s * (y * y + z * z), result[1] = s * (x * y - z * w),
+    result[2] = s * (x * z + y * w), result[3] = 0.0f;
+    result[4] = s * (x * y + z * w), result[5] = 1 - s * (x * x + z * z),
+    result[6] = s * (y * z - x * w), result[7] = 0.0f;
+    result[8] = s * (x * z - y * w), result[9] = s * (y * z + x * w),
+    result[10] = 1 - s * (x * x + y * y), result[11] = 0.0f;
+    result[12] = 0.0f, result[13] = 0.0f, result[14] = 0.0f, result[15] = 1.0f;
+
+    return Matrix(result, TransformClass::Rigid);
+}
+
+Quaternion Quaternion::nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    SIMD::Float4 qa = load(a);
+    SIMD::Float4 qb = load(b);
+
+    // Take the short way around
+    if (a.dotProduct(b) < 0.0f)
+    {
+        qb = SIMD::negate(qb);
+    }
+    SIMD::Float4 blended = SIMD::madd(SIMD::sub(qb, qa), SIMD::splat(t), qa);
+    return toQuaternion(normalize4(blended));
+}
+
+Quaternion Quaternion::slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    SIMD::Float4 qa     = load(a);
+    SIMD::Float4 qb     = load(b);
+    float        cosine = a.dotProduct(b);
+
+    // Take the short way around
+    if (cosine < 0.0f)
+    {
+        qb     = SIMD::negate(qb);
+        cosine = -cosine;
+    }
+
+    // Nearly parallel so sin(theta) is too small to divide by, nlerp is indistinguishable
+    if (cosine > 0.9995f)
+    {
+        SIMD::Float4 blended = SIMD::madd(SIMD::sub(qb, qa), SIMD::splat(t), qa);
+        return toQuaternion(normalize4(blended));
+    }
+
+    float theta     = acosf(cosine);
+    float rSinTheta = 1.0f / sinf(theta);
+    float weightA   = sinf((1.0f - t) * theta) * rSinTheta;
+    float weightB   = sinf(t * theta) * rSinTheta;
+
+    SIMD::Float4 result = SIMD::mul(qa, SIMD::splat(weightA));
+    result              = SIMD::madd(qb, SIMD::splat(weightB), result);
+    return toQuaternion(result);
+}
+
+const float* Quaternion::getFlatBuffer() const { return _q; }
+
+float Quaternion::getx() const { return _q[0]; }
+
+float Quaternion::gety() const { return _q[1]; }
+
+float Quaternion::getz() const { return _q[2]; }
+
+float Quaternion::getw() const { return _q[3]; }
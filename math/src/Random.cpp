@@ -0,0 +1,227 @@
+#include "Random.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+
+namespace
+{
+std::atomic<uint64_t> _seed(Random::DefaultSeed);
+std::atomic<bool>     _fixedSeed(false);
+std::atomic<uint64_t> _threadCount(0);
+
+struct SobolDirection
+{
+    uint32_t degree;
+    uint32_t coefficients;
+    uint32_t initial[5];
+};
+
+// First rows of new-joe-kuo-6.21201, dimension 0 is the van der Corput sequence
+constexpr SobolDirection SobolParameters[Random::SobolDimensions - 1] = {
+    {1, 0, {1}},          {2, 1, {1, 3}},       {3, 1, {1, 3, 1}},     {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}}, {4, 4, {1, 3, 5, 13}}, {5, 2, {1, 1, 5, 5, 17}},
+};
+
+struct SobolTable
+{
+    uint32_t direction[Random::SobolDimensions][32];
+};
+
+constexpr SobolTable buildSobolTable()
+{
+    SobolTable table = {};
+    for (int bit = 0; bit < 32; bit++)
+    {
+        table.direction[0][bit] = 1u << (31 - bit);
+    }
+
+    for (int dimension = 1; dimension < Random::SobolDimensions; dimension++)
+    {
+        const SobolDirection& parameters = SobolParameters[dimension - 1];
+        uint32_t*             v          = table.direction[dimension];
+        uint32_t              s          = parameters.degree;
+        for (uint32_t bit = 0; bit < 32; bit++)
+        {
+            if (bit < s)
+            {
+                v[bit] = parameters.initial[bit] << (31 - bit);
+                continue;
+            }
+            v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+            for (uint32_t k = 1; k < s; k++)
+            {
+                if ((parameters.coefficients >> (s - 1 - k)) & 1)
+                {
+                    v[bit] ^= v[bit - k];
+                }
+            }
+        }
+    }
+    return table;
+}
+
+constexpr SobolTable Sobol = buildSobolTable();
+
+// Distance on the unit torus so the blue noise tiles without seams
+float toroidalDistanceSquared(const Random::Sample2D& a, const Random::Sample2D& b)
+{
+    float dx = fabsf(a.x - b.x);
+    float dy = fabsf(a.y - b.y);
+    dx       = dx > 0.5f ? 1.0f - dx : dx;
+    dy       = dy > 0.5f ? 1.0f - dy : dy;
+    return dx * dx + dy * dy;
+}
+} // namespace
+
+namespace Random
+{
+
+void setSeed(uint64_t seed) { _seed = seed; }
+
+uint64_t getSeed() { return _seed; }
+
+void seedFromTime()
+{
+    if (_fixedSeed)
+    {
+        return;
+    }
+    _seed = mix64(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
+void setFixedSeed(bool fixedSeed) { _fixedSeed = fixedSeed; }
+
+bool isFixedSeed() { return _fixedSeed; }
+
+PCG32 generator(uint64_t stream) { return PCG32(_seed, stream); }
+
+// Streams are handed out in the order threads first ask, the main thread gets stream 0
+// as long as it draws before any worker does
+PCG32& threadGenerator()
+{
+    thread_local PCG32 threadLocal = PCG32(_seed).split(_threadCount++);
+    return threadLocal;
+}
+
+Vector4 pointInSphere(PCG32& generator)
+{
+    float x, y, z;
+    do
+    {
+        x = generator.nextFloat(-1.0f, 1.0f);
+        y = generator.nextFloat(-1.0f, 1.0f);
+        z = generator.nextFloat(-1.0f, 1.0f);
+    } while (x * x + y * y + z * z > 1.0f);
+
+    return Vector4(x, y, z, 0.0f);
+}
+
+Philox4 philox(uint64_t index, uint64_t stream)
+{
+    return philox(static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+                  static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), _seed);
+}
+
+void philoxUnitFloats(uint64_t index, uint64_t stream, float output[4])
+{
+    Philox4 words = philox(index, stream);
+    for (int i = 0; i < 4; i++)
+    {
+        output[i] = toUnitFloat(words.value[i]);
+    }
+}
+
+float sobol(uint32_t index, uint32_t dimension, uint32_t scramble)
+{
+    const uint32_t* v      = Sobol.direction[dimension % SobolDimensions];
+    uint32_t        result = scramble;
+    for (int bit = 0; index != 0; bit++, index >>= 1)
+    {
+        if (index & 1)
+        {
+            result ^= v[bit];
+        }
+    }
+    return toUnitFloat(result);
+}
+
+Sample2D sobol2D(uint32_t index, uint32_t scramble)
+{
+    return Sample2D{sobol(index, 0, scramble), sobol(index, 1, hash(scramble))};
+}
+
+// Offsets of 1/g and 1/g^2 with g the plastic number, as 0.32 fixed point so the sequence does
+// not drift for large indices the way float accumulation would
+Sample2D r2(uint32_t index)
+{
+    const uint32_t alphaX = 3242174889u; // 0.7548776662466927 * 2^32
+    const uint32_t alphaY = 2447445413u; // 0.5698402909980532 * 2^32
+    const uint32_t half   = 0x80000000u;
+    return Sample2D{toUnitFloat(half + index * alphaX), toUnitFloat(half + index * alphaY)};
+}
+
+std::vector<Sample2D> blueNoise(size_t count, uint64_t seed, int candidates)
+{
+    std::vector<Sample2D> points;
+    points.reserve(count);
+    PCG32 random(seed);
+
+    // Odd sized toroidal grid of about one point per cell, rings around the candidate's cell
+    // are searched outwards until no closer point can exist
+    int   gridSize = static_cast<int>(sqrtf(static_cast<float>(count))) | 1;
+    float cellSize = 1.0f / gridSize;
+    std::vector<std::vector<uint32_t>> grid(gridSize * gridSize);
+
+    auto cellOf = [gridSize](float value)
+    { return std::min(static_cast<int>(value * gridSize), gridSize - 1); };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // Candidates grow with the set so the spacing stays even, the first point is free
+        size_t   tries    = i == 0 ? 1 : static_cast<size_t>(candidates) * i;
+        Sample2D best     = {};
+        float    bestDist = -1.0f;
+        for (size_t t = 0; t < tries; t++)
+        {
+            Sample2D candidate = {random.nextFloat(), random.nextFloat()};
+            int      cellX     = cellOf(candidate.x);
+            int      cellY     = cellOf(candidate.y);
+            float    nearest   = 2.0f;
+            for (int ring = 0; ring <= gridSize / 2; ring++)
+            {
+                float reach = (ring - 1) * cellSize;
+                if (ring > 0 && reach * reach >= nearest)
+                {
+                    break;
+                }
+                for (int y = -ring; y <= ring; y++)
+                {
+                    // Only the border of the ring, the inside was searched already
+                    int step = (y == -ring || y == ring) ? 1 : 2 * ring;
+                    for (int x = -ring; x <= ring; x += step)
+                    {
+                        int wrappedX = (cellX + x + gridSize) % gridSize;
+                        int wrappedY = (cellY + y + gridSize) % gridSize;
+                        for (uint32_t index : grid[wrappedY * gridSize + wrappedX])
+                        {
+                            nearest = std::min(nearest,
+                                               toroidalDistanceSquared(candidate, points[index]));
+                        }
+                    }
+                }
+            }
+            if (nearest > bestDist)
+            {
+                best     = candidate;
+                bestDist = nearest;
+            }
+        }
+        grid[cellOf(best.y) * gridSize + cellOf(best.x)].push_back(
+            static_cast<uint32_t>(points.size()));
+        points.push_back(best);
+    }
+    return points;
+}
+
+} // namespace Random
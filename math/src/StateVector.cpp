@@ -1,5 +1,4 @@
 #include "StateVector.h"
-#include "EngineManager.h"
 
 StateVector::StateVector() : _mass(1.0), _active(false), _gravity(true) {}
 
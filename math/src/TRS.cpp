@@ -0,0 +1,97 @@
+#include "TRS.h"
+#include "SIMD.h"
+#include <math.h>
+
+TRS::TRS(const Vector4& t, const Quaternion& r, const Vector4& s) : rotation(r)
+{
+    translation[0] = t.getx(), translation[1] = t.gety(), translation[2] = t.getz();
+    scale[0] = s.getx(), scale[1] = s.gety(), scale[2] = s.getz();
+}
+
+TRS TRS::fromMatrix(const Matrix& transform)
+{
+    const float* m = transform.getFlatBuffer();
+
+    // Column lengths are the scales, a negative determinant flips the x axis
+    float sx          = sqrtf(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+    float sy          = sqrtf(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+    float sz          = sqrtf(m[2] * m[2] + m[6] * m[6] + m[10] * m[10]);
+    float determinant = m[0] * (m[5] * m[10] - m[6] * m[9]) - m[1] * (m[4] * m[10] - m[6] * m[8]) +
+                        m[2] * (m[4] * m[9] - m[5] * m[8]);
+    if (determinant < 0.0f)
+    {
+        sx = -sx;
+    }
+
+    TRS result;
+    result.translation[0] = m[3], result.translation[1] = m[7], result.translation[2] = m[11];
+    result.scale[0] = sx, result.scale[1] = sy, result.scale[2] = sz;
+    if (sx == 0.0f || sy == 0.0f || sz == 0.0f)
+    {
+        return result;
+    }
+
+    float rotation[MATRIX_SIZE] = {m[0] / sx, m[1] / sy, m[2] / sz,  0.0f,
+                                   m[4] / sx, m[5] / sy, m[6] / sz,  0.0f,
+                                   m[8] / sx, m[9] / sy, m[10] / sz, 0.0f,
+                                   0.0f,      0.0f,      0.0f,       1.0f};
+    result.rotation = Quaternion::fromMatrix(Matrix(rotation)).normalized();
+    return result;
+}
+
+Vector4 TRS::getTranslation() const { return Vector4(translation[0], translation[1], translation[2]); }
+
+Vector4 TRS::getScale() const { return Vector4(scale[0], scale[1], scale[2]); }
+
+Matrix TRS::toMatrix() const
+{
+    Matrix       rotationMatrix = rotation.toMatrix();
+    const float* r              = rotationMatrix._matrix;
+
+    // Scale the columns of each rotation row and drop the translation into w
+    SIMD::Float4 s = SIMD::set(scale[0], scale[1], scale[2], 0.0f);
+
+    SIMD::Float4 tx = SIMD::set(0.0f, 0.0f, 0.0f, translation[0]);
+    SIMD::Float4 ty = SIMD::set(0.0f, 0.0f, 0.0f, translation[1]);
+    SIMD::Float4 tz = SIMD::set(0.0f, 0.0f, 0.0f, translation[2]);
+
+    Matrix matrix;
+    SIMD::store(&matrix._matrix[0], SIMD::madd(SIMD::load(&r[0]), s, tx));
+    SIMD::store(&matrix._matrix[4], SIMD::madd(SIMD::load(&r[4]), s, ty));
+    SIMD::store(&matrix._matrix[8], SIMD::madd(SIMD::load(&r[8]), s, tz));
+
+    if (scale[0] == 1.0f && scale[1] == 1.0f && scale[2] == 1.0f)
+    {
+        matrix._transformClass = TransformClass::Rigid;
+    }
+    else if (scale[0] == scale[1] && scale[1] == scale[2])
+    {
+        matrix._transformClass = TransformClass::UniformScale;
+    }
+    else
+    {
+        matrix._transformClass = TransformClass::Affine;
+    }
+    return matrix;
+}
+
+TRS TRS::compose(const TRS& parent, const TRS& child)
+{
+    Vector4 childTranslation = parent.rotation.rotate(child.getTranslation() * parent.getScale());
+    return TRS(childTranslation + parent.getTranslation(), parent.rotation * child.rotation,
+               child.getScale() * parent.getScale());
+}
+
+TRS TRS::interpolate(const TRS& a, const TRS& b, float t, bool useSlerp)
+{
+    TRS result;
+    result.rotation = useSlerp ? Quaternion::slerp(a.rotation, b.rotation, t)
+                               : Quaternion::nlerp(a.rotation, b.rotation, t);
+
+    for (int i = 0; i < 3; i++)
+    {
+        result.translation[i] = a.translation[i] + (b.translation[i] - a.translation[i]) * t;
+        result.scale[i]       = a.scale[i] + (b.scale[i] - a.scale[i]) * t;
+    }
+    return result;
+}
@@ -0,0 +1,98 @@
+#include "TransformBatch.h"
+#include "AffineInverse.h"
+#include "SIMD.h"
+#include <cstring>
+
+namespace
+{
+SIMD_INLINE void writeNormal(float* dst, SIMD::Float4 n0, SIMD::Float4 n1, SIMD::Float4 n2)
+{
+    // Rows are packed back to back so go through a padded scratch to avoid writing past the end
+    alignas(16) float packed[12];
+    SIMD::store(&packed[0], n0);
+    SIMD::storeu(&packed[3], n1);
+    SIMD::storeu(&packed[6], n2);
+    memcpy(dst, packed, sizeof(float) * TransformBatch::NormalFloats);
+}
+} // namespace
+
+namespace TransformBatch
+{
+
+void write(const Matrix* transforms, size_t count, const Streams& streams)
+{
+    const bool needInverse = (streams.worldToObject != nullptr) || (streams.normal != nullptr);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* m = transforms[i].getFlatBuffer();
+
+        SIMD::Float4 r0 = SIMD::load(&m[0]);
+        SIMD::Float4 r1 = SIMD::load(&m[4]);
+        SIMD::Float4 r2 = SIMD::load(&m[8]);
+
+        if (streams.objectToWorld != nullptr)
+        {
+            float* dst = streams.objectToWorld + i * ObjectToWorldFloats;
+            SIMD::storeu(&dst[0], r0);
+            SIMD::storeu(&dst[4], r1);
+            SIMD::storeu(&dst[8], r2);
+        }
+
+        if (streams.model != nullptr)
+        {
+            float* dst = streams.model + i * ModelFloats;
+            SIMD::storeu(&dst[0], r0);
+            SIMD::storeu(&dst[4], r1);
+            SIMD::storeu(&dst[8], r2);
+            SIMD::storeu(&dst[12], SIMD::load(&m[12]));
+        }
+
+        if (needInverse == false)
+        {
+            continue;
+        }
+
+        // Entity transforms are affine, only the tracked class changes how the 3x3 is inverted
+        TransformClass transformClass = transforms[i].getTransformClass();
+        if (transformClass == TransformClass::Projective)
+        {
+            transformClass = TransformClass::Affine;
+        }
+
+        SIMD::Float4 n0, n1, n2;
+        bool invertible = AffineInverse::normalRows(m, transformClass, n0, n1, n2);
+
+        if (streams.normal != nullptr)
+        {
+            if (invertible == false)
+            {
+                // Matches Matrix::inverse which hands back the original matrix
+                SIMD::Float4 r3 = SIMD::load(&m[12]);
+                n0 = r0, n1 = r1, n2 = r2;
+                SIMD::transpose(n0, n1, n2, r3);
+            }
+            writeNormal(streams.normal + i * NormalFloats, n0, n1, n2);
+        }
+
+        if (streams.worldToObject != nullptr)
+        {
+            float* dst = streams.worldToObject + i * WorldToObjectFloats;
+            if (invertible)
+            {
+                AffineInverse::inverseRows(m, n0, n1, n2);
+                SIMD::storeu(&dst[0], n0);
+                SIMD::storeu(&dst[4], n1);
+                SIMD::storeu(&dst[8], n2);
+            }
+            else
+            {
+                SIMD::storeu(&dst[0], r0);
+                SIMD::storeu(&dst[4], r1);
+                SIMD::storeu(&dst[8], r2);
+            }
+        }
+    }
+}
+
+} // namespace TransformBatch
@@ -7,6 +7,7 @@ VectorPath::VectorPath()
 {
     _elapsedTime   = 0;
     _currentVector = 0;
+    _buildCurves();
 }
 
 VectorPath::VectorPath(const std::string& pathFile)
@@ -14,12 +15,14 @@ VectorPath::VectorPath(const std::string& pathFile)
     _loadVectorsFromFile(pathFile);
     _elapsedTime   = 0;
     _currentVector = 0;
+    _buildCurves();
 }
 
 VectorPath::VectorPath(const std::vector<PathVector>& vectors) : _vectors(vectors)
 {
     _elapsedTime   = 0;
     _currentVector = 0;
+    _buildCurves();
 }
 
 void VectorPath::updateState(int milliseconds, StateVector* state, bool clearVelocity)
@@ -36,27 +39,24 @@ void VectorPath::updateState(int milliseconds, StateVector* state, bool clearVel
             state->setLinearVelocity(Vector4(0.0, 0.0, 0.0));
         }
         // If we also have waypoints, we dont want to double add the velocity
-        if (_elapsedTime >= _vectors[_currentVector].time)
+        if (_elapsedTime >= _forceCurve.getEndTime() + _vectors.back().time)
         {
-            _elapsedTime = 0;
-            _currentVector++;
-
-            if (_currentVector >= _vectors.size())
-            {
-                _currentVector = -1;
-                state->setForce(Vector4(0.0, 0.0, 0.0));
-                state->setLinearAcceleration(Vector4(0.0, 0.0, 0.0));
-                state->setLinearVelocity(Vector4(0.0, 0.0, 0.0));
-                state->setAngularAcceleration(Vector4(0.0, 0.0, 0.0));
-                state->setAngularVelocity(Vector4(0.0, 0.0, 0.0));
-                state->setTorque(Vector4(0.0, 0.0, 0.0));
-                return;
-            }
+            _currentVector = -1;
+            state->setForce(Vector4(0.0, 0.0, 0.0));
+            state->setLinearAcceleration(Vector4(0.0, 0.0, 0.0));
+            state->setLinearVelocity(Vector4(0.0, 0.0, 0.0));
+            state->setAngularAcceleration(Vector4(0.0, 0.0, 0.0));
+            state->setAngularVelocity(Vector4(0.0, 0.0, 0.0));
+            state->setTorque(Vector4(0.0, 0.0, 0.0));
+            return;
         }
+
+        float time = static_cast<float>(_elapsedTime);
+        state->setForce(_forceCurve.evaluate(time, _forceCursor));
+        state->setTorque(_torqueCurve.evaluate(time, _torqueCursor));
+        _currentVector = static_cast<int>(_forceCursor.segment);
         _elapsedTime += milliseconds;
 
-        state->setForce(_vectors[_currentVector].direction);
-        state->setTorque(_vectors[_currentVector].rotation);
         state->update(milliseconds);
         if (clearVelocity)
         {
@@ -75,6 +75,7 @@ void VectorPath::resetVectorsFromFile(const std::string& pathFile)
     _loadVectorsFromFile(pathFile);
     _elapsedTime   = 0;
     _currentVector = 0;
+    _buildCurves();
 }
 
 void VectorPath::resetVectors(const std::vector<PathVector>& vectors)
@@ -82,12 +83,15 @@ void VectorPath::resetVectors(const std::vector<PathVector>& vectors)
     _vectors       = vectors;
     _elapsedTime   = 0;
     _currentVector = 0;
+    _buildCurves();
 }
 
 void VectorPath::resetState(StateVector* state)
 {
     _currentVector = -1;
     _elapsedTime   = 0;
+    _forceCursor   = Curve::Cursor();
+    _torqueCursor  = Curve::Cursor();
     if (_vectors.size() > 0)
     {
         _currentVector = 0;
@@ -129,3 +133,21 @@ void VectorPath::_loadVectorsFromFile(const std::string& file)
         _vectors.emplace_back(d, r, time);
     }
 }
+
+void VectorPath::_buildCurves()
+{
+    // Vector times are durations, each one takes over at the running sum of those before it
+    float time   = 0.0f;
+    _forceCurve  = Curve(CurveInterpolation::Step);
+    _torqueCurve = Curve(CurveInterpolation::Step);
+    _forceCurve.reserve(_vectors.size());
+    _torqueCurve.reserve(_vectors.size());
+    for (auto& vector : _vectors)
+    {
+        _forceCurve.addKey(time, vector.direction);
+        _torqueCurve.addKey(time, vector.rotation);
+        time += vector.time;
+    }
+    _forceCursor  = Curve::Cursor();
+    _torqueCursor = Curve::Cursor();
+}
@@ -1,7 +1,4 @@
 #include "WaypointPath.h"
-#include "IOEvents.h"
-#include "Logger.h"
-#include "ShaderBroker.h"
 #include <cmath>
 #include <fstream>
 #include <iterator>
@@ -27,7 +24,7 @@ WaypointPath::WaypointPath(const std::string& name, const std::string& pathFile,
     _loadWaypointsFromFile(pathFile);
     _elapsedTime     = 0;
     _currentWaypoint = 0;
-
+    _buildCurves();
 }
 
 WaypointPath::WaypointPath(const std::string& name, Vector4 finalPos, Vector4 finalRotation,
@@ -39,6 +36,7 @@ WaypointPath::WaypointPath(const std::string& name, Vector4 finalPos, Vector4 fi
     _waypoints.emplace_back(finalPos, finalRotation, Vector4(1.0, 1.0, 1.0), time, Matrix());
     _elapsedTime     = 0;
     _currentWaypoint = 0;
+    _buildCurves();
 }
 
 WaypointPath::WaypointPath(const std::string& name, const std::vector<PathWaypoint>& waypoints,
@@ -48,127 +46,33 @@ WaypointPath::WaypointPath(const std::string& name, const std::vector<PathWaypoi
     _name            = name;
     _elapsedTime     = 0;
     _currentWaypoint = 0;
+    _buildCurves();
 }
 
-float WaypointPath::ConvertToDegrees(float radian) { return (180.0f / PI) * radian; }
-
-float WaypointPath::GetRoll(Vector4 q)
+void WaypointPath::updateState(int milliseconds, StateVector* state)
 {
-    float x = ConvertToDegrees(atan2(2 * q.getx() * q.getw() - 2 * q.gety() * q.getz(),
-                                     1 - 2 * pow(q.getx(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-
-    if (q.getx() * q.gety() + q.getz() * q.getw() == 0.5)
+    if (_currentWaypoint == -1 || _waypoints.empty())
     {
-        x = ConvertToDegrees((float)(2 * atan2(q.getx(), q.getw())));
+        return;
     }
 
-    else if (q.getx() * q.gety() + q.getz() * q.getw() == -0.5)
+    // Loops back to the start once the last waypoint has played
+    if (_elapsedTime > _translationCurve.getEndTime())
     {
-        x = ConvertToDegrees((float)(-2 * atan2(q.getx(), q.getw())));
+        _elapsedTime = 0;
+        _cursor      = Curve::Cursor();
     }
-    return x;
-}
 
-float WaypointPath::GetPitch(Vector4 q)
-{
-    float y = ConvertToDegrees(atan2(2 * q.gety() * q.getw() - 2 * q.getx() * q.getz(),
-                                     1 - 2 * pow(q.gety(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-    if (q.getx() * q.gety() + q.getz() * q.getw() == 0.5)
-    {
-        y = 0;
-    }
-    else if (q.getx() * q.gety() + q.getz() * q.getw() == -0.5)
-    {
-        y = 0;
-    }
-    return y;
-}
+    Curve::Segment segment = _translationCurve.locate(static_cast<float>(_elapsedTime), _cursor);
+    _currentWaypoint       = static_cast<int>(segment.index);
+    state->setTransform(_evaluate(segment));
 
-float WaypointPath::GetYaw(Vector4 q)
-{
-    float z = ConvertToDegrees(
-        asin(std::clamp(2 * q.getx() * q.gety() + 2 * q.getz() * q.getw(), -1.0f, 1.0f)));
-    return z;
+    _elapsedTime += milliseconds;
 }
 
-void WaypointPath::updateState(int milliseconds, StateVector* state)
+Matrix WaypointPath::evaluate(float milliseconds) const
 {
-    /*if (_currentWaypoint != -1 && _currentWaypoint < _waypoints.size())
-    {
-        if (_elapsedTime >= _waypoints[_currentWaypoint].time)
-        {
-            _decelerating = false;
-            _elapsedTime  = 0;
-            _currentWaypoint++;
-            state->setForce(Vector4(0.0, 0.0, 0.0));
-            state->setTorque(Vector4(0.0, 0.0, 0.0));
-            state->setLinearVelocity(Vector4(0.0, 0.0, 0.0));
-            state->setLinearAcceleration(Vector4(0.0, 0.0, 0.0));
-            state->setAngularVelocity(Vector4(0.0, 0.0, 0.0));
-            state->setAngularAcceleration(Vector4(0.0, 0.0, 0.0));
-
-            if (_currentWaypoint >= _waypoints.size())
-            {
-                _currentWaypoint = -1;
-                return;
-            }
-
-            _calculateVelocities(state);
-        }
-        _elapsedTime += milliseconds;
-        if (!_accelerate)
-        {
-            state->setLinearVelocity(_currentVelocity);
-            state->setAngularVelocity(_currentRotation);
-        }
-        else
-        {
-            state->setForce(_currentLinearAcceleration);
-            state->setTorque(_currentAngularAcceleration);
-        }
-        state->update(milliseconds);
-    }
-    else
-    {*/
-     
-    if (_currentWaypoint != -1 && _currentWaypoint < _waypoints.size())
-    {
-        if (_elapsedTime >= _waypoints[_currentWaypoint].time)
-        {
-            _currentWaypoint++;
-
-            if (_currentWaypoint >= _waypoints.size())
-            {
-                _currentWaypoint = -1;
-                
-                _currentWaypoint = 0;
-                _elapsedTime     = 0;
-
-                return;
-            }
-
-            for (int i = _currentWaypoint; i < _waypoints.size(); i++)
-            {
-                if (_elapsedTime > _waypoints[i].time)
-                {
-                    _currentWaypoint = i;
-                    break;
-                }
-            }
-
-            //state->setLinearPosition(_waypoints[_currentWaypoint].position);
-            //state->setAngularPosition(_waypoints[_currentWaypoint].rotation);
-
-            state->setTransform(_waypoints[_currentWaypoint].transform);
-        }
-        _elapsedTime += milliseconds;
-    }
-
-    if (_currentWaypoint == _waypoints.size())
-    {
-        _currentWaypoint = 0;
-        _elapsedTime     = 0;
-    }
+    return _evaluate(_translationCurve.locate(milliseconds));
 }
 
 bool WaypointPath::isMoving() 
@@ -179,13 +83,15 @@ bool WaypointPath::isMoving()
 void WaypointPath::resetWaypointsFromFile(const std::string& pathFile)
 {
     _loadWaypointsFromFile(pathFile);
+    _buildCurves();
     _elapsedTime     = 0;
     _currentWaypoint = -1;
 }
 
 void WaypointPath::resetWaypoints(const std::vector<PathWaypoint>& waypoints)
 {
-    _waypoints       = waypoints;
+    _waypoints = waypoints;
+    _buildCurves();
     _elapsedTime     = 0;
     _currentWaypoint = -1;
 }
@@ -195,6 +101,7 @@ void WaypointPath::resetState(StateVector* state)
     _decelerating    = false;
     _currentWaypoint = -1;
     _elapsedTime     = 0;
+    _cursor          = Curve::Cursor();
     _currentVelocity = Vector4();
     _currentRotation = Vector4();
     _initialPosition = state->getLinearPosition();
@@ -279,4 +186,40 @@ void WaypointPath::_calculateVelocities(StateVector* state)
         state->setLinearVelocity(_currentVelocity);
         state->setAngularVelocity(_currentRotation);
     }
-}
\ No newline at end of file
+}
+
+void WaypointPath::_buildCurves()
+{
+    // Waypoint transforms already carry the animated parents, split them back into translation,
+    // rotation and scale so every part interpolates on its own between keys
+    _translationCurve = Curve(CurveInterpolation::Linear);
+    _scaleCurve       = Curve(CurveInterpolation::Linear);
+    _rotationKeys.clear();
+    _translationCurve.reserve(_waypoints.size());
+    _scaleCurve.reserve(_waypoints.size());
+    _rotationKeys.reserve(_waypoints.size());
+    _cursor = Curve::Cursor();
+
+    for (auto& waypoint : _waypoints)
+    {
+        TRS trs = TRS::fromMatrix(waypoint.transform);
+        _translationCurve.addKey(waypoint.time, trs.getTranslation());
+        _scaleCurve.addKey(waypoint.time, trs.getScale());
+        _rotationKeys.push_back(trs.rotation);
+    }
+}
+
+Matrix WaypointPath::_evaluate(const Curve::Segment& segment) const
+{
+    if (_waypoints.size() < 2)
+    {
+        return _waypoints.empty() ? Matrix() : _waypoints[0].transform;
+    }
+
+    // Every curve shares the waypoint times so one lookup serves all three parts
+    TRS trs(_translationCurve.evaluate(segment),
+            Quaternion::slerp(_rotationKeys[segment.index], _rotationKeys[segment.index + 1],
+                              segment.u),
+            _scaleCurve.evaluate(segment));
+    return trs.toMatrix();
+}
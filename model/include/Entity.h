@@ -21,10 +21,12 @@
  */
 
 #pragma once
+#include "Bounds.h"
 #include "EventSubscriber.h"
 #include "MVP.h"
 #include "MasterClock.h"
 #include "StateVector.h"
+#include "TRS.h"
 #include "VectorPath.h"
 #include "WaypointPath.h"
 #include "LayeredTexture.h"
@@ -34,7 +36,6 @@
 
 class IOEventDistributor;
 class Model;
-class FrustumCuller;
 struct SceneEntity;
 
 using VAOMap = std::map<int, std::vector<VAO*>>;
@@ -53,6 +54,7 @@ class Entity : public EventSubscriber
     void setPosition(Vector4 position);
     void setState(const Vector4& position, const Vector4& rotation, const Vector4& scale);
     void setState( Matrix& transform);
+    void setState(const TRS& trs);
     void setVelocity(Vector4 velocity);
     void setSelected(bool isSelected);
     void setVectorPaths(const std::vector<std::string>& pathFiles);
@@ -60,10 +62,11 @@ class Entity : public EventSubscriber
     bool isDynamic();
     bool isAnimated();
 
-    Matrix                      getWorldSpaceTransform();
+    const Matrix&               getWorldSpaceTransform();
     unsigned int                getRayTracingTextureId();
     LayeredTexture*             getLayeredTexture();
-    FrustumCuller*              getFrustumCuller();
+    AABB                        getWorldBounds();
+    bool                        isVisible(const Frustum& frustum);
     std::vector<RenderBuffers>* getRenderBuffers();
     StateVector*                getStateVector();
     std::vector<VAO*>*          getFrustumVAO();
@@ -75,6 +78,9 @@ class Entity : public EventSubscriber
     void                        setModel(Model* model);
     MVP*                        getMVP();
     unsigned int                getID();
+    unsigned int                getTransformGeneration();
+    void                        setInstanceSlot(uint64_t instanceSlot);
+    uint64_t                    getInstanceSlot();
     WaypointPath*               getWaypointPath();
     void        reset(const SceneEntity& sceneEntity, ViewEventDistributor* viewManager);
     void        entranceWaypoint(Vector4 initialPos, Vector4 initialRotation, float time);
@@ -96,6 +102,9 @@ class Entity : public EventSubscriber
     std::vector<VAO*> _frustumVAOs;
     // id generator that is incremented every time a new Entity is added
     static unsigned int _idGenerator;
+    // generation generator shared by all entities and incremented every time a world transform is
+    // written, a generation is never handed to two entities so uploads can tell entities apart
+    static unsigned int _transformGenerator;
     EngineStateFlags    _gameState;
     bool                _selected;
     // Previous Model view matrix container for motion blur
@@ -106,6 +115,8 @@ class Entity : public EventSubscriber
     Vector4      _scale; // Used with pathing
     MVP          _mvp;
     unsigned int _id;
+    unsigned int _transformGeneration;
+    uint64_t     _instanceSlot = 0; // Packed instance slot handle the resource manager numbered it with
     bool         _enteredView = false;
 
     void _updateReleaseKeyboard(int key, int x, int y){};
@@ -21,6 +21,7 @@
  */
 
 #pragma once
+#include "Bounds.h"
 #include "GltfLoader.h"
 #include "MVP.h"
 #include "MasterClock.h"
@@ -33,7 +34,6 @@
 #include <iostream>
 #include <mutex>
 #include <vector>
-class FrustumCuller;
 class IOEventDistributor;
 
 enum class ModelClass
@@ -99,7 +99,11 @@ class Model
     std::string              getName();
     std::vector<VAO*>*       getVAO();
     unsigned int             getId();
+    void                     setResourceId(uint64_t resourceId);
+    uint64_t                 getResourceId();
     GltfLoader*              getGltfLoader();
+    AABB                     getBounds();
+    void                     computeBounds();
     void setLoadModelCount(int modelCountToLoad) { _modelCountToLoad = modelCountToLoad; }
     int  getLoadModelCount() { return _modelCountToLoad; }
 
@@ -115,6 +119,8 @@ class Model
     static unsigned int   _modelIdTagger;
     // Manages vertex, normal and texture data
     RenderBuffers _renderBuffers;
+    // Object space bounds of every vertex in _renderBuffers, empty until the model has loaded
+    AABB _bounds;
     // Indicates whether the collision geometry is sphere or triangle based
     // 300 x, y and z offsets
     float      _offsets[900];
@@ -127,6 +133,8 @@ class Model
     ModelClass  _classId;
     // used to identify model, used for ray tracing
     unsigned int _modelId;
+    // Packed handle of the dense id the resource manager registered the model under
+    uint64_t     _resourceId = 0;
     std::string  _name;
     // Vao container
     std::vector<VAO*> _vao;
@@ -7,7 +7,8 @@
 #include "ShaderBroker.h"
 #include "AnimatedModel.h"
 
-unsigned int Entity::_idGenerator = 1;
+unsigned int Entity::_idGenerator        = 1;
+unsigned int Entity::_transformGenerator = 1;
 
 Entity::Entity(Model* model, ViewEvents* eventWrapper, MVP transforms)
     : EventSubscriber(eventWrapper), _clock(MasterClock::instance()), _model(model),
@@ -15,6 +16,7 @@ Entity::Entity(Model* model, ViewEvents* eventWrapper, MVP transforms)
       _gameState(EngineState::getEngineState()), _layeredTexture(nullptr), _rayTracingTextureId(0)
 {
     _worldSpaceTransform = transforms.getModelMatrix();
+    _transformGeneration = _transformGenerator++;
     _mvp.setProjection(transforms.getProjectionMatrix());
     _mvp.setView(transforms.getViewMatrix());
 
@@ -140,16 +142,26 @@ void Entity::entranceWaypoint(Vector4 initialPos, Vector4 initialRotation, float
 
 void Entity::_updateDraw()
 {
-    Matrix inverseViewProjection = ModelBroker::getViewManager()->getView().inverse() *
-                                   ModelBroker::getViewManager()->getProjection().inverse();
-
-    if (1) // FrustumCuller::getVisibleAABB(this, frustumPlanes))
+    if (isVisible(ModelBroker::getViewManager()->getFrustum()))
     {
         // Run model shader by allowing the shader to operate on the model
         _model->runShader(this);
     }
 }
 
+AABB Entity::getWorldBounds() { return _model->getBounds().transform(_worldSpaceTransform); }
+
+bool Entity::isVisible(const Frustum& frustum)
+{
+    AABB bounds = _model->getBounds();
+    // Keep drawing models that are still streaming in, their bounds are not known yet
+    if (bounds.isEmpty())
+    {
+        return true;
+    }
+    return frustum.isVisible(bounds.transform(_worldSpaceTransform));
+}
+
 Model* Entity::getModel()
 {
     // Used to query the correct lod
@@ -260,6 +272,7 @@ void Entity::_updatePathKinematics(int milliSeconds)
     if (_waypointPath != nullptr)
     {
         _worldSpaceTransform = kinematicTransform;
+        _transformGeneration = _transformGenerator++;
     }
     /*else
     {
@@ -281,6 +294,7 @@ MVP* Entity::getMVP() { return &_mvp; }
 void Entity::setMVP(MVP transforms)
 {
     _worldSpaceTransform = transforms.getModelMatrix();
+    _transformGeneration = _transformGenerator++;
     _mvp.setProjection(transforms.getProjectionMatrix());
     _mvp.setView(transforms.getViewMatrix());
 }
@@ -290,6 +304,12 @@ StateVector* Entity::getStateVector() { return &_state; }
 
 unsigned int Entity::getID() { return _id; }
 
+unsigned int Entity::getTransformGeneration() { return _transformGeneration; }
+
+void Entity::setInstanceSlot(uint64_t instanceSlot) { _instanceSlot = instanceSlot; }
+
+uint64_t Entity::getInstanceSlot() { return _instanceSlot; }
+
 bool Entity::isID(unsigned int entityID)
 {
 
@@ -306,7 +326,7 @@ bool Entity::isID(unsigned int entityID)
 
 std::vector<RenderBuffers>* Entity::getRenderBuffers() { return _frustumRenderBuffers; }
 
-Matrix Entity::getWorldSpaceTransform() { return _worldSpaceTransform; }
+const Matrix& Entity::getWorldSpaceTransform() { return _worldSpaceTransform; }
 
 bool Entity::isDynamic()
 {
@@ -362,28 +382,28 @@ void Entity::setPosition(Vector4 position)
 
 void Entity::setState(const Vector4& position, const Vector4& rotation, const Vector4& scale)
 {
-    _scale = scale;
-
-    Matrix objectSpaceTransform = Matrix();
+    setState(TRS(position, Quaternion::fromEulerDegrees(rotation), scale));
+    // Keep the angles as given rather than the ones recovered from the quaternion
+    _state.setAngularPosition(rotation);
+}
 
-    auto transform = Matrix::translation(position.getx(), position.gety(), position.getz()) *
-                     Matrix::rotationAroundY(rotation.gety()) * 
-                     Matrix::rotationAroundZ(rotation.getz()) *
-                     Matrix::rotationAroundX(rotation.getx()) *
-                     Matrix::scale(_scale.getx(), _scale.gety(), _scale.getz()) *
-                     objectSpaceTransform;
+void Entity::setState(const TRS& trs)
+{
+    _scale = trs.getScale();
 
     MVP worldSpaceTransform;
     worldSpaceTransform.setProjection(ModelBroker::getViewManager()->getProjection());
     worldSpaceTransform.setView(ModelBroker::getViewManager()->getView());
-    worldSpaceTransform.setModel(transform);
+    worldSpaceTransform.setModel(trs.toMatrix());
 
     _worldSpaceTransform = worldSpaceTransform.getModelMatrix();
+    _transformGeneration = _transformGenerator++;
     _mvp.setProjection(worldSpaceTransform.getProjectionMatrix());
     _mvp.setView(worldSpaceTransform.getViewMatrix());
 
-    _state.setLinearPosition(position);
-    _state.setAngularPosition(rotation);
+    _state.setLinearPosition(trs.getTranslation());
+    // toEulerDegrees returns the angles negated relative to what fromEulerDegrees takes
+    _state.setAngularPosition(-trs.rotation.toEulerDegrees());
 }
 
 void Entity::setState(Matrix& transform)
@@ -396,6 +416,7 @@ void Entity::setState(Matrix& transform)
     worldSpaceTransform.setModel(transform);
 
     _worldSpaceTransform = worldSpaceTransform.getModelMatrix();
+    _transformGeneration = _transformGenerator++;
     _mvp.setProjection(worldSpaceTransform.getProjectionMatrix());
     _mvp.setView(worldSpaceTransform.getViewMatrix());
 
@@ -14,6 +14,7 @@
 #include "ViewEventDistributor.h"
 #include "json.hpp"
 #include "SkinningData.h"
+#include "TRS.h"
 
 #undef max
 
@@ -183,6 +184,7 @@ void buildModel(std::vector<float>& vertices, std::vector<float>& normals,
     }
 
     renderBuffers->addVertexIndices(indices);
+    model->computeBounds();
 
     auto animatedModel = dynamic_cast<AnimatedModel*>(model);
     (*model->getVAO())[0]->createVAO(renderBuffers,
@@ -190,78 +192,6 @@ void buildModel(std::vector<float>& vertices, std::vector<float>& normals,
                                      animatedModel);
 }
 
-float ConvertToDegrees(float radian) 
-{
-    return (180.0f / PI) * radian;
-}
-
-Vector4 QuaternionToEuler(Vector4 q)
-{
-    Vector4 v = Vector4(0, 0, 0);
-
-    v.getFlatBuffer()[1] = ConvertToDegrees(atan2(2 * q.gety() * q.getw() - 2 * q.getx() * q.getz(),
-                                   1 - 2 * pow(q.gety(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-
-    v.getFlatBuffer()[2] =
-        ConvertToDegrees(asin(2 * q.getx() * q.gety() + 2 * q.getz() * q.getw()));
-
-    v.getFlatBuffer()[0] =
-        ConvertToDegrees(atan2(2 * q.getx() * q.getw() - 2 * q.gety() * q.getz(),
-                                 1 - 2 * pow(q.getx(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-
-    if (q.getx() * q.gety() + q.getz() * q.getw() == 0.5)
-    {
-        v.getFlatBuffer()[0] = ConvertToDegrees((float)(2 * atan2(q.getx(), q.getw())));
-        v.getFlatBuffer()[1] = 0;
-    }
-
-    else if (q.getx() * q.gety() + q.getz() * q.getw() == -0.5)
-    {
-        v.getFlatBuffer()[0] = ConvertToDegrees((float)(-2 * atan2(q.getx(), q.getw())));
-        v.getFlatBuffer()[1] = 0;
-    }
-
-    return v;
-}
-
-float GetRoll(Vector4 q)
-{
-    float x = ConvertToDegrees(atan2(2 * q.getx() * q.getw() - 2 * q.gety() * q.getz(),
-                                     1 - 2 * pow(q.getx(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-
-    if (q.getx() * q.gety() + q.getz() * q.getw() == 0.5)
-    {
-        x = ConvertToDegrees((float)(2 * atan2(q.getx(), q.getw())));
-    }
-
-    else if (q.getx() * q.gety() + q.getz() * q.getw() == -0.5)
-    {
-        x = ConvertToDegrees((float)(-2 * atan2(q.getx(), q.getw())));
-    }
-    return x;
-}
-
-float GetPitch(Vector4 q)
-{
-    float y = ConvertToDegrees(atan2(2 * q.gety() * q.getw() - 2 * q.getx() * q.getz(),
-                                     1 - 2 * pow(q.gety(), 2.0f) - 2 * pow(q.getz(), 2.0f)));
-    if (q.getx() * q.gety() + q.getz() * q.getw() == 0.5)
-    {
-        y = 0;
-    }
-    else if (q.getx() * q.gety() + q.getz() * q.getw() == -0.5)
-    {
-        y = 0;
-    }
-    return y;
-}
-
-float GetYaw(Vector4 q)
-{
-    float z = ConvertToDegrees(asin(std::clamp(2 * q.getx() * q.gety() + 2 * q.getz() * q.getw(), -1.0f, 1.0f)));
-    return z;
-}
-
 std::vector<PathWaypoint> AnimatingNodes(const Document* document, const GLTFResourceReader* resourceReader,
                     std::vector<PathWaypoint> waypoints, int nodeIndex, std::map<int, int> nodeIndexToAnimationIndex,
                     std::map<int, std::vector<PathWaypoint>>& nodeWayPoints, std::vector<PathWaypoint> currWayPoints,
@@ -343,9 +273,10 @@ std::vector<PathWaypoint> AnimatingNodes(const Document* document, const GLTFRes
     // Don't process step interpolation by making sure iterations are greater than 1
     while (timeIndex < iterations)
     {
-        Vector4 translation = Vector4(0.0, 0.0, 0.0);
-        Vector4 rotation    = Vector4(0.0, 0.0, 0.0);
-        Vector4 scale       = Vector4(1.0, 1.0, 1.0);
+        Vector4    translation = Vector4(0.0, 0.0, 0.0);
+        Vector4    rotation    = Vector4(0.0, 0.0, 0.0);
+        Vector4    scale       = Vector4(1.0, 1.0, 1.0);
+        Quaternion quaternion;
 
         bool grabbedTime = false;
         if (timeIndex < translationTimeFloats.size() &&
@@ -362,22 +293,24 @@ std::vector<PathWaypoint> AnimatingNodes(const Document* document, const GLTFRes
         if ((rotationIndex/4) < rotationTimeFloats.size() && currentTime >= rotationTimeFloats[rotationIndex/4] &&
             inputAccessorForAnimation.find(TargetPath::TARGET_ROTATION) != inputAccessorForAnimation.end())
         {
-            Vector4 quaternion(rotationVectors[rotationIndex],
-                                rotationVectors[rotationIndex + 1],
-                                rotationVectors[rotationIndex + 2],
-                                rotationVectors[rotationIndex + 3]);
+            quaternion = Quaternion(rotationVectors[rotationIndex],
+                                    rotationVectors[rotationIndex + 1],
+                                    rotationVectors[rotationIndex + 2],
+                                    rotationVectors[rotationIndex + 3]);
+
+            Vector4 euler = quaternion.toEulerDegrees();
 
             // Default camera orients in the negative Y direction
             if (/*(node.children.size() > 0 && document->nodes.Elements()[std::stoi(node.children[0], &sz)].cameraId.empty() == false)*/
                 (node.name == "Camera"))
             {
 
-                rotation = Vector4(-(90.0f - GetRoll(quaternion)), GetPitch(quaternion), GetYaw(quaternion));
+                rotation   = Vector4(-(90.0f - euler.getx()), euler.gety(), euler.getz());
+                quaternion = Quaternion::fromEulerDegrees(rotation);
             }
             else
             {
-                rotation =
-                    Vector4(-GetRoll(quaternion), -GetPitch(quaternion), -GetYaw(quaternion));
+                rotation = -euler;
             }
 
             currentTime = (rotationTimeFloats[rotationIndex / 4]) + timeOffset;
@@ -402,17 +335,11 @@ std::vector<PathWaypoint> AnimatingNodes(const Document* document, const GLTFRes
 
         // Way points are in milliseconds
 
-        auto currentTransform = Matrix::translation(translation.getx(), translation.gety(), translation.getz()) *
-                           Matrix::rotationAroundY(rotation.gety()) *
-                           Matrix::rotationAroundZ(rotation.getz()) *
-                           Matrix::rotationAroundX(rotation.getx()) *
-                           Matrix::scale(scale.getx(), scale.gety(), scale.getz());
+        TRS  localTRS(translation, quaternion, scale);
+        auto currentTransform = currWayPoints[waypoints.size()].transform * localTRS.toMatrix();
 
-        currentTransform = currWayPoints[waypoints.size()].transform * currentTransform;
-
-        PathWaypoint addedWaypoint(translation,
+        PathWaypoint addedWaypoint(localTRS,
                                    rotation,
-                                   scale,
                                    currentTime * 1000.0, currentTransform);
 
         currWayPoints[waypoints.size()] = addedWaypoint;
@@ -480,16 +407,11 @@ void ProcessChild(const Document* document, const GLTFResourceReader* resourceRe
     std::vector<PathWaypoint> waypoints;
     const auto& node = document->nodes.Elements()[childNodeIndex];
 
-    Vector4 position = Vector4(node.translation.x, node.translation.y, node.translation.z);
-    Vector4 quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
-    Vector4 rotation = Vector4(-GetRoll(quaternion), -GetPitch(quaternion), -GetYaw(quaternion));
-    Vector4 scale = Vector4(node.scale.x, node.scale.y, node.scale.z);
+    Vector4    position = Vector4(node.translation.x, node.translation.y, node.translation.z);
+    Quaternion quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
+    Vector4    scale = Vector4(node.scale.x, node.scale.y, node.scale.z);
 
-    auto transform = Matrix::translation(position.getx(), position.gety(), position.getz()) *
-                        Matrix::rotationAroundY(rotation.gety()) *
-                        Matrix::rotationAroundZ(rotation.getz()) *
-                        Matrix::rotationAroundX(rotation.getx()) *
-                        Matrix::scale(scale.getx(), scale.gety(), scale.getz());
+    auto transform = TRS(position, quaternion, scale).toMatrix();
 
     auto newTransform = currentTransform * transform;
 
@@ -622,20 +544,11 @@ void BuildGltfMeshes(const Document*           document,
 
         Matrix currentTransform = Matrix();
 
-        Vector4 position = Vector4(node.translation.x, node.translation.y, node.translation.z);
-        Vector4 quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
-        Vector4 rotation =
-            Vector4(-GetRoll(quaternion),
-                    -GetPitch(quaternion),
-                    -GetYaw(quaternion));
-        Vector4 scale = Vector4(node.scale.x, node.scale.y, node.scale.z);
-
-        currentTransform =
-            Matrix::translation(position.getx(), position.gety(), position.getz()) *
-            Matrix::rotationAroundY(rotation.gety()) *
-            Matrix::rotationAroundZ(rotation.getz()) *
-            Matrix::rotationAroundX(rotation.getx()) *
-            Matrix::scale(scale.getx(), scale.gety(), scale.getz());
+        Vector4    position = Vector4(node.translation.x, node.translation.y, node.translation.z);
+        Quaternion quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
+        Vector4    scale = Vector4(node.scale.x, node.scale.y, node.scale.z);
+
+        currentTransform = TRS(position, quaternion, scale).toMatrix();
 
         meshNodeTransforms[nodeIndex] = meshNodeTransforms[nodeIndex] * currentTransform;
 
@@ -1194,12 +1107,12 @@ void BuildGltfMeshes(const Document*           document,
             {
                 camSettingsFound = true;
                 Vector4 cameraPosition(node.translation.x, node.translation.y, node.translation.z);
-                Vector4 quaternion(node.rotation.x,
-                                   node.rotation.y,
-                                   node.rotation.z,
-                                   node.rotation.w);
+                Quaternion quaternion(node.rotation.x,
+                                      node.rotation.y,
+                                      node.rotation.z,
+                                      node.rotation.w);
 
-                Vector4 baseQuaternion(-0.7071067690849304, 0.0, 0.0, 0.7071067690849304);
+                Quaternion baseQuaternion(-0.7071067690849304f, 0.0f, 0.0f, 0.7071067690849304f);
 
                 camSettings.bobble           = false;
                 camSettings.lockedEntity     = -1;
@@ -1209,9 +1122,7 @@ void BuildGltfMeshes(const Document*           document,
                 camSettings.position         = cameraPosition;
                 // Default camera orients in the negative Y direction
                 camSettings.rotation =
-                    Vector4(GetRoll(baseQuaternion) + GetRoll(quaternion),
-                            GetPitch(baseQuaternion) + GetPitch(quaternion),
-                            GetYaw(baseQuaternion) + GetYaw(quaternion));
+                    baseQuaternion.toEulerDegrees() + quaternion.toEulerDegrees();
 
                 auto viewMan     = ModelBroker::getViewManager();
                 camSettings.type = ViewEventDistributor::CameraType::WAYPOINT;
@@ -1246,14 +1157,13 @@ void BuildGltfMeshes(const Document*           document,
 
                 SceneEntity sceneEntity;
 
-                Vector4 quaternion(node.rotation.x, node.rotation.y, node.rotation.z,
-                                   node.rotation.w);
+                Quaternion quaternion(node.rotation.x, node.rotation.y, node.rotation.z,
+                                      node.rotation.w);
                 sceneEntity.modelname = meshModel->getName();
                 sceneEntity.name      = meshModel->getName() + std::to_string(nodeIndex);
                 sceneEntity.position =
                     Vector4(node.translation.x, node.translation.y, node.translation.z);
-                sceneEntity.rotation =
-                    Vector4(GetRoll(quaternion), GetPitch(quaternion), GetYaw(quaternion));
+                sceneEntity.rotation = quaternion.toEulerDegrees();
                 sceneEntity.scale = Vector4(node.scale.x, node.scale.y, node.scale.z);
 
                 sceneEntity.useTransform = true;
@@ -1275,7 +1185,6 @@ void BuildGltfMeshes(const Document*           document,
         if (camSettingsFound == false)
         {
             Vector4 cameraPosition(0, 0, 0);
-            Vector4 quaternion(0, 0, 0, 0);
 
             camSettings.bobble           = false;
             camSettings.lockedEntity     = -1;
@@ -1285,12 +1194,10 @@ void BuildGltfMeshes(const Document*           document,
             camSettings.position         = cameraPosition;
             camSettings.fov              = 30.0f;
 
-            Vector4 baseQuaternion(-0.7071067690849304, 0.0, 0.0, 0.7071067690849304);
+            Quaternion baseQuaternion(-0.7071067690849304f, 0.0f, 0.0f, 0.7071067690849304f);
 
             // Default camera orients in the negative Y direction
-            camSettings.rotation = Vector4(GetRoll(baseQuaternion),
-                                           GetPitch(baseQuaternion),
-                                           GetYaw(baseQuaternion));
+            camSettings.rotation = baseQuaternion.toEulerDegrees();
 
             auto viewMan     = ModelBroker::getViewManager();
             camSettings.type = ViewEventDistributor::CameraType::WAYPOINT;
@@ -1367,9 +1274,9 @@ void BuildGltfMeshes(const Document*           document,
 
                             if (readLightIndex == lightIndex)
                             {
-                                Vector4 quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
+                                Quaternion quaternion(node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w);
                                 sceneLight.position = Vector4(node.translation.x, node.translation.y, node.translation.z);
-                                //sceneLight.rotation = Vector4(-GetRoll(quaternion), -GetPitch(quaternion), -GetYaw(quaternion));
+                                //sceneLight.rotation = -quaternion.toEulerDegrees();
                                 lightNodeIndex = nodeIndex;
                                 foundLight = true;
                             }
@@ -68,14 +68,22 @@ void Model::addVAO(ModelClass classType)
 
 void Model::updateModel(Model* model)
 {
+    // Read before taking our own lock, model can be this
+    AABB bounds = model->getBounds();
+
     std::lock_guard<std::mutex> lockGuard(_updateLock);
     this->_vao      = model->_vao;
+    this->_bounds   = bounds;
 }
 
 std::vector<VAO*>* Model::getVAO() { return &_vao; }
 
 unsigned int Model::getId() { return _modelId; }
 
+void Model::setResourceId(uint64_t resourceId) { _resourceId = resourceId; }
+
+uint64_t Model::getResourceId() { return _resourceId; }
+
 ModelClass Model::getClassType() { return _classId; }
 
 std::string Model::getName() { return _name; }
@@ -203,3 +211,18 @@ void Model::setInstances(std::vector<Vector4> offsets)
 bool Model::getIsInstancedModel() { return _isInstanced; }
 float* Model::getInstanceOffsets() { return _offsets; }
 GltfLoader* Model::getGltfLoader() { return _gltfLoader; }
+
+AABB Model::getBounds()
+{
+    std::lock_guard<std::mutex> lockGuard(_updateLock);
+    return _bounds;
+}
+
+void Model::computeBounds()
+{
+    std::vector<Vector4>* vertices = _renderBuffers.getVertices();
+    AABB                  bounds   = AABB::fromPoints(vertices->data(), vertices->size());
+
+    std::lock_guard<std::mutex> lockGuard(_updateLock);
+    _bounds = bounds;
+}
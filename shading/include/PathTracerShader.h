@@ -65,7 +65,7 @@ class PathTracerShader : public ShaderBase
     UINT                         _frameIndex;
     UINT                         _numSampleSets = 83;
     Samplers::MultiJittered      _randomSampler;
-    std::mt19937                 _generatorURNG;
+    Random::PCG32                _generatorURNG;
     bool                         _denoising;
     DXRStateObject*              _dxrStateObject;
 
@@ -28,7 +28,9 @@
 
 class StaticShader : public ShaderBase
 {
-    int _entityDrawIndex;
+    int  _getInstanceBufferIndex(Entity* entity);
+    void _drawInstances(Entity* entity, int instanceCount);
+
   public:
     StaticShader(std::string shaderName);
     virtual ~StaticShader();
@@ -0,0 +1,101 @@
+// Generated by KernelTables::emitHLSL from math/include/KernelTables.h, do not edit.
+// Define one of the kernel names before including this file.
+
+namespace FilterKernel
+{
+#if defined(BOX_KERNEL_3X3)
+static const unsigned int Radius          = 1;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.333333343, 0.333333343, 0.333333343};
+static const float        Kernel[Width][Width] = {
+    {0.111111119, 0.111111119, 0.111111119},
+    {0.111111119, 0.111111119, 0.111111119},
+    {0.111111119, 0.111111119, 0.111111119},
+};
+#endif
+
+#if defined(BOX_KERNEL_5X5)
+static const unsigned int Radius          = 2;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.200000003, 0.200000003, 0.200000003, 0.200000003, 0.200000003};
+static const float        Kernel[Width][Width] = {
+    {0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028},
+    {0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028},
+    {0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028},
+    {0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028},
+    {0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028, 0.0400000028},
+};
+#endif
+
+#if defined(BOX_KERNEL_7X7)
+static const unsigned int Radius          = 3;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.142857149, 0.142857149, 0.142857149, 0.142857149, 0.142857149, 0.142857149, 0.142857149};
+static const float        Kernel[Width][Width] = {
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+    {0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647, 0.0204081647},
+};
+#endif
+
+#if defined(GAUSSIAN_KERNEL_3X3)
+static const unsigned int Radius          = 1;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.279010117, 0.441979796, 0.279010117};
+static const float        Kernel[Width][Width] = {
+    {0.0778466463, 0.123316832, 0.0778466463},
+    {0.123316832, 0.195346147, 0.123316832},
+    {0.0778466463, 0.123316832, 0.0778466463},
+};
+#endif
+
+#if defined(GAUSSIAN_KERNEL_5X5)
+static const unsigned int Radius          = 2;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.0625, 0.25, 0.375, 0.25, 0.0625};
+static const float        Kernel[Width][Width] = {
+    {0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625},
+    {0.015625, 0.0625, 0.09375, 0.0625, 0.015625},
+    {0.0234375, 0.09375, 0.140625, 0.09375, 0.0234375},
+    {0.015625, 0.0625, 0.09375, 0.0625, 0.015625},
+    {0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625},
+};
+#endif
+
+#if defined(GAUSSIAN_KERNEL_7X7)
+static const unsigned int Radius          = 3;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.00597981829, 0.0606257431, 0.241842851, 0.383103162, 0.241842851, 0.0606257431, 0.00597981829};
+static const float        Kernel[Width][Width] = {
+    {3.57582285e-05, 0.000362530933, 0.00144617632, 0.00229088729, 0.00144617632, 0.000362530933, 3.57582285e-05},
+    {0.000362530933, 0.00367548084, 0.0146619026, 0.0232259147, 0.0146619026, 0.00367548084, 0.000362530933},
+    {0.00144617632, 0.0146619026, 0.0584879629, 0.0926507637, 0.0584879629, 0.0146619026, 0.00144617632},
+    {0.00229088729, 0.0232259147, 0.0926507637, 0.146768034, 0.0926507637, 0.0232259147, 0.00229088729},
+    {0.00144617632, 0.0146619026, 0.0584879629, 0.0926507637, 0.0584879629, 0.0146619026, 0.00144617632},
+    {0.000362530933, 0.00367548084, 0.0146619026, 0.0232259147, 0.0146619026, 0.00367548084, 0.000362530933},
+    {3.57582285e-05, 0.000362530933, 0.00144617632, 0.00229088729, 0.00144617632, 0.000362530933, 3.57582285e-05},
+};
+#endif
+
+#if defined(GAUSSIAN_KERNEL_9X9)
+static const unsigned int Radius          = 4;
+static const unsigned int Width           = 1 + 2 * Radius;
+static const float        Kernel1D[Width] = {0.000229232959, 0.00597707694, 0.0605979487, 0.241731986, 0.382927537, 0.241731986, 0.0605979487, 0.00597707694, 0.000229232959};
+static const float        Kernel[Width][Width] = {
+    {5.2547751e-08, 1.37014308e-06, 1.38910473e-05, 5.54129401e-05, 8.77796119e-05, 5.54129401e-05, 1.38910473e-05, 1.37014308e-06, 5.2547751e-08},
+    {1.37014308e-06, 3.57254503e-05, 0.000362198596, 0.0014448507, 0.00228878739, 0.0014448507, 0.000362198596, 3.57254503e-05, 1.37014308e-06},
+    {1.38910473e-05, 0.000362198596, 0.00367211131, 0.0146484626, 0.0232046228, 0.0146484626, 0.00367211131, 0.000362198596, 1.38910473e-05},
+    {5.54129401e-05, 0.0014448507, 0.0146484626, 0.0584343523, 0.0925658345, 0.0584343523, 0.0146484626, 0.0014448507, 5.54129401e-05},
+    {8.77796119e-05, 0.00228878739, 0.0232046228, 0.0925658345, 0.146633506, 0.0925658345, 0.0232046228, 0.00228878739, 8.77796119e-05},
+    {5.54129401e-05, 0.0014448507, 0.0146484626, 0.0584343523, 0.0925658345, 0.0584343523, 0.0146484626, 0.0014448507, 5.54129401e-05},
+    {1.38910473e-05, 0.000362198596, 0.00367211131, 0.0146484626, 0.0232046228, 0.0146484626, 0.00367211131, 0.000362198596, 1.38910473e-05},
+    {1.37014308e-06, 3.57254503e-05, 0.000362198596, 0.0014448507, 0.00228878739, 0.0014448507, 0.000362198596, 3.57254503e-05, 1.37014308e-06},
+    {5.2547751e-08, 1.37014308e-06, 1.38910473e-05, 5.54129401e-05, 8.77796119e-05, 5.54129401e-05, 1.38910473e-05, 1.37014308e-06, 5.2547751e-08},
+};
+#endif
+
+} // namespace FilterKernel
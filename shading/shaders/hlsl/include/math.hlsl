@@ -350,6 +350,24 @@ float halfFloatToFloat(min16uint halfFloat)
     return asfloat(value);
 }
 
+// Two half floats packed by Packing::packHalf2, x in the low 16 bits
+float2 unpackHalf2(uint packed)
+{
+    return f16tof32(uint2(packed & 0xFFFF, packed >> 16));
+}
+
+// Octahedral normal packed by Packing::encodeOctahedral as snorm16 x and y
+float3 octahedralDecode(uint packed)
+{
+    int2   quantized = int2(packed << 16, packed) >> 16;
+    float2 encoded   = max(float2(quantized) / 32767.0, -1.0);
+
+    float3 normal = float3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float  t      = max(-normal.z, 0.0);
+    normal.xy += (normal.xy >= 0.0) ? -t : t;
+    return normalize(normal);
+}
+
 /// Convert the specified single precision float number to a half precision float number.
 static min16uint floatToHalfFloat(float floatValue)
 {
@@ -5,10 +5,9 @@
 
 struct CompressedAttribute
 {
-    float3    vertex;
-    uint      normalXY;
-    uint      normalZuvX;
-    uint      uvYUnused;
+    float3 vertex;
+    uint   normal; // Octahedral snorm16 x and y, decode with octahedralDecode
+    uint   uv;     // Half float u and v, decode with unpackHalf2
 };
 
 #define ColorValidBit     1
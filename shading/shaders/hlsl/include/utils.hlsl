@@ -16,17 +16,9 @@ float2 GetTexCoord(float2 barycentrics, uint instanceIndex, uint primitiveIndex)
               indexBuffer[NonUniformResourceIndex(instanceIndex)].Load((primitiveIndex * 3) + 1),
               indexBuffer[NonUniformResourceIndex(instanceIndex)].Load((primitiveIndex * 3) + 2));
 
-    texCoord[0] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uvYUnused & 0xFFFF)));
-
-    texCoord[1] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uvYUnused & 0xFFFF)));
-
-    texCoord[2] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uvYUnused & 0xFFFF)));
+    texCoord[0] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uv);
+    texCoord[1] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uv);
+    texCoord[2] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uv);
 
     float2 interpolatedUV = (texCoord[0] + barycentrics.x * (texCoord[1] - texCoord[0]) +
                              barycentrics.y * (texCoord[2] - texCoord[0]));
@@ -43,20 +35,9 @@ float3 GetNormalCoord(float2 barycentrics, uint instanceIndex, uint primitiveInd
               indexBuffer[NonUniformResourceIndex(instanceIndex)].Load((primitiveIndex * 3) + 1),
               indexBuffer[NonUniformResourceIndex(instanceIndex)].Load((primitiveIndex * 3) + 2));
 
-    normal[0] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX & 0xFFFF)));
-
-    normal[1] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX & 0xFFFF)));
-
-    normal[2] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX & 0xFFFF)));
+    normal[0] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normal);
+    normal[1] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normal);
+    normal[2] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normal);
 
     return normalize(normal[0] + barycentrics.x * (normal[1] - normal[0]) +
                      barycentrics.y * (normal[2] - normal[0]));
@@ -97,34 +78,15 @@ float3x3 GetTBN(float2 barycentrics, uint instanceIndex, uint primitiveIndex)
 
     float2 texCoord[3];
 
-    texCoord[0] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uvYUnused & 0xFFFF)));
-
-    texCoord[1] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uvYUnused & 0xFFFF)));
-
-    texCoord[2] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uvYUnused & 0xFFFF)));
+    texCoord[0] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uv);
+    texCoord[1] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uv);
+    texCoord[2] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uv);
 
     float3 normal[3];
 
-    normal[0] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX & 0xFFFF)));
-
-    normal[1] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX & 0xFFFF)));
-
-    normal[2] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX & 0xFFFF)));
+    normal[0] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normal);
+    normal[1] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normal);
+    normal[2] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normal);
 
     float3 surfaceNormal = normal[0] + barycentrics.x * (normal[1] - normal[0]) +
                            barycentrics.y * (normal[2] - normal[0]);
@@ -465,21 +427,14 @@ float3 GetVertex(uint instanceIndex, uint vertexId)
 float3 GetNormal(uint instanceIndex, uint vertexId)
 {
     float3 normal =
-       float3(halfFloatToFloat(
-                  min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).normalXY & 0xFFFF)),
-              halfFloatToFloat(
-                  min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).normalXY >> 16)),
-              halfFloatToFloat(
-                  min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).normalZuvX & 0xFFFF)));
+       octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).normal);
 
     return normal;
 }
 
 float2 GetUV(uint instanceIndex, uint vertexId)
 {
-    float2 uv = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).uvYUnused & 0xFFFF)));
+    float2 uv = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(vertexId).uv);
     return uv;
 }
 
@@ -499,34 +454,15 @@ float3x3 GetTBN(float3 surfaceNormal, uint instanceIndex, uint primitiveIndex)
 
     float2 texCoord[3];
 
-    texCoord[0] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uvYUnused & 0xFFFF)));
-
-    texCoord[1] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uvYUnused & 0xFFFF)));
-
-    texCoord[2] = float2(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uvYUnused & 0xFFFF)));
+    texCoord[0] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).uv);
+    texCoord[1] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).uv);
+    texCoord[2] = unpackHalf2(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).uv);
 
     float3 normal[3];
 
-    normal[0] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normalZuvX & 0xFFFF)));
-
-    normal[1] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normalZuvX & 0xFFFF)));
-
-    normal[2] = float3(
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY & 0xFFFF)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalXY >> 16)),
-        halfFloatToFloat(min16uint(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normalZuvX & 0xFFFF)));
+    normal[0] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.x).normal);
+    normal[1] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.y).normal);
+    normal[2] = octahedralDecode(vertexBuffer[NonUniformResourceIndex(instanceIndex)].Load(index.z).normal);
 
     float3 edge[2];
 
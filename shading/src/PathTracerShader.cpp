@@ -169,7 +169,7 @@ PathTracerShader::PathTracerShader(std::string shaderName)
 
     auto texBroker = TextureBroker::instance();
 
-    _generatorURNG.seed(1729);
+    _generatorURNG = Random::PCG32(1729);
 
     UINT pixelsInSampleSet1D = 8;
     UINT samplesPerSet       = 64;
@@ -401,11 +401,10 @@ void PathTracerShader::runShader(std::vector<Light*>&  lights,
     const long long timing = 500000;
     end                    = end % timing;
 
-    std::uniform_int_distribution<UINT> seedDistribution(0, UINT_MAX);
-    UINT                                seed                  = seedDistribution(_generatorURNG);
-    UINT                                numSamplesPerSet      = 64;
-    UINT                                numSampleSets         = 83;
-    UINT                                numPixelsPerDimPerSet = 8;
+    UINT seed                  = _generatorURNG.nextUInt();
+    UINT numSamplesPerSet      = 64;
+    UINT numSampleSets         = 83;
+    UINT numPixelsPerDimPerSet = 8;
 
  
     cmdList->BeginEvent(0, L"Reflection Rays", sizeof(L"Reflection Rays"));
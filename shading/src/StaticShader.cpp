@@ -3,6 +3,7 @@
 #include "EngineManager.h"
 #include "Entity.h"
 #include "HLSLShader.h"
+#include "InstanceSlotAllocator.h"
 #include "Model.h"
 #include "ModelBroker.h"
 
@@ -22,7 +23,6 @@ StaticShader::~StaticShader() {}
 
 void StaticShader::startEntity()
 {
-    _entityDrawIndex = 0;
    
     _shader->bind();
     ResourceManager* resourceManager = EngineManager::getResourceManager();
@@ -62,109 +62,55 @@ void StaticShader::startEntity()
 
 void StaticShader::runShader(std::vector<Entity*> entities)
 {
-    bool sameModel = false;
-    std::string currModelName = "";
-    int         instanceCount = 0;
-    Entity*     prevEntity    = nullptr;
-    int         numEntities   = entities.size();
-
-    for (auto entity : entities)
+    // Per instance buffers are indexed by instance slot, so entities only share an instanced
+    // draw while they use the same model and sit in consecutive slots
+    size_t batchStart = 0;
+    for (size_t index = 1; index <= entities.size(); index++)
     {
-        
-        if (entity->getModel()->getName().compare(currModelName) == 0 || currModelName.empty())
-        {
-            sameModel = true;
-            instanceCount++;
-        }
-        else
-        {
-            sameModel = false;
-        }
-
-        if (sameModel == false)
-        {
-            int instanceBufferStartIndex = _entityDrawIndex - instanceCount;
-            _shader->updateData("instanceBufferIndex", &instanceBufferStartIndex, false);
-
-            // Special vao call that factors in frustum culling for the scene
-            std::vector<VAO*>* vao = prevEntity->getFrustumVAO();
-            for (auto vaoInstance : *vao)
-            {
-                _shader->bindAttributes(vaoInstance, false);
-
-                auto indexAndVertexBufferStrides = vaoInstance->getVertexAndIndexBufferStrides();
-                unsigned int strideLocation      = 0;
-
-                for (auto indexAndVertexBufferStride : indexAndVertexBufferStrides)
-                {
-                    _shader->draw(strideLocation, instanceCount, indexAndVertexBufferStride.second);
-
-                    strideLocation += indexAndVertexBufferStride.second;
-                }
-
-                _shader->unbindAttributes();
-            }
-
-            instanceCount = 1;
-        }
-
-        // Draw the last entity here
-        if(entity == entities[numEntities - 1])
+        if (index < entities.size() &&
+            entities[index]->getModel()->getName().compare(entities[batchStart]->getModel()->getName()) == 0 &&
+            _getInstanceBufferIndex(entities[index]) == _getInstanceBufferIndex(entities[index - 1]) + 1)
         {
-            int instanceBufferStartIndex = (_entityDrawIndex + 1) - instanceCount;
-            _shader->updateData("instanceBufferIndex", &instanceBufferStartIndex, false);
-
-            // Special vao call that factors in frustum culling for the scene
-            std::vector<VAO*>* vao = entity->getFrustumVAO();
-            for (auto vaoInstance : *vao)
-            {
-                _shader->bindAttributes(vaoInstance, false);
-
-                auto indexAndVertexBufferStrides = vaoInstance->getVertexAndIndexBufferStrides();
-                unsigned int strideLocation      = 0;
-
-                for (auto indexAndVertexBufferStride : indexAndVertexBufferStrides)
-                {
-                    _shader->draw(strideLocation, instanceCount, indexAndVertexBufferStride.second);
-
-                    strideLocation += indexAndVertexBufferStride.second;
-                }
-
-                _shader->unbindAttributes();
-            }
+            continue;
         }
 
-        prevEntity = entity;
-        currModelName = entity->getModel()->getName();
-
-        _entityDrawIndex++;
+        _drawInstances(entities[batchStart], static_cast<int>(index - batchStart));
+        batchStart = index;
     }
 }
 
 void StaticShader::runShader(Entity* entity)
 {
-    _shader->updateData("instanceBufferIndex", &_entityDrawIndex, false);
+    _drawInstances(entity, 1);
+    _shader->unbind();
+}
+
+int StaticShader::_getInstanceBufferIndex(Entity* entity)
+{
+    return static_cast<int>(InstanceSlotHandle{entity->getInstanceSlot()}.GetSlot());
+}
+
+void StaticShader::_drawInstances(Entity* entity, int instanceCount)
+{
+    int instanceBufferStartIndex = _getInstanceBufferIndex(entity);
+    _shader->updateData("instanceBufferIndex", &instanceBufferStartIndex, false);
 
     // Special vao call that factors in frustum culling for the scene
     std::vector<VAO*>* vao = entity->getFrustumVAO();
     for (auto vaoInstance : *vao)
     {
         _shader->bindAttributes(vaoInstance, false);
-        
 
         auto         indexAndVertexBufferStrides = vaoInstance->getVertexAndIndexBufferStrides();
-        unsigned int strideLocation = 0;
+        unsigned int strideLocation              = 0;
 
         for (auto indexAndVertexBufferStride : indexAndVertexBufferStrides)
         {
-            _shader->draw(strideLocation, 1, indexAndVertexBufferStride.second);
+            _shader->draw(strideLocation, instanceCount, indexAndVertexBufferStride.second);
 
             strideLocation += indexAndVertexBufferStride.second;
         }
 
         _shader->unbindAttributes();
     }
-    _shader->unbind();
-
-    _entityDrawIndex++;
 }
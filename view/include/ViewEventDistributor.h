@@ -25,6 +25,7 @@
  */
 
 #pragma once
+#include "Bounds.h"
 #include "Camera.h"
 #include "EventSubscriber.h"
 #include "IOEventDistributor.h"
@@ -103,6 +104,7 @@ class ViewEventDistributor : public EventSubscriber
     Vector4              _prevCameraPos;
     Matrix               _prevCameraView;
     CameraType           _cameraType;
+    Frustum              _frameFrustum; // Rebuilt once a frame, shared by every entity
 
     void _updateKinematics(int milliSeconds);
     void _updateView(Camera* camera, Vector4 posV, Vector4 rotV);
@@ -120,6 +122,9 @@ class ViewEventDistributor : public EventSubscriber
     void              displayViewFrustum();
     ViewEvents*       getEventWrapper();
     Matrix            getFrustumView();
+    // Rebuilds the frustum getFrustum hands out from the current view and projection
+    void              updateFrustum();
+    const Frustum&    getFrustum();
     Matrix            getProjection();
     void              triggerEvents();
     Vector4           getCameraPos();
@@ -21,6 +21,7 @@
 
 #pragma once
 #include "Camera.h"
+#include "Curve.h"
 #include "WaypointPath.h"
 
 enum class WaypointType
@@ -44,6 +45,7 @@ class WaypointCamera : public Camera
   private:
     void        _loadWaypointsFromFile(const std::string& file);
     void        _calculateVelocities(StateVector* state);
+    void        _buildCurves();
     std::string _name;
 
     bool                      _visualize;
@@ -62,5 +64,9 @@ class WaypointCamera : public Camera
     Matrix                    _view;
     Matrix                    _projection;
     WaypointType              _wayPointType;
+    Curve                     _positionCurve;
+    Curve                     _rotationCurve; // Euler angles unwrapped to turn the short way
+    Curve::Cursor             _positionCursor;
+    Curve::Cursor             _rotationCursor;
 
 };
\ No newline at end of file
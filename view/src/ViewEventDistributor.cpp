@@ -5,7 +5,7 @@
 #include "Logger.h"
 #include "Matrix.h"
 #include "Model.h"
-#include "Randomization.h"
+#include "Random.h"
 #include "ShaderBroker.h"
 #include "StateVector.h"
 #include "ViewEvents.h"
@@ -275,6 +275,10 @@ void ViewEventDistributor::triggerEvents()
 
 Matrix ViewEventDistributor::getProjection() { return _currCamera->getProjection(); }
 
+void ViewEventDistributor::updateFrustum() { _frameFrustum = Frustum(getView(), getProjection()); }
+
+const Frustum& ViewEventDistributor::getFrustum() { return _frameFrustum; }
+
 Matrix ViewEventDistributor::getView()
 {
     auto cameraView                = _currCamera->getView();
@@ -610,7 +614,7 @@ void ViewEventDistributor::_updateDraw()
         // bobble it!
         if (_bobble)
         { // Ignore this for now. WIP
-            auto& bobbleVector = Randomization::pointInSphere();
+            auto bobbleVector = Random::pointInSphere(Random::threadGenerator());
             rotation += bobbleVector / 100;
         }
         _updateView(_currCamera, position, rotation);
@@ -19,6 +19,8 @@ void WaypointCamera::reset()
     _elapsedTime     = 0;
     _currentVelocity = Vector4();
     _currentRotation = Vector4();
+    _positionCursor  = Curve::Cursor();
+    _rotationCursor  = Curve::Cursor();
     _initialPosition = state->getLinearPosition();
     if (_waypoints.size() > 0)
     {
@@ -37,6 +39,7 @@ void WaypointCamera::setWaypoints(const std::vector<PathWaypoint>& waypoints)
     _waypoints       = waypoints;
     _elapsedTime     = 0;
     _currentWaypoint = -1;
+    _buildCurves();
     reset();
 }
 
@@ -110,30 +113,19 @@ void WaypointCamera::updateState(int milliseconds)
     }
     else if (_wayPointType == WaypointType::LinearWaypoints)
     {
-        if (_currentWaypoint != -1 && _currentWaypoint < _waypoints.size())
+        if (_currentWaypoint != -1 && _waypoints.empty() == false)
         {
-            if (_elapsedTime >= _waypoints[_currentWaypoint].time)
+            // Stops on the last waypoint instead of looping
+            if (_elapsedTime > _positionCurve.getEndTime())
             {
-                _currentWaypoint++;
-
-                if (_currentWaypoint >= _waypoints.size())
-                {
-                    _currentWaypoint = -1;
-                    return;
-                }
-
-                for (int i = _currentWaypoint; i < _waypoints.size(); i++)
-                {
-                    if (_elapsedTime > _waypoints[i].time)
-                    {
-                        _currentWaypoint = i;
-                        break;
-                    }
-                }
-
-                state->setLinearPosition(_waypoints[_currentWaypoint].position);
-                state->setAngularPosition(_waypoints[_currentWaypoint].rotation);
+                _currentWaypoint = -1;
+                return;
             }
+
+            float time = static_cast<float>(_elapsedTime);
+            state->setLinearPosition(_positionCurve.evaluate(time, _positionCursor));
+            state->setAngularPosition(_rotationCurve.evaluate(time, _rotationCursor));
+            _currentWaypoint = static_cast<int>(_positionCursor.segment);
             _elapsedTime += milliseconds;
         }
     }
@@ -219,4 +211,31 @@ void WaypointCamera::_loadWaypointsFromFile(const std::string& file)
             _waypoints.back().linearVelocity = velocity;
         }
     }
-}
\ No newline at end of file
+}
+
+void WaypointCamera::_buildCurves()
+{
+    _positionCurve = Curve(CurveInterpolation::Linear);
+    _rotationCurve = Curve(CurveInterpolation::Linear);
+    _positionCurve.reserve(_waypoints.size());
+    _rotationCurve.reserve(_waypoints.size());
+
+    Vector4 previous;
+    for (size_t i = 0; i < _waypoints.size(); i++)
+    {
+        // Shift each angle by whole turns so it lands within 180 degrees of the previous key
+        Vector4 rotation = _waypoints[i].rotation;
+        if (i > 0)
+        {
+            float* angles = rotation.getFlatBuffer();
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float delta = angles[axis] - previous.getFlatBuffer()[axis];
+                angles[axis] -= 360.0f * roundf(delta / 360.0f);
+            }
+        }
+        _positionCurve.addKey(_waypoints[i].time, _waypoints[i].position);
+        _rotationCurve.addKey(_waypoints[i].time, rotation);
+        previous = rotation;
+    }
+}